@@ -0,0 +1,322 @@
+#include "AsyncMeshLoader.h"
+#include "MeshBounds.h"
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	double MillisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	// --------------------------------------------------------
+	// Turns an OBJ index (1-based, or negative = relative to
+	// the end) into a 0-based one, or -1 if it's out of range
+	// --------------------------------------------------------
+	int ResolveOBJIndex(int index, int count)
+	{
+		int resolved = index > 0 ? index - 1 : count + index;
+		return (resolved >= 0 && resolved < count) ? resolved : -1;
+	}
+
+	// --------------------------------------------------------
+	// Minimal OBJ reader - positions (plus the common "v x y z
+	// r g b" color extension) and faces of any size
+	//  - UVs and normals are skipped, Vertex has no room for them
+	//  - OBJ is right-handed with counter-clockwise front faces,
+	//    so Z is flipped and the winding reversed to match ours
+	// --------------------------------------------------------
+	bool DecodeOBJ(const std::wstring& path, MeshData& out)
+	{
+		std::ifstream file{ std::filesystem::path(path) };
+		if (!file.is_open())
+			return false;
+
+		std::vector<Vertex> positions;
+		std::vector<int> face;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream stream(line);
+			std::string type;
+			stream >> type;
+
+			if (type == "v")
+			{
+				Vertex v = {};
+				v.Color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+				stream >> v.Position.x >> v.Position.y >> v.Position.z;
+				v.Position.z = -v.Position.z;
+
+				float r, g, b;
+				if (stream >> r >> g >> b)
+					v.Color = XMFLOAT4(r, g, b, 1.0f);
+
+				positions.push_back(v);
+			}
+			else if (type == "f")
+			{
+				// Each corner is "p", "p/t", "p//n" or "p/t/n" - only p matters
+				face.clear();
+				std::string corner;
+				while (stream >> corner)
+				{
+					int index = ResolveOBJIndex(std::atoi(corner.c_str()), (int)positions.size());
+					if (index < 0)
+						return false;
+					face.push_back(index);
+				}
+
+				// Fan triangulation, reversed for clockwise winding
+				for (size_t i = 2; i < face.size(); i++)
+				{
+					out.Indices.push_back(face[0]);
+					out.Indices.push_back(face[i]);
+					out.Indices.push_back(face[i - 1]);
+				}
+			}
+		}
+
+		out.Vertices = std::move(positions);
+		return !out.Indices.empty();
+	}
+}
+
+size_t MeshData::GetByteSize() const
+{
+	return Vertices.size() * sizeof(Vertex) + Indices.size() * sizeof(unsigned int);
+}
+
+MeshHandle::MeshHandle(std::shared_ptr<MeshLoadSlot> slot) :
+	slot(slot)
+{
+}
+
+MeshLoadState MeshHandle::GetState() const
+{
+	return slot ? slot->State.load(std::memory_order_acquire) : MeshLoadState::Failed;
+}
+
+bool MeshHandle::IsReady() const { return GetState() == MeshLoadState::Ready; }
+bool MeshHandle::IsPending() const { return GetState() == MeshLoadState::Pending; }
+
+const std::string& MeshHandle::GetName() const
+{
+	static const std::string empty;
+	return slot ? slot->Name : empty;
+}
+
+std::shared_ptr<Mesh> MeshHandle::GetMesh() const
+{
+	return IsReady() ? slot->Result : nullptr;
+}
+
+AsyncMeshLoader::AsyncMeshLoader(MeshUploader uploader, unsigned int workerCount, size_t uploadBudgetBytes) :
+	uploader(uploader),
+	uploadBudget(uploadBudgetBytes),
+	activeJobs(0),
+	stopping(false),
+	stats()
+{
+	workerCount = std::max(workerCount, 1u);
+	for (unsigned int i = 0; i < workerCount; i++)
+		workers.emplace_back(&AsyncMeshLoader::WorkerLoop, this);
+}
+
+// --------------------------------------------------------
+// Stops the workers after their current job - anything
+// still queued or waiting for upload is marked as failed,
+// and counted as such so Requested still adds up
+// --------------------------------------------------------
+AsyncMeshLoader::~AsyncMeshLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	for (Job& job : jobs)
+		job.Slot->State.store(MeshLoadState::Failed, std::memory_order_release);
+	for (DecodedMesh& mesh : decoded)
+		mesh.Slot->State.store(MeshLoadState::Failed, std::memory_order_release);
+
+	std::lock_guard<std::mutex> lock(decodedMutex);
+	stats.Failed += (unsigned int)(jobs.size() + decoded.size());
+	jobs.clear();
+	decoded.clear();
+}
+
+MeshHandle AsyncMeshLoader::Load(const std::string& name, MeshDecoder decoder)
+{
+	std::shared_ptr<MeshLoadSlot> slot = std::make_shared<MeshLoadSlot>();
+	slot->Name = name;
+
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		stats.Requested++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		jobs.push_back({ slot, std::move(decoder) });
+	}
+	jobAvailable.notify_one();
+
+	return MeshHandle(slot);
+}
+
+MeshHandle AsyncMeshLoader::LoadOBJ(const std::wstring& path)
+{
+	return Load(std::filesystem::path(path).filename().string(),
+		[path](MeshData& out) { return DecodeOBJ(path, out); });
+}
+
+// --------------------------------------------------------
+// Read, decode and optimize - everything except the GPU
+// --------------------------------------------------------
+void AsyncMeshLoader::WorkerLoop()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping)
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			activeJobs++;
+		}
+
+		Clock::time_point start = Clock::now();
+
+		DecodedMesh result;
+		result.Slot = job.Slot;
+		bool success = job.Decoder(result.Data) && !result.Data.Indices.empty();
+		if (success)
+		{
+			MeshData& data = result.Data;
+			VertexWelder::Weld(data.Vertices, data.Indices);
+			data.Box = MeshBounds::ComputeBox(data.Vertices.data(), (int)data.Vertices.size(), sizeof(Vertex));
+			data.Sphere = MeshBounds::ComputeSphere(data.Vertices.data(), (int)data.Vertices.size(), sizeof(Vertex));
+		}
+
+		double elapsed = MillisecondsSince(start);
+		{
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			stats.DecodeMilliseconds += elapsed;
+			if (success)
+			{
+				stats.Decoded++;
+				decoded.push_back(std::move(result));
+			}
+			else
+			{
+				stats.Failed++;
+				job.Slot->State.store(MeshLoadState::Failed, std::memory_order_release);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			activeJobs--;
+			if (jobs.empty() && activeJobs == 0)
+				jobsDrained.notify_all();
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Uploads decoded meshes until this frame's byte budget is
+// spent. At least one mesh goes up per call, so a mesh
+// larger than the whole budget still gets through.
+// --------------------------------------------------------
+void AsyncMeshLoader::Update()
+{
+	Clock::time_point start = Clock::now();
+	size_t bytesThisFrame = 0;
+	unsigned int uploaded = 0;
+	unsigned int failed = 0;
+
+	while (true)
+	{
+		DecodedMesh mesh;
+		{
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			if (decoded.empty())
+				break;
+
+			size_t size = decoded.front().Data.GetByteSize();
+			if (bytesThisFrame > 0 && bytesThisFrame + size > uploadBudget)
+				break;
+
+			mesh = std::move(decoded.front());
+			decoded.pop_front();
+			bytesThisFrame += size;
+		}
+
+		std::shared_ptr<Mesh> result;
+		if (uploader(mesh.Data, result))
+		{
+			mesh.Slot->Result = result;
+			mesh.Slot->State.store(MeshLoadState::Ready, std::memory_order_release);
+			uploaded++;
+		}
+		else
+		{
+			mesh.Slot->State.store(MeshLoadState::Failed, std::memory_order_release);
+			failed++;
+		}
+	}
+
+	double elapsed = MillisecondsSince(start);
+
+	std::lock_guard<std::mutex> lock(decodedMutex);
+	stats.Uploaded += uploaded;
+	stats.Failed += failed;
+	stats.BytesUploaded += bytesThisFrame;
+	stats.UploadMilliseconds += elapsed;
+	stats.LastUploadMilliseconds = elapsed;
+	stats.MaxUploadMilliseconds = std::max(stats.MaxUploadMilliseconds, elapsed);
+}
+
+void AsyncMeshLoader::WaitForDecodes()
+{
+	std::unique_lock<std::mutex> lock(jobMutex);
+	jobsDrained.wait(lock, [this]() { return jobs.empty() && activeJobs == 0; });
+}
+
+bool AsyncMeshLoader::IsIdle() { return GetPendingCount() == 0; }
+
+unsigned int AsyncMeshLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(decodedMutex);
+	return stats.Requested - stats.Uploaded - stats.Failed;
+}
+
+MeshLoadStats AsyncMeshLoader::GetStats()
+{
+	std::lock_guard<std::mutex> lock(decodedMutex);
+	return stats;
+}
+
+size_t AsyncMeshLoader::GetUploadBudget() { return uploadBudget; }
+void AsyncMeshLoader::SetUploadBudget(size_t bytesPerFrame) { uploadBudget = bytesPerFrame; }
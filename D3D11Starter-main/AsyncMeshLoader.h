@@ -0,0 +1,168 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Vertex.h"
+
+class Mesh;
+
+// Where a mesh is in the loading pipeline
+enum class MeshLoadState
+{
+	Pending,	// Queued, decoding on a worker, or waiting for upload
+	Ready,		// Uploaded - safe to draw
+	Failed		// Decode or upload failed (or the loader shut down first)
+};
+
+// --------------------------------------------------------
+// CPU-side mesh data, produced on a worker thread and
+// handed to the main thread for upload
+// --------------------------------------------------------
+struct MeshData
+{
+	std::vector<Vertex> Vertices;
+	std::vector<unsigned int> Indices;
+
+	// Filled in by the loader after decoding
+	DirectX::BoundingBox Box;
+	DirectX::BoundingSphere Sphere;
+
+	size_t GetByteSize() const;
+};
+
+// State shared between the loader and every copy of a handle
+struct MeshLoadSlot
+{
+	std::string Name;
+	std::atomic<MeshLoadState> State = MeshLoadState::Pending;
+	std::shared_ptr<Mesh> Result;	// Only written on the main thread, before State becomes Ready
+};
+
+// --------------------------------------------------------
+// A cheap, copyable reference to a mesh that may still be
+// loading. Check IsReady() (or GetMesh() != nullptr) before
+// drawing, and skip or draw a proxy otherwise.
+// --------------------------------------------------------
+class MeshHandle
+{
+public:
+	MeshHandle() = default;
+	explicit MeshHandle(std::shared_ptr<MeshLoadSlot> slot);
+
+	MeshLoadState GetState() const;
+	bool IsReady() const;
+	bool IsPending() const;
+	const std::string& GetName() const;
+
+	// Null until the mesh is ready
+	std::shared_ptr<Mesh> GetMesh() const;
+
+private:
+	std::shared_ptr<MeshLoadSlot> slot;
+};
+
+// Decodes a mesh on a worker thread - return false on failure
+using MeshDecoder = std::function<bool(MeshData& out)>;
+
+// Turns decoded data into a GPU mesh on the main thread - return false
+// on failure. A stand-in can return true without creating anything.
+using MeshUploader = std::function<bool(MeshData& data, std::shared_ptr<Mesh>& outMesh)>;
+
+// Running totals, for profiling load throughput and main-thread stalls
+struct MeshLoadStats
+{
+	unsigned int Requested;
+	unsigned int Decoded;
+	unsigned int Uploaded;
+	unsigned int Failed;
+	size_t BytesUploaded;
+
+	double DecodeMilliseconds;		// Summed across all workers
+	double UploadMilliseconds;		// Main thread, summed over every Update()
+	double LastUploadMilliseconds;	// Main thread, most recent Update()
+	double MaxUploadMilliseconds;	// Main thread, worst single Update()
+};
+
+// --------------------------------------------------------
+// Loads meshes in the background
+//
+// - Worker threads run each decoder, weld the result and
+//   compute its bounds
+// - Update(), called once per frame on the main thread,
+//   uploads finished meshes until the frame's byte budget
+//   is used up, so a burst of loads can't stall a frame
+//
+// The uploader is the only part that touches the GPU, so
+// the whole pipeline can run headless with a stand-in.
+// --------------------------------------------------------
+class AsyncMeshLoader
+{
+public:
+	// Basic OOP Setup
+	AsyncMeshLoader(MeshUploader uploader, unsigned int workerCount = 2, size_t uploadBudgetBytes = 4 * 1024 * 1024);
+	~AsyncMeshLoader();
+	AsyncMeshLoader(const AsyncMeshLoader&) = delete;
+	AsyncMeshLoader& operator=(const AsyncMeshLoader&) = delete;
+
+	// Queues a load - the handle starts out pending
+	MeshHandle Load(const std::string& name, MeshDecoder decoder);
+	MeshHandle LoadOBJ(const std::wstring& path);
+
+	// Main thread, once per frame
+	void Update();
+
+	// Blocks until every queued decode has finished (uploads still
+	// wait for Update) - for loading screens and headless timing
+	void WaitForDecodes();
+
+	// Getters and setters
+	bool IsIdle();
+	unsigned int GetPendingCount();
+	MeshLoadStats GetStats();
+	size_t GetUploadBudget();
+	void SetUploadBudget(size_t bytesPerFrame);
+
+private:
+	struct Job
+	{
+		std::shared_ptr<MeshLoadSlot> Slot;
+		MeshDecoder Decoder;
+	};
+
+	struct DecodedMesh
+	{
+		std::shared_ptr<MeshLoadSlot> Slot;
+		MeshData Data;
+	};
+
+	void WorkerLoop();
+
+	MeshUploader uploader;
+	size_t uploadBudget;
+
+	// Worker side
+	std::vector<std::thread> workers;
+	std::mutex jobMutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobsDrained;
+	std::deque<Job> jobs;
+	unsigned int activeJobs;
+	bool stopping;
+
+	// Finished decodes waiting for the main thread
+	std::mutex decodedMutex;
+	std::deque<DecodedMesh> decoded;
+
+	// Guarded by decodedMutex (workers add decode time)
+	MeshLoadStats stats;
+};
@@ -1,10 +1,21 @@
 #include "Camera.h"
+#include "Input.h"
 
 using namespace DirectX;
 
-Camera::Camera(DirectX::XMFLOAT3 pos, float moveSpeed, float lookSpeed, float fov, float aspectRatio)
+Camera::Camera(DirectX::XMFLOAT3 pos, float moveSpeed, float lookSpeed, float fov, float aspectRatio) :
+	fieldOfView(fov),
+	nearClip(0.01f),
+	farClip(100.0f),
+	movementSpeed(moveSpeed),
+	mouseLookSpeed(lookSpeed)
 {
+	transform = std::make_shared<Transform>();
+	transform->SetPosition(pos);
 
+	// Both matrices are valid from the start, before any Update()
+	UpdateViewMatrix();
+	UpdteProjectMatrix(aspectRatio);
 }
 
 Camera::~Camera()
@@ -16,12 +27,12 @@ void Camera::Update(float dt)
 {
 	float speed = dt * movementSpeed;
 
-	if (Input::KeyDown('W')) { transform->Moverelative(0, 0, speed); }
-	if (Input::KeyDown('A')) { transform->Moverelative(-0, 0, -speed); }
-	if (Input::KeyDown('S')) { transform->Moverelative(-speed, 0, 0); }
-	if (Input::KeyDown('D')) { transform->Moverelative(speed, 0, 0); }
-	if (Input::KeyDown(' ')) { transform->Moverelative(0, speed, 0); }
-	if (Input::KeyDown('X')) { transform->Moverelative(0, -speed, 0); }
+	if (Input::KeyDown('W')) { transform->MoveRelative(0, 0, speed); }
+	if (Input::KeyDown('A')) { transform->MoveRelative(-speed, 0, 0); }
+	if (Input::KeyDown('S')) { transform->MoveRelative(0, 0, -speed); }
+	if (Input::KeyDown('D')) { transform->MoveRelative(speed, 0, 0); }
+	if (Input::KeyDown(' ')) { transform->MoveRelative(0, speed, 0); }
+	if (Input::KeyDown('X')) { transform->MoveRelative(0, -speed, 0); }
 
 	// Only rotate when clicking mouse
 	if (Input::MouseLeftDown())
@@ -30,7 +41,7 @@ void Camera::Update(float dt)
 		float yRot = mouseLookSpeed * Input::GetMouseXDelta();
 		float xRot = mouseLookSpeed * Input::GetMouseYDelta();
 
-		transform->Rotate(yRot, xRot, 0);
+		transform->Rotate(xRot, yRot, 0);
 	}
 
 	UpdateViewMatrix();
@@ -42,21 +53,25 @@ void Camera::UpdateViewMatrix()
 	XMFLOAT3 fwd = transform->GetForward();
 	XMFLOAT3 worldUp = XMFLOAT3(0, 1, 0);
 
-
-	XMMatrixLookAtLH(
-		XMLoadFloat3(&pos0),
+	// Forward is a direction, not a point to look at
+	XMMATRIX view = XMMatrixLookToLH(
+		XMLoadFloat3(&pos),
 		XMLoadFloat3(&fwd),
 		XMLoadFloat3(&worldUp));
+	XMStoreFloat4x4(&viewMatrix, view);
 }
 
 void Camera::UpdteProjectMatrix(float aspectRatio)
 {
-	XMMatrixPerspectiveFovLH(
-		XM_PIDIV4,
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(
+		fieldOfView,
 		aspectRatio,
-		0.01f,
-		100.0f);
+		nearClip,
+		farClip);
+	XMStoreFloat4x4(&projMatrix, projection);
 }
 
 DirectX::XMFLOAT4X4 Camera::GetView() {  return viewMatrix;  }
 DirectX::XMFLOAT4X4 Camera::GetProjection() { return projMatrix; }
+float Camera::GetNearClip() { return nearClip; }
+float Camera::GetFarClip() { return farClip; }
@@ -19,6 +19,8 @@ public:
 	// Getters
 	DirectX::XMFLOAT4X4 GetView();
 	DirectX::XMFLOAT4X4 GetProjection();
+	float GetNearClip();
+	float GetFarClip();
 
 private:
 	// Camera Matrices
@@ -26,10 +28,13 @@ private:
 	DirectX::XMFLOAT4X4 projMatrix;
 
 	// Transform
-	//std::shared_ptr<Transform> transform;
+	std::shared_ptr<Transform> transform;
 
 	// Other Camera related stuff
 	float fieldOfView;
+	float nearClip;
+	float farClip;
 	float movementSpeed;
+	float mouseLookSpeed;
 };
 
@@ -0,0 +1,310 @@
+#include "CommandList.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	enum class CommandType : uint32_t
+	{
+		SetInputLayout,
+		SetVertexShader,
+		SetPixelShader,
+		SetVertexBuffer,
+		SetIndexBuffer,
+		SetVSConstantBuffer,
+		SetVSConstantBufferRange,
+		UploadBuffer,
+		DrawIndexed,
+		DrawIndexedInstanced
+	};
+
+	// Starts every command - Size covers the header, the command
+	// and anything after it, so the reader can always skip ahead
+	struct CommandHeader
+	{
+		CommandType Type;
+		uint32_t Size;
+	};
+
+	// Layouts, shaders and index buffers - one pointer is all they need
+	struct SetObjectCommand
+	{
+		CommandHeader Header;
+		void* Object;
+	};
+
+	struct SetVertexBufferCommand
+	{
+		CommandHeader Header;
+		ID3D11Buffer* Buffer;
+		uint32_t Slot;
+		uint32_t Stride;
+		uint32_t Offset;
+	};
+
+	// A count of zero binds the whole buffer
+	struct SetConstantBufferCommand
+	{
+		CommandHeader Header;
+		ID3D11Buffer* Buffer;
+		uint32_t Slot;
+		uint32_t FirstConstant;
+		uint32_t ConstantCount;
+	};
+
+	// Followed by DataSize bytes of data
+	struct UploadBufferCommand
+	{
+		CommandHeader Header;
+		ID3D11Buffer* Buffer;
+		uint32_t DataSize;
+	};
+
+	// Both kinds of indexed draw
+	struct DrawCommand
+	{
+		CommandHeader Header;
+		uint32_t IndexCount;
+		uint32_t InstanceCount;
+		uint32_t StartIndex;
+		int32_t BaseVertex;
+		uint32_t StartInstance;
+	};
+
+	const size_t commandAlignment = sizeof(uint64_t);
+
+	size_t AlignSize(size_t size)
+	{
+		return (size + commandAlignment - 1) & ~(commandAlignment - 1);
+	}
+
+	// Commands are copied out rather than cast in place, so reading
+	// never depends on how the compiler lays out the storage
+	template <typename T>
+	T Read(const unsigned char* at)
+	{
+		T command;
+		memcpy(&command, at, sizeof(T));
+		return command;
+	}
+
+	SetObjectCommand MakeSetObject(CommandType type, void* object)
+	{
+		SetObjectCommand command = {};
+		command.Header.Type = type;
+		command.Object = object;
+		return command;
+	}
+}
+
+CommandList::CommandList() :
+	byteSize(0),
+	commandCount(0)
+{
+}
+
+CommandList::~CommandList()
+{
+}
+
+void CommandList::Reset()
+{
+	byteSize = 0;
+	commandCount = 0;
+}
+
+// --------------------------------------------------------
+// Walks the list from the front, decoding each command and
+// making the matching call on the target
+// --------------------------------------------------------
+void CommandList::Execute(RenderContext& target)
+{
+	const unsigned char* at = (const unsigned char*)storage.data();
+	const unsigned char* end = at + byteSize;
+
+	while (at < end)
+	{
+		CommandHeader header = Read<CommandHeader>(at);
+		switch (header.Type)
+		{
+		case CommandType::SetInputLayout:
+			target.SetInputLayout((ID3D11InputLayout*)Read<SetObjectCommand>(at).Object);
+			break;
+
+		case CommandType::SetVertexShader:
+			target.SetVertexShader((ID3D11VertexShader*)Read<SetObjectCommand>(at).Object);
+			break;
+
+		case CommandType::SetPixelShader:
+			target.SetPixelShader((ID3D11PixelShader*)Read<SetObjectCommand>(at).Object);
+			break;
+
+		case CommandType::SetIndexBuffer:
+			target.SetIndexBuffer((ID3D11Buffer*)Read<SetObjectCommand>(at).Object);
+			break;
+
+		case CommandType::SetVertexBuffer:
+		{
+			SetVertexBufferCommand command = Read<SetVertexBufferCommand>(at);
+			target.SetVertexBuffer(command.Slot, command.Buffer, command.Stride, command.Offset);
+			break;
+		}
+
+		case CommandType::SetVSConstantBuffer:
+		{
+			SetConstantBufferCommand command = Read<SetConstantBufferCommand>(at);
+			target.SetVSConstantBuffer(command.Slot, command.Buffer);
+			break;
+		}
+
+		case CommandType::SetVSConstantBufferRange:
+		{
+			SetConstantBufferCommand command = Read<SetConstantBufferCommand>(at);
+			target.SetVSConstantBufferRange(command.Slot, command.Buffer, command.FirstConstant, command.ConstantCount);
+			break;
+		}
+
+		case CommandType::UploadBuffer:
+		{
+			UploadBufferCommand command = Read<UploadBufferCommand>(at);
+			target.UploadBuffer(command.Buffer, at + AlignSize(sizeof(UploadBufferCommand)), command.DataSize);
+			break;
+		}
+
+		case CommandType::DrawIndexed:
+		{
+			DrawCommand command = Read<DrawCommand>(at);
+			target.DrawIndexed(command.IndexCount, command.StartIndex, command.BaseVertex);
+			break;
+		}
+
+		case CommandType::DrawIndexedInstanced:
+		{
+			DrawCommand command = Read<DrawCommand>(at);
+			target.DrawIndexedInstanced(command.IndexCount, command.InstanceCount, command.StartIndex, command.BaseVertex, command.StartInstance);
+			break;
+		}
+		}
+
+		at += header.Size;
+	}
+}
+
+void CommandList::SetInputLayout(ID3D11InputLayout* layout)
+{
+	SetObjectCommand command = MakeSetObject(CommandType::SetInputLayout, layout);
+	Write(&command, sizeof(command));
+}
+
+void CommandList::SetVertexShader(ID3D11VertexShader* shader)
+{
+	SetObjectCommand command = MakeSetObject(CommandType::SetVertexShader, shader);
+	Write(&command, sizeof(command));
+}
+
+void CommandList::SetPixelShader(ID3D11PixelShader* shader)
+{
+	SetObjectCommand command = MakeSetObject(CommandType::SetPixelShader, shader);
+	Write(&command, sizeof(command));
+}
+
+void CommandList::SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset)
+{
+	SetVertexBufferCommand command = {};
+	command.Header.Type = CommandType::SetVertexBuffer;
+	command.Buffer = buffer;
+	command.Slot = slot;
+	command.Stride = stride;
+	command.Offset = offset;
+	Write(&command, sizeof(command));
+}
+
+void CommandList::SetIndexBuffer(ID3D11Buffer* buffer)
+{
+	SetObjectCommand command = MakeSetObject(CommandType::SetIndexBuffer, buffer);
+	Write(&command, sizeof(command));
+}
+
+void CommandList::SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer)
+{
+	SetConstantBufferCommand command = {};
+	command.Header.Type = CommandType::SetVSConstantBuffer;
+	command.Buffer = buffer;
+	command.Slot = slot;
+	Write(&command, sizeof(command));
+}
+
+void CommandList::SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	SetConstantBufferCommand command = {};
+	command.Header.Type = CommandType::SetVSConstantBufferRange;
+	command.Buffer = buffer;
+	command.Slot = slot;
+	command.FirstConstant = firstConstant;
+	command.ConstantCount = constantCount;
+	Write(&command, sizeof(command));
+}
+
+void CommandList::UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size)
+{
+	UploadBufferCommand command = {};
+	command.Header.Type = CommandType::UploadBuffer;
+	command.Buffer = buffer;
+	command.DataSize = size;
+	Write(&command, sizeof(command), data, size);
+}
+
+void CommandList::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	DrawCommand command = {};
+	command.Header.Type = CommandType::DrawIndexed;
+	command.IndexCount = indexCount;
+	command.StartIndex = startIndex;
+	command.BaseVertex = baseVertex;
+	Write(&command, sizeof(command));
+}
+
+void CommandList::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	DrawCommand command = {};
+	command.Header.Type = CommandType::DrawIndexedInstanced;
+	command.IndexCount = indexCount;
+	command.InstanceCount = instanceCount;
+	command.StartIndex = startIndex;
+	command.BaseVertex = baseVertex;
+	command.StartInstance = startInstance;
+	Write(&command, sizeof(command));
+}
+
+unsigned int CommandList::GetCommandCount() { return commandCount; }
+size_t CommandList::GetByteSize() { return byteSize; }
+
+// --------------------------------------------------------
+// Copies the command (and its data, 8-byte aligned after it)
+// to the end of the list, doubling the storage when it's full
+// --------------------------------------------------------
+void CommandList::Write(const void* command, size_t commandSize, const void* data, size_t dataSize)
+{
+	size_t commandBytes = AlignSize(commandSize);
+	size_t totalBytes = commandBytes + AlignSize(dataSize);
+
+	size_t neededWords = (byteSize + totalBytes) / sizeof(uint64_t);
+	if (neededWords > storage.size())
+		storage.resize(std::max(neededWords, storage.size() * 2));
+
+	unsigned char* at = (unsigned char*)storage.data() + byteSize;
+	memcpy(at, command, commandSize);
+	if (dataSize > 0)
+		memcpy(at + commandBytes, data, dataSize);
+
+	// The header's size is only known here
+	CommandHeader header = Read<CommandHeader>(at);
+	header.Size = (uint32_t)totalBytes;
+	memcpy(at, &header, sizeof(header));
+
+	byteSize += totalBytes;
+	commandCount++;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RenderContext.h"
+
+// --------------------------------------------------------
+// A RenderContext that writes every call down as a small
+// POD command in one linear block of memory, to be replayed
+// later into any other RenderContext with Execute()
+//
+// Anything that draws through a RenderContext can record
+// into a list without knowing it: the same Mesh::Draw() that
+// drives the GPU fills a list on a machine without one, and
+// replaying into a RecordingRenderContext (or a
+// NullRenderContext, to time it) shows what would have run.
+//
+// Uploaded data is copied into the list, so it doesn't need
+// to outlive the call - but shaders, layouts and buffers are
+// held as plain pointers, so they must outlive Execute().
+// Reset() keeps the memory, so a list reused every frame
+// stops allocating once it's big enough.
+// --------------------------------------------------------
+class CommandList : public RenderContext
+{
+public:
+	// Basic OOP Setup
+	CommandList();
+	~CommandList();
+	CommandList(const CommandList&) = delete;
+	CommandList& operator=(const CommandList&) = delete;
+
+	// Empties the list, keeping its memory
+	void Reset();
+
+	// Makes every recorded call on target, in order
+	void Execute(RenderContext& target);
+
+	// RenderContext
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset) override;
+	void SetIndexBuffer(ID3D11Buffer* buffer) override;
+	void SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) override;
+	void SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount) override;
+	void UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size) override;
+	void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) override;
+	void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance) override;
+
+	// Getters
+	unsigned int GetCommandCount();
+	size_t GetByteSize();
+
+private:
+	// Appends one command (which starts with its header), plus
+	// any data that follows it, keeping commands 8-byte aligned
+	void Write(const void* command, size_t commandSize, const void* data = nullptr, size_t dataSize = 0);
+
+	// 64-bit words so every command starts suitably aligned
+	std::vector<uint64_t> storage;
+	size_t byteSize;
+	unsigned int commandCount;
+};
@@ -0,0 +1,230 @@
+#include "ConstantBufferRing.h"
+#include "Graphics.h"
+
+#include <cstring>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// VSSetConstantBuffers1 offsets and sizes are in 16-byte
+	// constants, and must both be multiples of 16 of them
+	const unsigned int bytesPerConstant = 16;
+	const unsigned int blockAlignment = 256;
+}
+
+ConstantBufferRing::ConstantBufferRing(unsigned int capacity) :
+	ring(0, blockAlignment),
+	mapped(nullptr),
+	everMapped(false),
+	noOverwriteSupported(false),
+	discardNextMap(false),
+	requestedBytes(0),
+	writeFailed(false),
+	mapCount(0),
+	lastFrameMapCount(0),
+	discardCount(0),
+	growCount(0)
+{
+	Grow(capacity);
+	growCount = 0;
+
+	// Without NO_OVERWRITE, every map has to discard instead
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	if (SUCCEEDED(Graphics::Device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+		noOverwriteSupported = options.MapNoOverwriteOnDynamicConstantBuffer;
+}
+
+ConstantBufferRing::~ConstantBufferRing()
+{
+	if (mapped)
+		EndWrite();
+}
+
+void ConstantBufferRing::BeginWrite()
+{
+	if (mapped)
+		return;
+
+	PollFences();
+
+	// A dynamic buffer must be discarded before its first NO_OVERWRITE map
+	Map(!everMapped || !noOverwriteSupported || discardNextMap);
+	discardNextMap = false;
+}
+
+bool ConstantBufferRing::EndWrite()
+{
+	if (mapped)
+	{
+		Graphics::Context->Unmap(buffer.Get(), 0);
+		mapped = nullptr;
+	}
+	return !writeFailed;
+}
+
+// --------------------------------------------------------
+// Copies a block of constants into the next free space
+//  - If the ring is full before the frame has anything in
+//    it, earlier frames' draws are all submitted, so it
+//    can start over with a discard
+//  - Otherwise this frame's earlier blocks aren't drawn with
+//    yet, so it fails and leaves it to RestartFrame()
+// --------------------------------------------------------
+ConstantAllocation ConstantBufferRing::Allocate(const void* data, unsigned int size)
+{
+	if (!mapped || size == 0)
+		return {};
+
+	unsigned int alignedSize = (size + blockAlignment - 1) / blockAlignment * blockAlignment;
+	requestedBytes += alignedSize;
+	if (writeFailed || alignedSize > ring.GetCapacity())
+	{
+		writeFailed = true;
+		return {};
+	}
+
+	unsigned int offset = ring.Allocate(size);
+	if (offset == RingAllocator::InvalidOffset && ring.GetFrameSpace() == 0)
+	{
+		Graphics::Context->Unmap(buffer.Get(), 0);
+		Map(true);
+		discardCount++;
+		offset = ring.Allocate(size);
+	}
+
+	if (offset == RingAllocator::InvalidOffset)
+	{
+		writeFailed = true;
+		return {};
+	}
+
+	memcpy(mapped + offset, data, size);
+	return { buffer.Get(), offset / bytesPerConstant, alignedSize / bytesPerConstant };
+}
+
+// --------------------------------------------------------
+// Drops the frame's allocations - the next BeginWrite()
+// discards, so they can all be written again from the
+// start of the ring, or into a bigger buffer if the frame
+// asked for more than the whole ring holds
+// --------------------------------------------------------
+void ConstantBufferRing::RestartFrame()
+{
+	if (mapped)
+		EndWrite();
+
+	if (requestedBytes > ring.GetCapacity())
+	{
+		// Double, so a frame that keeps growing doesn't grow every time
+		unsigned int capacity = ring.GetCapacity();
+		while (capacity < requestedBytes)
+			capacity *= 2;
+		Grow(capacity);
+	}
+	else
+	{
+		discardNextMap = true;
+		discardCount++;
+	}
+
+	requestedBytes = 0;
+	writeFailed = false;
+}
+
+// --------------------------------------------------------
+// Closes the frame's allocations and puts a fence after
+// its draws, so the space comes back once they're done
+// --------------------------------------------------------
+void ConstantBufferRing::EndFrame()
+{
+	if (mapped)
+		EndWrite();
+
+	Microsoft::WRL::ComPtr<ID3D11Query> query;
+	if (!spareQueries.empty())
+	{
+		query = spareQueries.back();
+		spareQueries.pop_back();
+	}
+	else
+	{
+		D3D11_QUERY_DESC desc = {};
+		desc.Query = D3D11_QUERY_EVENT;
+		Graphics::Device->CreateQuery(&desc, query.GetAddressOf());
+	}
+
+	Graphics::Context->End(query.Get());
+	fences.push_back({ ring.EndFrame(), query });
+
+	lastFrameMapCount = mapCount;
+	mapCount = 0;
+	requestedBytes = 0;
+	writeFailed = false;
+
+	PollFences();
+}
+
+unsigned int ConstantBufferRing::GetCapacity() { return ring.GetCapacity(); }
+unsigned int ConstantBufferRing::GetUsedSpace() { return ring.GetUsedSpace(); }
+unsigned int ConstantBufferRing::GetLastFrameMapCount() { return lastFrameMapCount; }
+unsigned int ConstantBufferRing::GetDiscardCount() { return discardCount; }
+unsigned int ConstantBufferRing::GetGrowCount() { return growCount; }
+
+void ConstantBufferRing::Map(bool discard)
+{
+	// Discarding hands back fresh memory, so nothing in the ring is in use any more
+	if (discard)
+		ring.Reset();
+
+	D3D11_MAPPED_SUBRESOURCE mappedBuffer = {};
+	Graphics::Context->Map(buffer.Get(), 0, discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedBuffer);
+	mapped = (unsigned char*)mappedBuffer.pData;
+	everMapped = true;
+	mapCount++;
+}
+
+// --------------------------------------------------------
+// Swaps in a bigger buffer - the old one lives on until the
+// draws already submitted with it are done, and the new one
+// has nothing in flight, so the old fences are dropped
+// --------------------------------------------------------
+void ConstantBufferRing::Grow(unsigned int minimumCapacity)
+{
+	ring = RingAllocator(minimumCapacity, blockAlignment);
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.ByteWidth = ring.GetCapacity();
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	buffer.Reset();
+	Graphics::Device->CreateBuffer(&desc, 0, buffer.GetAddressOf());
+
+	for (FrameFence& fence : fences)
+		spareQueries.push_back(fence.Query);
+	fences.clear();
+
+	everMapped = false;
+	discardNextMap = false;
+	growCount++;
+}
+
+// --------------------------------------------------------
+// Frames finish in order, so stop at the first one that
+// hasn't - without flushing, as nothing waits on the answer
+// --------------------------------------------------------
+void ConstantBufferRing::PollFences()
+{
+	while (!fences.empty())
+	{
+		FrameFence& fence = fences.front();
+		BOOL done = FALSE;
+		if (Graphics::Context->GetData(fence.Query.Get(), &done, sizeof(done), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK || !done)
+			break;
+
+		ring.Release(fence.Frame);
+		spareQueries.push_back(fence.Query);
+		fences.pop_front();
+	}
+}
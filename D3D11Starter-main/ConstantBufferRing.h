@@ -0,0 +1,122 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "RingAllocator.h"
+
+// --------------------------------------------------------
+// Where one block of constants ended up in a ConstantBufferRing,
+// in the units SetVSConstantBufferRange() takes
+// --------------------------------------------------------
+struct ConstantAllocation
+{
+	ID3D11Buffer* Buffer;
+	unsigned int FirstConstant;
+	unsigned int ConstantCount;
+
+	bool IsValid() const { return Buffer != nullptr; }
+};
+
+// --------------------------------------------------------
+// One large dynamic constant buffer that per-draw constants
+// are appended to, instead of a small buffer that's mapped
+// (and discarded) once per draw
+//
+// Writes go between BeginWrite() and EndWrite(), which map
+// the buffer once, so a frame's constants are usually all
+// written in one Map. Each block starts on a 256-byte boundary,
+// as VSSetConstantBuffers1 requires, and is bound by offset.
+//
+// The buffer is mapped with NO_OVERWRITE, which is only safe
+// because the RingAllocator never hands out space the GPU
+// could still be reading: every EndFrame() issues an event
+// query, and a frame's space is released once its query has
+// passed.
+//
+// A DISCARD only keeps the old contents alive for draws that
+// were already submitted, and a frame's constants are all
+// written before any of its draws are. So the ring only ever
+// starts over with a discard while the frame has nothing in
+// it yet. If it fills up part way through a frame, Allocate()
+// fails, EndWrite() says so, and the caller RestartFrame()s -
+// dropping the frame's allocations, starting over in fresh
+// memory (or a bigger buffer, if the frame alone didn't fit)
+// - and writes them all again.
+// --------------------------------------------------------
+class ConstantBufferRing
+{
+public:
+	// Basic OOP Setup
+	explicit ConstantBufferRing(unsigned int capacity = 1 << 20);
+	~ConstantBufferRing();
+	ConstantBufferRing(const ConstantBufferRing&) = delete;
+	ConstantBufferRing& operator=(const ConstantBufferRing&) = delete;
+
+	// Maps the buffer - every Allocate() goes between these two
+	// - EndWrite() is false if any allocation ran out of space
+	void BeginWrite();
+	bool EndWrite();
+
+	// Copies the data into the ring
+	// - Invalid if called outside BeginWrite/EndWrite, or there's no room
+	//   without overwriting this frame's earlier allocations
+	ConstantAllocation Allocate(const void* data, unsigned int size);
+
+	// Forgets this frame's allocations so they can be written again,
+	// into fresh memory big enough for everything asked for
+	// - Only while none of them have been drawn with
+	void RestartFrame();
+
+	template <typename T>
+	ConstantAllocation Allocate(const T& data) { return Allocate(&data, sizeof(T)); }
+
+	// Call once per frame, after the frame's last draw
+	void EndFrame();
+
+	// Getters
+	unsigned int GetCapacity();
+	unsigned int GetUsedSpace();
+	unsigned int GetLastFrameMapCount();
+	unsigned int GetDiscardCount();		// Times the ring filled up and had to discard
+	unsigned int GetGrowCount();		// Times a frame didn't fit and the buffer grew
+
+private:
+	// Maps the buffer, discarding it (and starting the ring over) if asked
+	void Map(bool discard);
+
+	// Replaces the buffer with one of at least this many bytes
+	void Grow(unsigned int minimumCapacity);
+
+	// Releases the space of every frame the GPU has finished
+	void PollFences();
+
+	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+	RingAllocator ring;
+
+	unsigned char* mapped;
+	bool everMapped;
+	bool noOverwriteSupported;
+	bool discardNextMap;
+
+	// This frame's requests since the last restart, failed ones included
+	unsigned int requestedBytes;
+	bool writeFailed;
+
+	// One event query per frame still on the GPU, oldest first
+	struct FrameFence
+	{
+		uint64_t Frame;
+		Microsoft::WRL::ComPtr<ID3D11Query> Query;
+	};
+	std::deque<FrameFence> fences;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> spareQueries;
+
+	unsigned int mapCount;
+	unsigned int lastFrameMapCount;
+	unsigned int discardCount;
+	unsigned int growCount;
+};
@@ -0,0 +1,76 @@
+#include "CpuTimestampSource.h"
+
+#include <algorithm>
+#include <chrono>
+
+CpuTimestampSource::CpuTimestampSource(unsigned int frameCount, unsigned int timestampsPerFrame, unsigned int latencyFrames, TimestampClock clock, uint64_t frequency) :
+	clock(clock),
+	frequency(frequency),
+	latencyFrames(latencyFrames),
+	timestampsPerFrame(timestampsPerFrame),
+	frames(frameCount),
+	frameCounter(0),
+	nextFrameDisjoint(false)
+{
+	if (!this->clock)
+	{
+		this->frequency = 1000000000;
+		this->clock = []()
+			{
+				auto now = std::chrono::steady_clock::now().time_since_epoch();
+				return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+			};
+	}
+
+	for (Frame& frame : frames)
+	{
+		frame.Timestamps.resize(timestampsPerFrame);
+		frame.EndedAt = 0;
+		frame.Disjoint = false;
+	}
+}
+
+CpuTimestampSource::~CpuTimestampSource()
+{
+}
+
+void CpuTimestampSource::SetNextFrameDisjoint()
+{
+	nextFrameDisjoint = true;
+}
+
+void CpuTimestampSource::BeginFrame(unsigned int slot)
+{
+	Frame& frame = frames[slot];
+	std::fill(frame.Timestamps.begin(), frame.Timestamps.end(), 0);
+	frame.EndedAt = 0;
+	frame.Disjoint = false;
+}
+
+void CpuTimestampSource::WriteTimestamp(unsigned int slot, unsigned int index)
+{
+	frames[slot].Timestamps[index] = clock();
+}
+
+void CpuTimestampSource::EndFrame(unsigned int slot)
+{
+	Frame& frame = frames[slot];
+	frame.EndedAt = ++frameCounter;
+	frame.Disjoint = nextFrameDisjoint;
+	nextFrameDisjoint = false;
+}
+
+bool CpuTimestampSource::ReadFrame(unsigned int slot, unsigned int count, uint64_t* timestamps, uint64_t& frequency, bool& disjoint)
+{
+	const Frame& frame = frames[slot];
+	if (frame.EndedAt == 0 || frameCounter < frame.EndedAt + latencyFrames)
+		return false;
+
+	std::copy(frame.Timestamps.begin(), frame.Timestamps.begin() + count, timestamps);
+	frequency = this->frequency;
+	disjoint = frame.Disjoint;
+	return true;
+}
+
+unsigned int CpuTimestampSource::GetFrameCount() { return (unsigned int)frames.size(); }
+unsigned int CpuTimestampSource::GetTimestampsPerFrame() { return timestampsPerFrame; }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "GpuTimestampSource.h"
+
+// Returns the time now, in ticks of the clock's own frequency
+using TimestampClock = std::function<uint64_t()>;
+
+// --------------------------------------------------------
+// Stands in for GPU timestamps wherever there's no GPU
+//
+// Timestamps are read from a clock when they're written -
+// steady_clock in nanoseconds unless another is given, so
+// tests can step time by hand. A frame only becomes readable
+// latencyFrames frames after it ends, the way GPU results
+// trail the CPU, so the GpuProfiler behaves as it would
+// against D3D11TimestampSource.
+// --------------------------------------------------------
+class CpuTimestampSource : public GpuTimestampSource
+{
+public:
+	// Basic OOP Setup
+	explicit CpuTimestampSource(
+		unsigned int frameCount = 4,
+		unsigned int timestampsPerFrame = 64,
+		unsigned int latencyFrames = 2,
+		TimestampClock clock = nullptr,		// Null = steady_clock
+		uint64_t frequency = 1000000000);	// Ticks per second of clock
+	~CpuTimestampSource();
+	CpuTimestampSource(const CpuTimestampSource&) = delete;
+	CpuTimestampSource& operator=(const CpuTimestampSource&) = delete;
+
+	// Marks the next frame that ends as disjoint
+	void SetNextFrameDisjoint();
+
+	// GpuTimestampSource
+	void BeginFrame(unsigned int slot) override;
+	void WriteTimestamp(unsigned int slot, unsigned int index) override;
+	void EndFrame(unsigned int slot) override;
+	bool ReadFrame(unsigned int slot, unsigned int count, uint64_t* timestamps, uint64_t& frequency, bool& disjoint) override;
+	unsigned int GetFrameCount() override;
+	unsigned int GetTimestampsPerFrame() override;
+
+private:
+	struct Frame
+	{
+		std::vector<uint64_t> Timestamps;
+		uint64_t EndedAt;	// frameCounter when it ended, or 0 while it's being written
+		bool Disjoint;
+	};
+
+	TimestampClock clock;
+	uint64_t frequency;
+	unsigned int latencyFrames;
+	unsigned int timestampsPerFrame;
+	std::vector<Frame> frames;
+	uint64_t frameCounter;		// Frames ended so far
+	bool nextFrameDisjoint;
+};
@@ -0,0 +1,196 @@
+#include "D3D11Bloom.h"
+#include "D3D11FrameGraphTextures.h"
+#include "GpuProfiler.h"
+#include "Graphics.h"
+#include "PathHelpers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <d3dcompiler.h>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Should match ExternalData in PixelShaderBloom.hlsl
+	struct BloomConstants
+	{
+		float TexelStep[2];
+		float Threshold;
+		float Intensity;
+	};
+
+	const float brightThreshold = 0.75f;
+	const float compositeIntensity = 0.6f;
+}
+
+D3D11Bloom::D3D11Bloom(GpuProfiler& profiler) :
+	profiler(profiler)
+{
+	Microsoft::WRL::ComPtr<ID3DBlob> vertexShaderBlob;
+	Microsoft::WRL::ComPtr<ID3DBlob> pixelShaderBlob;
+	if (SUCCEEDED(D3DReadFileToBlob(FixPath(L"VertexShaderFullscreen.cso").c_str(), vertexShaderBlob.GetAddressOf())))
+		Graphics::Device->CreateVertexShader(vertexShaderBlob->GetBufferPointer(), vertexShaderBlob->GetBufferSize(), 0, vertexShader.GetAddressOf());
+	if (SUCCEEDED(D3DReadFileToBlob(FixPath(L"PixelShaderBloom.cso").c_str(), pixelShaderBlob.GetAddressOf())))
+		Graphics::Device->CreatePixelShader(pixelShaderBlob->GetBufferPointer(), pixelShaderBlob->GetBufferSize(), 0, pixelShader.GetAddressOf());
+
+	// Rewritten before every pass
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.ByteWidth = sizeof(BloomConstants);
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	Graphics::Device->CreateBuffer(&bufferDesc, 0, constantBuffer.GetAddressOf());
+
+	D3D11_SAMPLER_DESC samplerDesc = {};
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+	Graphics::Device->CreateSamplerState(&samplerDesc, linearClamp.GetAddressOf());
+
+	// Adds color, and leaves the target's alpha alone
+	D3D11_BLEND_DESC blendDesc = {};
+	blendDesc.RenderTarget[0].BlendEnable = TRUE;
+	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+	blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+	blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ZERO;
+	blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+	blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+	Graphics::Device->CreateBlendState(&blendDesc, additiveBlend.GetAddressOf());
+}
+
+D3D11Bloom::~D3D11Bloom()
+{
+}
+
+void D3D11Bloom::AddPasses(
+	FrameGraph& graph,
+	D3D11FrameGraphTextures& textures,
+	unsigned int target,
+	const FrameGraphTextureDesc& targetDesc,
+	ID3D11RenderTargetView* targetView,
+	ID3D11DepthStencilView* depthView)
+{
+	FrameGraphTextureDesc halfDesc = targetDesc;
+	halfDesc.Width = std::max(targetDesc.Width / 2, 1u);
+	halfDesc.Height = std::max(targetDesc.Height / 2, 1u);
+	float texelX = 1.0f / halfDesc.Width;
+	float texelY = 1.0f / halfDesc.Height;
+
+	unsigned int scene = graph.CreateTexture("Bloom scene", targetDesc);
+	unsigned int halfA = graph.CreateTexture("Bloom half A", halfDesc);
+	unsigned int halfB = graph.CreateTexture("Bloom half B", halfDesc);
+	unsigned int halfC = graph.CreateTexture("Bloom half C", halfDesc);
+
+	unsigned int copyPass = graph.AddPass("Bloom copy",
+		[&graph, &textures, this, scene, targetView]()
+		{
+			GpuProfileScope scope(profiler, "Bloom copy");
+			ID3D11RenderTargetView* sceneView = textures.GetRenderTarget(graph, scene);
+			if (!sceneView)
+				return;
+
+			Microsoft::WRL::ComPtr<ID3D11Resource> source;
+			Microsoft::WRL::ComPtr<ID3D11Resource> destination;
+			targetView->GetResource(source.GetAddressOf());
+			sceneView->GetResource(destination.GetAddressOf());
+			Graphics::Context->CopyResource(destination.Get(), source.Get());
+		});
+	graph.Read(copyPass, target);
+	graph.Write(copyPass, scene);
+
+	unsigned int brightPass = graph.AddPass("Bloom bright",
+		[&graph, &textures, this, scene, halfA, halfDesc]()
+		{
+			GpuProfileScope scope(profiler, "Bloom bright");
+			Draw(textures.GetShaderResource(graph, scene), textures.GetRenderTarget(graph, halfA),
+				halfDesc.Width, halfDesc.Height, 0.0f, 0.0f, brightThreshold, 1.0f, 0);
+		});
+	graph.Read(brightPass, scene);
+	graph.Write(brightPass, halfA);
+
+	unsigned int blurXPass = graph.AddPass("Bloom blur X",
+		[&graph, &textures, this, halfA, halfB, halfDesc, texelX]()
+		{
+			GpuProfileScope scope(profiler, "Bloom blur X");
+			Draw(textures.GetShaderResource(graph, halfA), textures.GetRenderTarget(graph, halfB),
+				halfDesc.Width, halfDesc.Height, texelX, 0.0f, 0.0f, 1.0f, 0);
+		});
+	graph.Read(blurXPass, halfA);
+	graph.Write(blurXPass, halfB);
+
+	unsigned int blurYPass = graph.AddPass("Bloom blur Y",
+		[&graph, &textures, this, halfB, halfC, halfDesc, texelY]()
+		{
+			GpuProfileScope scope(profiler, "Bloom blur Y");
+			Draw(textures.GetShaderResource(graph, halfB), textures.GetRenderTarget(graph, halfC),
+				halfDesc.Width, halfDesc.Height, 0.0f, texelY, 0.0f, 1.0f, 0);
+		});
+	graph.Read(blurYPass, halfB);
+	graph.Write(blurYPass, halfC);
+
+	unsigned int compositePass = graph.AddPass("Bloom composite",
+		[&graph, &textures, this, halfC, targetDesc, targetView, depthView]()
+		{
+			GpuProfileScope scope(profiler, "Bloom composite");
+			Draw(textures.GetShaderResource(graph, halfC), targetView,
+				targetDesc.Width, targetDesc.Height, 0.0f, 0.0f, 0.0f, compositeIntensity, additiveBlend.Get());
+
+			// Back to what the passes after this expect
+			Graphics::Context->OMSetBlendState(0, 0, 0xFFFFFFFF);
+			Graphics::Context->OMSetRenderTargets(1, &targetView, depthView);
+		});
+	graph.Read(compositePass, halfC);
+	graph.Read(compositePass, target);
+	graph.Write(compositePass, target);
+}
+
+// --------------------------------------------------------
+// Draws one full screen triangle, then unbinds the source
+// so it can be a render target again in a later pass
+// --------------------------------------------------------
+void D3D11Bloom::Draw(
+	ID3D11ShaderResourceView* source,
+	ID3D11RenderTargetView* target,
+	unsigned int width,
+	unsigned int height,
+	float texelStepX,
+	float texelStepY,
+	float threshold,
+	float intensity,
+	ID3D11BlendState* blendState)
+{
+	if (!source || !target || !vertexShader || !pixelShader)
+		return;
+
+	BloomConstants constants = { { texelStepX, texelStepY }, threshold, intensity };
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(Graphics::Context->Map(constantBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return;
+	memcpy(mapped.pData, &constants, sizeof(BloomConstants));
+	Graphics::Context->Unmap(constantBuffer.Get(), 0);
+
+	D3D11_VIEWPORT viewport = {};
+	viewport.Width = (float)width;
+	viewport.Height = (float)height;
+	viewport.MaxDepth = 1.0f;
+
+	Graphics::Context->OMSetRenderTargets(1, &target, 0);
+	Graphics::Context->OMSetBlendState(blendState, 0, 0xFFFFFFFF);
+	Graphics::Context->RSSetViewports(1, &viewport);
+	Graphics::Context->IASetInputLayout(0);
+	Graphics::Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	Graphics::Context->VSSetShader(vertexShader.Get(), 0, 0);
+	Graphics::Context->PSSetShader(pixelShader.Get(), 0, 0);
+	Graphics::Context->PSSetConstantBuffers(0, 1, constantBuffer.GetAddressOf());
+	Graphics::Context->PSSetShaderResources(0, 1, &source);
+	Graphics::Context->PSSetSamplers(0, 1, linearClamp.GetAddressOf());
+	Graphics::Context->Draw(3, 0);
+
+	ID3D11ShaderResourceView* none = 0;
+	Graphics::Context->PSSetShaderResources(0, 1, &none);
+}
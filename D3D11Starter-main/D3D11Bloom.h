@@ -0,0 +1,68 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+
+#include "FrameGraph.h"
+
+class D3D11FrameGraphTextures;
+class GpuProfiler;
+
+// --------------------------------------------------------
+// A bloom, added to a frame graph as five passes that pass
+// transients from one to the next:
+//  - Copy:      the target into Scene, full size (a swap
+//               chain's back buffer can't be sampled)
+//  - Bright:    what's over the threshold into Half A
+//  - Blur X:    Half A into Half B
+//  - Blur Y:    Half B into Half C
+//  - Composite: Half C added onto the target
+//
+// Nothing reads Half A once Blur X is done with it, so the
+// graph gives Half C the same texture - four transients,
+// three textures.
+//
+// The passes bind straight to the context, around any state
+// cache, and leave the target and depth buffer bound with a
+// full size viewport when they're done.
+// --------------------------------------------------------
+class D3D11Bloom
+{
+public:
+	// Basic OOP Setup
+	explicit D3D11Bloom(GpuProfiler& profiler);
+	~D3D11Bloom();
+	D3D11Bloom(const D3D11Bloom&) = delete;
+	D3D11Bloom& operator=(const D3D11Bloom&) = delete;
+
+	// Adds the passes for this frame - textures must be Realize()d
+	// between the graph's Compile() and Execute()
+	void AddPasses(
+		FrameGraph& graph,
+		D3D11FrameGraphTextures& textures,
+		unsigned int target,
+		const FrameGraphTextureDesc& targetDesc,
+		ID3D11RenderTargetView* targetView,
+		ID3D11DepthStencilView* depthView);
+
+private:
+	// One full screen triangle from source into target
+	void Draw(
+		ID3D11ShaderResourceView* source,
+		ID3D11RenderTargetView* target,
+		unsigned int width,
+		unsigned int height,
+		float texelStepX,
+		float texelStepY,
+		float threshold,
+		float intensity,
+		ID3D11BlendState* blendState);
+
+	GpuProfiler& profiler;
+
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> vertexShader;
+	Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> constantBuffer;
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> linearClamp;
+	Microsoft::WRL::ComPtr<ID3D11BlendState> additiveBlend;
+};
@@ -0,0 +1,84 @@
+#include "D3D11DeferredExecutor.h"
+#include "D3D11RenderContext.h"
+#include "Graphics.h"
+#include "ParallelRecorder.h"
+#include "StateCache.h"
+#include "WorkerPool.h"
+
+#include <chrono>
+
+D3D11DeferredExecutor::D3D11DeferredExecutor(WorkerPool* pool) :
+	pool(pool),
+	supported(false),
+	executeMilliseconds(0)
+{
+	D3D11_FEATURE_DATA_THREADING threading = {};
+	if (SUCCEEDED(Graphics::Device->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading))))
+		supported = threading.DriverCommandLists;
+}
+
+D3D11DeferredExecutor::~D3D11DeferredExecutor()
+{
+}
+
+void D3D11DeferredExecutor::Execute(ParallelRecorder& recorder)
+{
+	auto start = std::chrono::steady_clock::now();
+	unsigned int sliceCount = recorder.GetSliceCount();
+
+	while (deferredContexts.size() < sliceCount)
+	{
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+		Graphics::Device->CreateDeferredContext(0, context.GetAddressOf());
+		deferredContexts.push_back(context);
+	}
+	commandLists.resize(sliceCount);
+
+	// The output state every slice draws with
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthBuffer;
+	Graphics::Context->OMGetRenderTargets(1, renderTarget.GetAddressOf(), depthBuffer.GetAddressOf());
+
+	D3D11_VIEWPORT viewport = {};
+	UINT viewportCount = 1;
+	Graphics::Context->RSGetViewports(&viewportCount, &viewport);
+
+	D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	Graphics::Context->IAGetPrimitiveTopology(&topology);
+
+	auto buildSlice = [&](unsigned int slice)
+		{
+			ID3D11DeviceContext* context = deferredContexts[slice].Get();
+			context->OMSetRenderTargets(1, renderTarget.GetAddressOf(), depthBuffer.Get());
+			context->RSSetViewports(viewportCount, &viewport);
+			context->IASetPrimitiveTopology(topology);
+
+			// Each deferred context has its own state, so each gets its own cache
+			D3D11RenderContext target(context);
+			StateCache cache(target);
+			recorder.GetSlice(slice).Execute(cache);
+
+			commandLists[slice].Reset();
+			context->FinishCommandList(FALSE, commandLists[slice].GetAddressOf());
+		};
+
+	if (pool && sliceCount > 1)
+		pool->ParallelFor(sliceCount, sliceCount, [&](unsigned int chunk, unsigned int, unsigned int) { buildSlice(chunk); });
+	else
+		for (unsigned int i = 0; i < sliceCount; i++)
+			buildSlice(i);
+
+	// Submission is the only part left on this thread
+	for (unsigned int i = 0; i < sliceCount; i++)
+		Graphics::Context->ExecuteCommandList(commandLists[i].Get(), FALSE);
+
+	// Executing without restoring leaves the immediate context in default state
+	Graphics::Context->OMSetRenderTargets(1, renderTarget.GetAddressOf(), depthBuffer.Get());
+	Graphics::Context->RSSetViewports(viewportCount, &viewport);
+	Graphics::Context->IASetPrimitiveTopology(topology);
+
+	executeMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool D3D11DeferredExecutor::IsSupported() { return supported; }
+float D3D11DeferredExecutor::GetExecuteMilliseconds() { return executeMilliseconds; }
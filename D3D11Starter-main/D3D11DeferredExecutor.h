@@ -0,0 +1,49 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+
+class ParallelRecorder;
+class WorkerPool;
+
+// --------------------------------------------------------
+// Replays a ParallelRecorder's slices on D3D11 deferred
+// contexts, one per slice and all at once, then runs the
+// resulting D3D11 command lists on the immediate context in
+// slice order
+//
+// Only worth it when the driver builds command lists itself
+// (IsSupported()) - otherwise the runtime emulates them and
+// replaying straight onto the immediate context is cheaper.
+//
+// Deferred contexts start from default state, so each one
+// is given the immediate context's render targets, viewport
+// and topology first, and those are put back on the immediate
+// context afterwards (executing a command list clears them).
+// Anything else bound directly on the immediate context is
+// lost, so callers must rebind (or Invalidate() their cache).
+// --------------------------------------------------------
+class D3D11DeferredExecutor
+{
+public:
+	// Basic OOP Setup
+	explicit D3D11DeferredExecutor(WorkerPool* pool);
+	~D3D11DeferredExecutor();
+	D3D11DeferredExecutor(const D3D11DeferredExecutor&) = delete;
+	D3D11DeferredExecutor& operator=(const D3D11DeferredExecutor&) = delete;
+
+	void Execute(ParallelRecorder& recorder);
+
+	// Getters
+	bool IsSupported();
+	float GetExecuteMilliseconds();		// Wall time of the last Execute()
+
+private:
+	WorkerPool* pool;
+	bool supported;
+	float executeMilliseconds;
+
+	std::vector<Microsoft::WRL::ComPtr<ID3D11DeviceContext>> deferredContexts;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11CommandList>> commandLists;
+};
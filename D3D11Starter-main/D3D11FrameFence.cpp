@@ -0,0 +1,38 @@
+#include "D3D11FrameFence.h"
+#include "Graphics.h"
+
+D3D11FrameFence::D3D11FrameFence(Microsoft::WRL::ComPtr<ID3D11DeviceContext> context) :
+	context(context),
+	signaledFrames{}
+{
+	D3D11_QUERY_DESC desc = {};
+	desc.Query = D3D11_QUERY_EVENT;
+	for (Microsoft::WRL::ComPtr<ID3D11Query>& query : queries)
+		Graphics::Device->CreateQuery(&desc, query.GetAddressOf());
+}
+
+D3D11FrameFence::~D3D11FrameFence()
+{
+}
+
+void D3D11FrameFence::Signal(uint64_t frame)
+{
+	unsigned int slot = (unsigned int)(frame % MaxFrames);
+	context->End(queries[slot].Get());
+	signaledFrames[slot].store(frame, std::memory_order_release);
+}
+
+bool D3D11FrameFence::IsComplete(uint64_t frame)
+{
+	unsigned int slot = (unsigned int)(frame % MaxFrames);
+
+	// Reused by a newer frame, so this one's long done - or not signaled yet
+	uint64_t signaledFrame = signaledFrames[slot].load(std::memory_order_acquire);
+	if (signaledFrame != frame)
+		return signaledFrame > frame;
+
+	// Flushing, as the event may have been issued after the last Present()
+	// and would otherwise sit in the command buffer while we wait on it
+	BOOL done = FALSE;
+	return context->GetData(queries[slot].Get(), &done, sizeof(done), 0) == S_OK && done;
+}
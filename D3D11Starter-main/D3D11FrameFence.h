@@ -0,0 +1,41 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <atomic>
+
+#include "FrameFence.h"
+
+// --------------------------------------------------------
+// A FrameFence made of D3D11 event queries, one per slot in
+// a ring
+//
+// A slot is reused every MaxFrames frames, so frames more
+// than that far back are taken as finished - which they are
+// by the time the pacer asks, as it never lets more than
+// MaxFrames get ahead.
+//
+// Signal() may come from the render thread while the game
+// thread asks IsComplete(), as long as the context is
+// multithread-protected (ID3D11Multithread).
+// --------------------------------------------------------
+class D3D11FrameFence : public FrameFence
+{
+public:
+	static const unsigned int MaxFrames = 8;
+
+	// Basic OOP Setup
+	explicit D3D11FrameFence(Microsoft::WRL::ComPtr<ID3D11DeviceContext> context);
+	~D3D11FrameFence();
+	D3D11FrameFence(const D3D11FrameFence&) = delete;
+	D3D11FrameFence& operator=(const D3D11FrameFence&) = delete;
+
+	// FrameFence
+	void Signal(uint64_t frame) override;
+	bool IsComplete(uint64_t frame) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	Microsoft::WRL::ComPtr<ID3D11Query> queries[MaxFrames];
+	std::atomic<uint64_t> signaledFrames[MaxFrames];	// 0 until a slot's first frame
+};
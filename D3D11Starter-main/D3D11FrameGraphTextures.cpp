@@ -0,0 +1,60 @@
+#include "D3D11FrameGraphTextures.h"
+#include "Graphics.h"
+
+D3D11FrameGraphTextures::D3D11FrameGraphTextures() :
+	createdCount(0)
+{
+}
+
+D3D11FrameGraphTextures::~D3D11FrameGraphTextures()
+{
+}
+
+void D3D11FrameGraphTextures::Realize(FrameGraph& graph)
+{
+	unsigned int count = graph.GetPhysicalTextureCount();
+	textures.resize(count);
+	createdCount = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const FrameGraphTextureDesc& desc = graph.GetPhysicalTexture(i);
+		Texture& texture = textures[i];
+		if (texture.Resource && texture.Desc == desc)
+			continue;
+
+		texture = {};
+		texture.Desc = desc;
+
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = desc.Width;
+		textureDesc.Height = desc.Height;
+		textureDesc.MipLevels = 1;
+		textureDesc.ArraySize = 1;
+		textureDesc.Format = (DXGI_FORMAT)desc.Format;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+		if (FAILED(Graphics::Device->CreateTexture2D(&textureDesc, 0, texture.Resource.GetAddressOf())))
+			continue;
+
+		Graphics::Device->CreateRenderTargetView(texture.Resource.Get(), 0, texture.RenderTarget.GetAddressOf());
+		Graphics::Device->CreateShaderResourceView(texture.Resource.Get(), 0, texture.ShaderResource.GetAddressOf());
+		createdCount++;
+	}
+}
+
+ID3D11RenderTargetView* D3D11FrameGraphTextures::GetRenderTarget(FrameGraph& graph, unsigned int resource)
+{
+	unsigned int physical = graph.GetPhysicalIndex(resource);
+	return physical < textures.size() ? textures[physical].RenderTarget.Get() : nullptr;
+}
+
+ID3D11ShaderResourceView* D3D11FrameGraphTextures::GetShaderResource(FrameGraph& graph, unsigned int resource)
+{
+	unsigned int physical = graph.GetPhysicalIndex(resource);
+	return physical < textures.size() ? textures[physical].ShaderResource.Get() : nullptr;
+}
+
+unsigned int D3D11FrameGraphTextures::GetCreatedCount() { return createdCount; }
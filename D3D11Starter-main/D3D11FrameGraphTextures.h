@@ -0,0 +1,45 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+
+#include "FrameGraph.h"
+
+// --------------------------------------------------------
+// The D3D11 textures behind a compiled FrameGraph's
+// transients, one per physical texture
+//
+// Realize() after each Compile() - textures whose description
+// hasn't changed since last frame are kept, so a graph that
+// compiles the same way every frame creates nothing. Every
+// texture can be both rendered to and sampled.
+// --------------------------------------------------------
+class D3D11FrameGraphTextures
+{
+public:
+	// Basic OOP Setup
+	D3D11FrameGraphTextures();
+	~D3D11FrameGraphTextures();
+	D3D11FrameGraphTextures(const D3D11FrameGraphTextures&) = delete;
+	D3D11FrameGraphTextures& operator=(const D3D11FrameGraphTextures&) = delete;
+
+	void Realize(FrameGraph& graph);
+
+	// Getters - null for imports and culled transients
+	ID3D11RenderTargetView* GetRenderTarget(FrameGraph& graph, unsigned int resource);
+	ID3D11ShaderResourceView* GetShaderResource(FrameGraph& graph, unsigned int resource);
+	unsigned int GetCreatedCount();		// Textures created by the last Realize()
+
+private:
+	struct Texture
+	{
+		FrameGraphTextureDesc Desc;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> Resource;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RenderTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> ShaderResource;
+	};
+
+	std::vector<Texture> textures;
+	unsigned int createdCount;
+};
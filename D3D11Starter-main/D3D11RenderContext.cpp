@@ -0,0 +1,68 @@
+#include "D3D11RenderContext.h"
+
+#include <cstring>
+
+D3D11RenderContext::D3D11RenderContext(Microsoft::WRL::ComPtr<ID3D11DeviceContext> context) :
+	context(context)
+{
+	context.As(&context1);
+}
+
+D3D11RenderContext::~D3D11RenderContext()
+{
+}
+
+void D3D11RenderContext::SetInputLayout(ID3D11InputLayout* layout)
+{
+	context->IASetInputLayout(layout);
+}
+
+void D3D11RenderContext::SetVertexShader(ID3D11VertexShader* shader)
+{
+	context->VSSetShader(shader, 0, 0);
+}
+
+void D3D11RenderContext::SetPixelShader(ID3D11PixelShader* shader)
+{
+	context->PSSetShader(shader, 0, 0);
+}
+
+void D3D11RenderContext::SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset)
+{
+	context->IASetVertexBuffers(slot, 1, &buffer, &stride, &offset);
+}
+
+void D3D11RenderContext::SetIndexBuffer(ID3D11Buffer* buffer)
+{
+	context->IASetIndexBuffer(buffer, DXGI_FORMAT_R32_UINT, 0);
+}
+
+void D3D11RenderContext::SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer)
+{
+	context->VSSetConstantBuffers(slot, 1, &buffer);
+}
+
+void D3D11RenderContext::SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	context1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+}
+
+void D3D11RenderContext::UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size)
+{
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return;
+
+	memcpy(mapped.pData, data, size);
+	context->Unmap(buffer, 0);
+}
+
+void D3D11RenderContext::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	context->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void D3D11RenderContext::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	context->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
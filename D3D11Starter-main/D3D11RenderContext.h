@@ -0,0 +1,39 @@
+#pragma once
+
+#include <d3d11_1.h>
+#include <wrl/client.h>
+
+#include "RenderContext.h"
+
+// --------------------------------------------------------
+// A RenderContext that sends every call straight on to a
+// D3D11 device context
+//
+// Constant buffer ranges need the D3D11.1 runtime (Windows 8
+// and up) for VSSetConstantBuffers1.
+// --------------------------------------------------------
+class D3D11RenderContext : public RenderContext
+{
+public:
+	// Basic OOP Setup
+	explicit D3D11RenderContext(Microsoft::WRL::ComPtr<ID3D11DeviceContext> context);
+	~D3D11RenderContext();
+	D3D11RenderContext(const D3D11RenderContext&) = delete;
+	D3D11RenderContext& operator=(const D3D11RenderContext&) = delete;
+
+	// RenderContext
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset) override;
+	void SetIndexBuffer(ID3D11Buffer* buffer) override;
+	void SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) override;
+	void SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount) override;
+	void UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size) override;
+	void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) override;
+	void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> context1;
+};
@@ -0,0 +1,66 @@
+#include "D3D11TimestampSource.h"
+#include "Graphics.h"
+
+D3D11TimestampSource::D3D11TimestampSource(Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, unsigned int frameCount, unsigned int timestampsPerFrame) :
+	context(context),
+	frames(frameCount),
+	timestampsPerFrame(timestampsPerFrame)
+{
+	D3D11_QUERY_DESC disjointDesc = {};
+	disjointDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+
+	D3D11_QUERY_DESC timestampDesc = {};
+	timestampDesc.Query = D3D11_QUERY_TIMESTAMP;
+
+	for (Frame& frame : frames)
+	{
+		Graphics::Device->CreateQuery(&disjointDesc, frame.Disjoint.GetAddressOf());
+
+		frame.Timestamps.resize(timestampsPerFrame);
+		for (Microsoft::WRL::ComPtr<ID3D11Query>& query : frame.Timestamps)
+			Graphics::Device->CreateQuery(&timestampDesc, query.GetAddressOf());
+	}
+}
+
+D3D11TimestampSource::~D3D11TimestampSource()
+{
+}
+
+void D3D11TimestampSource::BeginFrame(unsigned int slot)
+{
+	context->Begin(frames[slot].Disjoint.Get());
+}
+
+void D3D11TimestampSource::WriteTimestamp(unsigned int slot, unsigned int index)
+{
+	// Timestamp queries only have an end
+	context->End(frames[slot].Timestamps[index].Get());
+}
+
+void D3D11TimestampSource::EndFrame(unsigned int slot)
+{
+	context->End(frames[slot].Disjoint.Get());
+}
+
+bool D3D11TimestampSource::ReadFrame(unsigned int slot, unsigned int count, uint64_t* timestamps, uint64_t& frequency, bool& disjoint)
+{
+	Frame& frame = frames[slot];
+
+	// The disjoint query ends last, so once it's done the rest usually are too
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData = {};
+	if (context->GetData(frame.Disjoint.Get(), &disjointData, sizeof(disjointData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		return false;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (context->GetData(frame.Timestamps[i].Get(), &timestamps[i], sizeof(uint64_t), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			return false;
+	}
+
+	frequency = disjointData.Frequency;
+	disjoint = disjointData.Disjoint;
+	return true;
+}
+
+unsigned int D3D11TimestampSource::GetFrameCount() { return (unsigned int)frames.size(); }
+unsigned int D3D11TimestampSource::GetTimestampsPerFrame() { return timestampsPerFrame; }
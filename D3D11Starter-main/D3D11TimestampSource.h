@@ -0,0 +1,45 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+
+#include "GpuTimestampSource.h"
+
+// --------------------------------------------------------
+// Timestamps from D3D11 queries
+//
+// Each slot has a TIMESTAMP_DISJOINT query around the whole
+// frame, which gives the tick frequency and whether the
+// ticks can be trusted, and a TIMESTAMP query per timestamp.
+// Results are read with DONOTFLUSH, so reading never makes
+// the CPU wait on (or flush work to) the GPU.
+// --------------------------------------------------------
+class D3D11TimestampSource : public GpuTimestampSource
+{
+public:
+	// Basic OOP Setup
+	D3D11TimestampSource(Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, unsigned int frameCount = 4, unsigned int timestampsPerFrame = 64);
+	~D3D11TimestampSource();
+	D3D11TimestampSource(const D3D11TimestampSource&) = delete;
+	D3D11TimestampSource& operator=(const D3D11TimestampSource&) = delete;
+
+	// GpuTimestampSource
+	void BeginFrame(unsigned int slot) override;
+	void WriteTimestamp(unsigned int slot, unsigned int index) override;
+	void EndFrame(unsigned int slot) override;
+	bool ReadFrame(unsigned int slot, unsigned int count, uint64_t* timestamps, uint64_t& frequency, bool& disjoint) override;
+	unsigned int GetFrameCount() override;
+	unsigned int GetTimestampsPerFrame() override;
+
+private:
+	struct Frame
+	{
+		Microsoft::WRL::ComPtr<ID3D11Query> Disjoint;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> Timestamps;
+	};
+
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	std::vector<Frame> frames;
+	unsigned int timestampsPerFrame;
+};
@@ -0,0 +1,221 @@
+#include "D3D11UiRenderer.h"
+#include "FramePacket.h"
+#include "Graphics.h"
+#include "PathHelpers.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <d3dcompiler.h>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Should match ExternalData in VertexShaderUi.hlsl
+	struct UiConstants
+	{
+		XMFLOAT4X4 Projection;
+	};
+
+	// Input layout matching PacketUiVertex
+	// - COLOR is packed RGBA8, expanded to a float4 by the input assembler
+	const D3D11_INPUT_ELEMENT_DESC uiVertexLayout[] =
+	{
+		{ "POSITION",	0, DXGI_FORMAT_R32G32_FLOAT,	0, offsetof(PacketUiVertex, Position),	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,	0, offsetof(PacketUiVertex, UV),		D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR",		0, DXGI_FORMAT_R8G8B8A8_UNORM,	0, offsetof(PacketUiVertex, Color),		D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	};
+}
+
+D3D11UiRenderer::D3D11UiRenderer() :
+	vertexCapacity(0),
+	indexCapacity(0)
+{
+	Microsoft::WRL::ComPtr<ID3DBlob> vertexShaderBlob;
+	Microsoft::WRL::ComPtr<ID3DBlob> pixelShaderBlob;
+	if (SUCCEEDED(D3DReadFileToBlob(FixPath(L"VertexShaderUi.cso").c_str(), vertexShaderBlob.GetAddressOf())))
+	{
+		Graphics::Device->CreateVertexShader(vertexShaderBlob->GetBufferPointer(), vertexShaderBlob->GetBufferSize(), 0, vertexShader.GetAddressOf());
+		Graphics::Device->CreateInputLayout(
+			uiVertexLayout,
+			ARRAYSIZE(uiVertexLayout),
+			vertexShaderBlob->GetBufferPointer(),
+			vertexShaderBlob->GetBufferSize(),
+			inputLayout.GetAddressOf());
+	}
+	if (SUCCEEDED(D3DReadFileToBlob(FixPath(L"PixelShaderUi.cso").c_str(), pixelShaderBlob.GetAddressOf())))
+		Graphics::Device->CreatePixelShader(pixelShaderBlob->GetBufferPointer(), pixelShaderBlob->GetBufferSize(), 0, pixelShader.GetAddressOf());
+
+	// The projection, rewritten every frame
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.ByteWidth = sizeof(UiConstants);
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	Graphics::Device->CreateBuffer(&bufferDesc, 0, constantBuffer.GetAddressOf());
+
+	// Alpha blending over what's already there
+	D3D11_BLEND_DESC blendDesc = {};
+	blendDesc.RenderTarget[0].BlendEnable = TRUE;
+	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+	blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+	blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+	blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+	blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+	Graphics::Device->CreateBlendState(&blendDesc, blendState.GetAddressOf());
+
+	// No culling, as UI triangles come in either winding, and
+	// every command clips to its own rectangle
+	D3D11_RASTERIZER_DESC rasterizerDesc = {};
+	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+	rasterizerDesc.CullMode = D3D11_CULL_NONE;
+	rasterizerDesc.DepthClipEnable = TRUE;
+	rasterizerDesc.ScissorEnable = TRUE;
+	Graphics::Device->CreateRasterizerState(&rasterizerDesc, rasterizerState.GetAddressOf());
+
+	// Drawn over everything, whatever's in the depth buffer
+	D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {};
+	depthStencilDesc.DepthEnable = FALSE;
+	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+	depthStencilDesc.DepthFunc = D3D11_COMPARISON_ALWAYS;
+	depthStencilDesc.FrontFace.StencilFailOp = D3D11_STENCIL_OP_KEEP;
+	depthStencilDesc.FrontFace.StencilDepthFailOp = D3D11_STENCIL_OP_KEEP;
+	depthStencilDesc.FrontFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
+	depthStencilDesc.FrontFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
+	depthStencilDesc.BackFace = depthStencilDesc.FrontFace;
+	Graphics::Device->CreateDepthStencilState(&depthStencilDesc, depthStencilState.GetAddressOf());
+
+	D3D11_SAMPLER_DESC samplerDesc = {};
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	Graphics::Device->CreateSamplerState(&samplerDesc, sampler.GetAddressOf());
+}
+
+D3D11UiRenderer::~D3D11UiRenderer()
+{
+}
+
+void D3D11UiRenderer::Draw(const FramePacket& packet)
+{
+	// Nothing to see when minimized
+	const PacketUiDisplay& display = packet.GetUiDisplay();
+	std::span<const PacketUiVertex> vertices = packet.GetUiVertices();
+	std::span<const uint16_t> indices = packet.GetUiIndices();
+	if (display.Size.x <= 0.0f || display.Size.y <= 0.0f || vertices.empty() || indices.empty())
+		return;
+	if (!vertexShader || !pixelShader || !inputLayout)
+		return;
+
+	// Every list's vertices and indices are already back to back in the packet
+	Reserve(vertexBuffer, vertexCapacity, (unsigned int)vertices.size(), sizeof(PacketUiVertex), D3D11_BIND_VERTEX_BUFFER, 5000);
+	Reserve(indexBuffer, indexCapacity, (unsigned int)indices.size(), sizeof(uint16_t), D3D11_BIND_INDEX_BUFFER, 10000);
+	if (!vertexBuffer || !indexBuffer)
+		return;
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(Graphics::Context->Map(vertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return;
+	memcpy(mapped.pData, vertices.data(), vertices.size_bytes());
+	Graphics::Context->Unmap(vertexBuffer.Get(), 0);
+
+	if (FAILED(Graphics::Context->Map(indexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return;
+	memcpy(mapped.pData, indices.data(), indices.size_bytes());
+	Graphics::Context->Unmap(indexBuffer.Get(), 0);
+
+	// UI pixels, from the display's top left corner, onto the screen
+	UiConstants constants;
+	XMStoreFloat4x4(&constants.Projection, XMMatrixOrthographicOffCenterLH(
+		display.Position.x, display.Position.x + display.Size.x,
+		display.Position.y + display.Size.y, display.Position.y,
+		0.0f, 1.0f));
+	if (FAILED(Graphics::Context->Map(constantBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return;
+	memcpy(mapped.pData, &constants, sizeof(UiConstants));
+	Graphics::Context->Unmap(constantBuffer.Get(), 0);
+
+	D3D11_VIEWPORT viewport = {};
+	viewport.Width = display.Size.x;
+	viewport.Height = display.Size.y;
+	viewport.MaxDepth = 1.0f;
+
+	unsigned int stride = sizeof(PacketUiVertex);
+	unsigned int offset = 0;
+	const float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	Graphics::Context->RSSetViewports(1, &viewport);
+	Graphics::Context->IASetInputLayout(inputLayout.Get());
+	Graphics::Context->IASetVertexBuffers(0, 1, vertexBuffer.GetAddressOf(), &stride, &offset);
+	Graphics::Context->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+	Graphics::Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	Graphics::Context->VSSetShader(vertexShader.Get(), 0, 0);
+	Graphics::Context->VSSetConstantBuffers(0, 1, constantBuffer.GetAddressOf());
+	Graphics::Context->PSSetShader(pixelShader.Get(), 0, 0);
+	Graphics::Context->PSSetSamplers(0, 1, sampler.GetAddressOf());
+	Graphics::Context->OMSetBlendState(blendState.Get(), blendFactor, 0xFFFFFFFF);
+	Graphics::Context->OMSetDepthStencilState(depthStencilState.Get(), 0);
+	Graphics::Context->RSSetState(rasterizerState.Get());
+
+	// Commands index from the start of their own list
+	std::span<const PacketUiCommand> commands = packet.GetUiCommands();
+	for (const PacketUiList& list : packet.GetUiLists())
+	{
+		for (unsigned int c = 0; c < list.CommandCount; c++)
+		{
+			const PacketUiCommand& command = commands[list.FirstCommand + c];
+
+			// Clip rectangles are in UI pixels, scissors from the display's corner
+			D3D11_RECT scissor = {
+				(LONG)(command.ClipRect.x - display.Position.x),
+				(LONG)(command.ClipRect.y - display.Position.y),
+				(LONG)(command.ClipRect.z - display.Position.x),
+				(LONG)(command.ClipRect.w - display.Position.y) };
+			if (scissor.right <= scissor.left || scissor.bottom <= scissor.top || command.ElementCount == 0)
+				continue;
+
+			ID3D11ShaderResourceView* texture = (ID3D11ShaderResourceView*)(uintptr_t)command.Texture;
+			Graphics::Context->RSSetScissorRects(1, &scissor);
+			Graphics::Context->PSSetShaderResources(0, 1, &texture);
+			Graphics::Context->DrawIndexed(
+				command.ElementCount,
+				list.FirstIndex + command.FirstIndex,
+				(int)(list.FirstVertex + command.FirstVertex));
+		}
+	}
+
+	// Back to the defaults, so nothing drawn after is scissored or blended
+	ID3D11ShaderResourceView* none = 0;
+	Graphics::Context->PSSetShaderResources(0, 1, &none);
+	Graphics::Context->OMSetBlendState(0, 0, 0xFFFFFFFF);
+	Graphics::Context->OMSetDepthStencilState(0, 0);
+	Graphics::Context->RSSetState(0);
+}
+
+// --------------------------------------------------------
+// Makes a dynamic buffer at least count elements long,
+// with extra room so slowly growing UIs don't recreate
+// it every frame
+// --------------------------------------------------------
+void D3D11UiRenderer::Reserve(Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, unsigned int& capacity, unsigned int count, unsigned int stride, unsigned int bindFlags, unsigned int extra)
+{
+	if (buffer && capacity >= count)
+		return;
+
+	buffer.Reset();
+	capacity = count + extra;
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.ByteWidth = capacity * stride;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.BindFlags = bindFlags;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	if (FAILED(Graphics::Device->CreateBuffer(&desc, 0, buffer.GetAddressOf())))
+		capacity = 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+
+class FramePacket;
+
+// --------------------------------------------------------
+// Draws a packet's UI with D3D11 - on the render thread,
+// from nothing but the packet
+//
+// The UI library's own renderer reads its shared draw list
+// data and backend state, which the game thread is busy
+// changing for the next frame by then. This keeps its own
+// shaders, states and buffers instead, so the only thing it
+// shares with the game thread is the device.
+//
+// Textures are the commands' ImTextureIDs, which the UI
+// library's backend creates (on the game thread, in
+// NewFrame()) as shader resource views and keeps until
+// shutdown.
+//
+// Draws into whatever render target is bound. Leaves its
+// shaders and buffers bound, but the blend, rasterizer
+// (scissor) and depth states back at their defaults.
+// --------------------------------------------------------
+class D3D11UiRenderer
+{
+public:
+	// Basic OOP Setup
+	D3D11UiRenderer();
+	~D3D11UiRenderer();
+	D3D11UiRenderer(const D3D11UiRenderer&) = delete;
+	D3D11UiRenderer& operator=(const D3D11UiRenderer&) = delete;
+
+	void Draw(const FramePacket& packet);
+
+private:
+	// Recreates a dynamic buffer if it can't hold count elements
+	void Reserve(Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, unsigned int& capacity, unsigned int count, unsigned int stride, unsigned int bindFlags, unsigned int extra);
+
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> vertexShader;
+	Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader;
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> constantBuffer;
+	Microsoft::WRL::ComPtr<ID3D11BlendState> blendState;
+	Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterizerState;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthStencilState;
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;
+
+	// Grown as needed, never shrunk
+	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+	unsigned int vertexCapacity;
+	unsigned int indexCapacity;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// --------------------------------------------------------
+// Tells when the GPU has finished a frame, behind an
+// interface so a FramePacer can limit frames in flight on
+// D3D11 (D3D11FrameFence) or against a simulated GPU
+// --------------------------------------------------------
+class FrameFence
+{
+public:
+	virtual ~FrameFence() {}
+
+	// After the frame's last GPU work has been submitted
+	virtual void Signal(uint64_t frame) = 0;
+
+	// Never waits - frames finish in order, so any frame older
+	// than a finished one counts as finished too. A frame that
+	// hasn't been signaled yet isn't finished, as it may still
+	// be on its way from another thread.
+	virtual bool IsComplete(uint64_t frame) = 0;
+};
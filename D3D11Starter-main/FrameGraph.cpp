@@ -0,0 +1,266 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	float MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+FrameGraph::FrameGraph() :
+	compiled(false),
+	stats{},
+	compileMilliseconds(0),
+	executeMilliseconds(0)
+{
+}
+
+FrameGraph::~FrameGraph()
+{
+}
+
+void FrameGraph::Reset()
+{
+	resources.clear();
+	passes.clear();
+	passOrder.clear();
+	physicalTextures.clear();
+	error.clear();
+	stats = {};
+	compiled = false;
+}
+
+unsigned int FrameGraph::CreateTexture(const std::string& name, const FrameGraphTextureDesc& desc)
+{
+	resources.push_back({ name, desc, false, {}, Invalid, Invalid, Invalid });
+	compiled = false;
+	return (unsigned int)resources.size() - 1;
+}
+
+unsigned int FrameGraph::ImportTexture(const std::string& name, const FrameGraphTextureDesc& desc)
+{
+	resources.push_back({ name, desc, true, {}, Invalid, Invalid, Invalid });
+	compiled = false;
+	return (unsigned int)resources.size() - 1;
+}
+
+unsigned int FrameGraph::AddPass(const std::string& name, FrameGraphExecute execute)
+{
+	passes.push_back({ name, std::move(execute), {}, {}, false, false });
+	compiled = false;
+	return (unsigned int)passes.size() - 1;
+}
+
+void FrameGraph::Read(unsigned int pass, unsigned int resource)
+{
+	if (pass >= passes.size() || resource >= resources.size())
+		return;
+
+	passes[pass].Reads.push_back(resource);
+	compiled = false;
+}
+
+void FrameGraph::Write(unsigned int pass, unsigned int resource)
+{
+	if (pass >= passes.size() || resource >= resources.size())
+		return;
+
+	passes[pass].Writes.push_back(resource);
+	resources[resource].Writers.push_back(pass);
+	compiled = false;
+}
+
+void FrameGraph::KeepAlive(unsigned int pass)
+{
+	if (pass < passes.size())
+		passes[pass].KeepAlive = true;
+	compiled = false;
+}
+
+bool FrameGraph::Compile()
+{
+	auto start = std::chrono::steady_clock::now();
+	compiled = false;
+	error.clear();
+	passOrder.clear();
+	physicalTextures.clear();
+	stats = {};
+	stats.PassCount = (unsigned int)passes.size();
+
+	for (Resource& r : resources)
+	{
+		// Read()/Write() may come in any order, but writers go in the order their passes were added
+		std::sort(r.Writers.begin(), r.Writers.end());
+		r.Writers.erase(std::unique(r.Writers.begin(), r.Writers.end()), r.Writers.end());
+		r.FirstUse = Invalid;
+		r.LastUse = Invalid;
+		r.Physical = Invalid;
+	}
+
+	// The version of a resource a pass reads is the one left by
+	// its last writer added before the pass - a pass that reads
+	// and writes sees what came before its own write
+	auto writerBefore = [&](unsigned int pass, unsigned int resource)
+		{
+			const std::vector<unsigned int>& writers = resources[resource].Writers;
+			auto next = std::lower_bound(writers.begin(), writers.end(), pass);
+			return next == writers.begin() ? Invalid : *(next - 1);
+		};
+
+	// Culling
+	// - Walk back from the passes with visible results, keeping
+	//   the writer of each version they read (earlier versions
+	//   that were overwritten before anything kept read them go)
+	std::vector<unsigned int> open;
+	for (unsigned int i = 0; i < passes.size(); i++)
+	{
+		Pass& pass = passes[i];
+		pass.Kept = pass.KeepAlive;
+		for (unsigned int resource : pass.Writes)
+			pass.Kept = pass.Kept || resources[resource].Imported;
+
+		if (pass.Kept)
+			open.push_back(i);
+	}
+
+	while (!open.empty())
+	{
+		unsigned int current = open.back();
+		open.pop_back();
+		for (unsigned int resource : passes[current].Reads)
+		{
+			unsigned int writer = writerBefore(current, resource);
+			if (writer != Invalid && !passes[writer].Kept)
+			{
+				passes[writer].Kept = true;
+				open.push_back(writer);
+			}
+		}
+	}
+
+	// Order
+	// - Every read comes after the write it sees and before the
+	//   next write (write after read), and writes of a resource
+	//   keep the order they were added - all of which point from
+	//   an earlier added pass to a later one, so the kept passes
+	//   run in the order they were added
+	for (unsigned int i = 0; i < passes.size(); i++)
+	{
+		if (!passes[i].Kept)
+			continue;
+
+		// A transient must have been written before it's read
+		for (unsigned int resource : passes[i].Reads)
+		{
+			if (!resources[resource].Imported && writerBefore(i, resource) == Invalid)
+			{
+				passOrder.clear();
+				return Fail("Pass \"" + passes[i].Name + "\" reads \"" + resources[resource].Name + "\" before anything writes it");
+			}
+		}
+		passOrder.push_back(i);
+	}
+	unsigned int keptCount = (unsigned int)passOrder.size();
+
+	// Lifetimes, as positions in the pass order
+	for (unsigned int position = 0; position < passOrder.size(); position++)
+	{
+		const Pass& pass = passes[passOrder[position]];
+		for (const std::vector<unsigned int>* accesses : { &pass.Reads, &pass.Writes })
+		{
+			for (unsigned int resource : *accesses)
+			{
+				Resource& r = resources[resource];
+				if (r.FirstUse == Invalid)
+					r.FirstUse = position;
+				r.LastUse = position;
+			}
+		}
+	}
+
+	// Physical textures
+	// - Taking transients in the order they start and giving each the
+	//   first matching texture that's free by then uses as few as the
+	//   overlaps allow (it's interval coloring, per description)
+	std::vector<unsigned int> transients;
+	for (unsigned int resource = 0; resource < resources.size(); resource++)
+	{
+		if (!resources[resource].Imported && resources[resource].FirstUse != Invalid)
+			transients.push_back(resource);
+	}
+	std::stable_sort(transients.begin(), transients.end(),
+		[&](unsigned int a, unsigned int b) { return resources[a].FirstUse < resources[b].FirstUse; });
+
+	std::vector<unsigned int> physicalFreeAfter;
+	for (unsigned int resource : transients)
+	{
+		Resource& r = resources[resource];
+		for (unsigned int i = 0; i < physicalTextures.size() && r.Physical == Invalid; i++)
+		{
+			if (physicalTextures[i] == r.Desc && physicalFreeAfter[i] < r.FirstUse)
+				r.Physical = i;
+		}
+
+		if (r.Physical == Invalid)
+		{
+			r.Physical = (unsigned int)physicalTextures.size();
+			physicalTextures.push_back(r.Desc);
+			physicalFreeAfter.push_back(0);
+		}
+		physicalFreeAfter[r.Physical] = r.LastUse;
+
+		stats.UnaliasedBytes += (size_t)r.Desc.Width * r.Desc.Height * r.Desc.BytesPerPixel;
+	}
+
+	for (const FrameGraphTextureDesc& desc : physicalTextures)
+		stats.PeakTransientBytes += (size_t)desc.Width * desc.Height * desc.BytesPerPixel;
+
+	stats.CulledPassCount = stats.PassCount - keptCount;
+	stats.TransientCount = (unsigned int)transients.size();
+	stats.PhysicalTextureCount = (unsigned int)physicalTextures.size();
+
+	compiled = true;
+	compileMilliseconds = MillisecondsSince(start);
+	return true;
+}
+
+void FrameGraph::Execute()
+{
+	if (!compiled)
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int pass : passOrder)
+	{
+		if (passes[pass].Execute)
+			passes[pass].Execute();
+	}
+	executeMilliseconds = MillisecondsSince(start);
+}
+
+// --------------------------------------------------------
+// Records why Compile() failed, and leaves nothing to run
+// --------------------------------------------------------
+bool FrameGraph::Fail(const std::string& message)
+{
+	error = message;
+	compiled = false;
+	return false;
+}
+
+FrameGraphStats FrameGraph::GetStats() { return stats; }
+const std::string& FrameGraph::GetError() { return error; }
+const std::vector<unsigned int>& FrameGraph::GetPassOrder() { return passOrder; }
+const std::string& FrameGraph::GetPassName(unsigned int pass) { return passes[pass].Name; }
+bool FrameGraph::IsCulled(unsigned int pass) { return !passes[pass].Kept; }
+unsigned int FrameGraph::GetPhysicalIndex(unsigned int resource) { return resources[resource].Physical; }
+unsigned int FrameGraph::GetPhysicalTextureCount() { return (unsigned int)physicalTextures.size(); }
+const FrameGraphTextureDesc& FrameGraph::GetPhysicalTexture(unsigned int index) { return physicalTextures[index]; }
+float FrameGraph::GetCompileMilliseconds() { return compileMilliseconds; }
+float FrameGraph::GetExecuteMilliseconds() { return executeMilliseconds; }
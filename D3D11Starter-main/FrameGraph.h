@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------
+// What a frame graph texture looks like - transients with
+// equal descriptions can share one physical texture
+// --------------------------------------------------------
+struct FrameGraphTextureDesc
+{
+	unsigned int Width;
+	unsigned int Height;
+	unsigned int Format;		// A DXGI_FORMAT, only ever compared here
+	unsigned int BytesPerPixel;	// For the memory report
+
+	bool operator==(const FrameGraphTextureDesc& other) const
+	{
+		return Width == other.Width && Height == other.Height && Format == other.Format && BytesPerPixel == other.BytesPerPixel;
+	}
+};
+
+// What the last Compile() came to
+struct FrameGraphStats
+{
+	unsigned int PassCount;				// Added
+	unsigned int CulledPassCount;		// Dropped, as nothing kept used what they wrote
+	unsigned int TransientCount;		// Used by the passes that are left
+	unsigned int PhysicalTextureCount;	// Actually needed once lifetimes are shared
+	size_t UnaliasedBytes;				// Every used transient with its own texture
+	size_t PeakTransientBytes;			// The physical textures
+};
+
+// Runs one pass - whatever it draws with is captured by the function
+using FrameGraphExecute = std::function<void()>;
+
+// --------------------------------------------------------
+// Orders, trims and lays out the memory of a frame's passes
+// from what each one says it reads and writes
+//
+// Passes are added with the resources they touch, then
+// Compile() works out, on the CPU and without a device:
+//  - Versions: each write makes a new version of a resource,
+//    and a read sees the one left by the last pass added
+//    before it that writes the resource - so W1, R, W2 has R
+//    reading W1's version, and W2 waits for R
+//  - Culling: passes are kept if they're marked KeepAlive(),
+//    write an imported resource (the back buffer, say) or
+//    wrote a version a kept pass reads - the rest are dropped
+//  - Order: the kept passes run in the order they were added,
+//    which puts every read between the write it sees and the
+//    next one
+//  - Lifetimes: each transient lives from the first kept pass
+//    that touches it to the last, and transients that are
+//    never alive at once share a physical texture when their
+//    descriptions match (D3D11 can't place two textures in
+//    one allocation, so equal textures are reused instead)
+//
+// A pass that both reads and writes a resource (blending
+// into it, say) must declare both, or it won't keep the
+// pass that wrote the version it blends into.
+//
+// Execute() then runs the kept passes in order. Binding the
+// physical textures is up to the passes themselves - see
+// D3D11FrameGraphTextures for a pool to get them from.
+// --------------------------------------------------------
+class FrameGraph
+{
+public:
+	static const unsigned int Invalid = 0xFFFFFFFF;
+
+	// Basic OOP Setup
+	FrameGraph();
+	~FrameGraph();
+	FrameGraph(const FrameGraph&) = delete;
+	FrameGraph& operator=(const FrameGraph&) = delete;
+
+	// Forgets every pass and resource, ready for the next frame
+	void Reset();
+
+	// Resources
+	unsigned int CreateTexture(const std::string& name, const FrameGraphTextureDesc& desc);	// Transient, only lives during the frame
+	unsigned int ImportTexture(const std::string& name, const FrameGraphTextureDesc& desc);	// Owned outside the graph
+
+	// Passes
+	unsigned int AddPass(const std::string& name, FrameGraphExecute execute);
+	void Read(unsigned int pass, unsigned int resource);
+	void Write(unsigned int pass, unsigned int resource);
+	void KeepAlive(unsigned int pass);	// For passes with effects the graph can't see
+
+	// Culls, orders and assigns physical textures
+	// - Fails if a kept pass reads a transient nothing wrote before it
+	bool Compile();
+
+	// Runs the kept passes in order - only after a successful Compile()
+	void Execute();
+
+	// Getters
+	FrameGraphStats GetStats();
+	const std::string& GetError();						// Why the last Compile() failed
+	const std::vector<unsigned int>& GetPassOrder();	// Kept passes, in the order they run
+	const std::string& GetPassName(unsigned int pass);
+	bool IsCulled(unsigned int pass);
+	unsigned int GetPhysicalIndex(unsigned int resource);	// Invalid for imports and unused transients
+	unsigned int GetPhysicalTextureCount();
+	const FrameGraphTextureDesc& GetPhysicalTexture(unsigned int index);
+	float GetCompileMilliseconds();
+	float GetExecuteMilliseconds();
+
+private:
+	struct Resource
+	{
+		std::string Name;
+		FrameGraphTextureDesc Desc;
+		bool Imported;
+		std::vector<unsigned int> Writers;	// Passes, in the order they were added
+		unsigned int FirstUse;				// Positions in passOrder
+		unsigned int LastUse;
+		unsigned int Physical;
+	};
+
+	struct Pass
+	{
+		std::string Name;
+		FrameGraphExecute Execute;
+		std::vector<unsigned int> Reads;
+		std::vector<unsigned int> Writes;
+		bool KeepAlive;
+		bool Kept;
+	};
+
+	bool Fail(const std::string& error);
+
+	std::vector<Resource> resources;
+	std::vector<Pass> passes;
+
+	// Compiled
+	bool compiled;
+	std::string error;
+	std::vector<unsigned int> passOrder;
+	std::vector<FrameGraphTextureDesc> physicalTextures;
+	FrameGraphStats stats;
+
+	float compileMilliseconds;
+	float executeMilliseconds;
+};
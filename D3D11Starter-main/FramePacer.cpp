@@ -0,0 +1,254 @@
+#include "FramePacer.h"
+#include "FrameFence.h"
+#include "PacingClock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// How often to look at the fence while the GPU catches up
+	const double fencePollSeconds = 0.0005;
+
+	// Spin for at least this long before a deadline, and past
+	// the worst recent sleep overrun by this much again
+	const double minSpinSeconds = 0.0005;
+	const double spinPadding = 1.25;
+
+	// How quickly a sleep overrun is forgotten, per sleep
+	const double overrunDecay = 0.98;
+
+	// Adaptive mode needs this many frames before it trusts its
+	// numbers, then eases its beat down (never up) this much a frame
+	const unsigned int minAdaptiveFrames = 10;
+	const double adaptiveEaseDown = 0.05;
+
+	// Average and standard deviation of value(record) over a set of records
+	template <typename Record, typename Value>
+	void MeanAndDeviation(const std::vector<Record>& records, unsigned int count, Value value, double& mean, double& deviation)
+	{
+		mean = 0;
+		deviation = 0;
+		if (count == 0)
+			return;
+
+		for (unsigned int i = 0; i < count; i++)
+			mean += value(records[i]);
+		mean /= count;
+
+		for (unsigned int i = 0; i < count; i++)
+			deviation += (value(records[i]) - mean) * (value(records[i]) - mean);
+		deviation = std::sqrt(deviation / count);
+	}
+}
+
+FramePacer::FramePacer(PacingClock& clock) :
+	clock(clock),
+	fence(nullptr),
+	maxFramesInFlight(0),
+	signalFence(true),
+	mode(FramePacingMode::TargetFps),
+	targetFps(60.0f),
+	frameNumber(0),
+	frameStart(0),
+	deadline(0),
+	started(false),
+	sleepOverrun(0),
+	history(StatsWindow),
+	historyCount(0),
+	current{},
+	currentHasInterval(false),
+	missedDeadlines(0),
+	adaptiveBeat(0)
+{
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+void FramePacer::SetMode(FramePacingMode mode)
+{
+	this->mode = mode;
+}
+
+void FramePacer::SetTargetFps(float fps)
+{
+	targetFps = std::max(fps, 1.0f);
+}
+
+void FramePacer::SetFramesInFlight(FrameFence* fence, unsigned int maxFramesInFlight, bool signalFence)
+{
+	this->fence = fence;
+	this->maxFramesInFlight = maxFramesInFlight;
+	this->signalFence = signalFence;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+	double waitStart = clock.Now();
+	uint64_t nextFrame = frameNumber + 1;
+
+	// Let the GPU catch up first, as it decides when there's room for another frame
+	if (fence && maxFramesInFlight > 0 && nextFrame > maxFramesInFlight)
+	{
+		while (!fence->IsComplete(nextFrame - maxFramesInFlight))
+			clock.Sleep(fencePollSeconds);
+	}
+	double fenceWait = clock.Now() - waitStart;
+
+	// Then wait for this frame's place on the beat
+	double beat = GetBeat();
+	if (beat > 0 && started)
+	{
+		deadline += beat;
+		if (clock.Now() > deadline + beat)
+		{
+			missedDeadlines++;
+			deadline = clock.Now();
+		}
+		else
+		{
+			WaitUntil(deadline);
+		}
+	}
+
+	double start = clock.Now();
+	if (beat <= 0 || !started)
+		deadline = start;
+
+	current.Interval = (float)((start - frameStart) * 1000.0);
+	current.DeadlineError = (float)(std::abs(start - deadline) * 1000.0);
+	current.Wait = (float)((start - waitStart) * 1000.0);
+	current.FenceWait = (float)(fenceWait * 1000.0);
+	currentHasInterval = started;
+
+	frameStart = start;
+	frameNumber = nextFrame;
+	started = true;
+}
+
+void FramePacer::EndFrame()
+{
+	if (!started)
+		return;
+
+	if (fence && signalFence)
+		fence->Signal(frameNumber);
+
+	// The first frame has nothing to measure its start from
+	current.Work = (float)((clock.Now() - frameStart) * 1000.0);
+	if (currentHasInterval)
+	{
+		history[historyCount % StatsWindow] = current;
+		historyCount++;
+	}
+	currentHasInterval = false;
+}
+
+// --------------------------------------------------------
+// Sleeps while there's comfortably more time left than a
+// sleep might run over by, then spins out the rest
+// --------------------------------------------------------
+void FramePacer::WaitUntil(double deadline)
+{
+	for (;;)
+	{
+		double remaining = deadline - clock.Now();
+		if (remaining <= 0)
+			return;
+
+		double margin = std::max(minSpinSeconds, sleepOverrun * spinPadding);
+		if (remaining <= margin)
+			break;
+
+		double request = remaining - margin;
+		double before = clock.Now();
+		clock.Sleep(request);
+		double overrun = (clock.Now() - before) - request;
+		sleepOverrun = std::max(overrun, sleepOverrun * overrunDecay);
+	}
+
+	while (clock.Now() < deadline)
+		std::this_thread::yield();
+}
+
+// --------------------------------------------------------
+// Seconds between frame starts for the current mode, or 0
+// to start each frame as soon as possible
+// --------------------------------------------------------
+double FramePacer::GetBeat()
+{
+	double targetBeat = 1.0 / targetFps;
+	switch (mode)
+	{
+	case FramePacingMode::Unlimited:
+		return 0;
+
+	case FramePacingMode::TargetFps:
+		return targetBeat;
+
+	case FramePacingMode::Adaptive:
+	{
+		unsigned int count = std::min(historyCount, StatsWindow);
+		if (count < minAdaptiveFrames)
+		{
+			adaptiveBeat = targetBeat;
+			return adaptiveBeat;
+		}
+
+		// A frame costs its own work plus any wait for the GPU, so GPU-bound
+		// frames slow the beat too. Slow frames lengthen it straight away,
+		// fast ones shorten it gradually
+		double mean, deviation;
+		MeanAndDeviation(history, count, [](const FrameRecord& r) { return (double)r.Work + r.FenceWait; }, mean, deviation);
+		double needed = std::max((mean + 2.0 * deviation) / 1000.0, targetBeat);
+		if (needed > adaptiveBeat)
+			adaptiveBeat = needed;
+		else
+			adaptiveBeat += (needed - adaptiveBeat) * adaptiveEaseDown;
+		return adaptiveBeat;
+	}
+	}
+	return 0;
+}
+
+FramePacerStats FramePacer::GetStats()
+{
+	FramePacerStats stats = {};
+	unsigned int count = std::min(historyCount, StatsWindow);
+	double beat = mode == FramePacingMode::Adaptive ? adaptiveBeat : GetBeat();
+	stats.TargetMilliseconds = (float)(beat * 1000.0);
+	stats.MissedDeadlines = missedDeadlines;
+	if (count == 0)
+		return stats;
+
+	double mean, deviation;
+	MeanAndDeviation(history, count, [](const FrameRecord& r) { return (double)r.Interval; }, mean, deviation);
+	stats.AverageMilliseconds = (float)mean;
+	stats.JitterMilliseconds = (float)deviation;
+
+	MeanAndDeviation(history, count, [](const FrameRecord& r) { return (double)r.DeadlineError; }, mean, deviation);
+	stats.DeadlineErrorMilliseconds = (float)mean;
+	MeanAndDeviation(history, count, [](const FrameRecord& r) { return (double)r.Work; }, mean, deviation);
+	stats.AverageWorkMilliseconds = (float)mean;
+	MeanAndDeviation(history, count, [](const FrameRecord& r) { return (double)r.Wait; }, mean, deviation);
+	stats.AverageWaitMilliseconds = (float)mean;
+
+	stats.MinMilliseconds = history[0].Interval;
+	stats.MaxMilliseconds = history[0].Interval;
+	for (unsigned int i = 1; i < count; i++)
+	{
+		stats.MinMilliseconds = std::min(stats.MinMilliseconds, history[i].Interval);
+		stats.MaxMilliseconds = std::max(stats.MaxMilliseconds, history[i].Interval);
+	}
+	return stats;
+}
+
+FramePacingMode FramePacer::GetMode() { return mode; }
+float FramePacer::GetTargetFps() { return targetFps; }
+unsigned int FramePacer::GetMaxFramesInFlight() { return maxFramesInFlight; }
+uint64_t FramePacer::GetFrameNumber() { return frameNumber; }
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class FrameFence;
+class PacingClock;
+
+// How a FramePacer picks when the next frame starts
+enum class FramePacingMode
+{
+	Unlimited,	// As soon as the last one's done (frames in flight still apply)
+	TargetFps,	// On a fixed beat of 1 / target FPS
+	Adaptive	// On a beat the frames' own work times can keep up with, capped at the target FPS
+};
+
+// Frame timing over the last StatsWindow frames, in milliseconds
+struct FramePacerStats
+{
+	float TargetMilliseconds;	// The beat being kept, 0 when unlimited
+	float AverageMilliseconds;	// Start to start
+	float MinMilliseconds;
+	float MaxMilliseconds;
+	float JitterMilliseconds;	// Standard deviation of start to start
+	float DeadlineErrorMilliseconds;	// Average distance of each start from its deadline
+	float AverageWorkMilliseconds;		// Start to EndFrame()
+	float AverageWaitMilliseconds;		// Spent in WaitForNextFrame()
+	unsigned int MissedDeadlines;		// Frames that started over a beat late, since the pacer was made
+};
+
+// --------------------------------------------------------
+// Decides when each frame starts, so the game runs at a
+// steady rate instead of as fast as it can
+//
+// WaitForNextFrame() goes at the top of the loop and
+// EndFrame() after Present():
+//  - Frames in flight: with a fence, a frame can't start
+//    until the GPU has finished the one maxFramesInFlight
+//    back, so input never queues up behind a long backlog.
+//    EndFrame() signals the fence, unless whatever actually
+//    submits the frame (a render thread) does it instead,
+//    with the frame's GetFrameNumber()
+//  - TargetFps: frames start on a fixed beat - each deadline
+//    is the last one plus a beat, not the last start plus a
+//    beat, so early and late starts don't add up to drift.
+//    Frames that fall a whole beat behind start straight
+//    away and the beat restarts from there, rather than
+//    rushing to catch up
+//  - Adaptive: the beat is the recent work time plus two
+//    standard deviations, so the rate drops to one the
+//    frames can keep up with instead of stuttering
+//
+// Waiting sleeps until just before the deadline and spins
+// for the rest. How close to sleep is learned from how far
+// past their time the clock's sleeps actually run.
+//
+// Platform-neutral: the clock (and fence) are interfaces, so
+// the pacing can be checked on a simulated clock.
+// --------------------------------------------------------
+class FramePacer
+{
+public:
+	static const unsigned int StatsWindow = 120;
+
+	// Basic OOP Setup
+	explicit FramePacer(PacingClock& clock);
+	~FramePacer();
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	// Settings
+	void SetMode(FramePacingMode mode);
+	void SetTargetFps(float fps);
+	void SetFramesInFlight(FrameFence* fence, unsigned int maxFramesInFlight, bool signalFence = true);	// Null or 0 = no limit
+
+	void WaitForNextFrame();
+	void EndFrame();
+
+	// Getters
+	FramePacingMode GetMode();
+	float GetTargetFps();
+	unsigned int GetMaxFramesInFlight();
+	uint64_t GetFrameNumber();		// Of the frame started by the last WaitForNextFrame()
+	FramePacerStats GetStats();
+
+private:
+	// One finished frame
+	struct FrameRecord
+	{
+		float Interval;			// Its start from the last one's
+		float DeadlineError;
+		float Work;
+		float Wait;				// All of WaitForNextFrame()
+		float FenceWait;		// The part of it spent waiting on the GPU
+	};
+
+	void WaitUntil(double deadline);
+	double GetBeat();
+
+	PacingClock& clock;
+	FrameFence* fence;
+	unsigned int maxFramesInFlight;
+	bool signalFence;
+	FramePacingMode mode;
+	float targetFps;
+
+	// The beat
+	uint64_t frameNumber;
+	double frameStart;
+	double deadline;
+	bool started;
+
+	// How far past their time sleeps have run, decaying so one
+	// bad sleep doesn't mean spinning forever after
+	double sleepOverrun;
+
+	// Recent frames - the current one is only added once it ends
+	std::vector<FrameRecord> history;
+	unsigned int historyCount;
+	FrameRecord current;
+	bool currentHasInterval;
+	unsigned int missedDeadlines;
+	double adaptiveBeat;
+};
@@ -0,0 +1,141 @@
+#include "FramePacket.h"
+
+using namespace DirectX;
+
+FramePacket::FramePacket() :
+	frameNumber(0),
+	deltaTime(0),
+	totalTime(0),
+	finished(false),
+	camera{},
+	uiDisplay{}
+{
+}
+
+FramePacket::~FramePacket()
+{
+}
+
+// --------------------------------------------------------
+// Empties the packet for a new frame, releasing whatever
+// the last one kept alive
+// --------------------------------------------------------
+void FramePacket::Reset(uint64_t frameNumber, float deltaTime, float totalTime)
+{
+	this->frameNumber = frameNumber;
+	this->deltaTime = deltaTime;
+	this->totalTime = totalTime;
+	finished = false;
+
+	camera = {};
+	addedDraws.clear();
+	draws.clear();
+	keptMeshes.clear();
+	instances.clear();
+	instanceGroups.clear();
+	ribbonVertices.clear();
+	ribbonIndices.clear();
+	uiDisplay = {};
+	uiLists.clear();
+	uiCommands.clear();
+	uiVertices.clear();
+	uiIndices.clear();
+}
+
+void FramePacket::SetCamera(const XMFLOAT4X4& view, const XMFLOAT4X4& projection, unsigned int screenWidth, unsigned int screenHeight)
+{
+	camera.View = view;
+	camera.Projection = projection;
+	camera.ScreenWidth = screenWidth;
+	camera.ScreenHeight = screenHeight;
+	XMStoreFloat3(&camera.EyePosition, XMMatrixInverse(0, XMLoadFloat4x4(&view)).r[3]);
+}
+
+void FramePacket::AddDraw(uint64_t sortKey, Mesh* mesh, const BufferStruct& constants)
+{
+	addedDraws.push_back({ sortKey, mesh, constants });
+}
+
+void FramePacket::KeepAlive(std::shared_ptr<Mesh> mesh)
+{
+	keptMeshes.push_back(std::move(mesh));
+}
+
+// --------------------------------------------------------
+// Adds one instanced draw of mesh, copying its instances
+// --------------------------------------------------------
+void FramePacket::AddInstances(Mesh* mesh, std::span<const InstanceData> instances)
+{
+	if (instances.empty())
+		return;
+
+	instanceGroups.push_back({ mesh, (unsigned int)this->instances.size(), (unsigned int)instances.size() });
+	this->instances.insert(this->instances.end(), instances.begin(), instances.end());
+}
+
+void FramePacket::SetRibbons(std::span<const RibbonVertex> vertices, std::span<const unsigned int> indices)
+{
+	ribbonVertices.assign(vertices.begin(), vertices.end());
+	ribbonIndices.assign(indices.begin(), indices.end());
+}
+
+void FramePacket::SetUiDisplay(const PacketUiDisplay& display)
+{
+	uiDisplay = display;
+}
+
+// --------------------------------------------------------
+// Copies one UI draw list in - its commands' first index
+// and vertex stay relative to the list
+// --------------------------------------------------------
+void FramePacket::AddUiList(std::span<const PacketUiVertex> vertices, std::span<const uint16_t> indices, std::span<const PacketUiCommand> commands)
+{
+	PacketUiList list = {};
+	list.FirstCommand = (unsigned int)uiCommands.size();
+	list.CommandCount = (unsigned int)commands.size();
+	list.FirstVertex = (unsigned int)uiVertices.size();
+	list.VertexCount = (unsigned int)vertices.size();
+	list.FirstIndex = (unsigned int)uiIndices.size();
+	list.IndexCount = (unsigned int)indices.size();
+	uiLists.push_back(list);
+
+	uiCommands.insert(uiCommands.end(), commands.begin(), commands.end());
+	uiVertices.insert(uiVertices.end(), vertices.begin(), vertices.end());
+	uiIndices.insert(uiIndices.end(), indices.begin(), indices.end());
+}
+
+// --------------------------------------------------------
+// Sorts the draws by key - the radix sort is stable, so
+// equal keys keep the order they were added in
+// --------------------------------------------------------
+void FramePacket::Finish()
+{
+	sortQueue.Clear();
+	sortQueue.Reserve(addedDraws.size());
+	for (size_t i = 0; i < addedDraws.size(); i++)
+		sortQueue.Add(addedDraws[i].SortKey, (uint32_t)i);
+	sortQueue.Sort();
+
+	draws.clear();
+	draws.reserve(addedDraws.size());
+	for (const RenderQueueEntry& entry : sortQueue.GetEntries())
+		draws.push_back(addedDraws[entry.Payload]);
+
+	finished = true;
+}
+
+bool FramePacket::IsFinished() const { return finished; }
+uint64_t FramePacket::GetFrameNumber() const { return frameNumber; }
+float FramePacket::GetDeltaTime() const { return deltaTime; }
+float FramePacket::GetTotalTime() const { return totalTime; }
+const PacketCamera& FramePacket::GetCamera() const { return camera; }
+std::span<const PacketDraw> FramePacket::GetDraws() const { return draws; }
+std::span<const InstanceData> FramePacket::GetInstances() const { return instances; }
+std::span<const PacketInstanceGroup> FramePacket::GetInstanceGroups() const { return instanceGroups; }
+std::span<const RibbonVertex> FramePacket::GetRibbonVertices() const { return ribbonVertices; }
+std::span<const unsigned int> FramePacket::GetRibbonIndices() const { return ribbonIndices; }
+const PacketUiDisplay& FramePacket::GetUiDisplay() const { return uiDisplay; }
+std::span<const PacketUiList> FramePacket::GetUiLists() const { return uiLists; }
+std::span<const PacketUiCommand> FramePacket::GetUiCommands() const { return uiCommands; }
+std::span<const PacketUiVertex> FramePacket::GetUiVertices() const { return uiVertices; }
+std::span<const uint16_t> FramePacket::GetUiIndices() const { return uiIndices; }
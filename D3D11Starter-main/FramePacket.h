@@ -0,0 +1,170 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "BufferStruct.h"
+#include "InstanceData.h"
+#include "RenderQueue.h"
+#include "RibbonSystem.h"
+
+class Mesh;
+
+// --------------------------------------------------------
+// One opaque draw - its mesh must outlive the packet (see
+// FramePacket::KeepAlive() for meshes that might not)
+// --------------------------------------------------------
+struct PacketDraw
+{
+	uint64_t SortKey;		// A RenderKey
+	Mesh* Geometry;
+	BufferStruct Constants;	// Its world transform and tint
+};
+
+// One instanced draw, a run of the packet's instances
+struct PacketInstanceGroup
+{
+	Mesh* Geometry;
+	unsigned int FirstInstance;
+	unsigned int InstanceCount;
+};
+
+// What the frame is seen from
+struct PacketCamera
+{
+	DirectX::XMFLOAT4X4 View;
+	DirectX::XMFLOAT4X4 Projection;
+	DirectX::XMFLOAT3 EyePosition;	// World space, from the inverse of the view
+	unsigned int ScreenWidth;
+	unsigned int ScreenHeight;
+};
+
+// --------------------------------------------------------
+// The UI, copied out of the UI library's own draw data so
+// the packet doesn't point into anything the game thread
+// rebuilds next frame
+// - Must match ImDrawVert and ImDrawCmd (less callbacks)
+// --------------------------------------------------------
+struct PacketUiVertex
+{
+	DirectX::XMFLOAT2 Position;
+	DirectX::XMFLOAT2 UV;
+	uint32_t Color;			// RGBA8
+};
+
+static_assert(sizeof(PacketUiVertex) == 20, "PacketUiVertex must match ImDrawVert");
+
+struct PacketUiCommand
+{
+	DirectX::XMFLOAT4 ClipRect;	// x1, y1, x2, y2
+	uint64_t Texture;			// An ImTextureID
+	unsigned int FirstIndex;	// Within its list
+	unsigned int FirstVertex;
+	unsigned int ElementCount;
+};
+
+// One window's worth of UI - runs of the packet's UI arrays
+struct PacketUiList
+{
+	unsigned int FirstCommand;
+	unsigned int CommandCount;
+	unsigned int FirstVertex;
+	unsigned int VertexCount;
+	unsigned int FirstIndex;
+	unsigned int IndexCount;
+};
+
+// Where the UI goes on screen
+struct PacketUiDisplay
+{
+	DirectX::XMFLOAT2 Position;
+	DirectX::XMFLOAT2 Size;
+	DirectX::XMFLOAT2 FramebufferScale;
+};
+
+// --------------------------------------------------------
+// Everything the render thread needs to draw one frame,
+// built by the game thread and then left alone
+//
+// The game thread Reset()s a packet, fills it in and calls
+// Finish(), which sorts the draws by key. From then on it's
+// only read - through a const reference, on the render
+// thread - until the game thread Reset()s it again, so
+// nothing in it may point at state the game thread changes
+// in the meantime: draws carry their own constants and the
+// instances, ribbons and UI are copied in.
+//
+// Meshes are plain pointers, so they must live as long as
+// the packet. Meshes whose destruction is deferred (the
+// MeshRegistry's) already do; for any other, KeepAlive()
+// holds a reference until the next Reset().
+//
+// Pure CPU: building, sorting and reading need no device.
+// Vectors are kept between frames to avoid reallocating.
+// --------------------------------------------------------
+class FramePacket
+{
+public:
+	// Basic OOP Setup
+	FramePacket();
+	~FramePacket();
+	FramePacket(const FramePacket&) = delete;
+	FramePacket& operator=(const FramePacket&) = delete;
+
+	// Building - between Reset() and Finish()
+	void Reset(uint64_t frameNumber, float deltaTime, float totalTime);
+	void SetCamera(const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& projection, unsigned int screenWidth, unsigned int screenHeight);
+	void AddDraw(uint64_t sortKey, Mesh* mesh, const BufferStruct& constants);
+	void KeepAlive(std::shared_ptr<Mesh> mesh);
+	void AddInstances(Mesh* mesh, std::span<const InstanceData> instances);
+	void SetRibbons(std::span<const RibbonVertex> vertices, std::span<const unsigned int> indices);
+	void SetUiDisplay(const PacketUiDisplay& display);
+	void AddUiList(std::span<const PacketUiVertex> vertices, std::span<const uint16_t> indices, std::span<const PacketUiCommand> commands);
+	void Finish();
+
+	// Getters - the packet's contents are only complete after Finish()
+	bool IsFinished() const;
+	uint64_t GetFrameNumber() const;
+	float GetDeltaTime() const;
+	float GetTotalTime() const;
+	const PacketCamera& GetCamera() const;
+	std::span<const PacketDraw> GetDraws() const;	// In key order
+	std::span<const InstanceData> GetInstances() const;
+	std::span<const PacketInstanceGroup> GetInstanceGroups() const;
+	std::span<const RibbonVertex> GetRibbonVertices() const;
+	std::span<const unsigned int> GetRibbonIndices() const;
+	const PacketUiDisplay& GetUiDisplay() const;
+	std::span<const PacketUiList> GetUiLists() const;
+	std::span<const PacketUiCommand> GetUiCommands() const;
+	std::span<const PacketUiVertex> GetUiVertices() const;
+	std::span<const uint16_t> GetUiIndices() const;
+
+private:
+	uint64_t frameNumber;
+	float deltaTime;
+	float totalTime;
+	bool finished;
+
+	PacketCamera camera;
+
+	// Draws as they were added, then sorted into draws by Finish()
+	std::vector<PacketDraw> addedDraws;
+	std::vector<PacketDraw> draws;
+	RenderQueue sortQueue;
+	std::vector<std::shared_ptr<Mesh>> keptMeshes;
+
+	std::vector<InstanceData> instances;
+	std::vector<PacketInstanceGroup> instanceGroups;
+
+	std::vector<RibbonVertex> ribbonVertices;
+	std::vector<unsigned int> ribbonIndices;
+
+	PacketUiDisplay uiDisplay;
+	std::vector<PacketUiList> uiLists;
+	std::vector<PacketUiCommand> uiCommands;
+	std::vector<PacketUiVertex> uiVertices;
+	std::vector<uint16_t> uiIndices;
+};
@@ -9,12 +9,43 @@
 #include "Transform.h"
 #include <memory>
 #include "BufferStruct.h"
+#include "PackedVertexLayouts.h"
+#include "StaticBatcher.h"
+#include "InstanceGatherer.h"
+#include "AsyncMeshLoader.h"
+#include "PrimitiveGenerators.h"
+#include "MeshRegistry.h"
+#include "RenderQueue.h"
+#include "D3D11RenderContext.h"
+#include "StateCache.h"
+#include "ConstantBufferRing.h"
+#include "CommandList.h"
+#include "WorkerPool.h"
+#include "ParallelRecorder.h"
+#include "D3D11DeferredExecutor.h"
+#include "RibbonSystem.h"
+#include "RibbonVertexLayout.h"
+#include "FrameGraph.h"
+#include "D3D11FrameGraphTextures.h"
+#include "D3D11Bloom.h"
+#include "D3D11UiRenderer.h"
+#include "LightClusters.h"
+#include "D3D11TimestampSource.h"
+#include "FramePacer.h"
+#include "FrameFence.h"
+#include "GpuProfiler.h"
+#include "FramePacket.h"
+#include "RenderThread.h"
+#include <vector>
+#include <mutex>
+#include <cstring>
 
 #include <DirectXMath.h>
 
 // Needed for a helper function to load pre-compiled shader files
 #pragma comment(lib, "d3dcompiler.lib")
 #include <d3dcompiler.h>
+#include <d3d11_4.h>
 
 // This code assumes files are in "ImGui" subfolder!
 // Adjust as necessary for your own folder structure and project setup
@@ -26,11 +57,125 @@
 using namespace DirectX;
 
 // Meshes
-std::shared_ptr<Mesh> mainTriangle;
-std::shared_ptr<Mesh> rectangle;
-std::shared_ptr<Mesh> polygon;
-
-BufferStruct constBuffer;
+// - The registry owns them, everything else holds MeshIDs
+// - AdvanceFrame() runs once per packet, so a mesh destroyed
+//   while building packet N (maybe after N took its pointer)
+//   is released at the end of packet N + 2. By then
+//   BeginPacket() has waited for the render thread to finish
+//   N, as N + 2 reuses its packet - one more frame than there
+//   are packets. Frames still queued on the GPU don't add to
+//   this: D3D11 holds its own reference to anything bound.
+MeshRegistry meshRegistry(RenderThread::PacketCount + 1);
+
+// Static geometry is merged into one mesh per batch (material + cell)
+std::vector<MeshID> staticBatches;
+
+// A torus stored as PackedLitVertex, drawn with VertexShaderPackedLit
+// - Its positions are in [0, 1] of its bounds, so this goes in
+//   front of its world matrix
+MeshID packedLitTorus;
+XMFLOAT4X4 packedLitDequantization;
+
+// Which vertex shader (and input layout) an opaque draw uses - the
+// shader field of its sort key, so draws come grouped by it
+enum OpaqueShader
+{
+	OpaqueShaderVertexColor,
+	OpaqueShaderPackedLit,
+};
+
+// Meshes drawn with instancing - the ID's value is the mesh id given to the gatherer
+std::vector<MeshID> instancedMeshes;
+InstanceGatherer instanceGatherer;
+
+// Meshes that load in the background - drawn once they're ready
+std::unique_ptr<AsyncMeshLoader> meshLoader;
+std::vector<MeshHandle> streamedMeshes;
+
+// The game thread builds each frame into a packet that the
+// render thread draws while the next one is built
+// - The state cache, recorders, constant ring, profiler and
+//   frame graph below are only used by the render thread;
+//   the ribbons and light clusters only by the game thread
+// - The worker pool is shared, one ParallelFor at a time
+std::unique_ptr<RenderThread> renderThread;
+std::vector<PacketUiCommand> uiCommands;
+
+// Draws the packet's UI - ImGui itself is only ever touched by
+// the game thread, which has moved on to the next frame by then
+std::unique_ptr<D3D11UiRenderer> uiRenderer;
+
+static_assert(sizeof(ImDrawVert) == sizeof(PacketUiVertex), "PacketUiVertex must match ImDrawVert");
+static_assert(sizeof(ImDrawIdx) == sizeof(uint16_t), "The packet's UI indices are 16-bit");
+
+// Every bind and draw goes through the state cache, which
+// drops calls that wouldn't change anything on the device
+std::unique_ptr<D3D11RenderContext> deviceContext;
+std::unique_ptr<StateCache> stateCache;
+
+// The frame's binds and draws are recorded here first, then
+// replayed through the state cache in one go
+// - The sorted draws are split across the worker threads, each
+//   recording its own slice; the rest go in frameCommands
+std::unique_ptr<WorkerPool> workerPool;
+std::unique_ptr<ParallelRecorder> drawRecorder;
+std::unique_ptr<D3D11DeferredExecutor> deferredExecutor;
+CommandList frameCommands;
+
+// The sorted draws again, position stream only, for the depth prepass
+CommandList depthCommands;
+
+// Every draw's constants go into one ring buffer, bound by offset
+std::unique_ptr<ConstantBufferRing> constantRing;
+std::vector<ConstantAllocation> queuedConstants;
+
+// Trails swept out behind a few points circling the screen
+// - Expanded on the CPU every frame into one stream, drawn with one call
+std::unique_ptr<RibbonSystem> ribbons;
+std::vector<unsigned int> ribbonTrails;
+float lastRibbonPointTime = 0.0f;
+
+// Lights, and which of them reach each cluster of the view frustum
+// - Nothing shades with them yet, so only the assignment runs
+std::vector<ClusterLight> sceneLights;
+std::unique_ptr<LightClusters> lightClusters;
+
+// Times each pass on the GPU, a few frames behind
+std::unique_ptr<D3D11TimestampSource> gpuTimestamps;
+std::unique_ptr<GpuProfiler> gpuProfiler;
+
+// The frame's passes, rebuilt every frame - their order comes
+// from the resources each one reads and writes
+// - The bloom's transients are the graph's to place, and the
+//   textures behind them are kept from frame to frame
+FrameGraph frameGraph;
+std::unique_ptr<D3D11FrameGraphTextures> frameGraphTextures;
+std::unique_ptr<D3D11Bloom> bloom;
+
+// What the render thread last drew, for the inspector
+// - Written by the render thread after each frame, read by the game thread
+struct RenderReport
+{
+	StateCacheStats StateStats;
+	unsigned int CommandCount;
+	unsigned int SliceCount;
+	unsigned int FrameCommandCount;
+	float RecordMilliseconds;
+	float SubmitMilliseconds;
+	bool UsedDeferred;
+	unsigned int ConstantRingUsed;
+	unsigned int ConstantRingCapacity;
+	unsigned int ConstantRingMaps;
+	unsigned int ConstantRingDiscards;
+	unsigned int ConstantRingGrows;
+	FrameGraphStats GraphStats;
+	float GraphCompileMilliseconds;
+	float GpuFrameMilliseconds;
+	float GpuAverageFrameMilliseconds;
+	std::vector<GpuProfileResult> GpuResults;
+};
+RenderReport renderReport = {};
+std::mutex renderReportMutex;
 
 // --------------------------------------------------------
 // Called once per program, after the window and graphics API
@@ -41,9 +186,36 @@ void Game::Initialize()
 	// Helper methods for loading shaders, creating some basic
 	// geometry to draw and some simple camera matrices.
 	//  - You'll be expanding and/or replacing these later
+	deviceContext = std::make_unique<D3D11RenderContext>(Graphics::Context);
+	stateCache = std::make_unique<StateCache>(*deviceContext);
+	gpuTimestamps = std::make_unique<D3D11TimestampSource>(Graphics::Context);
+	gpuProfiler = std::make_unique<GpuProfiler>(*gpuTimestamps);
+	frameGraphTextures = std::make_unique<D3D11FrameGraphTextures>();
+	bloom = std::make_unique<D3D11Bloom>(*gpuProfiler);
+	uiRenderer = std::make_unique<D3D11UiRenderer>();
+
+	workerPool = std::make_unique<WorkerPool>();
+	drawRecorder = std::make_unique<ParallelRecorder>(workerPool.get());
+	deferredExecutor = std::make_unique<D3D11DeferredExecutor>(workerPool.get());
+	ribbons = std::make_unique<RibbonSystem>(workerPool.get());
+	lightClusters = std::make_unique<LightClusters>(workerPool.get());
+
 	LoadShaders();
 	CreateGeometry();
 
+	// The depth prepass writes its depths a little further away than
+	// the opaque pass will compute them, so the opaque pass only loses
+	// what's clearly hidden - even where its shaders round differently
+	{
+		D3D11_RASTERIZER_DESC rasterizerDesc = {};
+		rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+		rasterizerDesc.CullMode = D3D11_CULL_BACK;
+		rasterizerDesc.DepthBias = 16;
+		rasterizerDesc.SlopeScaledDepthBias = 1.0f;
+		rasterizerDesc.DepthClipEnable = TRUE;
+		Graphics::Device->CreateRasterizerState(&rasterizerDesc, depthPrepassRasterizerState.GetAddressOf());
+	}
+
 	// Set initial graphics API state
 	//  - These settings persist until we change them
 	//  - Some of these, like the primitive topology & input layout, probably won't change
@@ -77,28 +249,36 @@ void Game::Initialize()
 	//ImGui::StyleColorsClassic();
 
 	// Constant Buffer
-	
-	// Calculate the next multiple of 16 (instead of hardcoding it)
-	unsigned int size = sizeof(BufferStruct);
-	size = (size + 15) / 16 * 16;
-
-	// Describe the constant buffer
-	D3D11_BUFFER_DESC cbDesc = {}; // 
-	cbDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	cbDesc.ByteWidth = size; // Must be a multiple of 16
-	cbDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	cbDesc.Usage = D3D11_USAGE_DYNAMIC;
-
-	Graphics::Device->CreateBuffer(&cbDesc, 0, vsConstantBuffer.GetAddressOf());
-
-	// Bind the Constant Buffer to rendering pipeline
-	Graphics::Context->VSSetConstantBuffers(
-		0, // Which slot (register) to bind the buffer to?
-		1, // How many are we setting right now?
-		vsConstantBuffer.GetAddressOf()); // Array of buffers (or address of just one)
+	// - One large ring that every draw's BufferStruct is appended to,
+	//   each bound to slot 0 at its own offset
+	constantRing = std::make_unique<ConstantBufferRing>();
 
 	camera = std::make_shared<Camera>(
 		XMFLOAT3(0, 0, -5), 5.0f, 0.05f, XM_PIDIV4, Window::AspectRatio());
+
+	// A field of small point and spot lights in front of the camera
+	for (unsigned int i = 0; i < 1000; i++)
+	{
+		ClusterLight light = {};
+		float angle = i * 2.39996f; // Golden angle, spreads them evenly
+		float distance = sqrtf((float)i / 1000.0f) * 20.0f;
+		light.Position = XMFLOAT3(cosf(angle) * distance, (float)(i % 7) - 3.0f, 5.0f + sinf(angle) * distance + 20.0f);
+		light.Range = 1.0f + (float)(i % 5) * 0.5f;
+		light.Color = XMFLOAT3((float)(i % 3 == 0), (float)(i % 3 == 1), (float)(i % 3 == 2));
+		light.Type = (i % 4 == 0) ? LightTypeSpot : LightTypePoint;
+		light.Direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+		light.SpotCosAngle = 0.8f;
+		sceneLights.push_back(light);
+	}
+
+	// Draw on a thread of our own from here on
+	// - The frame fence is still queried from the game thread, so the
+	//   context serializes its calls rather than trusting they don't overlap
+	Microsoft::WRL::ComPtr<ID3D11Multithread> multithread;
+	if (SUCCEEDED(Graphics::Context.As(&multithread)))
+		multithread->SetMultithreadProtected(TRUE);
+	renderThread = std::make_unique<RenderThread>(
+		[this](const FramePacket& packet) { RenderFrame(packet); });
 }
 
 
@@ -110,6 +290,24 @@ void Game::Initialize()
 // --------------------------------------------------------
 Game::~Game()
 {
+	// Stop the render and loader threads before anything they reference goes away
+	renderThread.reset();
+	meshLoader.reset();
+	meshRegistry.Clear();
+	constantRing.reset();
+	ribbons.reset();
+	lightClusters.reset();
+	deferredExecutor.reset();
+	drawRecorder.reset();
+	workerPool.reset();
+	bloom.reset();
+	frameGraphTextures.reset();
+	uiRenderer.reset();
+	gpuProfiler.reset();
+	gpuTimestamps.reset();
+	stateCache.reset();
+	deviceContext.reset();
+
 	// ImGui clean up
 	ImGui_ImplDX11_Shutdown();
 	ImGui_ImplWin32_Shutdown();
@@ -132,6 +330,10 @@ void Game::LoadShaders()
 	// - Literally just a big array of bytes read from a file
 	ID3DBlob* pixelShaderBlob;
 	ID3DBlob* vertexShaderBlob;
+	ID3DBlob* instancedVertexShaderBlob;
+	ID3DBlob* depthVertexShaderBlob;
+	ID3DBlob* ribbonVertexShaderBlob;
+	ID3DBlob* packedLitVertexShaderBlob;
 
 	// Loading shaders
 	//  - Visual Studio will compile our shaders at build time
@@ -144,6 +346,10 @@ void Game::LoadShaders()
 		// - Note the "L" before the string - this tells the compiler the string uses wide characters
 		D3DReadFileToBlob(FixPath(L"PixelShader.cso").c_str(), &pixelShaderBlob);
 		D3DReadFileToBlob(FixPath(L"VertexShader.cso").c_str(), &vertexShaderBlob);
+		D3DReadFileToBlob(FixPath(L"VertexShaderInstanced.cso").c_str(), &instancedVertexShaderBlob);
+		D3DReadFileToBlob(FixPath(L"VertexShaderDepth.cso").c_str(), &depthVertexShaderBlob);
+		D3DReadFileToBlob(FixPath(L"VertexShaderRibbon.cso").c_str(), &ribbonVertexShaderBlob);
+		D3DReadFileToBlob(FixPath(L"VertexShaderPackedLit.cso").c_str(), &packedLitVertexShaderBlob);
 
 		// Create the actual Direct3D shaders on the GPU
 		Graphics::Device->CreatePixelShader(
@@ -157,6 +363,30 @@ void Game::LoadShaders()
 			vertexShaderBlob->GetBufferSize(),		// How big is that data?
 			0,										// No classes in this shader
 			vertexShader.GetAddressOf());			// The address of the ID3D11VertexShader pointer
+
+		Graphics::Device->CreateVertexShader(
+			instancedVertexShaderBlob->GetBufferPointer(),
+			instancedVertexShaderBlob->GetBufferSize(),
+			0,
+			instancedVertexShader.GetAddressOf());
+
+		Graphics::Device->CreateVertexShader(
+			depthVertexShaderBlob->GetBufferPointer(),
+			depthVertexShaderBlob->GetBufferSize(),
+			0,
+			depthVertexShader.GetAddressOf());
+
+		Graphics::Device->CreateVertexShader(
+			ribbonVertexShaderBlob->GetBufferPointer(),
+			ribbonVertexShaderBlob->GetBufferSize(),
+			0,
+			ribbonVertexShader.GetAddressOf());
+
+		Graphics::Device->CreateVertexShader(
+			packedLitVertexShaderBlob->GetBufferPointer(),
+			packedLitVertexShaderBlob->GetBufferSize(),
+			0,
+			packedLitVertexShader.GetAddressOf());
 	}
 
 	// Create an input layout 
@@ -184,6 +414,73 @@ void Game::LoadShaders()
 			vertexShaderBlob->GetBufferPointer(),	// Pointer to the code of a shader that uses this layout
 			vertexShaderBlob->GetBufferSize(),		// Size of the shader code that uses this layout
 			inputLayout.GetAddressOf());			// Address of the resulting ID3D11InputLayout pointer
+
+		// Generate the position-only layout from the same description
+		//  - Meshes keep positions in a separate, tightly packed stream,
+		//    so only POSITION survives, at the start of each element
+		D3D11_INPUT_ELEMENT_DESC positionElements[2] = {};
+		unsigned int positionElementCount = 0;
+		for (const D3D11_INPUT_ELEMENT_DESC& element : inputElements)
+		{
+			if (strcmp(element.SemanticName, "POSITION") != 0)
+				continue;
+
+			positionElements[positionElementCount] = element;
+			positionElements[positionElementCount].AlignedByteOffset = 0;
+			positionElementCount++;
+		}
+
+		Graphics::Device->CreateInputLayout(
+			positionElements,
+			positionElementCount,
+			depthVertexShaderBlob->GetBufferPointer(),
+			depthVertexShaderBlob->GetBufferSize(),
+			positionOnlyInputLayout.GetAddressOf());
+	}
+
+	// Create the input layout for instanced drawing
+	//  - Slot 0 is the regular per-vertex data
+	//  - Slot 1 is an InstanceData per instance: a world matrix
+	//    (one float4 row per WORLD semantic index) and a tint
+	{
+		D3D11_INPUT_ELEMENT_DESC inputElements[7] = {};
+
+		inputElements[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+		inputElements[1] = { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+
+		// Step rate of 1 = advance once per instance instead of once per vertex
+		for (unsigned int row = 0; row < 4; row++)
+			inputElements[2 + row] = { "WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 };
+		inputElements[6] = { "TINT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 };
+
+		Graphics::Device->CreateInputLayout(
+			inputElements,
+			7,
+			instancedVertexShaderBlob->GetBufferPointer(),
+			instancedVertexShaderBlob->GetBufferSize(),
+			instancedInputLayout.GetAddressOf());
+	}
+
+	// Create the input layout for ribbons
+	//  - Expanded on the CPU into RibbonVertex, see RibbonSystem
+	{
+		Graphics::Device->CreateInputLayout(
+			RibbonVertexLayout,
+			ARRAYSIZE(RibbonVertexLayout),
+			ribbonVertexShaderBlob->GetBufferPointer(),
+			ribbonVertexShaderBlob->GetBufferSize(),
+			ribbonInputLayout.GetAddressOf());
+	}
+
+	// Create the input layout for packed lit vertices
+	//  - Normals and tangents stay encoded until the vertex shader
+	{
+		Graphics::Device->CreateInputLayout(
+			VertexPacking::PackedLitVertexLayout,
+			ARRAYSIZE(VertexPacking::PackedLitVertexLayout),
+			packedLitVertexShaderBlob->GetBufferPointer(),
+			packedLitVertexShaderBlob->GetBufferSize(),
+			packedLitInputLayout.GetAddressOf());
 	}
 }
 
@@ -254,12 +551,96 @@ void Game::CreateGeometry()
 	//Indices for the rectangle
 	unsigned int polyIndices[] = { 0, 1, 2, 2, 3, 0, 3, 4, 5, 5, 0, 3 };
 
+	// All three shapes are static and share a material, so merge
+	// them into as few meshes as possible
+	// - Vertices are pre-transformed, so batches draw with an identity world matrix
+	XMFLOAT4X4 identity;
+	XMStoreFloat4x4(&identity, XMMatrixIdentity());
+
+	StaticBatcher batcher(10.0f);
+	batcher.Add(triangleVertices, 3, triangleIndices, 3, identity, 0);
+	batcher.Add(rectangleVertices, 4, rectangleIndices, 6, identity, 0);
+	batcher.Add(polyVertices, 6, polyIndices, 12, identity, 0);
+
 	// Use Mesh class to create meshes
-	// Initialize Meshes
-	mainTriangle = std::make_shared<Mesh>(triangleVertices, 3, triangleIndices, 3);
-	rectangle = std::make_shared<Mesh>(rectangleVertices, 4, rectangleIndices, 6);
-	polygon = std::make_shared<Mesh>(polyVertices, 6, polyIndices, 12);
+	// - All batches share one arena, so drawing them needs a single buffer bind
+	geometryArena = std::make_shared<GeometryArena>(sizeof(Vertex), 65536, 196608);
+	for (StaticBatch& batch : batcher.Build())
+	{
+		staticBatches.push_back(meshRegistry.Create(
+			geometryArena,
+			batch.Vertices.data(), (int)batch.Vertices.size(),
+			batch.Indices.data(), (int)batch.Indices.size()));
+	}
+
+	// A small triangle to draw many copies of with instancing
+	Vertex smallTriangleVertices[] =
+	{
+		{ XMFLOAT3(+0.00f, +0.05f, +0.0f), white },
+		{ XMFLOAT3(+0.05f, -0.05f, +0.0f), white },
+		{ XMFLOAT3(-0.05f, -0.05f, +0.0f), white },
+	};
+	unsigned int smallTriangleIndices[] = { 0, 1, 2 };
+	instancedMeshes.push_back(meshRegistry.Create(geometryArena, smallTriangleVertices, 3, smallTriangleIndices, 3));
+
+	// A lit torus in packed vertices - 24 bytes each instead of 64
+	{
+		const unsigned int majorSegments = 48;
+		const unsigned int minorSegments = 24;
+		PrimitiveSize size = PrimitiveGenerators::TorusSize(majorSegments, minorSegments);
+		std::vector<LitVertex> vertices(size.VertexCount);
+		std::vector<unsigned int> indices(size.IndexCount);
+		PrimitiveGenerators::Torus(vertices, indices, 0.12f, 0.05f, majorSegments, minorSegments);
+		for (LitVertex& v : vertices)
+			v.Color = XMFLOAT4(1.0f, 0.85f, 0.4f, 1.0f);
+
+		std::vector<PackedLitVertex> packed(vertices.size());
+		QuantizationBounds bounds = VertexPacking::PackVertices(vertices.data(), (int)vertices.size(), packed.data());
+		packedLitDequantization = VertexPacking::DequantizationMatrix(bounds);
+		packedLitTorus = meshRegistry.Create(packed.data(), (int)packed.size(), indices.data(), (int)indices.size());
+	}
 
+	// Anything bigger goes through the background loader
+	// - Workers decode, weld and compute bounds, so the upload
+	//   only needs to create the buffers
+	meshLoader = std::make_unique<AsyncMeshLoader>(
+		[](MeshData& data, std::shared_ptr<Mesh>& outMesh)
+		{
+			outMesh = std::make_shared<Mesh>(
+				data.Vertices.data(), (int)data.Vertices.size(),
+				data.Indices.data(), (int)data.Indices.size(),
+				data.Box, data.Sphere);
+			return true;
+		});
+
+	// A finely tessellated sphere in the bottom right corner
+	// - Vertex has no normal, so the generator shades it by normal instead
+	streamedMeshes.push_back(meshLoader->Load("sphere",
+		[](MeshData& out)
+		{
+			const unsigned int segments = 128;
+			const unsigned int rings = 64;
+			PrimitiveSize size = PrimitiveGenerators::SphereSize(segments, rings);
+			out.Vertices.resize(size.VertexCount);
+			out.Indices.resize(size.IndexCount);
+			PrimitiveGenerators::Sphere(out.Vertices, out.Indices, 0.15f, segments, rings);
+
+			// Still in screen space, so move it into place (and in front of the near plane)
+			for (Vertex& v : out.Vertices)
+			{
+				v.Position.x += 0.75f;
+				v.Position.y -= 0.5f;
+				v.Position.z += 0.5f;
+			}
+			return true;
+		}));
+
+
+	// Three trails circling the middle of the screen
+	// - Points are added in Update(), and fade out over a second
+	XMFLOAT4 trailColors[] = { red, green, XMFLOAT4(1.0f, 0.8f, 0.2f, 1.0f) };
+	for (const XMFLOAT4& trailColor : trailColors)
+		ribbonTrails.push_back(ribbons->CreateTrail({ 0.04f, 1.0f, trailColor }));
 }
 
 
@@ -272,6 +653,29 @@ void Game::OnResize()
 	camera->UpdteProjectMatrix(Window::AspectRatio());
 }
 
+
+// --------------------------------------------------------
+// Called before the window's buffers are resized - lets the
+// render thread finish with the old ones first
+// --------------------------------------------------------
+void Game::BeforeResize()
+{
+	if (renderThread)
+		renderThread->WaitForIdle();
+}
+
+// --------------------------------------------------------
+// Hands over the main loop's pacer so the inspector can
+// show its stats and change its mode, and the fence it
+// limits frames in flight with - the render thread signals
+// it once each frame is presented
+// --------------------------------------------------------
+void Game::SetFramePacer(FramePacer* pacer, FrameFence* fence)
+{
+	framePacer = pacer;
+	frameFence = fence;
+}
+
 // --------------------------------------------------------
 // Variables. I know they shouldn't go here but I need to
 // keep track of them and for now this is fine
@@ -315,6 +719,60 @@ void Game::Update(float deltaTime, float totalTime)
 	// Color picker
 	ImGui::ColorEdit4("Background Color", &color.x);
 
+	// Background loading
+	MeshLoadStats loadStats = meshLoader->GetStats();
+	ImGui::Text("Meshes loading: %u (%u loaded, %u failed)", meshLoader->GetPendingCount(), loadStats.Uploaded, loadStats.Failed);
+	ImGui::Text("Mesh upload time: %.3f ms (worst %.3f ms)", loadStats.LastUploadMilliseconds, loadStats.MaxUploadMilliseconds);
+
+	// The render thread's last frame, and how the two threads are keeping up
+	RenderReport report;
+	{
+		std::lock_guard<std::mutex> lock(renderReportMutex);
+		report = renderReport;
+	}
+	RenderThreadStats threadStats = renderThread->GetStats();
+	ImGui::Text("Render thread: %.3f ms drawing, %.3f ms idle, game thread waited %.3f ms",
+		threadStats.RenderMilliseconds, threadStats.RenderWaitMilliseconds, threadStats.GameWaitMilliseconds);
+
+	// Redundant binds skipped last frame
+	ImGui::Text("State calls: %u submitted, %u filtered", report.StateStats.Submitted, report.StateStats.Filtered);
+	ImGui::Text("Commands: %u in %u slices, %u after", report.CommandCount, report.SliceCount, report.FrameCommandCount);
+	ImGui::Text("Record: %.3f ms, submit: %.3f ms%s",
+		report.RecordMilliseconds, report.SubmitMilliseconds, report.UsedDeferred ? " (deferred contexts)" : "");
+	ImGui::Text("Constant ring: %u / %u bytes, %u maps last frame, %u discards, %u grows",
+		report.ConstantRingUsed, report.ConstantRingCapacity, report.ConstantRingMaps, report.ConstantRingDiscards, report.ConstantRingGrows);
+	ImGui::Text("Frame graph: %u passes (%u culled), %u transient textures in %u, compiled in %.3f ms",
+		report.GraphStats.PassCount, report.GraphStats.CulledPassCount, report.GraphStats.TransientCount,
+		report.GraphStats.PhysicalTextureCount, report.GraphCompileMilliseconds);
+	ImGui::Text("Light clusters: %u lights, %u indices (at most %u per cluster), built in %.3f ms",
+		(unsigned int)sceneLights.size(), (unsigned int)lightClusters->GetLightIndices().size(),
+		lightClusters->GetMaxLightsPerCluster(), lightClusters->GetBuildMilliseconds());
+	ImGui::Text("Ribbons: %u trails, %u vertices, expanded in %.3f ms",
+		ribbons->GetTrailCount(), (unsigned int)ribbons->GetVertices().size(), ribbons->GetExpandMilliseconds());
+
+	// GPU time per pass, from the newest frame the GPU has finished
+	ImGui::Text("GPU frame: %.3f ms (average %.3f ms)", report.GpuFrameMilliseconds, report.GpuAverageFrameMilliseconds);
+	for (const GpuProfileResult& result : report.GpuResults)
+		ImGui::Text("%*s%s: %.3f ms (average %.3f ms)", 2 + result.Depth * 2, "", result.Name, result.Milliseconds, result.AverageMilliseconds);
+
+	// Frame pacing, and how steady it's keeping the frames
+	if (framePacer)
+	{
+		const char* pacingModes[] = { "Unlimited", "Target FPS", "Adaptive" };
+		int pacingMode = (int)framePacer->GetMode();
+		if (ImGui::Combo("Frame pacing", &pacingMode, pacingModes, IM_ARRAYSIZE(pacingModes)))
+			framePacer->SetMode((FramePacingMode)pacingMode);
+		float targetFps = framePacer->GetTargetFps();
+		if (ImGui::SliderFloat("Target FPS", &targetFps, 15.0f, 240.0f, "%.0f"))
+			framePacer->SetTargetFps(targetFps);
+
+		FramePacerStats pacing = framePacer->GetStats();
+		ImGui::Text("Frame: %.3f ms (target %.3f ms), %.3f to %.3f ms, jitter %.3f ms",
+			pacing.AverageMilliseconds, pacing.TargetMilliseconds, pacing.MinMilliseconds, pacing.MaxMilliseconds, pacing.JitterMilliseconds);
+		ImGui::Text("Work: %.3f ms, waiting: %.3f ms, off deadline by %.3f ms, %u missed",
+			pacing.AverageWorkMilliseconds, pacing.AverageWaitMilliseconds, pacing.DeadlineErrorMilliseconds, pacing.MissedDeadlines);
+	}
+
 	// Create a button and test for a click
 	if (ImGui::Button("Press to hide/show"))
 	{
@@ -329,6 +787,22 @@ void Game::Update(float deltaTime, float totalTime)
 		ImGui::ShowDemoWindow();
 	}
 
+	// Upload whatever finished loading, within this frame's budget
+	meshLoader->Update();
+
+	// Move the trails on, spacing their points so a full ring
+	// spans the trail's lifetime whatever the framerate
+	if (totalTime - lastRibbonPointTime >= 1.0f / RibbonSystem::PointsPerTrail)
+	{
+		lastRibbonPointTime = totalTime;
+		for (unsigned int i = 0; i < ribbonTrails.size(); i++)
+		{
+			float angle = totalTime * (1.5f + i * 0.5f) + i * XM_2PI / 3.0f;
+			XMFLOAT3 head(cosf(angle) * 0.4f, sinf(angle * 2.0f) * 0.25f, 0.25f);
+			ribbons->AddPoint(ribbonTrails[i], head, totalTime);
+		}
+	}
+
 	// Example input checking: Quit if the escape key is pressed
 	if (Input::KeyDown(VK_ESCAPE))
 		Window::Quit();
@@ -336,48 +810,369 @@ void Game::Update(float deltaTime, float totalTime)
 
 
 // --------------------------------------------------------
-// Clear the screen, redraw everything, present to the user
+// Build this frame into a packet and hand it to the render
+// thread - everything it draws is copied in here, so the
+// next Update() can carry on while it's drawn
 // --------------------------------------------------------
 void Game::Draw(float deltaTime, float totalTime)
 {
-	// Frame START
-	// - These things should happen ONCE PER FRAME
-	// - At the beginning of Game::Draw() before drawing *anything*
-	{
-		// Clear the back buffer (erase what's on screen) and depth buffer
-		const float color[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
-		Graphics::Context->ClearRenderTargetView(Graphics::BackBufferRTV.Get(),	color);
-		Graphics::Context->ClearDepthStencilView(Graphics::DepthBufferDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
-	}
+	// Numbered like the pacer's frames, so the fence it waits on matches
+	uint64_t frameNumber = framePacer ? framePacer->GetFrameNumber() : renderThread->GetStats().PacketsSubmitted + 1;
+	FramePacket& packet = renderThread->BeginPacket(frameNumber, deltaTime, totalTime);
+
+	XMFLOAT4X4 view = camera->GetView();
+	XMFLOAT4X4 projection = camera->GetProjection();
+	packet.SetCamera(view, projection, Window::Width(), Window::Height());
+
+	// Queue up the opaque meshes, sorted by key when the packet's finished
+	// - Everything shares one shader and material for now, so the
+	//   key groups draws by mesh and then sorts them front to back
+	// - Depth is the bounding sphere's center taken into view space,
+	//   quantized linearly between the camera's near and far planes
+	XMMATRIX viewMatrix = XMLoadFloat4x4(&view);
+	float nearClip = camera->GetNearClip();
+	float farClip = camera->GetFarClip();
+	auto viewDepth = [&](Mesh* mesh, XMMATRIX world)
+		{
+			XMVECTOR center = XMLoadFloat3(&mesh->GetBoundingSphere().Center);
+			float z = XMVectorGetZ(XMVector3TransformCoord(center, world * viewMatrix));
+			return RenderKey::QuantizeDepth(z, nearClip, farClip);
+		};
 
-	// Constant Buffer Business
 	BufferStruct vsData;
 	vsData.colorTint = XMFLOAT4(1.0f, 0.5f, 0.5f, 1.0f);
-	vsData.offset = XMFLOAT3(0.25f, 0.0f, 0.0f);
+	XMStoreFloat4x4(&vsData.world, XMMatrixIdentity()); // Static batches are already in world space
+	auto queue = [&](Mesh* mesh, unsigned int meshKey)
+		{
+			uint32_t depth = viewDepth(mesh, XMMatrixIdentity());
+			packet.AddDraw(RenderKey::Opaque(0, OpaqueShaderVertexColor, 0, meshKey, depth), mesh, vsData);
+		};
 
-	// Mapping and unmapping the buffer
-	D3D11_MAPPED_SUBRESOURCE mappedBuffer = {};
-	Graphics::Context->Map(vsConstantBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer);
-	memcpy(mappedBuffer.pData, &vsData, sizeof(vsData));
-	Graphics::Context->Unmap(vsConstantBuffer.Get(), 0);
+	for (MeshID batch : staticBatches)
+		queue(meshRegistry.Get(batch), batch.Index());
 
-	// Draw triangle mesh
-	mainTriangle->Draw();
-	
-	ImGui::Render(); // Turns this frames UI into renderable triangles
-	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData()); // Draws it to the screen
+	// The packed torus, tumbling so its lighting moves
+	{
+		BufferStruct torusData;
+		torusData.colorTint = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+		XMMATRIX world =
+			XMMatrixRotationRollPitchYaw(totalTime * 0.7f, totalTime, 0.0f) *
+			XMMatrixTranslation(-0.6f, -0.45f, 0.5f);
+		XMMATRIX dequantizedWorld = XMLoadFloat4x4(&packedLitDequantization) * world;
+		XMStoreFloat4x4(&torusData.world, dequantizedWorld);
+
+		// Its bounds are in the packed [0, 1] space, like its positions
+		Mesh* torus = meshRegistry.Get(packedLitTorus);
+		uint32_t depth = viewDepth(torus, dequantizedWorld);
+		packet.AddDraw(RenderKey::Opaque(0, OpaqueShaderPackedLit, 0, packedLitTorus.Index(), depth), torus, torusData);
+	}
 
-	// DRAW Rectangle mesh
-	rectangle->Draw();
+	// Streamed meshes only once they've finished loading
+	// - They aren't in the registry, so their keys count down from the top,
+	//   and the packet keeps them alive until it's drawn
+	for (unsigned int i = 0; i < streamedMeshes.size(); i++)
+	{
+		if (std::shared_ptr<Mesh> mesh = streamedMeshes[i].GetMesh())
+		{
+			queue(mesh.get(), (1u << RenderKey::MeshBits) - 1 - i);
+			packet.KeepAlive(mesh);
+		}
+	}
 
-	ImGui::Render(); // Turns this frames UI into renderable triangles
-	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData()); // Draws it to the screen
+	// Gather a row of instances along the bottom of the screen
+	// - They're already in clip space, so there's nothing to cull yet
+	instanceGatherer.BeginWithoutCulling();
+	for (int i = 0; i < 20; i++)
+	{
+		InstanceData instance = {};
+		XMStoreFloat4x4(&instance.World, XMMatrixTranslation(-0.95f + i * 0.1f, -0.85f, 0.0f));
+		instance.Tint = XMFLOAT4((float)i / 19.0f, 1.0f - (float)i / 19.0f, 1.0f, 1.0f);
+		instanceGatherer.Add(instancedMeshes[0].Value, instance);
+	}
+	instanceGatherer.Finish();
+
+	const std::vector<InstanceData>& instances = instanceGatherer.GetInstances();
+	for (const InstanceGroup& group : instanceGatherer.GetGroups())
+	{
+		packet.AddInstances(
+			meshRegistry.Get(MeshID{ group.MeshID }),
+			std::span<const InstanceData>(&instances[group.FirstInstance], group.InstanceCount));
+	}
+
+	// Turn the trails into strips facing the camera
+	ribbons->Expand(packet.GetCamera().EyePosition, totalTime);
+	packet.SetRibbons(ribbons->GetVertices(), ribbons->GetIndices());
 
-	// DRAW Polygon mesh
-	polygon->Draw();
+	// Bin the lights into the view's clusters
+	lightClusters->Build(sceneLights, view, projection, Window::Width(), Window::Height());
 
+	// Finish the UI and copy its triangles out, as ImGui reuses its
+	// draw lists next frame
 	ImGui::Render(); // Turns this frames UI into renderable triangles
-	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData()); // Draws it to the screen
+	ImDrawData* drawData = ImGui::GetDrawData();
+	packet.SetUiDisplay({
+		XMFLOAT2(drawData->DisplayPos.x, drawData->DisplayPos.y),
+		XMFLOAT2(drawData->DisplaySize.x, drawData->DisplaySize.y),
+		XMFLOAT2(drawData->FramebufferScale.x, drawData->FramebufferScale.y) });
+	for (ImDrawList* list : drawData->CmdLists)
+	{
+		uiCommands.clear();
+		for (const ImDrawCmd& command : list->CmdBuffer)
+		{
+			// Callbacks can't be carried over to another thread (and nothing adds any)
+			if (command.UserCallback)
+				continue;
+
+			PacketUiCommand copy = {};
+			copy.ClipRect = XMFLOAT4(command.ClipRect.x, command.ClipRect.y, command.ClipRect.z, command.ClipRect.w);
+			copy.Texture = (uint64_t)command.GetTexID();
+			copy.FirstIndex = command.IdxOffset;
+			copy.FirstVertex = command.VtxOffset;
+			copy.ElementCount = command.ElemCount;
+			uiCommands.push_back(copy);
+		}
+
+		packet.AddUiList(
+			std::span<const PacketUiVertex>((const PacketUiVertex*)list->VtxBuffer.Data, list->VtxBuffer.Size),
+			std::span<const uint16_t>(list->IdxBuffer.Data, list->IdxBuffer.Size),
+			uiCommands);
+	}
+
+	// Meshes destroyed a few frames ago are no longer in use
+	// - Counted in packets, so the registry is only touched by this thread
+	meshRegistry.AdvanceFrame();
+
+	renderThread->SubmitPacket();
+}
+
+
+// --------------------------------------------------------
+// Clear the screen, redraw everything, present to the user
+// - On the render thread, from nothing but the packet
+// --------------------------------------------------------
+void Game::RenderFrame(const FramePacket& packet)
+{
+	// Everything from here to Present() counts towards the GPU frame
+	gpuProfiler->BeginFrame();
+
+	// Every draw's constants, written in draw order with a single map
+	// - The last two blocks are for the instanced draws and the ribbons
+	// - None of them are drawn with until the graph runs, so if the ring
+	//   fills up part way it can't discard - instead the frame starts over
+	//   in fresh (or bigger) memory and they're all written again
+	std::span<const PacketDraw> draws = packet.GetDraws();
+	BufferStruct instancedData;
+	instancedData.colorTint = XMFLOAT4(1.0f, 0.5f, 0.5f, 1.0f);
+	XMStoreFloat4x4(&instancedData.world, XMMatrixIdentity());
+	BufferStruct ribbonData = instancedData;
+	ribbonData.colorTint = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+
+	ConstantAllocation instancedConstants;
+	ConstantAllocation ribbonConstants;
+	while (true)
+	{
+		queuedConstants.clear();
+		constantRing->BeginWrite();
+		for (const PacketDraw& draw : draws)
+			queuedConstants.push_back(constantRing->Allocate(draw.Constants));
+		instancedConstants = constantRing->Allocate(instancedData);
+		ribbonConstants = constantRing->Allocate(ribbonData);
+		if (constantRing->EndWrite())
+			break;
+		constantRing->RestartFrame();
+	}
+
+	// Record the sorted draws, a slice per thread
+	// - Nothing reaches the device until they're executed
+	// - Every slice binds its own shaders, since it can't know what the one before left bound
+	// - Draws come grouped by shader, so switching on it is rare
+	drawRecorder->Record((unsigned int)draws.size(),
+		[&](CommandList& list, unsigned int begin, unsigned int end)
+		{
+			list.SetPixelShader(pixelShader.Get());
+			unsigned int boundShader = ~0u;
+			for (unsigned int i = begin; i < end; i++)
+			{
+				unsigned int shader = RenderKey::GetOpaqueShader(draws[i].SortKey);
+				if (shader != boundShader)
+				{
+					bool packedLit = shader == OpaqueShaderPackedLit;
+					list.SetInputLayout(packedLit ? packedLitInputLayout.Get() : inputLayout.Get());
+					list.SetVertexShader(packedLit ? packedLitVertexShader.Get() : vertexShader.Get());
+					boundShader = shader;
+				}
+
+				const ConstantAllocation& constants = queuedConstants[i];
+				list.SetVSConstantBufferRange(0, constants.Buffer, constants.FirstConstant, constants.ConstantCount);
+				draws[i].Geometry->Draw(list);
+			}
+		});
+
+	// The same draws with only positions and no pixel shader
+	// - 12 bytes fetched per vertex instead of the whole vertex
+	depthCommands.Reset();
+	depthCommands.SetInputLayout(positionOnlyInputLayout.Get());
+	depthCommands.SetVertexShader(depthVertexShader.Get());
+	depthCommands.SetPixelShader(0);
+	for (unsigned int i = 0; i < draws.size(); i++)
+	{
+		const ConstantAllocation& constants = queuedConstants[i];
+		depthCommands.SetVSConstantBufferRange(0, constants.Buffer, constants.FirstConstant, constants.ConstantCount);
+		draws[i].Geometry->DrawPositionOnly(depthCommands);
+	}
+
+	// One instanced draw per mesh
+	frameCommands.Reset();
+	frameCommands.SetInputLayout(instancedInputLayout.Get());
+	frameCommands.SetPixelShader(pixelShader.Get());
+	frameCommands.SetVertexShader(instancedVertexShader.Get());
+	frameCommands.SetVSConstantBufferRange(0, instancedConstants.Buffer, instancedConstants.FirstConstant, instancedConstants.ConstantCount);
+	std::span<const InstanceData> instances = packet.GetInstances();
+	Mesh::ReserveInstances((unsigned int)instances.size());
+	for (const PacketInstanceGroup& group : packet.GetInstanceGroups())
+		group.Geometry->DrawInstanced(frameCommands, instances.subspan(group.FirstInstance, group.InstanceCount));
+
+	// Every trail in one draw, after growing the buffers to fit
+	std::span<const RibbonVertex> ribbonVertices = packet.GetRibbonVertices();
+	std::span<const unsigned int> ribbonIndices = packet.GetRibbonIndices();
+	if (!ribbonIndices.empty())
+	{
+		if (ribbonVertices.size() > ribbonVertexCapacity)
+		{
+			ribbonVertexCapacity = (unsigned int)ribbonVertices.size() * 2;
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.Usage = D3D11_USAGE_DYNAMIC;
+			desc.ByteWidth = sizeof(RibbonVertex) * ribbonVertexCapacity;
+			desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+			ribbonVertexBuffer.Reset();
+			Graphics::Device->CreateBuffer(&desc, 0, ribbonVertexBuffer.GetAddressOf());
+		}
+
+		if (ribbonIndices.size() > ribbonIndexCapacity)
+		{
+			ribbonIndexCapacity = (unsigned int)ribbonIndices.size() * 2;
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.Usage = D3D11_USAGE_DYNAMIC;
+			desc.ByteWidth = sizeof(unsigned int) * ribbonIndexCapacity;
+			desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+			ribbonIndexBuffer.Reset();
+			Graphics::Device->CreateBuffer(&desc, 0, ribbonIndexBuffer.GetAddressOf());
+		}
+
+		frameCommands.UploadBuffer(ribbonVertexBuffer.Get(), ribbonVertices.data(), (unsigned int)ribbonVertices.size_bytes());
+		frameCommands.UploadBuffer(ribbonIndexBuffer.Get(), ribbonIndices.data(), (unsigned int)ribbonIndices.size_bytes());
+		frameCommands.SetInputLayout(ribbonInputLayout.Get());
+		frameCommands.SetVertexShader(ribbonVertexShader.Get());
+		frameCommands.SetVSConstantBufferRange(0, ribbonConstants.Buffer, ribbonConstants.FirstConstant, ribbonConstants.ConstantCount);
+		frameCommands.SetVertexBuffer(0, ribbonVertexBuffer.Get(), sizeof(RibbonVertex), 0);
+		frameCommands.SetIndexBuffer(ribbonIndexBuffer.Get());
+		frameCommands.DrawIndexed((unsigned int)ribbonIndices.size(), 0, 0);
+	}
+
+	frameCommands.SetInputLayout(inputLayout.Get());
+	frameCommands.SetVertexShader(vertexShader.Get());
+
+	// Build the frame's passes - nothing above has touched the device
+	// - The back and depth buffers are owned by Graphics, the
+	//   bloom's textures by the graph
+	frameGraph.Reset();
+	const PacketCamera& frameCamera = packet.GetCamera();
+	FrameGraphTextureDesc backBufferDesc = { frameCamera.ScreenWidth, frameCamera.ScreenHeight, DXGI_FORMAT_R8G8B8A8_UNORM, 4 };
+	FrameGraphTextureDesc depthBufferDesc = { frameCamera.ScreenWidth, frameCamera.ScreenHeight, DXGI_FORMAT_D24_UNORM_S8_UINT, 4 };
+	unsigned int backBuffer = frameGraph.ImportTexture("Back buffer", backBufferDesc);
+	unsigned int depthBuffer = frameGraph.ImportTexture("Depth buffer", depthBufferDesc);
+
+	// Clear the back buffer (erase what's on screen) and depth buffer
+	unsigned int clearPass = frameGraph.AddPass("Clear",
+		[&]()
+		{
+			GpuProfileScope scope(*gpuProfiler, "Clear");
+			const float color[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
+			Graphics::Context->ClearRenderTargetView(Graphics::BackBufferRTV.Get(),	color);
+			Graphics::Context->ClearDepthStencilView(Graphics::DepthBufferDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+		});
+	frameGraph.Write(clearPass, backBuffer);
+	frameGraph.Write(clearPass, depthBuffer);
+
+	// Depth first, so the opaque pass only shades visible pixels
+	unsigned int depthPass = frameGraph.AddPass("Depth prepass",
+		[&]()
+		{
+			GpuProfileScope scope(*gpuProfiler, "Depth prepass");
+
+			// The UI (and anything else) may have changed the pipeline
+			// since last frame, so the cache can't trust what it knows
+			stateCache->Invalidate();
+			stateCache->ResetStats();
+
+			Graphics::Context->RSSetState(depthPrepassRasterizerState.Get());
+			depthCommands.Execute(*stateCache);
+			Graphics::Context->RSSetState(0);
+		});
+	frameGraph.Read(depthPass, depthBuffer);
+	frameGraph.Write(depthPass, depthBuffer);
+
+	// The sorted draws
+	unsigned int opaquePass = frameGraph.AddPass("Opaque",
+		[&]()
+		{
+			GpuProfileScope scope(*gpuProfiler, "Opaque");
+
+			// Slices go to deferred contexts when the driver builds command lists
+			// itself, otherwise they're replayed in order on this thread
+			if (deferredExecutor->IsSupported() && drawRecorder->GetSliceCount() > 1)
+			{
+				deferredExecutor->Execute(*drawRecorder);
+				stateCache->Invalidate();
+			}
+			else
+			{
+				drawRecorder->Execute(*stateCache);
+			}
+		});
+	frameGraph.Read(opaquePass, backBuffer);
+	frameGraph.Write(opaquePass, backBuffer);
+	frameGraph.Read(opaquePass, depthBuffer);
+	frameGraph.Write(opaquePass, depthBuffer);
+
+	// The instanced draws and ribbons
+	unsigned int instancePass = frameGraph.AddPass("Instances and ribbons",
+		[&]()
+		{
+			GpuProfileScope scope(*gpuProfiler, "Instances and ribbons");
+			frameCommands.Execute(*stateCache);
+		});
+	frameGraph.Read(instancePass, backBuffer);
+	frameGraph.Write(instancePass, backBuffer);
+	frameGraph.Read(instancePass, depthBuffer);
+	frameGraph.Write(instancePass, depthBuffer);
+
+	// Glow around the brightest parts of the scene, but not the UI
+	bloom->AddPasses(frameGraph, *frameGraphTextures, backBuffer, backBufferDesc,
+		Graphics::BackBufferRTV.Get(), Graphics::DepthBufferDSV.Get());
+
+	// Draw the UI once, after every mesh
+	// - Straight from the packet, without the UI library
+	unsigned int uiPass = frameGraph.AddPass("UI",
+		[&]()
+		{
+			GpuProfileScope scope(*gpuProfiler, "UI");
+			uiRenderer->Draw(packet);
+		});
+	frameGraph.Read(uiPass, backBuffer);
+	frameGraph.Write(uiPass, backBuffer);
+
+	if (frameGraph.Compile())
+	{
+		frameGraphTextures->Realize(frameGraph);
+		frameGraph.Execute();
+	}
 
 	// Frame END
 	// - These should happen exactly ONCE PER FRAME
@@ -385,17 +1180,46 @@ void Game::Draw(float deltaTime, float totalTime)
 	{
 		// Present at the end of the frame
 		bool vsync = Graphics::VsyncState();
-		Graphics::SwapChain->Present(
-			vsync ? 1 : 0,
-			vsync ? 0 : DXGI_PRESENT_ALLOW_TEARING);
+		{
+			GpuProfileScope scope(*gpuProfiler, "Present");
+			Graphics::SwapChain->Present(
+				vsync ? 1 : 0,
+				vsync ? 0 : DXGI_PRESENT_ALLOW_TEARING);
+		}
+		gpuProfiler->EndFrame();
+
+		// The frame's last GPU work is in, so the pacer can count it as in flight
+		if (frameFence)
+			frameFence->Signal(packet.GetFrameNumber());
 
 		// Re-bind back buffer and depth buffer after presenting
 		Graphics::Context->OMSetRenderTargets(
 			1,
 			Graphics::BackBufferRTV.GetAddressOf(),
 			Graphics::DepthBufferDSV.Get());
-	}
-}
-
 
+		// Fence this frame's constants, so their space comes back once the GPU is done
+		constantRing->EndFrame();
+	}
 
+	// Report back to the inspector
+	std::lock_guard<std::mutex> lock(renderReportMutex);
+	bool usedDeferred = deferredExecutor->IsSupported() && drawRecorder->GetSliceCount() > 1;
+	renderReport.StateStats = stateCache->GetStats();
+	renderReport.CommandCount = drawRecorder->GetCommandCount();
+	renderReport.SliceCount = drawRecorder->GetSliceCount();
+	renderReport.FrameCommandCount = frameCommands.GetCommandCount();
+	renderReport.RecordMilliseconds = drawRecorder->GetRecordMilliseconds();
+	renderReport.SubmitMilliseconds = usedDeferred ? deferredExecutor->GetExecuteMilliseconds() : drawRecorder->GetExecuteMilliseconds();
+	renderReport.UsedDeferred = usedDeferred;
+	renderReport.ConstantRingUsed = constantRing->GetUsedSpace();
+	renderReport.ConstantRingCapacity = constantRing->GetCapacity();
+	renderReport.ConstantRingMaps = constantRing->GetLastFrameMapCount();
+	renderReport.ConstantRingDiscards = constantRing->GetDiscardCount();
+	renderReport.ConstantRingGrows = constantRing->GetGrowCount();
+	renderReport.GraphStats = frameGraph.GetStats();
+	renderReport.GraphCompileMilliseconds = frameGraph.GetCompileMilliseconds();
+	renderReport.GpuFrameMilliseconds = gpuProfiler->GetFrameMilliseconds();
+	renderReport.GpuAverageFrameMilliseconds = gpuProfiler->GetAverageFrameMilliseconds();
+	renderReport.GpuResults = gpuProfiler->GetResults();
+}
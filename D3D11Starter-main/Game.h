@@ -2,6 +2,13 @@
 
 #include <d3d11.h>
 #include <wrl/client.h>
+#include <memory>
+
+#include "GeometryArena.h"
+
+class FrameFence;
+class FramePacer;
+class FramePacket;
 
 class Game
 {
@@ -16,14 +23,22 @@ public:
 	void Initialize();
 	void Update(float deltaTime, float totalTime);
 	void Draw(float deltaTime, float totalTime);
+	void BeforeResize();
 	void OnResize();
 
+	// The loop's pacer, for the inspector to show and adjust, and the
+	// fence it counts frames in flight with
+	void SetFramePacer(FramePacer* pacer, FrameFence* fence);
+
 private:
 
 	// Initialization helper methods - feel free to customize, combine, remove, etc.
 	void LoadShaders();
 	void CreateGeometry();
 
+	// Draws a frame Draw() built - on the render thread
+	void RenderFrame(const FramePacket& packet);
+
 	// Note the usage of ComPtr below
 	//  - This is a smart pointer for objects that abide by the
 	//     Component Object Model, which DirectX objects do
@@ -32,7 +47,19 @@ private:
 	// Buffers to hold actual geometry data
 	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11Buffer> vsConstantBuffer;
+
+	// Shared vertex/index buffers that meshes are sub-allocated from
+	std::shared_ptr<GeometryArena> geometryArena;
+
+	// Dynamic buffers the ribbons are re-uploaded to every frame
+	Microsoft::WRL::ComPtr<ID3D11Buffer> ribbonVertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> ribbonIndexBuffer;
+	unsigned int ribbonVertexCapacity = 0;
+	unsigned int ribbonIndexCapacity = 0;
+
+	// Owned by the main loop
+	FramePacer* framePacer = nullptr;
+	FrameFence* frameFence = nullptr;
 
 	// Camera for the 3D scene
 	std::shared_ptr<Camera> camera;
@@ -40,6 +67,18 @@ private:
 	// Shaders and shader-related constructs
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader;
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> vertexShader;
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> instancedVertexShader;
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> depthVertexShader;
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> ribbonVertexShader;
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> packedLitVertexShader;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> instancedInputLayout;
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> positionOnlyInputLayout;
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> ribbonInputLayout;
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> packedLitInputLayout;
+
+	// Pushes the depth prepass slightly back, so the opaque pass
+	// can keep its usual LESS test against the prepass's depths
+	Microsoft::WRL::ComPtr<ID3D11RasterizerState> depthPrepassRasterizerState;
 };
 
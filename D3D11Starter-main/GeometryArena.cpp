@@ -0,0 +1,129 @@
+#include "GeometryArena.h"
+#include "Graphics.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// --------------------------------------------------------
+// Creates both buffers up front with DEFAULT usage, so
+// meshes can be copied in (and freed) at any time
+// --------------------------------------------------------
+GeometryArena::GeometryArena(unsigned int vertexStride, unsigned int maxVertices, unsigned int maxIndices) :
+	vertexStride(vertexStride),
+	vertexAllocator(maxVertices),
+	indexAllocator(maxIndices)
+{
+	D3D11_BUFFER_DESC vbd = {};
+	vbd.Usage = D3D11_USAGE_DEFAULT;
+	vbd.ByteWidth = vertexStride * maxVertices;
+	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	Graphics::Device->CreateBuffer(&vbd, 0, vertexBuffer.GetAddressOf());
+
+	D3D11_BUFFER_DESC pbd = vbd;
+	pbd.ByteWidth = sizeof(DirectX::XMFLOAT3) * maxVertices;
+	Graphics::Device->CreateBuffer(&pbd, 0, positionBuffer.GetAddressOf());
+
+	D3D11_BUFFER_DESC ibd = {};
+	ibd.Usage = D3D11_USAGE_DEFAULT;
+	ibd.ByteWidth = sizeof(unsigned int) * maxIndices;
+	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	Graphics::Device->CreateBuffer(&ibd, 0, indexBuffer.GetAddressOf());
+}
+
+GeometryArena::~GeometryArena()
+{
+}
+
+// --------------------------------------------------------
+// Reserves space for a mesh and uploads its data into
+// that part of the shared buffers
+//  - Empty meshes get an invalid range, as there's nothing
+//    to copy in
+// --------------------------------------------------------
+GeometryRange GeometryArena::Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	GeometryRange range = {};
+	if (vertexCount == 0 || indexCount == 0)
+	{
+		range.BaseVertex = RangeAllocator::InvalidOffset;
+		range.StartIndex = RangeAllocator::InvalidOffset;
+		return range;
+	}
+
+	range.BaseVertex = vertexAllocator.Allocate(vertexCount);
+	range.StartIndex = indexAllocator.Allocate(indexCount);
+	range.VertexCount = vertexCount;
+	range.IndexCount = indexCount;
+
+	// Both or nothing
+	if (range.BaseVertex == RangeAllocator::InvalidOffset || range.StartIndex == RangeAllocator::InvalidOffset)
+	{
+		vertexAllocator.Free(range.BaseVertex, vertexCount);
+		indexAllocator.Free(range.StartIndex, indexCount);
+		range.BaseVertex = RangeAllocator::InvalidOffset;
+		range.StartIndex = RangeAllocator::InvalidOffset;
+		return range;
+	}
+
+	// Copy into just the allocated regions
+	D3D11_BOX vertexBox = {};
+	vertexBox.left = range.BaseVertex * vertexStride;
+	vertexBox.right = vertexBox.left + vertexCount * vertexStride;
+	vertexBox.bottom = 1;
+	vertexBox.back = 1;
+	Graphics::Context->UpdateSubresource(vertexBuffer.Get(), 0, &vertexBox, vertices, 0, 0);
+
+	// Positions are the first member of every vertex
+	std::vector<DirectX::XMFLOAT3> positions(vertexCount);
+	const unsigned char* vertexBytes = (const unsigned char*)vertices;
+	for (unsigned int i = 0; i < vertexCount; i++)
+		positions[i] = *(const DirectX::XMFLOAT3*)(vertexBytes + i * vertexStride);
+
+	D3D11_BOX positionBox = {};
+	positionBox.left = range.BaseVertex * sizeof(DirectX::XMFLOAT3);
+	positionBox.right = positionBox.left + vertexCount * sizeof(DirectX::XMFLOAT3);
+	positionBox.bottom = 1;
+	positionBox.back = 1;
+	Graphics::Context->UpdateSubresource(positionBuffer.Get(), 0, &positionBox, positions.data(), 0, 0);
+
+	D3D11_BOX indexBox = {};
+	indexBox.left = range.StartIndex * sizeof(unsigned int);
+	indexBox.right = indexBox.left + indexCount * sizeof(unsigned int);
+	indexBox.bottom = 1;
+	indexBox.back = 1;
+	Graphics::Context->UpdateSubresource(indexBuffer.Get(), 0, &indexBox, indices, 0, 0);
+
+	return range;
+}
+
+void GeometryArena::Free(const GeometryRange& range)
+{
+	if (!range.IsValid())
+		return;
+
+	vertexAllocator.Free(range.BaseVertex, range.VertexCount);
+	indexAllocator.Free(range.StartIndex, range.IndexCount);
+}
+
+void GeometryArena::Bind(RenderContext& context)
+{
+	context.SetVertexBuffer(0, vertexBuffer.Get(), vertexStride, 0);
+	context.SetIndexBuffer(indexBuffer.Get());
+}
+
+// --------------------------------------------------------
+// Binds the position stream in place of the vertices, for
+// passes whose input layout only reads POSITION
+// --------------------------------------------------------
+void GeometryArena::BindPositions(RenderContext& context)
+{
+	context.SetVertexBuffer(0, positionBuffer.Get(), sizeof(DirectX::XMFLOAT3), 0);
+	context.SetIndexBuffer(indexBuffer.Get());
+}
+
+Microsoft::WRL::ComPtr<ID3D11Buffer> GeometryArena::GetVertexBuffer() { return vertexBuffer; }
+Microsoft::WRL::ComPtr<ID3D11Buffer> GeometryArena::GetIndexBuffer() { return indexBuffer; }
+Microsoft::WRL::ComPtr<ID3D11Buffer> GeometryArena::GetPositionBuffer() { return positionBuffer; }
+unsigned int GeometryArena::GetVertexStride() { return vertexStride; }
+RangeAllocator& GeometryArena::GetVertexAllocator() { return vertexAllocator; }
+RangeAllocator& GeometryArena::GetIndexAllocator() { return indexAllocator; }
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+
+#include "RangeAllocator.h"
+#include "RenderContext.h"
+
+// --------------------------------------------------------
+// Where a mesh lives inside a GeometryArena
+// --------------------------------------------------------
+struct GeometryRange
+{
+	unsigned int BaseVertex;	// First vertex, passed as DrawIndexed's baseVertexLocation
+	unsigned int VertexCount;
+	unsigned int StartIndex;	// First index, passed as DrawIndexed's startIndexLocation
+	unsigned int IndexCount;
+
+	bool IsValid() const { return BaseVertex != RangeAllocator::InvalidOffset; }
+};
+
+// --------------------------------------------------------
+// One large vertex buffer and one large index buffer that
+// many meshes are sub-allocated from
+//
+// Every mesh in the arena draws with the same two buffers
+// bound, so behind a StateCache switching between them
+// costs no IASet* calls.
+// A third buffer keeps just the positions (12 bytes per
+// vertex, at the same vertex offsets) for depth-only passes.
+// The bookkeeping is done by two RangeAllocators (one in
+// vertices, one in indices), so it can be exercised without
+// a GPU.
+// --------------------------------------------------------
+class GeometryArena
+{
+public:
+	// Basic OOP Setup
+	GeometryArena(unsigned int vertexStride, unsigned int maxVertices, unsigned int maxIndices);
+	~GeometryArena();
+	GeometryArena(const GeometryArena&) = delete;
+	GeometryArena& operator = (const GeometryArena&) = delete;
+
+	// Allocation - returns an invalid range if either buffer is full
+	// - The vertex format must start with an XMFLOAT3 position
+	GeometryRange Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Free(const GeometryRange& range);
+
+	// Binds the vertex (or position) and index buffers
+	void Bind(RenderContext& context);
+	void BindPositions(RenderContext& context);
+
+	// Getters
+	Microsoft::WRL::ComPtr<ID3D11Buffer> GetVertexBuffer();
+	Microsoft::WRL::ComPtr<ID3D11Buffer> GetIndexBuffer();
+	Microsoft::WRL::ComPtr<ID3D11Buffer> GetPositionBuffer();
+	unsigned int GetVertexStride();
+	RangeAllocator& GetVertexAllocator();
+	RangeAllocator& GetIndexAllocator();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> positionBuffer;
+	unsigned int vertexStride;
+
+	RangeAllocator vertexAllocator;
+	RangeAllocator indexAllocator;
+};
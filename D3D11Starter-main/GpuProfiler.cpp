@@ -0,0 +1,192 @@
+#include "GpuProfiler.h"
+#include "GpuTimestampSource.h"
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// How much of each new frame goes into an average
+	const float averageWeight = 0.1f;
+
+	// The frame's own timestamps, either side of every scope
+	const unsigned int frameBeginTimestamp = 0;
+	const unsigned int frameEndTimestamp = 1;
+	const unsigned int firstScopeTimestamp = 2;
+}
+
+GpuProfiler::GpuProfiler(GpuTimestampSource& source) :
+	source(source),
+	frames(source.GetFrameCount()),
+	timestamps(source.GetTimestampsPerFrame()),
+	currentSlot(0),
+	framesBegun(0),
+	oldestPending(0),
+	inFrame(false),
+	frameMilliseconds(0),
+	averageFrameMilliseconds(0),
+	stats{}
+{
+	for (Frame& frame : frames)
+	{
+		frame.TimestampCount = 0;
+		frame.Pending = false;
+	}
+}
+
+GpuProfiler::~GpuProfiler()
+{
+}
+
+void GpuProfiler::BeginFrame()
+{
+	if (inFrame)
+		EndFrame();
+
+	Collect();
+
+	// Never wait for a slot - if it's still in use, its frame is lost
+	currentSlot = (unsigned int)(framesBegun % frames.size());
+	Frame& frame = frames[currentSlot];
+	if (frame.Pending)
+	{
+		frame.Pending = false;
+		stats.FramesDropped++;
+		oldestPending++;
+	}
+
+	frame.Scopes.clear();
+	frame.TimestampCount = firstScopeTimestamp;
+	openScopes.clear();
+	framesBegun++;
+	inFrame = true;
+
+	source.BeginFrame(currentSlot);
+	source.WriteTimestamp(currentSlot, frameBeginTimestamp);
+}
+
+void GpuProfiler::EndFrame()
+{
+	if (!inFrame)
+		return;
+
+	while (!openScopes.empty())
+		EndScope();
+
+	source.WriteTimestamp(currentSlot, frameEndTimestamp);
+	source.EndFrame(currentSlot);
+	frames[currentSlot].Pending = true;
+	inFrame = false;
+}
+
+void GpuProfiler::BeginScope(const char* name)
+{
+	if (!inFrame)
+		return;
+
+	// Scopes that don't fit keep their place in the nesting, but aren't timed
+	Frame& frame = frames[currentSlot];
+	Scope scope = { name, (unsigned int)openScopes.size(), InvalidTimestamp, InvalidTimestamp };
+	if (frame.TimestampCount + 2 <= timestamps.size())
+	{
+		scope.Begin = frame.TimestampCount++;
+		scope.End = frame.TimestampCount++;
+		source.WriteTimestamp(currentSlot, scope.Begin);
+	}
+	else
+	{
+		stats.ScopesDropped++;
+	}
+
+	openScopes.push_back((unsigned int)frame.Scopes.size());
+	frame.Scopes.push_back(scope);
+}
+
+void GpuProfiler::EndScope()
+{
+	if (!inFrame || openScopes.empty())
+		return;
+
+	const Scope& scope = frames[currentSlot].Scopes[openScopes.back()];
+	openScopes.pop_back();
+	if (scope.End != InvalidTimestamp)
+		source.WriteTimestamp(currentSlot, scope.End);
+}
+
+// --------------------------------------------------------
+// Reads back every frame that's ready, oldest first, so
+// the results are always from the newest finished frame
+// --------------------------------------------------------
+void GpuProfiler::Collect()
+{
+	while (oldestPending < framesBegun)
+	{
+		unsigned int slot = (unsigned int)(oldestPending % frames.size());
+		if (frames[slot].Pending && !Resolve(slot))
+			break;
+
+		oldestPending++;
+	}
+}
+
+// --------------------------------------------------------
+// Turns one frame's timestamps into results, if they're in
+// --------------------------------------------------------
+bool GpuProfiler::Resolve(unsigned int slot)
+{
+	Frame& frame = frames[slot];
+	uint64_t frequency = 0;
+	bool disjoint = false;
+	if (!source.ReadFrame(slot, frame.TimestampCount, timestamps.data(), frequency, disjoint))
+		return false;
+
+	frame.Pending = false;
+	if (disjoint || frequency == 0)
+	{
+		stats.FramesDisjoint++;
+		return true;
+	}
+
+	auto milliseconds = [&](unsigned int begin, unsigned int end)
+		{
+			// Timestamps can come back out of order across a clock change
+			if (timestamps[end] < timestamps[begin])
+				return 0.0f;
+			return (float)((double)(timestamps[end] - timestamps[begin]) * 1000.0 / (double)frequency);
+		};
+
+	frameMilliseconds = milliseconds(frameBeginTimestamp, frameEndTimestamp);
+	averageFrameMilliseconds = Average(averageFrameMilliseconds, frameMilliseconds);
+
+	results.clear();
+	for (const Scope& scope : frame.Scopes)
+	{
+		GpuProfileResult result = { scope.Name, scope.Depth, 0.0f, 0.0f };
+		if (scope.Begin != InvalidTimestamp)
+			result.Milliseconds = milliseconds(scope.Begin, scope.End);
+
+		// First sighting of a name starts its average where it is
+		auto found = averages.find(scope.Name);
+		if (found == averages.end())
+			found = averages.emplace(scope.Name, result.Milliseconds).first;
+		else
+			found->second = Average(found->second, result.Milliseconds);
+		result.AverageMilliseconds = found->second;
+
+		results.push_back(result);
+	}
+
+	stats.FramesResolved++;
+	return true;
+}
+
+float GpuProfiler::Average(float previous, float latest)
+{
+	if (stats.FramesResolved == 0)
+		return latest;
+	return previous + (latest - previous) * averageWeight;
+}
+
+const std::vector<GpuProfileResult>& GpuProfiler::GetResults() { return results; }
+float GpuProfiler::GetFrameMilliseconds() { return frameMilliseconds; }
+float GpuProfiler::GetAverageFrameMilliseconds() { return averageFrameMilliseconds; }
+GpuProfilerStats GpuProfiler::GetStats() { return stats; }
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GpuTimestampSource;
+
+// --------------------------------------------------------
+// One scope's time in the latest frame the GPU has finished
+// --------------------------------------------------------
+struct GpuProfileResult
+{
+	const char* Name;
+	unsigned int Depth;			// 0 for top-level scopes, +1 per enclosing scope
+	float Milliseconds;			// This frame
+	float AverageMilliseconds;	// Smoothed over recent frames, by name
+};
+
+// How the profiler's frames have fared
+struct GpuProfilerStats
+{
+	unsigned int FramesResolved;
+	unsigned int FramesDropped;		// Still not ready when their slot was needed again
+	unsigned int FramesDisjoint;	// Ready, but with timestamps that couldn't be trusted
+	unsigned int ScopesDropped;		// Didn't fit in a frame's timestamps
+};
+
+// --------------------------------------------------------
+// Times nested scopes of GPU work, frame after frame,
+// without ever waiting on the GPU
+//
+// Each BeginScope()/EndScope() pair writes a timestamp at
+// either end. Frames go round the source's ring of slots, so
+// a frame's timestamps are read back a few frames later:
+// BeginFrame() collects every frame that's ready (oldest
+// first, stopping at the first that isn't), and if the slot
+// it's about to reuse still isn't ready that frame is
+// dropped rather than waited for.
+//
+// Scope names must outlive the results - string literals,
+// in practice. GpuProfileScope ends its scope when it goes
+// out of scope.
+// --------------------------------------------------------
+class GpuProfiler
+{
+public:
+	// Basic OOP Setup
+	explicit GpuProfiler(GpuTimestampSource& source);
+	~GpuProfiler();
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginScope(const char* name);
+	void EndScope();
+
+	// Getters
+	const std::vector<GpuProfileResult>& GetResults();	// In the order the scopes began
+	float GetFrameMilliseconds();						// BeginFrame() to EndFrame(), latest frame
+	float GetAverageFrameMilliseconds();
+	GpuProfilerStats GetStats();
+
+private:
+	static const unsigned int InvalidTimestamp = 0xFFFFFFFF;
+
+	struct Scope
+	{
+		const char* Name;
+		unsigned int Depth;
+		unsigned int Begin;		// Timestamp indices
+		unsigned int End;
+	};
+
+	struct Frame
+	{
+		std::vector<Scope> Scopes;
+		unsigned int TimestampCount;
+		bool Pending;			// Ended, but not read back yet
+	};
+
+	void Collect();
+	bool Resolve(unsigned int slot);
+	float Average(float previous, float latest);
+
+	GpuTimestampSource& source;
+	std::vector<Frame> frames;
+	std::vector<uint64_t> timestamps;	// Read back into here
+	std::vector<unsigned int> openScopes;
+	unsigned int currentSlot;
+	uint64_t framesBegun;
+	uint64_t oldestPending;				// Frame number, so slots are read in order
+	bool inFrame;
+
+	std::vector<GpuProfileResult> results;
+	std::unordered_map<std::string, float> averages;
+	float frameMilliseconds;
+	float averageFrameMilliseconds;
+	GpuProfilerStats stats;
+};
+
+// --------------------------------------------------------
+// Times everything until the end of the enclosing block
+// --------------------------------------------------------
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(GpuProfiler& profiler, const char* name) : profiler(profiler) { profiler.BeginScope(name); }
+	~GpuProfileScope() { profiler.EndScope(); }
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	GpuProfiler& profiler;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+// --------------------------------------------------------
+// Somewhere to write timestamps during a frame and read them
+// back a few frames later, behind an interface so they can
+// come from the GPU (D3D11TimestampSource) or a CPU clock
+// (CpuTimestampSource)
+//
+// Frames live in a ring of GetFrameCount() slots, each with
+// room for GetTimestampsPerFrame() timestamps. A slot's
+// results stay readable until it's begun again.
+// --------------------------------------------------------
+class GpuTimestampSource
+{
+public:
+	virtual ~GpuTimestampSource() {}
+
+	// Writing
+	virtual void BeginFrame(unsigned int slot) = 0;
+	virtual void WriteTimestamp(unsigned int slot, unsigned int index) = 0;
+	virtual void EndFrame(unsigned int slot) = 0;
+
+	// Reading - never waits, returning false while the slot's
+	// timestamps aren't available yet
+	// - disjoint means something (a clock change, say) made this
+	//   frame's timestamps meaningless, so they should be skipped
+	virtual bool ReadFrame(unsigned int slot, unsigned int count, uint64_t* timestamps, uint64_t& frequency, bool& disjoint) = 0;
+
+	// Getters
+	virtual unsigned int GetFrameCount() = 0;
+	virtual unsigned int GetTimestampsPerFrame() = 0;
+};
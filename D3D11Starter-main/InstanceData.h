@@ -0,0 +1,16 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+// --------------------------------------------------------
+// Per-instance data for instanced drawing
+//
+// This goes into the second vertex buffer slot and must
+// match the per-instance elements of the instanced input
+// layout (WORLD0-3 and TINT) in VertexShaderInstanced.hlsl
+// --------------------------------------------------------
+struct InstanceData
+{
+	DirectX::XMFLOAT4X4 World;	// Row-major world matrix, one row per WORLD semantic
+	DirectX::XMFLOAT4 Tint;		// Multiplied with the vertex color
+};
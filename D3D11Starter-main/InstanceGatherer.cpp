@@ -0,0 +1,97 @@
+#include "InstanceGatherer.h"
+#include "MeshBounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+InstanceGatherer::InstanceGatherer() :
+	cullingEnabled(false),
+	frustumPlanes{},
+	culledCount(0)
+{
+}
+
+InstanceGatherer::~InstanceGatherer()
+{
+}
+
+// --------------------------------------------------------
+// Starts a new frame, culling against this view-projection
+// --------------------------------------------------------
+void InstanceGatherer::Begin(const XMFLOAT4X4& viewProjection)
+{
+	BeginWithoutCulling();
+	MeshBounds::ExtractFrustumPlanes(viewProjection, frustumPlanes);
+	cullingEnabled = true;
+}
+
+void InstanceGatherer::BeginWithoutCulling()
+{
+	cullingEnabled = false;
+	culledCount = 0;
+	pending.clear();
+	unsorted.clear();
+	instances.clear();
+	groups.clear();
+}
+
+// --------------------------------------------------------
+// Adds an instance if its bounds (in mesh-local space) are
+// inside the frustum. Returns whether it was kept.
+// --------------------------------------------------------
+bool InstanceGatherer::Add(unsigned int meshID, const InstanceData& instance, const BoundingSphere& localBounds)
+{
+	if (cullingEnabled)
+	{
+		XMMATRIX world = XMLoadFloat4x4(&instance.World);
+
+		// Move the center, and grow the radius by the largest axis scale
+		XMFLOAT3 center;
+		XMStoreFloat3(&center, XMVector3TransformCoord(XMLoadFloat3(&localBounds.Center), world));
+		float scaleSq = std::max(
+			XMVectorGetX(XMVector3LengthSq(world.r[0])),
+			std::max(XMVectorGetX(XMVector3LengthSq(world.r[1])), XMVectorGetX(XMVector3LengthSq(world.r[2]))));
+
+		if (!MeshBounds::SphereInFrustum(frustumPlanes, center, localBounds.Radius * std::sqrt(scaleSq)))
+		{
+			culledCount++;
+			return false;
+		}
+	}
+
+	Add(meshID, instance);
+	return true;
+}
+
+void InstanceGatherer::Add(unsigned int meshID, const InstanceData& instance)
+{
+	pending.push_back({ meshID, (unsigned int)unsorted.size() });
+	unsorted.push_back(instance);
+}
+
+// --------------------------------------------------------
+// Groups everything by mesh - a stable sort keeps the
+// submission order within each group
+// --------------------------------------------------------
+void InstanceGatherer::Finish()
+{
+	std::stable_sort(pending.begin(), pending.end(),
+		[](const Pending& a, const Pending& b) { return a.MeshID < b.MeshID; });
+
+	instances.resize(pending.size());
+	groups.clear();
+	for (unsigned int i = 0; i < pending.size(); i++)
+	{
+		instances[i] = unsorted[pending[i].Index];
+
+		if (groups.empty() || groups.back().MeshID != pending[i].MeshID)
+			groups.push_back({ pending[i].MeshID, i, 0 });
+		groups.back().InstanceCount++;
+	}
+}
+
+const std::vector<InstanceData>& InstanceGatherer::GetInstances() { return instances; }
+const std::vector<InstanceGroup>& InstanceGatherer::GetGroups() { return groups; }
+unsigned int InstanceGatherer::GetCulledCount() { return culledCount; }
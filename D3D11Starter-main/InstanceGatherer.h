@@ -0,0 +1,61 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+#include <vector>
+
+#include "InstanceData.h"
+
+// --------------------------------------------------------
+// A run of instances that all use the same mesh
+// --------------------------------------------------------
+struct InstanceGroup
+{
+	unsigned int MeshID;		// Whatever id the caller uses for its meshes
+	unsigned int FirstInstance;	// Offset into InstanceGatherer::GetInstances()
+	unsigned int InstanceCount;
+};
+
+// --------------------------------------------------------
+// Collects the visible instances for a frame and packs them
+// into one contiguous array, grouped by mesh, ready to be
+// uploaded and drawn with one DrawIndexedInstanced per group
+//
+// Pure CPU - mesh ids are plain integers, so grouping and
+// packing can be checked without a GPU
+// --------------------------------------------------------
+class InstanceGatherer
+{
+public:
+	// Basic OOP Setup
+	InstanceGatherer();
+	~InstanceGatherer();
+
+	// Per-frame usage
+	void Begin(const DirectX::XMFLOAT4X4& viewProjection);
+	void BeginWithoutCulling();
+	bool Add(unsigned int meshID, const InstanceData& instance, const DirectX::BoundingSphere& localBounds);
+	void Add(unsigned int meshID, const InstanceData& instance);
+	void Finish();
+
+	// Results (valid after Finish)
+	const std::vector<InstanceData>& GetInstances();
+	const std::vector<InstanceGroup>& GetGroups();
+	unsigned int GetCulledCount();
+
+private:
+	struct Pending
+	{
+		unsigned int MeshID;
+		unsigned int Index;
+	};
+
+	bool cullingEnabled;
+	DirectX::XMFLOAT4 frustumPlanes[6];
+	unsigned int culledCount;
+
+	std::vector<Pending> pending;
+	std::vector<InstanceData> unsorted;
+	std::vector<InstanceData> instances;
+	std::vector<InstanceGroup> groups;
+};
@@ -0,0 +1,366 @@
+#include "LightClusters.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Below this many lights, waking the pool costs more than it saves
+	const unsigned int minLightsForPool = 64;
+
+	// Cosine of 45 degrees, where the tightest sphere around a cone
+	// switches from being centered on the cone's axis to its cap
+	const float wideSpotCos = 0.70710678f;
+
+	// --------------------------------------------------------
+	// Which of four spheres touch a box - squared distance from
+	// each center to the box against each squared radius
+	// --------------------------------------------------------
+	XMVECTOR SpheresTouchBox(
+		XMVECTOR x, XMVECTOR y, XMVECTOR z, XMVECTOR radiusSq,
+		XMVECTOR minX, XMVECTOR minY, XMVECTOR minZ,
+		XMVECTOR maxX, XMVECTOR maxY, XMVECTOR maxZ)
+	{
+		XMVECTOR zero = XMVectorZero();
+		XMVECTOR dx = XMVectorMax(XMVectorMax(XMVectorSubtract(minX, x), XMVectorSubtract(x, maxX)), zero);
+		XMVECTOR dy = XMVectorMax(XMVectorMax(XMVectorSubtract(minY, y), XMVectorSubtract(y, maxY)), zero);
+		XMVECTOR dz = XMVectorMax(XMVectorMax(XMVectorSubtract(minZ, z), XMVectorSubtract(z, maxZ)), zero);
+		XMVECTOR distanceSq = XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)));
+		return XMVectorLessOrEqual(distanceSq, radiusSq);
+	}
+
+	// --------------------------------------------------------
+	// Sizes a set of sphere arrays for count spheres, padding
+	// the last four with ones that never touch anything
+	// --------------------------------------------------------
+	void PadSpheres(std::vector<float>& x, std::vector<float>& y, std::vector<float>& z, std::vector<float>& radiusSq, size_t count)
+	{
+		size_t padded = (count + 3) & ~(size_t)3;
+		x.resize(padded);
+		y.resize(padded);
+		z.resize(padded);
+		radiusSq.resize(padded);
+		for (size_t i = count; i < padded; i++)
+		{
+			x[i] = y[i] = z[i] = 0.0f;
+			radiusSq[i] = -1.0f;
+		}
+	}
+}
+
+LightClusters::LightClusters(WorkerPool* pool) :
+	pool(pool),
+	gridProjection{},
+	nearZ(0),
+	farZ(0),
+	slices(ClustersZ),
+	clusterRanges(ClusterCount),
+	constants{},
+	maxLightsPerCluster(0),
+	buildMilliseconds(0)
+{
+}
+
+LightClusters::~LightClusters()
+{
+}
+
+void LightClusters::Build(
+	std::span<const ClusterLight> lights,
+	const XMFLOAT4X4& view,
+	const XMFLOAT4X4& projection,
+	unsigned int screenWidth,
+	unsigned int screenHeight)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	if (memcmp(&projection, &gridProjection, sizeof(XMFLOAT4X4)) != 0)
+		UpdateGrid(projection);
+
+	constants.ClustersX = ClustersX;
+	constants.ClustersY = ClustersY;
+	constants.ClustersZ = ClustersZ;
+	constants.TileScaleX = (float)ClustersX / std::max(screenWidth, 1u);
+	constants.TileScaleY = (float)ClustersY / std::max(screenHeight, 1u);
+
+	// Bounding spheres in view space, and the slices they overlap
+	unsigned int lightCount = (unsigned int)lights.size();
+	lightX.resize(lightCount);
+	lightY.resize(lightCount);
+	lightZ.resize(lightCount);
+	lightRadius.resize(lightCount);
+	lightFirstSlice.resize(lightCount);
+	lightLastSlice.resize(lightCount);
+
+	XMMATRIX viewMatrix = XMLoadFloat4x4(&view);
+	for (unsigned int i = 0; i < lightCount; i++)
+	{
+		const ClusterLight& light = lights[i];
+		XMVECTOR center = XMLoadFloat3(&light.Position);
+		float radius = light.Range;
+
+		// Spot lights are bounded by their cone rather than their range
+		if (light.Type == LightTypeSpot)
+		{
+			XMVECTOR direction = XMLoadFloat3(&light.Direction);
+			float cosAngle = std::clamp(light.SpotCosAngle, 0.0f, 1.0f);
+			float offset;
+			if (cosAngle >= wideSpotCos)
+			{
+				radius = light.Range / (2.0f * cosAngle);
+				offset = radius;
+			}
+			else
+			{
+				radius = light.Range * std::sqrt(1.0f - cosAngle * cosAngle);
+				offset = light.Range * cosAngle;
+			}
+			center = XMVectorMultiplyAdd(direction, XMVectorReplicate(offset), center);
+		}
+
+		XMFLOAT3 viewCenter;
+		XMStoreFloat3(&viewCenter, XMVector3Transform(center, viewMatrix));
+		lightX[i] = viewCenter.x;
+		lightY[i] = viewCenter.y;
+		lightZ[i] = viewCenter.z;
+		lightRadius[i] = radius;
+
+		float nearest = viewCenter.z - radius;
+		float farthest = viewCenter.z + radius;
+		if (farthest < nearZ || nearest > farZ)
+		{
+			lightFirstSlice[i] = 1;
+			lightLastSlice[i] = 0;
+			continue;
+		}
+
+		auto sliceOf = [&](float depth)
+			{
+				float slice = std::log(std::max(depth, nearZ)) * constants.DepthScale + constants.DepthBias;
+				return (unsigned int)std::clamp(slice, 0.0f, (float)(ClustersZ - 1));
+			};
+		lightFirstSlice[i] = sliceOf(nearest);
+		lightLastSlice[i] = sliceOf(farthest);
+	}
+
+	// Each slice fills its own clusters, so slices can't collide
+	if (pool && lightCount >= minLightsForPool)
+	{
+		pool->ParallelFor(ClustersZ, ClustersZ,
+			[&](unsigned int, unsigned int begin, unsigned int end)
+			{
+				for (unsigned int z = begin; z < end; z++)
+					BuildSlice(z);
+			});
+	}
+	else
+	{
+		for (unsigned int z = 0; z < ClustersZ; z++)
+			BuildSlice(z);
+	}
+
+	// Pack the slices' lists into one, moving their ranges to match
+	size_t indexCount = 0;
+	for (const Slice& slice : slices)
+		indexCount += slice.Indices.size();
+	lightIndices.resize(indexCount);
+
+	uint32_t offset = 0;
+	maxLightsPerCluster = 0;
+	for (unsigned int z = 0; z < ClustersZ; z++)
+	{
+		const Slice& slice = slices[z];
+		std::copy(slice.Indices.begin(), slice.Indices.end(), lightIndices.begin() + offset);
+
+		ClusterRange* ranges = &clusterRanges[z * ClustersX * ClustersY];
+		for (unsigned int i = 0; i < ClustersX * ClustersY; i++)
+		{
+			ranges[i].FirstIndex += offset;
+			maxLightsPerCluster = std::max(maxLightsPerCluster, ranges[i].LightCount);
+		}
+		offset += (uint32_t)slice.Indices.size();
+	}
+
+	buildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --------------------------------------------------------
+// Works out the slice depths and every cluster's view space
+// bounds from a perspective projection
+// --------------------------------------------------------
+void LightClusters::UpdateGrid(const XMFLOAT4X4& projection)
+{
+	gridProjection = projection;
+
+	// A left-handed perspective projection has _33 = f / (f - n)
+	// and _43 = -n * f / (f - n), which give back both planes
+	nearZ = -projection._43 / projection._33;
+	farZ = projection._33 * nearZ / (projection._33 - 1.0f);
+
+	// Slices grow exponentially, so each is about as deep as it is wide
+	float logRange = std::log(farZ / nearZ);
+	constants.DepthScale = ClustersZ / logRange;
+	constants.DepthBias = -(float)ClustersZ * std::log(nearZ) / logRange;
+
+	sliceDepths.resize(ClustersZ + 1);
+	for (unsigned int z = 0; z <= ClustersZ; z++)
+		sliceDepths[z] = nearZ * std::exp(logRange * z / ClustersZ);
+
+	// A tile's sides are planes through the eye, so its widest
+	// point at any depth is at whichever end of the slice is
+	// farther out - view x = ndc x * depth / _11
+	boxMinX.resize(ClusterCount);
+	boxMinY.resize(ClusterCount);
+	boxMaxX.resize(ClusterCount);
+	boxMaxY.resize(ClusterCount);
+	for (unsigned int z = 0; z < ClustersZ; z++)
+	{
+		float sliceNear = sliceDepths[z];
+		float sliceFar = sliceDepths[z + 1];
+		auto extent = [&](float ndc, float scale, bool lower)
+			{
+				float nearPoint = ndc * sliceNear / scale;
+				float farPoint = ndc * sliceFar / scale;
+				return lower ? std::min(nearPoint, farPoint) : std::max(nearPoint, farPoint);
+			};
+
+		for (unsigned int y = 0; y < ClustersY; y++)
+		{
+			// Tile rows go down the screen, as SV_Position does
+			float top = 1.0f - 2.0f * y / ClustersY;
+			float bottom = 1.0f - 2.0f * (y + 1) / ClustersY;
+			for (unsigned int x = 0; x < ClustersX; x++)
+			{
+				float left = -1.0f + 2.0f * x / ClustersX;
+				float right = -1.0f + 2.0f * (x + 1) / ClustersX;
+
+				unsigned int cluster = GetClusterIndex(x, y, z);
+				boxMinX[cluster] = extent(left, projection._11, true);
+				boxMaxX[cluster] = extent(right, projection._11, false);
+				boxMinY[cluster] = extent(bottom, projection._22, true);
+				boxMaxY[cluster] = extent(top, projection._22, false);
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Fills one depth slice's clusters - the lights in the slice
+// are narrowed down a row at a time, then tested against
+// each of the row's clusters
+// --------------------------------------------------------
+void LightClusters::BuildSlice(unsigned int z)
+{
+	Slice& slice = slices[z];
+	slice.Indices.clear();
+
+	slice.Lights.clear();
+	for (unsigned int i = 0; i < (unsigned int)lightX.size(); i++)
+	{
+		if (lightFirstSlice[i] <= z && z <= lightLastSlice[i])
+			slice.Lights.push_back(i);
+	}
+
+	size_t sliceLightCount = slice.Lights.size();
+	PadSpheres(slice.X, slice.Y, slice.Z, slice.RadiusSq, sliceLightCount);
+	for (size_t i = 0; i < sliceLightCount; i++)
+	{
+		uint32_t light = slice.Lights[i];
+		slice.X[i] = lightX[light];
+		slice.Y[i] = lightY[light];
+		slice.Z[i] = lightZ[light];
+		slice.RadiusSq[i] = lightRadius[light] * lightRadius[light];
+	}
+
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR minZ = XMVectorReplicate(sliceDepths[z]);
+	const XMVECTOR maxZ = XMVectorReplicate(sliceDepths[z + 1]);
+	auto load = [](const std::vector<float>& values, size_t at) { return XMLoadFloat4((const XMFLOAT4*)&values[at]); };
+
+	uint32_t hits[4];
+	for (unsigned int y = 0; y < ClustersY; y++)
+	{
+		unsigned int rowStart = GetClusterIndex(0, y, z);
+
+		// The row's box spans its clusters'
+		float rowMinX = boxMinX[rowStart], rowMaxX = boxMaxX[rowStart];
+		for (unsigned int x = 1; x < ClustersX; x++)
+		{
+			rowMinX = std::min(rowMinX, boxMinX[rowStart + x]);
+			rowMaxX = std::max(rowMaxX, boxMaxX[rowStart + x]);
+		}
+
+		// Narrow the slice's lights down to the row's
+		slice.RowLights.clear();
+		for (size_t i = 0; i < sliceLightCount; i += 4)
+		{
+			XMVECTOR touches = SpheresTouchBox(
+				load(slice.X, i), load(slice.Y, i), load(slice.Z, i), load(slice.RadiusSq, i),
+				XMVectorReplicate(rowMinX), XMVectorReplicate(boxMinY[rowStart]), minZ,
+				XMVectorReplicate(rowMaxX), XMVectorReplicate(boxMaxY[rowStart]), maxZ);
+			if (XMVector4EqualInt(touches, zero))
+				continue;
+
+			XMStoreInt4(hits, touches);
+			for (size_t lane = 0; lane < 4; lane++)
+			{
+				if (hits[lane])
+					slice.RowLights.push_back((uint32_t)(i + lane));
+			}
+		}
+
+		size_t rowLightCount = slice.RowLights.size();
+		PadSpheres(slice.RowX, slice.RowY, slice.RowZ, slice.RowRadiusSq, rowLightCount);
+		for (size_t i = 0; i < rowLightCount; i++)
+		{
+			uint32_t light = slice.RowLights[i];
+			slice.RowX[i] = slice.X[light];
+			slice.RowY[i] = slice.Y[light];
+			slice.RowZ[i] = slice.Z[light];
+			slice.RowRadiusSq[i] = slice.RadiusSq[light];
+		}
+
+		// Then each cluster's, from the row's
+		for (unsigned int x = 0; x < ClustersX; x++)
+		{
+			unsigned int cluster = rowStart + x;
+			XMVECTOR minX = XMVectorReplicate(boxMinX[cluster]);
+			XMVECTOR maxX = XMVectorReplicate(boxMaxX[cluster]);
+			XMVECTOR minY = XMVectorReplicate(boxMinY[cluster]);
+			XMVECTOR maxY = XMVectorReplicate(boxMaxY[cluster]);
+
+			ClusterRange& range = clusterRanges[cluster];
+			range.FirstIndex = (uint32_t)slice.Indices.size();
+			for (size_t i = 0; i < rowLightCount; i += 4)
+			{
+				XMVECTOR touches = SpheresTouchBox(
+					load(slice.RowX, i), load(slice.RowY, i), load(slice.RowZ, i), load(slice.RowRadiusSq, i),
+					minX, minY, minZ, maxX, maxY, maxZ);
+				if (XMVector4EqualInt(touches, zero))
+					continue;
+
+				XMStoreInt4(hits, touches);
+				for (size_t lane = 0; lane < 4; lane++)
+				{
+					if (hits[lane])
+						slice.Indices.push_back(slice.Lights[slice.RowLights[i + lane]]);
+				}
+			}
+			range.LightCount = (uint32_t)slice.Indices.size() - range.FirstIndex;
+		}
+	}
+}
+
+std::span<const ClusterRange> LightClusters::GetClusterRanges() { return clusterRanges; }
+std::span<const uint32_t> LightClusters::GetLightIndices() { return lightIndices; }
+ClusterConstants LightClusters::GetConstants() { return constants; }
+unsigned int LightClusters::GetClusterIndex(unsigned int x, unsigned int y, unsigned int z) { return x + ClustersX * (y + ClustersY * z); }
+unsigned int LightClusters::GetMaxLightsPerCluster() { return maxLightsPerCluster; }
+float LightClusters::GetBuildMilliseconds() { return buildMilliseconds; }
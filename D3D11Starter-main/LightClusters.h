@@ -0,0 +1,152 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class WorkerPool;
+
+// Kinds of ClusterLight
+const uint32_t LightTypePoint = 0;
+const uint32_t LightTypeSpot = 1;
+
+// --------------------------------------------------------
+// One light as the GPU sees it - 48 bytes, for a
+// StructuredBuffer<Light> in the same order as the span
+// handed to LightClusters::Build()
+// --------------------------------------------------------
+struct ClusterLight
+{
+	DirectX::XMFLOAT3 Position;		// World space
+	float Range;					// Nothing is lit beyond this distance
+	DirectX::XMFLOAT3 Direction;	// Spot lights only, unit length
+	float SpotCosAngle;				// Spot lights only, cosine of the cone's half angle
+	DirectX::XMFLOAT3 Color;
+	uint32_t Type;					// LightTypePoint or LightTypeSpot
+};
+
+static_assert(sizeof(ClusterLight) == 48, "ClusterLight must match the HLSL struct");
+
+// --------------------------------------------------------
+// Where one cluster's lights are in the index list - for a
+// StructuredBuffer<uint2>, one per cluster
+// --------------------------------------------------------
+struct ClusterRange
+{
+	uint32_t FirstIndex;
+	uint32_t LightCount;
+};
+
+// --------------------------------------------------------
+// What a pixel shader needs to find its cluster - a 32 byte
+// cbuffer block:
+//  x = floor(SV_Position.x * TileScaleX)
+//  y = floor(SV_Position.y * TileScaleY)
+//  z = floor(log(viewDepth) * DepthScale + DepthBias)
+// clamped to the grid, then
+//  cluster = x + ClustersX * (y + ClustersY * z)
+// --------------------------------------------------------
+struct ClusterConstants
+{
+	uint32_t ClustersX;
+	uint32_t ClustersY;
+	uint32_t ClustersZ;
+	uint32_t Padding;
+	float TileScaleX;	// Clusters per pixel
+	float TileScaleY;
+	float DepthScale;
+	float DepthBias;
+};
+
+// --------------------------------------------------------
+// Assigns lights to the froxels (frustum-shaped voxels) of
+// a grid over the view frustum, so shading a pixel only
+// loops over the lights near it instead of every light
+//
+// The grid is ClustersX by ClustersY screen tiles, cut into
+// ClustersZ slices whose depth grows exponentially from the
+// near plane to the far plane (read from the projection,
+// which must be a perspective one). Each cluster's view
+// space bounding box is worked out once per projection.
+//
+// Build() moves the lights into view space, bounds spot
+// lights' cones with tight spheres, and bins the lights by
+// the slices their spheres overlap. The slices are then
+// shared out across the pool: each tests its lights against
+// its rows, and those that pass against the row's clusters,
+// four lights at a time with DirectXMath sphere-box tests.
+// Each slice fills its own lists, which are packed into one
+// index list at the end, lights ascending in each cluster.
+//
+// Pure CPU: GetClusterRanges(), GetLightIndices() and
+// GetConstants() are ready to upload as they are.
+// --------------------------------------------------------
+class LightClusters
+{
+public:
+	static const unsigned int ClustersX = 16;
+	static const unsigned int ClustersY = 9;
+	static const unsigned int ClustersZ = 24;
+	static const unsigned int ClusterCount = ClustersX * ClustersY * ClustersZ;
+
+	// Basic OOP Setup
+	explicit LightClusters(WorkerPool* pool = nullptr);	// Null builds everything on the calling thread
+	~LightClusters();
+	LightClusters(const LightClusters&) = delete;
+	LightClusters& operator=(const LightClusters&) = delete;
+
+	void Build(
+		std::span<const ClusterLight> lights,
+		const DirectX::XMFLOAT4X4& view,
+		const DirectX::XMFLOAT4X4& projection,
+		unsigned int screenWidth,
+		unsigned int screenHeight);
+
+	// Getters
+	std::span<const ClusterRange> GetClusterRanges();	// ClusterCount of them, x fastest, then y, then z
+	std::span<const uint32_t> GetLightIndices();		// Into the lights given to Build()
+	ClusterConstants GetConstants();
+	unsigned int GetClusterIndex(unsigned int x, unsigned int y, unsigned int z);
+	unsigned int GetMaxLightsPerCluster();				// In the last Build()
+	float GetBuildMilliseconds();						// Wall time of the last Build()
+
+private:
+	// One depth slice's share of the work, kept between builds
+	// to avoid reallocating
+	struct Slice
+	{
+		// Every light overlapping the slice's depth range, then the
+		// ones overlapping the current row - spheres padded to whole
+		// fours with lights that can't touch anything
+		std::vector<uint32_t> Lights;
+		std::vector<float> X, Y, Z, RadiusSq;
+		std::vector<uint32_t> RowLights;
+		std::vector<float> RowX, RowY, RowZ, RowRadiusSq;
+
+		std::vector<uint32_t> Indices;	// This slice's lists, one cluster after another
+	};
+
+	void UpdateGrid(const DirectX::XMFLOAT4X4& projection);
+	void BuildSlice(unsigned int z);
+
+	WorkerPool* pool;
+
+	// The grid, rebuilt when the projection changes
+	DirectX::XMFLOAT4X4 gridProjection;
+	float nearZ;
+	float farZ;
+	std::vector<float> sliceDepths;		// ClustersZ + 1 boundaries, near to far
+	std::vector<float> boxMinX, boxMinY, boxMaxX, boxMaxY;	// Per cluster, view space (z comes from sliceDepths)
+
+	// Lights in view space, bounding spheres only
+	std::vector<float> lightX, lightY, lightZ, lightRadius;
+	std::vector<unsigned int> lightFirstSlice, lightLastSlice;	// First > last when it's outside the grid
+
+	std::vector<Slice> slices;
+	std::vector<ClusterRange> clusterRanges;
+	std::vector<uint32_t> lightIndices;
+	ClusterConstants constants;
+	unsigned int maxLightsPerCluster;
+	float buildMilliseconds;
+};
@@ -1,11 +1,17 @@
 
 #include <Windows.h>
 #include <crtdbg.h>
+#include <timeapi.h>
+
+#pragma comment(lib, "winmm.lib")
 
 #include "Window.h"
 #include "Graphics.h"
 #include "Game.h"
 #include "Input.h"
+#include "FramePacer.h"
+#include "SteadyPacingClock.h"
+#include "D3D11FrameFence.h"
 
 // Annonymous namespace to hold variables
 // only accessible in this file
@@ -27,6 +33,14 @@ namespace
 		if(game)
 			game->OnResize();
 	}
+
+	// And one for just before the resize,
+	// while the old buffers are still there
+	void WindowBeforeResizeCallback()
+	{
+		if(game)
+			game->BeforeResize();
+	}
 }
 
 
@@ -56,6 +70,8 @@ int WINAPI WinMain(
 	const wchar_t* windowTitle = L"Direct3D11 Game";
 	bool statsInTitleBar = true;
 	bool vsync = false;
+	float targetFps = 120.0f;			// Ignored when vsync is on - presenting sets the pace then
+	unsigned int maxFramesInFlight = 2;	// Frames the GPU may be behind the render thread
 
 	// The main application object
 	game = new Game();
@@ -67,7 +83,8 @@ int WINAPI WinMain(
 		windowHeight,
 		windowTitle,
 		statsInTitleBar,
-		WindowResizeCallback);
+		WindowResizeCallback,
+		WindowBeforeResizeCallback);
 	if (FAILED(windowResult))
 		return windowResult;
 
@@ -86,6 +103,18 @@ int WINAPI WinMain(
 	// Now the game itself can be initialzied
 	game->Initialize();
 
+	// Frame pacing, so the loop doesn't spin as fast as it can
+	//  - 1ms timer resolution lets the pacer sleep most of each wait
+	timeBeginPeriod(1);
+	SteadyPacingClock pacingClock;
+	D3D11FrameFence frameFence(Graphics::Context);
+	FramePacer framePacer(pacingClock);
+	framePacer.SetMode(Graphics::VsyncState() ? FramePacingMode::Unlimited : FramePacingMode::TargetFps);
+	framePacer.SetTargetFps(targetFps);
+	//  - The game draws on a render thread, which signals the fence itself
+	framePacer.SetFramesInFlight(&frameFence, maxFramesInFlight, false);
+	game->SetFramePacer(&framePacer, &frameFence);
+
 	// Time tracking
 	LARGE_INTEGER perfFreq{};
 	double perfSeconds = 0;
@@ -116,6 +145,9 @@ int WINAPI WinMain(
 		}
 		else
 		{
+			// Wait for this frame's turn
+			framePacer.WaitForNextFrame();
+
 			// Calculate up-to-date timing info
 			QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
 			float deltaTime = max((float)((currentTime - previousTime) * perfSeconds), 0.0f);
@@ -131,6 +163,7 @@ int WINAPI WinMain(
 			// Update and draw
 			game->Update(deltaTime, totalTime);
 			game->Draw(deltaTime, totalTime);
+			framePacer.EndFrame();
 
 			// Notify Input system about end of frame
 			Input::EndOfFrame();
@@ -143,7 +176,10 @@ int WINAPI WinMain(
 	}
 
 	// Clean up
+	// - The game goes first, as its render thread signals the fence
+	timeEndPeriod(1);
 	delete game;
+	game = 0;
 	Input::ShutDown();
 	Graphics::ShutDown();
 	return (HRESULT)msg.wParam;
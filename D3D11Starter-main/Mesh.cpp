@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include "MeshBounds.h"
 #include "Game.h"
 #include "Graphics.h"
 #include "Vertex.h"
@@ -10,17 +11,144 @@
 
 using namespace DirectX;
 
+// Annonymous namespace to hold variables
+// only accessible in this file
+namespace
+{
+	// One dynamic per-instance vertex buffer shared by every mesh
+	// - Grows (never shrinks) in Mesh::ReserveInstances(), never
+	//   while draws that use it are being recorded
+	Microsoft::WRL::ComPtr<ID3D11Buffer> instanceBuffer;
+	unsigned int instanceCapacity = 0;
+
+	// Copies out the leading XMFLOAT3 of each vertex
+	std::vector<XMFLOAT3> PositionsOf(const void* vertices, int count, unsigned int stride)
+	{
+		std::vector<XMFLOAT3> positions(count);
+		const unsigned char* bytes = (const unsigned char*)vertices;
+		for (int i = 0; i < count; i++)
+			positions[i] = *(const XMFLOAT3*)(bytes + i * stride);
+		return positions;
+	}
+
+	// Expands quantized positions to the [0, 1] space they
+	// were packed in, for either packed vertex format
+	template <typename T>
+	std::vector<XMFLOAT3> QuantizedPositionsOf(const T* vertices, int count)
+	{
+		std::vector<XMFLOAT3> positions(count);
+		for (int i = 0; i < count; i++)
+		{
+			positions[i] = XMFLOAT3(
+				vertices[i].Position[0] / 65535.0f,
+				vertices[i].Position[1] / 65535.0f,
+				vertices[i].Position[2] / 65535.0f);
+		}
+		return positions;
+	}
+}
+
 Mesh::Mesh (Vertex vertices[], int verticesSize, unsigned int indices[], int indicesSize)
 {
 	
 	numIndices = indicesSize;
 	numVertices = verticesSize;
 
+	CreateBuffers(vertices, sizeof(Vertex), indices, PositionsOf(vertices, verticesSize, sizeof(Vertex)).data());
+
+	// Work out the extents while we still have the vertices
+	boundingBox = MeshBounds::ComputeBox(vertices, verticesSize, sizeof(Vertex));
+	boundingSphere = MeshBounds::ComputeSphere(vertices, verticesSize, sizeof(Vertex));
+}
+
+// --------------------------------------------------------
+// Creates a mesh whose bounds are already known (e.g. from
+// a file), so the vertices don't need to be scanned again
+// --------------------------------------------------------
+Mesh::Mesh(Vertex vertices[], int verticesSize, unsigned int indices[], int indicesSize,
+	const BoundingBox& box, const BoundingSphere& sphere)
+{
+	numIndices = indicesSize;
+	numVertices = verticesSize;
+
+	CreateBuffers(vertices, sizeof(Vertex), indices, PositionsOf(vertices, verticesSize, sizeof(Vertex)).data());
+	SetBounds(box, sphere);
+}
+
+// --------------------------------------------------------
+// Creates a mesh inside a shared geometry arena
+//  - Only the offsets are kept; the data lives in the
+//    arena's buffers
+//  - Falls back to buffers of its own if the arena is full,
+//    or was made for a different vertex format (its stride
+//    isn't sizeof(Vertex)), since those offsets would land
+//    mid-vertex
+// --------------------------------------------------------
+Mesh::Mesh(std::shared_ptr<GeometryArena> arena, Vertex vertices[], int verticesSize, unsigned int indices[], int indicesSize)
+{
+	numIndices = indicesSize;
+	numVertices = verticesSize;
+	vertexStride = sizeof(Vertex);
+
+	range = {};
+	range.BaseVertex = RangeAllocator::InvalidOffset;
+	if (arena && arena->GetVertexStride() == sizeof(Vertex))
+		range = arena->Allocate(vertices, verticesSize, indices, indicesSize);
+	if (range.IsValid())
+		this->arena = arena;
+	else
+		CreateBuffers(vertices, sizeof(Vertex), indices, PositionsOf(vertices, verticesSize, sizeof(Vertex)).data());
+
+	boundingBox = MeshBounds::ComputeBox(vertices, verticesSize, sizeof(Vertex));
+	boundingSphere = MeshBounds::ComputeSphere(vertices, verticesSize, sizeof(Vertex));
+}
+
+// --------------------------------------------------------
+// Creates a mesh from packed (quantized) vertices
+//  - Positions are relative to the bounds they were packed
+//    with, so the caller must fold that dequantization
+//    matrix into the world matrix when drawing
+// --------------------------------------------------------
+Mesh::Mesh(PackedVertex vertices[], int verticesSize, unsigned int indices[], int indicesSize)
+{
+	numIndices = indicesSize;
+	numVertices = verticesSize;
+
+	// The position stream stays in the same [0, 1] space as the packed
+	// positions, so the same dequantization matrix works for both
+	CreateBuffers(vertices, sizeof(PackedVertex), indices, QuantizedPositionsOf(vertices, verticesSize).data());
+	SetQuantizedBounds();
+}
+
+// --------------------------------------------------------
+// Creates a mesh from packed lit vertices, for
+// VertexShaderPackedLit and PackedLitVertexLayout
+//  - Dequantized the same way as PackedVertex meshes
+// --------------------------------------------------------
+Mesh::Mesh(PackedLitVertex vertices[], int verticesSize, unsigned int indices[], int indicesSize)
+{
+	numIndices = indicesSize;
+	numVertices = verticesSize;
+
+	CreateBuffers(vertices, sizeof(PackedLitVertex), indices, QuantizedPositionsOf(vertices, verticesSize).data());
+	SetQuantizedBounds();
+}
+
+void Mesh::CreateBuffers(const void* vertices, unsigned int stride, unsigned int indices[], const XMFLOAT3* positions)
+{
+	vertexStride = stride;
+	range = { RangeAllocator::InvalidOffset, 0, RangeAllocator::InvalidOffset, 0 };
+
+	// D3D rejects zero-byte buffers, so an empty mesh gets none
+	// - The draw functions skip it instead
+	if (numVertices == 0 || numIndices == 0)
+		return;
+
 	// Create the vertex buffer using our passed vertices
 	{
 		D3D11_BUFFER_DESC vbd = {};
 		vbd.Usage = D3D11_USAGE_IMMUTABLE;
-		vbd.ByteWidth = sizeof(Vertex) * numVertices; // Number of vertices related to input
+		vbd.ByteWidth = vertexStride * numVertices; // Number of vertices related to input
 		vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 		vbd.CPUAccessFlags = 0;
 		vbd.MiscFlags = 0;
@@ -32,6 +160,19 @@ Mesh::Mesh (Vertex vertices[], int verticesSize, unsigned int indices[], int ind
 		Graphics::Device->CreateBuffer(&vbd, &initialVertexData, vertexBuffer.GetAddressOf());
 	}
 
+	// Create the position-only stream for depth-only passes
+	{
+		D3D11_BUFFER_DESC pbd = {};
+		pbd.Usage = D3D11_USAGE_IMMUTABLE;
+		pbd.ByteWidth = sizeof(XMFLOAT3) * numVertices;
+		pbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+		D3D11_SUBRESOURCE_DATA initialPositionData = {};
+		initialPositionData.pSysMem = positions;
+
+		Graphics::Device->CreateBuffer(&pbd, &initialPositionData, positionBuffer.GetAddressOf());
+	}
+
 	// Create the index buffer using our passed indices
 	{
 		D3D11_BUFFER_DESC ibd = {};
@@ -53,23 +194,41 @@ Mesh::Mesh (Vertex vertices[], int verticesSize, unsigned int indices[], int ind
 }
 
 
+// --------------------------------------------------------
+// Bounds of quantized positions, which all fall in [0, 1]
+// - Transform these by the dequantization matrix for local space
+// --------------------------------------------------------
+void Mesh::SetQuantizedBounds()
+{
+	boundingBox = BoundingBox(XMFLOAT3(0.5f, 0.5f, 0.5f), XMFLOAT3(0.5f, 0.5f, 0.5f));
+	boundingSphere = BoundingSphere(XMFLOAT3(0.5f, 0.5f, 0.5f), 0.8660254f);
+}
+
+
 // --------------------------------------------------------
 // Destructor to clean up memory objects
 // --------------------------------------------------------
 Mesh::~Mesh()
 {
-
+	// Give our space back to the arena
+	if (arena)
+		arena->Free(range);
 }
 
 
 Microsoft::WRL::ComPtr<ID3D11Buffer> Mesh::GetVertexBuffer()
 {
-	return vertexBuffer;
+	return arena ? arena->GetVertexBuffer() : vertexBuffer;
 }
 
 Microsoft::WRL::ComPtr<ID3D11Buffer> Mesh::GetIndexBuffer()
 {
-	return indexBuffer;
+	return arena ? arena->GetIndexBuffer() : indexBuffer;
+}
+
+Microsoft::WRL::ComPtr<ID3D11Buffer> Mesh::GetPositionBuffer()
+{
+	return arena ? arena->GetPositionBuffer() : positionBuffer;
 }
 
 int Mesh::GetVertexCount()
@@ -82,15 +241,142 @@ int Mesh::GetIndexCount()
 	return numIndices;
 }
 
-void Mesh::Draw()
+unsigned int Mesh::GetBaseVertex()
+{
+	return arena ? range.BaseVertex : 0;
+}
+
+unsigned int Mesh::GetStartIndex()
+{
+	return arena ? range.StartIndex : 0;
+}
+
+BoundingBox Mesh::GetBoundingBox()
+{
+	return boundingBox;
+}
+
+BoundingSphere Mesh::GetBoundingSphere()
+{
+	return boundingSphere;
+}
+
+// --------------------------------------------------------
+// Overrides the bounds, for loaders that already have them
+// --------------------------------------------------------
+void Mesh::SetBounds(const BoundingBox& box, const BoundingSphere& sphere)
+{
+	boundingBox = box;
+	boundingSphere = sphere;
+}
+
+void Mesh::Draw(RenderContext& context)
 {
-	UINT stride = sizeof(Vertex);
-	UINT offset = 0;
-	Graphics::Context->IASetVertexBuffers(0, 1, this->GetVertexBuffer().GetAddressOf(), &stride, &offset);
-	Graphics::Context->IASetIndexBuffer(this->GetIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
+	if (numIndices == 0)
+		return;
 
-	Graphics::Context->DrawIndexed(
+	// Arena meshes share their buffers, so binding is usually filtered out
+	if (arena)
+	{
+		arena->Bind(context);
+	}
+	else
+	{
+		context.SetVertexBuffer(0, vertexBuffer.Get(), vertexStride, 0);
+		context.SetIndexBuffer(indexBuffer.Get());
+	}
+
+	context.DrawIndexed(
 		this->GetIndexCount(),
-		0,
+		this->GetStartIndex(),
+		this->GetBaseVertex());
+}
+
+// --------------------------------------------------------
+// Draws with only the position stream bound, fetching 12
+// bytes per vertex instead of the whole vertex
+//  - For depth-only, shadow and occlusion passes
+//  - Requires the position-only input layout
+// --------------------------------------------------------
+void Mesh::DrawPositionOnly(RenderContext& context)
+{
+	if (numIndices == 0)
+		return;
+
+	if (arena)
+	{
+		arena->BindPositions(context);
+	}
+	else
+	{
+		context.SetVertexBuffer(0, positionBuffer.Get(), sizeof(XMFLOAT3), 0);
+		context.SetIndexBuffer(indexBuffer.Get());
+	}
+
+	context.DrawIndexed(
+		this->GetIndexCount(),
+		this->GetStartIndex(),
+		this->GetBaseVertex());
+}
+
+// --------------------------------------------------------
+// Makes sure the shared instance buffer holds this many
+// instances, replacing it with a bigger one if not
+//  - Call with the frame's total before recording any
+//    DrawInstanced(), since a recorded command only keeps
+//    the raw buffer pointer - replacing the buffer part way
+//    through would leave earlier commands pointing at a
+//    released one
+// --------------------------------------------------------
+void Mesh::ReserveInstances(unsigned int count)
+{
+	if (count <= instanceCapacity)
+		return;
+
+	instanceCapacity = count * 2;
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.ByteWidth = sizeof(InstanceData) * instanceCapacity;
+	desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	instanceBuffer.Reset();
+	Graphics::Device->CreateBuffer(&desc, 0, instanceBuffer.GetAddressOf());
+}
+
+// --------------------------------------------------------
+// Draws this mesh once per instance in a single call
+//  - The instance data is copied into a shared dynamic
+//    buffer and bound to vertex buffer slot 1
+//  - Requires the instanced input layout and vertex shader
+//  - Skipped if ReserveInstances() wasn't given room for it
+// --------------------------------------------------------
+void Mesh::DrawInstanced(RenderContext& context, std::span<const InstanceData> instances)
+{
+	unsigned int count = (unsigned int)instances.size();
+	if (count == 0 || count > instanceCapacity || numIndices == 0)
+		return;
+
+	// Upload this draw's instances
+	context.UploadBuffer(instanceBuffer.Get(), instances.data(), sizeof(InstanceData) * count);
+
+	// Slot 0 holds the mesh's vertices, slot 1 the instances
+	if (arena)
+	{
+		arena->Bind(context);
+	}
+	else
+	{
+		context.SetVertexBuffer(0, vertexBuffer.Get(), vertexStride, 0);
+		context.SetIndexBuffer(indexBuffer.Get());
+	}
+	context.SetVertexBuffer(1, instanceBuffer.Get(), sizeof(InstanceData), 0);
+
+	context.DrawIndexedInstanced(
+		this->GetIndexCount(),
+		count,
+		this->GetStartIndex(),
+		this->GetBaseVertex(),
 		0);
-}
\ No newline at end of file
+}
@@ -1,15 +1,28 @@
 #pragma once
 #include <d3d11.h>
 #include <wrl/client.h>
+#include <DirectXCollision.h>
+#include <memory>
+#include <span>
+#include <vector>
 
 #include "Graphics.h"
 #include "Vertex.h"
+#include "PackedVertex.h"
+#include "GeometryArena.h"
+#include "InstanceData.h"
+#include "RenderContext.h"
 
 class Mesh
 {
 public:
 	// Basic OOP Setup
 	Mesh(Vertex vertices[], int verticesSize, unsigned int indices[], int indicesSize);
+	Mesh(PackedVertex vertices[], int verticesSize, unsigned int indices[], int indicesSize);
+	Mesh(PackedLitVertex vertices[], int verticesSize, unsigned int indices[], int indicesSize);
+	Mesh(Vertex vertices[], int verticesSize, unsigned int indices[], int indicesSize,
+		const DirectX::BoundingBox& box, const DirectX::BoundingSphere& sphere);
+	Mesh(std::shared_ptr<GeometryArena> arena, Vertex vertices[], int verticesSize, unsigned int indices[], int indicesSize);
 	~Mesh();
 	Mesh(const Mesh&) = delete;
 	Mesh& operator = (const Mesh&) = delete;
@@ -17,19 +30,50 @@ public:
 	// Public Methods
 	Microsoft::WRL::ComPtr<ID3D11Buffer> GetVertexBuffer();
 	Microsoft::WRL::ComPtr<ID3D11Buffer> GetIndexBuffer();
+	Microsoft::WRL::ComPtr<ID3D11Buffer> GetPositionBuffer();
 	int GetIndexCount();
 	int GetVertexCount();
-	void Draw();
+	unsigned int GetBaseVertex();
+	unsigned int GetStartIndex();
+	DirectX::BoundingBox GetBoundingBox();
+	DirectX::BoundingSphere GetBoundingSphere();
+	void SetBounds(const DirectX::BoundingBox& box, const DirectX::BoundingSphere& sphere);
+	void Draw(RenderContext& context);
+	void DrawPositionOnly(RenderContext& context);
+	void DrawInstanced(RenderContext& context, std::span<const InstanceData> instances);
+
+	// Sizes the instance buffer every DrawInstanced() shares - call
+	// before recording a frame's instanced draws, with their total
+	static void ReserveInstances(unsigned int count);
 
 private:
+	// Shared buffer creation for every vertex format
+	void CreateBuffers(const void* vertices, unsigned int stride, unsigned int indices[], const DirectX::XMFLOAT3* positions);
+	void SetQuantizedBounds();
+
 	// Buffers for geometric data
 	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
 
+	// Just the positions, one XMFLOAT3 per vertex, for position-only passes
+	Microsoft::WRL::ComPtr<ID3D11Buffer> positionBuffer;
+
 	// Integers for keeping track of vertext and index buffer numbers
 	int numVertices;
 	int numIndices;
 
+	// Size of one vertex in the vertex buffer
+	unsigned int vertexStride;
+
+	// Shared buffers this mesh lives in, if any
+	// - When set, vertexBuffer and indexBuffer are unused
+	std::shared_ptr<GeometryArena> arena;
+	GeometryRange range;
+
+	// Local space extents, for culling
+	DirectX::BoundingBox boundingBox;
+	DirectX::BoundingSphere boundingSphere;
+
 };
 
 
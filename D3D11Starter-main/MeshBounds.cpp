@@ -0,0 +1,174 @@
+#include "MeshBounds.h"
+
+#include <cmath>
+#include <cstdint>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Each refinement pass starts from a sphere this much smaller
+	const float shrinkFactor = 0.95f;
+
+	XMVECTOR LoadPosition(const void* positions, int i, unsigned int stride)
+	{
+		const uint8_t* bytes = (const uint8_t*)positions + (size_t)i * stride;
+		return XMLoadFloat3((const XMFLOAT3*)bytes);
+	}
+
+	// Grows the sphere just enough to include every point,
+	// visiting them starting at `start` and wrapping around
+	void GrowToFit(XMVECTOR& center, float& radius, const void* positions, int count, unsigned int stride, int start)
+	{
+		for (int n = 0; n < count; n++)
+		{
+			XMVECTOR p = LoadPosition(positions, (start + n) % count, stride);
+			XMVECTOR toPoint = XMVectorSubtract(p, center);
+			float distSq = XMVectorGetX(XMVector3LengthSq(toPoint));
+			if (distSq <= radius * radius)
+				continue;
+
+			// New sphere touches the far side of the old one and the point
+			float dist = std::sqrt(distSq);
+			float newRadius = (radius + dist) * 0.5f;
+			center = XMVectorAdd(center, XMVectorScale(toPoint, (newRadius - radius) / dist));
+			radius = newRadius;
+		}
+	}
+
+	XMVECTOR Farthest(XMVECTOR from, const void* positions, int count, unsigned int stride)
+	{
+		XMVECTOR best = from;
+		float bestDistSq = -1.0f;
+		for (int i = 0; i < count; i++)
+		{
+			XMVECTOR p = LoadPosition(positions, i, stride);
+			float distSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(p, from)));
+			if (distSq > bestDistSq)
+			{
+				bestDistSq = distSq;
+				best = p;
+			}
+		}
+		return best;
+	}
+}
+
+// --------------------------------------------------------
+// Min/max over all positions, four at a time so the
+// reductions don't wait on each other
+// --------------------------------------------------------
+BoundingBox MeshBounds::ComputeBox(const void* positions, int count, unsigned int stride)
+{
+	BoundingBox box(XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 0));
+	if (count <= 0)
+		return box;
+
+	XMVECTOR first = LoadPosition(positions, 0, stride);
+	XMVECTOR min0 = first, min1 = first, min2 = first, min3 = first;
+	XMVECTOR max0 = first, max1 = first, max2 = first, max3 = first;
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		XMVECTOR p0 = LoadPosition(positions, i + 0, stride);
+		XMVECTOR p1 = LoadPosition(positions, i + 1, stride);
+		XMVECTOR p2 = LoadPosition(positions, i + 2, stride);
+		XMVECTOR p3 = LoadPosition(positions, i + 3, stride);
+		min0 = XMVectorMin(min0, p0); max0 = XMVectorMax(max0, p0);
+		min1 = XMVectorMin(min1, p1); max1 = XMVectorMax(max1, p1);
+		min2 = XMVectorMin(min2, p2); max2 = XMVectorMax(max2, p2);
+		min3 = XMVectorMin(min3, p3); max3 = XMVectorMax(max3, p3);
+	}
+	for (; i < count; i++)
+	{
+		XMVECTOR p = LoadPosition(positions, i, stride);
+		min0 = XMVectorMin(min0, p);
+		max0 = XMVectorMax(max0, p);
+	}
+
+	XMVECTOR vMin = XMVectorMin(XMVectorMin(min0, min1), XMVectorMin(min2, min3));
+	XMVECTOR vMax = XMVectorMax(XMVectorMax(max0, max1), XMVectorMax(max2, max3));
+	BoundingBox::CreateFromPoints(box, vMin, vMax);
+	return box;
+}
+
+BoundingSphere MeshBounds::ComputeSphere(const void* positions, int count, unsigned int stride, int refinementPasses)
+{
+	BoundingSphere sphere(XMFLOAT3(0, 0, 0), 0.0f);
+	if (count <= 0)
+		return sphere;
+
+	// Ritter - start from two far-apart points
+	XMVECTOR a = Farthest(LoadPosition(positions, 0, stride), positions, count, stride);
+	XMVECTOR b = Farthest(a, positions, count, stride);
+	XMVECTOR center = XMVectorScale(XMVectorAdd(a, b), 0.5f);
+	float radius = XMVectorGetX(XMVector3Length(XMVectorSubtract(b, a))) * 0.5f;
+	GrowToFit(center, radius, positions, count, stride, 0);
+
+	// Refinement - shrink, regrow from a different starting point,
+	// and keep the result if it came out smaller
+	XMVECTOR bestCenter = center;
+	float bestRadius = radius;
+	for (int pass = 0; pass < refinementPasses; pass++)
+	{
+		XMVECTOR tryCenter = bestCenter;
+		float tryRadius = bestRadius * shrinkFactor;
+		int start = (int)(((long long)count * (pass + 1)) / (refinementPasses + 1));
+		GrowToFit(tryCenter, tryRadius, positions, count, stride, start);
+
+		if (tryRadius < bestRadius)
+		{
+			bestCenter = tryCenter;
+			bestRadius = tryRadius;
+		}
+	}
+
+	XMStoreFloat3(&sphere.Center, bestCenter);
+	sphere.Radius = bestRadius;
+	return sphere;
+}
+
+// --------------------------------------------------------
+// Gribb/Hartmann plane extraction - each plane is a sum or
+// difference of the matrix columns. D3D's clip space z
+// starts at 0, so the near plane is just the third column.
+// --------------------------------------------------------
+void MeshBounds::ExtractFrustumPlanes(const XMFLOAT4X4& m, XMFLOAT4 planes[6])
+{
+	XMVECTOR col0 = XMVectorSet(m._11, m._21, m._31, m._41);
+	XMVECTOR col1 = XMVectorSet(m._12, m._22, m._32, m._42);
+	XMVECTOR col2 = XMVectorSet(m._13, m._23, m._33, m._43);
+	XMVECTOR col3 = XMVectorSet(m._14, m._24, m._34, m._44);
+
+	XMVECTOR raw[6] =
+	{
+		XMVectorAdd(col3, col0),		// Left
+		XMVectorSubtract(col3, col0),	// Right
+		XMVectorAdd(col3, col1),		// Bottom
+		XMVectorSubtract(col3, col1),	// Top
+		col2,							// Near
+		XMVectorSubtract(col3, col2),	// Far
+	};
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = XMVectorGetX(XMVector3Length(raw[i]));
+		if (length > 0.0f)
+			raw[i] = XMVectorScale(raw[i], 1.0f / length);
+		XMStoreFloat4(&planes[i], raw[i]);
+	}
+}
+
+bool MeshBounds::SphereInFrustum(const XMFLOAT4 planes[6], const XMFLOAT3& center, float radius)
+{
+	XMVECTOR c = XMVectorSetW(XMLoadFloat3(&center), 1.0f);
+	for (int i = 0; i < 6; i++)
+	{
+		if (XMVectorGetX(XMVector4Dot(XMLoadFloat4(&planes[i]), c)) < -radius)
+			return false;
+	}
+	return true;
+}
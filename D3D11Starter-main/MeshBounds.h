@@ -0,0 +1,28 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+
+// --------------------------------------------------------
+// Bounding volume helpers for vertex data
+//
+// Positions are read through a byte stride, so any vertex
+// format whose first member is an XMFLOAT3 can be passed
+// straight in, e.g.:
+//
+//   MeshBounds::ComputeBox(vertices, count, sizeof(Vertex));
+// --------------------------------------------------------
+namespace MeshBounds
+{
+	// Axis-aligned box from a SIMD min/max reduction
+	DirectX::BoundingBox ComputeBox(const void* positions, int count, unsigned int stride);
+
+	// Tight sphere - Ritter's sphere, then a few shrink-and-regrow
+	// refinement passes that keep whichever sphere is smallest
+	DirectX::BoundingSphere ComputeSphere(const void* positions, int count, unsigned int stride, int refinementPasses = 8);
+
+	// Frustum planes (left, right, bottom, top, near, far) of a row-vector
+	// view-projection matrix, normalized so plane distances are in world units
+	void ExtractFrustumPlanes(const DirectX::XMFLOAT4X4& viewProjection, DirectX::XMFLOAT4 planes[6]);
+	bool SphereInFrustum(const DirectX::XMFLOAT4 planes[6], const DirectX::XMFLOAT3& center, float radius);
+}
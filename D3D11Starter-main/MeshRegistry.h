@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Mesh.h"
+#include "SlotRegistry.h"
+
+// --------------------------------------------------------
+// Owns the game's meshes and hands out 32-bit MeshIDs
+//
+// Destroy() invalidates the ID straight away, but the mesh
+// (and its buffers) lives on until framesInFlight more
+// calls to AdvanceFrame(), so frames that are still queued
+// up can finish with it. Call AdvanceFrame() once per
+// frame, after the frame's draws have been handed off.
+// --------------------------------------------------------
+using MeshID = SlotID;
+using MeshRegistry = SlotRegistry<Mesh>;
@@ -0,0 +1,569 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// How much more a border constraint plane counts than a face plane
+	const double borderWeight = 10.0;
+
+	// Collapses that would tilt a face further than this (cosine) are rejected
+	const float minFlipDot = 0.2f;
+
+	// --------------------------------------------------------
+	// Symmetric 4x4 quadric (sum of squared plane distances)
+	// plus the total area that contributed to it
+	// --------------------------------------------------------
+	struct Quadric
+	{
+		double a2, ab, ac, ad;
+		double b2, bc, bd;
+		double c2, cd;
+		double d2;
+		double area;
+
+		void AddPlane(double a, double b, double c, double d, double weight)
+		{
+			a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+			b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+			c2 += weight * c * c; cd += weight * c * d;
+			d2 += weight * d * d;
+		}
+
+		void Add(const Quadric& q)
+		{
+			a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+			b2 += q.b2; bc += q.bc; bd += q.bd;
+			c2 += q.c2; cd += q.cd;
+			d2 += q.d2;
+			area += q.area;
+		}
+
+		double Evaluate(const XMFLOAT3& p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			return
+				a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+				b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+				c2 * z * z + 2 * cd * z +
+				d2;
+		}
+	};
+
+	// A candidate collapse of From onto To, valid only while
+	// both vertices still have the versions it was built with
+	// - Cost orders the collapses and includes the attribute
+	//   term; Error is the positional part alone, in local units
+	struct Collapse
+	{
+		float Cost;
+		float Error;
+		unsigned int From;
+		unsigned int To;
+		unsigned int FromVersion;
+		unsigned int ToVersion;
+
+		bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+	};
+
+	uint64_t EdgeKey(unsigned int a, unsigned int b)
+	{
+		if (a > b) std::swap(a, b);
+		return ((uint64_t)a << 32) | b;
+	}
+
+	// --------------------------------------------------------
+	// Incremental edge-collapse simplifier
+	//
+	// - Vertex -> triangle adjacency is a linked list of
+	//   triangle corners, so merging two vertices is O(1)
+	// - The priority queue is a flat binary heap with lazy
+	//   invalidation through per-vertex version numbers,
+	//   which keeps it cheap for millions of edges
+	// --------------------------------------------------------
+	class Simplifier
+	{
+	public:
+		Simplifier(
+			const Vertex* vertices, int vertexCount,
+			const unsigned int* indices, int indexCount,
+			bool lockBorders, float attributeWeight)
+			: vertices(vertices),
+			indices(indices, indices + (indexCount / 3) * 3),
+			lockBorders(lockBorders),
+			attributeWeight(attributeWeight)
+		{
+			triangleCount = (unsigned int)this->indices.size() / 3;
+			liveTriangles = triangleCount;
+
+			quadrics.assign(vertexCount, Quadric{});
+			alive.assign(vertexCount, 1);
+			isBorder.assign(vertexCount, 0);
+			version.assign(vertexCount, 0);
+			head.assign(vertexCount, -1);
+			tail.assign(vertexCount, -1);
+			cornerNext.assign(this->indices.size(), -1);
+			triangleAlive.assign(triangleCount, 1);
+
+			BuildAdjacency();
+			BuildQuadrics();
+			BuildHeap();
+		}
+
+		// Collapses edges until either limit is reached
+		// - The heap is ordered by cost, not error, so collapses over
+		//   the error limit are skipped rather than ending the run
+		void Run(unsigned int targetTriangles, float targetError)
+		{
+			while (liveTriangles > targetTriangles && !heap.empty())
+			{
+				Collapse top = heap.front();
+				std::pop_heap(heap.begin(), heap.end(), std::greater<Collapse>());
+				heap.pop_back();
+
+				// Stale entry?
+				if (!alive[top.From] || !alive[top.To] ||
+					version[top.From] != top.FromVersion ||
+					version[top.To] != top.ToVersion)
+					continue;
+
+				if (top.Error > targetError)
+					continue;
+
+				if (BreaksManifold(top.From, top.To) || FlipsTriangles(top.From, top.To))
+					continue;
+
+				Apply(top.From, top.To);
+				maxError = std::max(maxError, top.Error);
+			}
+		}
+
+		// Copies out the current live triangles
+		MeshLOD Snapshot() const
+		{
+			MeshLOD lod;
+			lod.Indices.reserve(liveTriangles * 3);
+			for (unsigned int t = 0; t < triangleCount; t++)
+			{
+				if (!triangleAlive[t])
+					continue;
+				lod.Indices.insert(lod.Indices.end(), &indices[t * 3], &indices[t * 3] + 3);
+			}
+			lod.Error = maxError;
+			return lod;
+		}
+
+		unsigned int LiveTriangles() const { return liveTriangles; }
+
+	private:
+		const Vertex* vertices;
+		std::vector<unsigned int> indices;
+		bool lockBorders;
+		float attributeWeight;
+
+		unsigned int triangleCount = 0;
+		unsigned int liveTriangles = 0;
+		float maxError = 0.0f;
+
+		std::vector<Quadric> quadrics;
+		std::vector<uint8_t> alive;
+		std::vector<uint8_t> isBorder;
+		std::vector<unsigned int> version;
+		std::vector<int> head;
+		std::vector<int> tail;
+		std::vector<int> cornerNext;
+		std::vector<uint8_t> triangleAlive;
+		std::vector<uint64_t> borderEdges;
+		std::vector<Collapse> heap;
+		std::vector<unsigned int> scratch;
+		std::vector<unsigned int> fromRing;
+		std::vector<unsigned int> toRing;
+
+		const XMFLOAT3& Position(unsigned int v) const { return vertices[v].Position; }
+
+		void BuildAdjacency()
+		{
+			for (unsigned int c = 0; c < indices.size(); c++)
+			{
+				unsigned int v = indices[c];
+				if (tail[v] < 0) head[v] = (int)c;
+				else cornerNext[tail[v]] = (int)c;
+				tail[v] = (int)c;
+			}
+		}
+
+		void BuildQuadrics()
+		{
+			// Face planes, weighted by area
+			for (unsigned int t = 0; t < triangleCount; t++)
+			{
+				XMVECTOR p0 = XMLoadFloat3(&Position(indices[t * 3 + 0]));
+				XMVECTOR p1 = XMLoadFloat3(&Position(indices[t * 3 + 1]));
+				XMVECTOR p2 = XMLoadFloat3(&Position(indices[t * 3 + 2]));
+				XMVECTOR n = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+				float length = XMVectorGetX(XMVector3Length(n));
+				if (length <= 0.0f)
+					continue;
+
+				n = XMVectorScale(n, 1.0f / length);
+				double area = length * 0.5;
+				double d = -XMVectorGetX(XMVector3Dot(n, p0));
+
+				Quadric q = {};
+				q.AddPlane(XMVectorGetX(n), XMVectorGetY(n), XMVectorGetZ(n), d, area);
+				q.area = area;
+				for (int k = 0; k < 3; k++)
+					quadrics[indices[t * 3 + k]].Add(q);
+			}
+
+			// Open edges are the ones used by exactly one triangle
+			std::vector<uint64_t> edges;
+			edges.reserve(indices.size());
+			for (unsigned int t = 0; t < triangleCount; t++)
+				for (int k = 0; k < 3; k++)
+					edges.push_back(EdgeKey(indices[t * 3 + k], indices[t * 3 + (k + 1) % 3]));
+			std::sort(edges.begin(), edges.end());
+
+			for (size_t i = 0; i < edges.size();)
+			{
+				size_t run = i + 1;
+				while (run < edges.size() && edges[run] == edges[i]) run++;
+				if (run - i == 1)
+					borderEdges.push_back(edges[i]);
+				i = run;
+			}
+
+			// Border edges get a constraint plane perpendicular to their face,
+			// so sliding a border vertex inward is expensive
+			for (unsigned int t = 0; t < triangleCount; t++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					unsigned int a = indices[t * 3 + k];
+					unsigned int b = indices[t * 3 + (k + 1) % 3];
+					if (!IsBorderEdge(a, b))
+						continue;
+
+					isBorder[a] = 1;
+					isBorder[b] = 1;
+
+					unsigned int c = indices[t * 3 + (k + 2) % 3];
+					XMVECTOR pa = XMLoadFloat3(&Position(a));
+					XMVECTOR edge = XMVectorSubtract(XMLoadFloat3(&Position(b)), pa);
+					XMVECTOR faceNormal = XMVector3Cross(edge, XMVectorSubtract(XMLoadFloat3(&Position(c)), pa));
+					XMVECTOR n = XMVector3Cross(edge, faceNormal);
+					if (XMVectorGetX(XMVector3LengthSq(n)) <= 0.0f)
+						continue;
+
+					n = XMVector3Normalize(n);
+					double weight = borderWeight * XMVectorGetX(XMVector3LengthSq(edge));
+					double d = -XMVectorGetX(XMVector3Dot(n, pa));
+
+					Quadric q = {};
+					q.AddPlane(XMVectorGetX(n), XMVectorGetY(n), XMVectorGetZ(n), d, weight);
+					quadrics[a].Add(q);
+					quadrics[b].Add(q);
+				}
+			}
+		}
+
+		void BuildHeap()
+		{
+			std::vector<uint64_t> edges;
+			edges.reserve(indices.size());
+			for (unsigned int t = 0; t < triangleCount; t++)
+				for (int k = 0; k < 3; k++)
+					edges.push_back(EdgeKey(indices[t * 3 + k], indices[t * 3 + (k + 1) % 3]));
+			std::sort(edges.begin(), edges.end());
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+			heap.reserve(edges.size());
+			for (uint64_t key : edges)
+				PushEdge((unsigned int)(key >> 32), (unsigned int)(key & 0xFFFFFFFF), false);
+
+			std::make_heap(heap.begin(), heap.end(), std::greater<Collapse>());
+		}
+
+		bool IsBorderEdge(unsigned int a, unsigned int b) const
+		{
+			return std::binary_search(borderEdges.begin(), borderEdges.end(), EdgeKey(a, b));
+		}
+
+		// Squared distance `to` would sit from the planes merged into it
+		// (area-weighted, so an average over the surface it replaces),
+		// or a negative value if the collapse isn't allowed
+		double PositionError(unsigned int from, unsigned int to) const
+		{
+			if (isBorder[from])
+			{
+				// Borders may only slide along themselves
+				if (lockBorders || !IsBorderEdge(from, to))
+					return -1.0;
+			}
+
+			Quadric q = quadrics[from];
+			q.Add(quadrics[to]);
+			double error = q.Evaluate(Position(to));
+			if (q.area > 0.0)
+				error /= q.area;
+			return std::max(error, 0.0);
+		}
+
+		// What the collapse costs on top of its position error - moving
+		// `from` onto `to` gives its corners `to`'s color
+		double AttributeCost(unsigned int from, unsigned int to) const
+		{
+			const XMFLOAT4& ca = vertices[from].Color;
+			const XMFLOAT4& cb = vertices[to].Color;
+			double dr = ca.x - cb.x, dg = ca.y - cb.y, db = ca.z - cb.z, da = ca.w - cb.w;
+			return attributeWeight * (dr * dr + dg * dg + db * db + da * da);
+		}
+
+		// Queues the cheaper direction of an edge
+		void PushEdge(unsigned int a, unsigned int b, bool keepHeap)
+		{
+			double errorAB = PositionError(a, b);
+			double errorBA = PositionError(b, a);
+			if (errorAB < 0.0 && errorBA < 0.0)
+				return;
+
+			// The attribute cost is the same both ways round
+			double attributeCost = AttributeCost(a, b);
+			bool useAB = errorBA < 0.0 || (errorAB >= 0.0 && errorAB <= errorBA);
+
+			Collapse collapse = {};
+			collapse.From = useAB ? a : b;
+			collapse.To = useAB ? b : a;
+			collapse.Error = (float)std::sqrt(useAB ? errorAB : errorBA);
+			collapse.Cost = (float)((useAB ? errorAB : errorBA) + attributeCost);
+			collapse.FromVersion = version[collapse.From];
+			collapse.ToVersion = version[collapse.To];
+
+			heap.push_back(collapse);
+			if (keepHeap)
+				std::push_heap(heap.begin(), heap.end(), std::greater<Collapse>());
+		}
+
+		// --------------------------------------------------------
+		// The link condition: the only vertices both ends may share
+		// are the far corners of the faces on the edge itself.
+		// Any other shared neighbor means the collapse would fold
+		// two faces onto each other or pinch the surface into a
+		// non-manifold edge.
+		// --------------------------------------------------------
+		bool BreaksManifold(unsigned int from, unsigned int to)
+		{
+			unsigned int edgeFaces = 0;
+			GatherRing(from, to, fromRing, edgeFaces);
+			unsigned int unused = 0;
+			GatherRing(to, from, toRing, unused);
+
+			unsigned int shared = 0;
+			for (size_t i = 0, j = 0; i < fromRing.size() && j < toRing.size();)
+			{
+				if (fromRing[i] < toRing[j]) i++;
+				else if (toRing[j] < fromRing[i]) j++;
+				else { shared++; i++; j++; }
+			}
+			if (shared > edgeFaces)
+				return true;
+
+			// A tetrahedron passes the link condition, but collapsing
+			// any of its edges folds it flat onto two back-to-back faces
+			size_t ringUnion = fromRing.size() + toRing.size() - shared;
+			return ringUnion + 2 <= 4;
+		}
+
+		// The sorted, distinct neighbors of v (other than `other`),
+		// counting the live faces that also use `other`
+		void GatherRing(unsigned int v, unsigned int other, std::vector<unsigned int>& ring, unsigned int& facesWithOther) const
+		{
+			ring.clear();
+			for (int c = head[v]; c >= 0; c = cornerNext[c])
+			{
+				unsigned int t = c / 3;
+				if (!triangleAlive[t])
+					continue;
+
+				const unsigned int* tri = &indices[t * 3];
+				if (tri[0] == other || tri[1] == other || tri[2] == other)
+					facesWithOther++;
+				for (int k = 0; k < 3; k++)
+					if (tri[k] != v && tri[k] != other)
+						ring.push_back(tri[k]);
+			}
+			std::sort(ring.begin(), ring.end());
+			ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+		}
+
+		// Would moving `from` onto `to` turn any remaining face over?
+		bool FlipsTriangles(unsigned int from, unsigned int to) const
+		{
+			XMVECTOR target = XMLoadFloat3(&Position(to));
+			for (int c = head[from]; c >= 0; c = cornerNext[c])
+			{
+				unsigned int t = c / 3;
+				if (!triangleAlive[t])
+					continue;
+
+				unsigned int v0 = indices[t * 3 + 0];
+				unsigned int v1 = indices[t * 3 + 1];
+				unsigned int v2 = indices[t * 3 + 2];
+				if (v0 == to || v1 == to || v2 == to)
+					continue; // This face disappears
+
+				XMVECTOR p0 = XMLoadFloat3(&Position(v0));
+				XMVECTOR p1 = XMLoadFloat3(&Position(v1));
+				XMVECTOR p2 = XMLoadFloat3(&Position(v2));
+				XMVECTOR before = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+
+				if (v0 == from) p0 = target;
+				if (v1 == from) p1 = target;
+				if (v2 == from) p2 = target;
+				XMVECTOR after = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+
+				float afterLength = XMVectorGetX(XMVector3Length(after));
+				float beforeLength = XMVectorGetX(XMVector3Length(before));
+				if (afterLength <= 0.0f)
+					return true;
+				if (beforeLength > 0.0f &&
+					XMVectorGetX(XMVector3Dot(before, after)) < minFlipDot * beforeLength * afterLength)
+					return true;
+			}
+			return false;
+		}
+
+		void Apply(unsigned int from, unsigned int to)
+		{
+			alive[from] = 0;
+			quadrics[to].Add(quadrics[from]);
+			version[to]++;
+
+			// Retarget from's corners, dropping faces that now collapse
+			for (int c = head[from]; c >= 0; c = cornerNext[c])
+			{
+				unsigned int t = c / 3;
+				if (!triangleAlive[t])
+					continue;
+
+				unsigned int* tri = &indices[t * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to)
+				{
+					triangleAlive[t] = 0;
+					liveTriangles--;
+					continue;
+				}
+				indices[c] = to;
+			}
+
+			// Splice from's corner list onto to's
+			if (head[from] >= 0)
+			{
+				if (tail[to] < 0) head[to] = head[from];
+				else cornerNext[tail[to]] = head[from];
+				tail[to] = tail[from];
+			}
+			head[from] = tail[from] = -1;
+
+			// Requeue every edge around the merged vertex
+			scratch.clear();
+			for (int c = head[to]; c >= 0; c = cornerNext[c])
+			{
+				unsigned int t = c / 3;
+				if (!triangleAlive[t])
+					continue;
+				for (int k = 0; k < 3; k++)
+					if (indices[t * 3 + k] != to)
+						scratch.push_back(indices[t * 3 + k]);
+			}
+			std::sort(scratch.begin(), scratch.end());
+			scratch.erase(std::unique(scratch.begin(), scratch.end()), scratch.end());
+
+			for (unsigned int neighbor : scratch)
+				PushEdge(to, neighbor, true);
+		}
+	};
+}
+
+MeshLOD MeshSimplifier::Simplify(
+	const Vertex* vertices, int vertexCount,
+	const unsigned int* indices, int indexCount,
+	const SimplifyOptions& options)
+{
+	Simplifier simplifier(vertices, vertexCount, indices, indexCount, options.LockBorders, options.AttributeWeight);
+	simplifier.Run(options.TargetTriangleCount, options.TargetError);
+	return simplifier.Snapshot();
+}
+
+// --------------------------------------------------------
+// One simplification pass that snapshots each level as the
+// triangle count passes it, so the errors of later levels
+// include everything removed by earlier ones
+// --------------------------------------------------------
+std::vector<MeshLOD> MeshSimplifier::BuildLODChain(
+	const Vertex* vertices, int vertexCount,
+	const unsigned int* indices, int indexCount,
+	int levelCount,
+	float reduction,
+	bool lockBorders)
+{
+	std::vector<MeshLOD> lods;
+	if (levelCount <= 0)
+		return lods;
+
+	SimplifyOptions defaults;
+	Simplifier simplifier(vertices, vertexCount, indices, indexCount, lockBorders, defaults.AttributeWeight);
+	lods.push_back(simplifier.Snapshot());
+
+	float target = (float)simplifier.LiveTriangles();
+	for (int level = 1; level < levelCount; level++)
+	{
+		target *= reduction;
+		simplifier.Run((unsigned int)target, defaults.TargetError);
+
+		// Stop early if the mesh can't get any simpler
+		if (simplifier.LiveTriangles() * 3 >= lods.back().Indices.size())
+			break;
+
+		lods.push_back(simplifier.Snapshot());
+	}
+
+	return lods;
+}
+
+// --------------------------------------------------------
+// Projects each LOD's error to pixels:
+//
+//   pixels = error * (projection._22 * screenHeight / 2) / distance
+//
+// where projection._22 is cot(fov / 2) for a perspective
+// projection from XMMatrixPerspectiveFovLH
+// --------------------------------------------------------
+int MeshSimplifier::SelectLOD(
+	const std::vector<MeshLOD>& lods,
+	float distance,
+	const XMFLOAT4X4& projection,
+	float screenHeight,
+	float maxPixelError)
+{
+	if (lods.empty())
+		return -1;
+
+	float pixelsPerUnit = projection._22 * screenHeight * 0.5f / std::max(distance, 1e-4f);
+
+	int selected = 0;
+	for (int i = 1; i < (int)lods.size(); i++)
+	{
+		if (lods[i].Error * pixelsPerUnit > maxPixelError)
+			break;
+		selected = i;
+	}
+	return selected;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+#include "Vertex.h"
+
+// --------------------------------------------------------
+// Quadric error metric (QEM) mesh simplification
+//
+// Simplification only rewrites the index buffer: every
+// edge collapse moves one vertex onto the other endpoint,
+// so all levels of detail can share the original vertex
+// buffer and keep its attributes exactly.
+//
+// Collapses are ordered by position error plus an attribute
+// term, but only the position error is reported or compared
+// with TargetError. Collapses that would break the surface's
+// manifoldness (the link condition) or turn a face over are
+// never made.
+// --------------------------------------------------------
+
+// Options for a single simplification
+struct SimplifyOptions
+{
+	unsigned int TargetTriangleCount = 0;	// Stop once this many triangles remain
+	float TargetError = 1e30f;				// Skip collapses that would move the surface further than this (local units)
+	bool LockBorders = false;				// Never move vertices on open edges
+	float AttributeWeight = 0.01f;			// Extra cost per unit of squared color difference (orders collapses, never counts as error)
+};
+
+// One level of detail - indices into the original vertices
+struct MeshLOD
+{
+	std::vector<unsigned int> Indices;
+	float Error;	// Largest position error of any collapse so far (local units, RMS over the surface it replaced)
+};
+
+namespace MeshSimplifier
+{
+	// Simplifies down to a target triangle count and/or error
+	MeshLOD Simplify(
+		const Vertex* vertices, int vertexCount,
+		const unsigned int* indices, int indexCount,
+		const SimplifyOptions& options);
+
+	// Builds levelCount LODs, each with roughly `reduction` times the
+	// triangles of the previous one. Level 0 is the original mesh.
+	std::vector<MeshLOD> BuildLODChain(
+		const Vertex* vertices, int vertexCount,
+		const unsigned int* indices, int indexCount,
+		int levelCount = 5,
+		float reduction = 0.5f,
+		bool lockBorders = false);
+
+	// Picks the coarsest LOD whose error projects to at most maxPixelError
+	// pixels on screen. Pass the camera's projection (Camera::GetProjection())
+	// and the distance from the eye to the nearest point of the mesh bounds.
+	int SelectLOD(
+		const std::vector<MeshLOD>& lods,
+		float distance,
+		const DirectX::XMFLOAT4X4& projection,
+		float screenHeight,
+		float maxPixelError = 1.0f);
+}
@@ -0,0 +1,303 @@
+#include "MeshTangents.h"
+#include "WorkerPool.h"
+
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Below this many triangles per chunk, splitting isn't worth the merge
+	// - Chunks depend on the triangle count alone, never the thread
+	//   count, so every pool (or none) sums in the same order
+	const unsigned int minTrianglesPerChunk = 16384;
+	const unsigned int maxChunks = 64;
+
+	// What a triangle adds to each of its vertices' tangent frame
+	struct TangentSum
+	{
+		XMFLOAT3 Tangent;
+		XMFLOAT3 Bitangent;
+	};
+
+	void Add(XMFLOAT3& sum, const XMFLOAT3& value)
+	{
+		sum.x += value.x;
+		sum.y += value.y;
+		sum.z += value.z;
+	}
+
+	void Add(TangentSum& sum, const TangentSum& value)
+	{
+		Add(sum.Tangent, value.Tangent);
+		Add(sum.Bitangent, value.Bitangent);
+	}
+
+	// --------------------------------------------------------
+	// Interior angle of a triangle at each corner
+	// --------------------------------------------------------
+	void CornerAngles(FXMVECTOR p0, FXMVECTOR p1, FXMVECTOR p2, float angles[3])
+	{
+		XMVECTOR e01 = XMVector3Normalize(XMVectorSubtract(p1, p0));
+		XMVECTOR e12 = XMVector3Normalize(XMVectorSubtract(p2, p1));
+		XMVECTOR e20 = XMVector3Normalize(XMVectorSubtract(p0, p2));
+
+		auto angle = [](FXMVECTOR a, FXMVECTOR b)
+			{
+				return std::acos(std::clamp(XMVectorGetX(XMVector3Dot(a, b)), -1.0f, 1.0f));
+			};
+
+		angles[0] = angle(e01, XMVectorNegate(e20));
+		angles[1] = angle(e12, XMVectorNegate(e01));
+		angles[2] = angle(e20, XMVectorNegate(e12));
+	}
+
+	// v with its component along unit normal n removed, then normalized
+	XMVECTOR ProjectOntoPlane(FXMVECTOR v, FXMVECTOR n)
+	{
+		return XMVector3Normalize(XMVectorSubtract(v, XMVectorMultiply(n, XMVector3Dot(n, v))));
+	}
+
+	// --------------------------------------------------------
+	// Runs body(begin, end) over [0, count), spread across the
+	// pool if there is one
+	// --------------------------------------------------------
+	template <typename Body>
+	void ForRange(WorkerPool* pool, unsigned int count, Body body)
+	{
+		if (!pool)
+		{
+			body(0u, count);
+			return;
+		}
+
+		pool->ParallelFor(count, pool->GetThreadCount(),
+			[&](unsigned int, unsigned int begin, unsigned int end) { body(begin, end); });
+	}
+
+	// --------------------------------------------------------
+	// Runs body(chunk, begin, end) for each of chunkCount
+	// chunks of [0, count), with the same boundaries whether
+	// or not there's a pool to spread them across
+	// --------------------------------------------------------
+	template <typename Body>
+	void ForChunks(WorkerPool* pool, unsigned int count, unsigned int chunkCount, Body body)
+	{
+		if (pool)
+		{
+			pool->ParallelFor(count, chunkCount, body);
+			return;
+		}
+
+		for (unsigned int c = 0; c < chunkCount; c++)
+			body(c, (unsigned int)((uint64_t)count * c / chunkCount), (unsigned int)((uint64_t)count * (c + 1) / chunkCount));
+	}
+
+	// --------------------------------------------------------
+	// Sums per-corner contributions into per-vertex totals
+	//
+	// cornerFunc(triangle, Sum out[3]) fills in what a triangle
+	// adds to each of its three corners. Each chunk of triangles
+	// writes only to its own partial array (sized to the range
+	// of vertices it references, which is small for meshes with
+	// any locality), then the partials are merged per vertex in
+	// chunk order so the sums come out the same every run, on
+	// any number of threads.
+	// --------------------------------------------------------
+	template <typename Sum, typename CornerFunc>
+	std::vector<Sum> AccumulateCorners(
+		WorkerPool* pool,
+		int vertexCount,
+		const unsigned int* indices, int indexCount,
+		CornerFunc cornerFunc)
+	{
+		std::vector<Sum> sums(vertexCount, Sum{});
+		unsigned int triangleCount = indexCount / 3;
+
+		unsigned int chunkCount = std::clamp(triangleCount / minTrianglesPerChunk, 1u, maxChunks);
+
+		// Small enough to do in place
+		if (chunkCount == 1)
+		{
+			Sum corners[3];
+			for (unsigned int t = 0; t < triangleCount; t++)
+			{
+				cornerFunc(t, corners);
+				for (int c = 0; c < 3; c++)
+					Add(sums[indices[t * 3 + c]], corners[c]);
+			}
+			return sums;
+		}
+
+		struct Partial
+		{
+			unsigned int FirstVertex;
+			std::vector<Sum> Sums;
+		};
+		std::vector<Partial> partials(chunkCount);
+
+		ForChunks(pool, triangleCount, chunkCount,
+			[&](unsigned int chunk, unsigned int begin, unsigned int end)
+			{
+				const unsigned int* first = indices + begin * 3;
+				const unsigned int* last = indices + end * 3;
+				auto range = std::minmax_element(first, last);
+
+				Partial& partial = partials[chunk];
+				partial.FirstVertex = *range.first;
+				partial.Sums.assign(*range.second - *range.first + 1, Sum{});
+
+				Sum corners[3];
+				for (unsigned int t = begin; t < end; t++)
+				{
+					cornerFunc(t, corners);
+					for (int c = 0; c < 3; c++)
+						Add(partial.Sums[indices[t * 3 + c] - partial.FirstVertex], corners[c]);
+				}
+			});
+
+		// Merge - each thread owns a slice of the vertices, so no two touch the same sum
+		ForRange(pool, (unsigned int)vertexCount,
+			[&](unsigned int begin, unsigned int end)
+			{
+				for (const Partial& partial : partials)
+				{
+					unsigned int from = std::max(begin, partial.FirstVertex);
+					unsigned int to = std::min(end, partial.FirstVertex + (unsigned int)partial.Sums.size());
+					for (unsigned int v = from; v < to; v++)
+						Add(sums[v], partial.Sums[v - partial.FirstVertex]);
+				}
+			});
+
+		return sums;
+	}
+}
+
+void MeshTangents::Expand(const Vertex* vertices, int count, LitVertex* out)
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = {};
+		out[i].Position = vertices[i].Position;
+		out[i].Color = vertices[i].Color;
+	}
+}
+
+void MeshTangents::GenerateNormals(
+	LitVertex* vertices, int vertexCount,
+	const unsigned int* indices, int indexCount,
+	WorkerPool* pool)
+{
+	std::vector<XMFLOAT3> sums = AccumulateCorners<XMFLOAT3>(pool, vertexCount, indices, indexCount,
+		[&](unsigned int t, XMFLOAT3 corners[3])
+		{
+			XMVECTOR p0 = XMLoadFloat3(&vertices[indices[t * 3 + 0]].Position);
+			XMVECTOR p1 = XMLoadFloat3(&vertices[indices[t * 3 + 1]].Position);
+			XMVECTOR p2 = XMLoadFloat3(&vertices[indices[t * 3 + 2]].Position);
+
+			// Clockwise winding, so this points out of the front face
+			XMVECTOR normal = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+			if (XMVectorGetX(XMVector3LengthSq(normal)) <= 0.0f)
+			{
+				corners[0] = corners[1] = corners[2] = XMFLOAT3(0, 0, 0);
+				return;
+			}
+			normal = XMVector3Normalize(normal);
+
+			float angles[3];
+			CornerAngles(p0, p1, p2, angles);
+			for (int c = 0; c < 3; c++)
+				XMStoreFloat3(&corners[c], XMVectorScale(normal, angles[c]));
+		});
+
+	ForRange(pool, (unsigned int)vertexCount,
+		[&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int v = begin; v < end; v++)
+			{
+				XMVECTOR normal = XMLoadFloat3(&sums[v]);
+
+				// Unused or only on degenerate triangles - any unit vector will do
+				if (XMVectorGetX(XMVector3LengthSq(normal)) <= 0.0f)
+					normal = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+
+				XMStoreFloat3(&vertices[v].Normal, XMVector3Normalize(normal));
+			}
+		});
+}
+
+void MeshTangents::GenerateTangents(
+	LitVertex* vertices, int vertexCount,
+	const unsigned int* indices, int indexCount,
+	WorkerPool* pool)
+{
+	std::vector<TangentSum> sums = AccumulateCorners<TangentSum>(pool, vertexCount, indices, indexCount,
+		[&](unsigned int t, TangentSum corners[3])
+		{
+			const LitVertex* v[3] =
+			{
+				&vertices[indices[t * 3 + 0]],
+				&vertices[indices[t * 3 + 1]],
+				&vertices[indices[t * 3 + 2]],
+			};
+			XMVECTOR p0 = XMLoadFloat3(&v[0]->Position);
+			XMVECTOR p1 = XMLoadFloat3(&v[1]->Position);
+			XMVECTOR p2 = XMLoadFloat3(&v[2]->Position);
+			XMVECTOR e1 = XMVectorSubtract(p1, p0);
+			XMVECTOR e2 = XMVectorSubtract(p2, p0);
+
+			float du1 = v[1]->UV.x - v[0]->UV.x;
+			float dv1 = v[1]->UV.y - v[0]->UV.y;
+			float du2 = v[2]->UV.x - v[0]->UV.x;
+			float dv2 = v[2]->UV.y - v[0]->UV.y;
+			float signedArea = du1 * dv2 - du2 * dv1;
+
+			// No UV area (or no area at all) - nothing to say about this triangle
+			for (int c = 0; c < 3; c++)
+				corners[c] = {};
+			if (signedArea == 0.0f || XMVectorGetX(XMVector3LengthSq(XMVector3Cross(e1, e2))) <= 0.0f)
+				return;
+
+			// Directions of increasing u and v across the triangle - only the
+			// direction matters, so divide by the sign of the area, not the area
+			float sign = signedArea > 0.0f ? 1.0f : -1.0f;
+			XMVECTOR tangent = XMVectorScale(XMVectorSubtract(XMVectorScale(e1, dv2), XMVectorScale(e2, dv1)), sign);
+			XMVECTOR bitangent = XMVectorScale(XMVectorSubtract(XMVectorScale(e2, du1), XMVectorScale(e1, du2)), sign);
+
+			float angles[3];
+			CornerAngles(p0, p1, p2, angles);
+			for (int c = 0; c < 3; c++)
+			{
+				XMVECTOR normal = XMLoadFloat3(&v[c]->Normal);
+				XMStoreFloat3(&corners[c].Tangent, XMVectorScale(ProjectOntoPlane(tangent, normal), angles[c]));
+				XMStoreFloat3(&corners[c].Bitangent, XMVectorScale(ProjectOntoPlane(bitangent, normal), angles[c]));
+			}
+		});
+
+	ForRange(pool, (unsigned int)vertexCount,
+		[&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int v = begin; v < end; v++)
+			{
+				XMVECTOR normal = XMLoadFloat3(&vertices[v].Normal);
+				XMVECTOR tangent = XMVectorSubtract(XMLoadFloat3(&sums[v].Tangent),
+					XMVectorMultiply(normal, XMVector3Dot(normal, XMLoadFloat3(&sums[v].Tangent))));
+
+				// No usable UVs - pick any direction perpendicular to the normal
+				if (XMVectorGetX(XMVector3LengthSq(tangent)) <= 1e-12f)
+				{
+					XMVECTOR axis = std::fabs(vertices[v].Normal.x) < 0.9f ? XMVectorSet(1, 0, 0, 0) : XMVectorSet(0, 1, 0, 0);
+					tangent = XMVector3Cross(axis, normal);
+				}
+				tangent = XMVector3Normalize(tangent);
+
+				float handedness = XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), XMLoadFloat3(&sums[v].Bitangent))) < 0.0f ? -1.0f : 1.0f;
+				XMStoreFloat4(&vertices[v].Tangent, XMVectorSetW(tangent, handedness));
+			}
+		});
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Vertex.h"
+
+class WorkerPool;
+
+// --------------------------------------------------------
+// Normal and tangent generation for meshes that arrive
+// without them
+//
+// Both passes are triangle-parallel: each chunk of triangles
+// accumulates into its own partial sums (covering only the
+// vertex range it touches), and the partials are merged in
+// chunk order afterwards. There are no atomics or locks on
+// the vertex data, and the output doesn't depend on thread
+// timing or count - a pool gives the same bits as running
+// on the calling thread, which is what a null pool does.
+//
+// Vertices are smoothed across the triangles that index
+// them, so weld first (VertexWelder) if a mesh has split
+// vertices that should share a normal.
+// --------------------------------------------------------
+namespace MeshTangents
+{
+	// Copies positions and colors into LitVertices, with everything else zeroed
+	void Expand(const Vertex* vertices, int count, LitVertex* out);
+
+	// Smooth normals - each face normal is weighted by the angle
+	// of the triangle's corner at the vertex
+	void GenerateNormals(
+		LitVertex* vertices, int vertexCount,
+		const unsigned int* indices, int indexCount,
+		WorkerPool* pool = nullptr);
+
+	// MikkTSpace-style tangents from normals and UVs
+	//  - Each triangle's UV tangent is projected into the plane of
+	//    the corner's normal, normalized and weighted by corner angle
+	//  - w is the bitangent sign, so bitangent = cross(N, T) * w
+	//  - Unlike the full MikkTSpace this never splits vertices,
+	//    so corners that disagree (mirrored UVs on one vertex) are averaged
+	void GenerateTangents(
+		LitVertex* vertices, int vertexCount,
+		const unsigned int* indices, int indexCount,
+		WorkerPool* pool = nullptr);
+}
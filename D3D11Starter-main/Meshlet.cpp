@@ -0,0 +1,224 @@
+#include "Meshlet.h"
+#include "MeshBounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Below this the cone is too wide to ever cull anything
+	const float minConeDot = 0.1f;
+
+	// --------------------------------------------------------
+	// Fills in the bounding sphere and normal cone of a meshlet
+	// whose vertex and triangle lists are already written
+	// --------------------------------------------------------
+	void ComputeMeshletBounds(Meshlet& meshlet, const MeshletData& data, const Vertex* vertices)
+	{
+		const unsigned int* meshletVerts = &data.Vertices[meshlet.VertexOffset];
+		const uint8_t* meshletTris = &data.Triangles[meshlet.TriangleOffset];
+
+		// Sphere around the box of the cluster's vertices
+		XMVECTOR vMin = XMLoadFloat3(&vertices[meshletVerts[0]].Position);
+		XMVECTOR vMax = vMin;
+		for (unsigned int i = 1; i < meshlet.VertexCount; i++)
+		{
+			XMVECTOR p = XMLoadFloat3(&vertices[meshletVerts[i]].Position);
+			vMin = XMVectorMin(vMin, p);
+			vMax = XMVectorMax(vMax, p);
+		}
+
+		XMVECTOR center = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+		float radiusSq = 0.0f;
+		for (unsigned int i = 0; i < meshlet.VertexCount; i++)
+		{
+			XMVECTOR p = XMLoadFloat3(&vertices[meshletVerts[i]].Position);
+			radiusSq = std::max(radiusSq, XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(p, center))));
+		}
+
+		XMStoreFloat3(&meshlet.Center, center);
+		meshlet.Radius = std::sqrt(radiusSq);
+
+		// Average the triangle normals to get the cone axis
+		// - Clockwise winding (D3D's default front face) in a left-handed
+		//   space means cross(p1 - p0, p2 - p0) points out of the front
+		std::vector<XMVECTOR> normals;
+		normals.reserve(meshlet.TriangleCount);
+		XMVECTOR axis = XMVectorZero();
+		for (unsigned int t = 0; t < meshlet.TriangleCount; t++)
+		{
+			XMVECTOR p0 = XMLoadFloat3(&vertices[meshletVerts[meshletTris[t * 3 + 0]]].Position);
+			XMVECTOR p1 = XMLoadFloat3(&vertices[meshletVerts[meshletTris[t * 3 + 1]]].Position);
+			XMVECTOR p2 = XMLoadFloat3(&vertices[meshletVerts[meshletTris[t * 3 + 2]]].Position);
+			XMVECTOR n = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+
+			// Skip degenerate triangles, they can't face anywhere
+			if (XMVectorGetX(XMVector3LengthSq(n)) <= 0.0f)
+				continue;
+
+			n = XMVector3Normalize(n);
+			normals.push_back(n);
+			axis = XMVectorAdd(axis, n);
+		}
+
+		meshlet.ConeApex = meshlet.Center;
+		meshlet.ConeAxis = XMFLOAT3(0, 0, 0);
+		meshlet.ConeCutoff = 1.0f;
+		if (normals.empty() || XMVectorGetX(XMVector3LengthSq(axis)) <= 0.0f)
+			return;
+
+		axis = XMVector3Normalize(axis);
+		XMStoreFloat3(&meshlet.ConeAxis, axis);
+
+		// The cone half-angle comes from the least aligned normal
+		float minDot = 1.0f;
+		for (XMVECTOR n : normals)
+			minDot = std::min(minDot, XMVectorGetX(XMVector3Dot(n, axis)));
+
+		if (minDot <= minConeDot)
+			return;
+
+		// Slide the apex back along the axis until it sits behind every triangle's plane
+		float maxT = 0.0f;
+		for (unsigned int t = 0, n = 0; t < meshlet.TriangleCount; t++)
+		{
+			XMVECTOR p0 = XMLoadFloat3(&vertices[meshletVerts[meshletTris[t * 3 + 0]]].Position);
+			XMVECTOR p1 = XMLoadFloat3(&vertices[meshletVerts[meshletTris[t * 3 + 1]]].Position);
+			XMVECTOR p2 = XMLoadFloat3(&vertices[meshletVerts[meshletTris[t * 3 + 2]]].Position);
+			XMVECTOR normal = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+			if (XMVectorGetX(XMVector3LengthSq(normal)) <= 0.0f)
+				continue;
+
+			XMVECTOR unitNormal = normals[n++];
+			float dc = XMVectorGetX(XMVector3Dot(XMVectorSubtract(center, p0), unitNormal));
+			float dn = XMVectorGetX(XMVector3Dot(axis, unitNormal));
+			maxT = std::max(maxT, dc / dn);
+		}
+
+		XMStoreFloat3(&meshlet.ConeApex, XMVectorSubtract(center, XMVectorScale(axis, maxT)));
+		meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+}
+
+// --------------------------------------------------------
+// Greedily walks the triangle list, starting a new meshlet
+// whenever the next triangle would overflow the current one
+// --------------------------------------------------------
+MeshletData Meshlets::Build(const Vertex* vertices, int vertexCount, const unsigned int* indices, int indexCount)
+{
+	MeshletData data;
+	if (vertexCount <= 0 || indexCount < 3)
+		return data;
+
+	// Worst case guesses so the arrays rarely reallocate
+	int triangleCount = indexCount / 3;
+	data.Meshlets.reserve(triangleCount / MaxTriangles + 1);
+	data.Vertices.reserve(vertexCount);
+	data.Triangles.reserve(triangleCount * 3);
+
+	// Which local slot each mesh vertex has in the current meshlet (-1 = none)
+	std::vector<int> localIndex(vertexCount, -1);
+
+	Meshlet current = {};
+
+	auto finishMeshlet = [&]()
+		{
+			if (current.TriangleCount == 0)
+				return;
+
+			ComputeMeshletBounds(current, data, vertices);
+			data.Meshlets.push_back(current);
+
+			// Reset only the entries we touched
+			for (unsigned int i = 0; i < current.VertexCount; i++)
+				localIndex[data.Vertices[current.VertexOffset + i]] = -1;
+
+			current = {};
+			current.VertexOffset = (unsigned int)data.Vertices.size();
+			current.TriangleOffset = (unsigned int)data.Triangles.size();
+		};
+
+	for (int t = 0; t < triangleCount; t++)
+	{
+		unsigned int a = indices[t * 3 + 0];
+		unsigned int b = indices[t * 3 + 1];
+		unsigned int c = indices[t * 3 + 2];
+
+		// How many vertices would this triangle add?
+		unsigned int newVerts =
+			(localIndex[a] < 0) +
+			(localIndex[b] < 0 && b != a) +
+			(localIndex[c] < 0 && c != a && c != b);
+
+		if (current.VertexCount + newVerts > MaxVertices || current.TriangleCount + 1 > MaxTriangles)
+			finishMeshlet();
+
+		for (unsigned int v : { a, b, c })
+		{
+			if (localIndex[v] < 0)
+			{
+				localIndex[v] = (int)current.VertexCount++;
+				data.Vertices.push_back(v);
+			}
+			data.Triangles.push_back((uint8_t)localIndex[v]);
+		}
+		current.TriangleCount++;
+	}
+
+	finishMeshlet();
+	return data;
+}
+
+// --------------------------------------------------------
+// Tests every meshlet against the frustum and its normal
+// cone, and writes the survivors into one index buffer
+// --------------------------------------------------------
+MeshletCullStats Meshlets::Cull(
+	const MeshletData& data,
+	const XMFLOAT4X4& worldViewProjection,
+	const XMFLOAT3& localEye,
+	std::vector<unsigned int>& outIndices)
+{
+	MeshletCullStats stats = {};
+
+	XMFLOAT4 planes[6];
+	MeshBounds::ExtractFrustumPlanes(worldViewProjection, planes);
+	XMVECTOR eye = XMLoadFloat3(&localEye);
+
+	for (const Meshlet& meshlet : data.Meshlets)
+	{
+		// Frustum - sphere entirely outside any plane?
+		if (!MeshBounds::SphereInFrustum(planes, meshlet.Center, meshlet.Radius))
+		{
+			stats.FrustumCulled++;
+			continue;
+		}
+
+		// Backface - is the eye inside the "all triangles face away" cone?
+		if (meshlet.ConeCutoff < 1.0f)
+		{
+			XMVECTOR toApex = XMVectorSubtract(XMLoadFloat3(&meshlet.ConeApex), eye);
+			float length = XMVectorGetX(XMVector3Length(toApex));
+			float facing = XMVectorGetX(XMVector3Dot(toApex, XMLoadFloat3(&meshlet.ConeAxis)));
+			if (facing >= meshlet.ConeCutoff * length)
+			{
+				stats.BackfaceCulled++;
+				continue;
+			}
+		}
+
+		// Visible - expand the local triangles back to mesh indices
+		const unsigned int* meshletVerts = &data.Vertices[meshlet.VertexOffset];
+		const uint8_t* meshletTris = &data.Triangles[meshlet.TriangleOffset];
+		for (unsigned int i = 0; i < meshlet.TriangleCount * 3; i++)
+			outIndices.push_back(meshletVerts[meshletTris[i]]);
+
+		stats.Visible++;
+	}
+
+	return stats;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+#include "Vertex.h"
+
+// --------------------------------------------------------
+// A small cluster of triangles that can be culled as a unit
+//
+// Vertices and triangles are stored in the shared arrays
+// of the owning MeshletData:
+//  - Vertices[VertexOffset + i] is an index into the
+//    original mesh's vertex array
+//  - Triangles[TriangleOffset + t * 3 + c] is an index into
+//    this meshlet's own vertex list (so it fits in a byte)
+// --------------------------------------------------------
+struct Meshlet
+{
+	unsigned int VertexOffset;
+	unsigned int TriangleOffset;
+	unsigned int VertexCount;
+	unsigned int TriangleCount;
+
+	// Bounding sphere in mesh-local space
+	DirectX::XMFLOAT3 Center;
+	float Radius;
+
+	// Normal cone - the whole cluster faces away from any viewer
+	// for which dot(normalize(ConeApex - eye), ConeAxis) >= ConeCutoff
+	DirectX::XMFLOAT3 ConeApex;
+	DirectX::XMFLOAT3 ConeAxis;
+	float ConeCutoff;
+};
+
+// Output of the meshlet builder
+struct MeshletData
+{
+	std::vector<Meshlet> Meshlets;
+	std::vector<unsigned int> Vertices;
+	std::vector<uint8_t> Triangles;
+};
+
+// Counters from a single cull pass
+struct MeshletCullStats
+{
+	unsigned int Visible;
+	unsigned int FrustumCulled;
+	unsigned int BackfaceCulled;
+};
+
+namespace Meshlets
+{
+	// Cluster size limits
+	const unsigned int MaxVertices = 64;
+	const unsigned int MaxTriangles = 124;
+
+	// Offline build - splits a triangle list into meshlets
+	MeshletData Build(
+		const Vertex* vertices, int vertexCount,
+		const unsigned int* indices, int indexCount);
+
+	// Per-frame cull - appends the triangles of every visible
+	// meshlet to outIndices (as indices into the original vertices)
+	//  - worldViewProjection transforms mesh-local space to clip space
+	//  - localEye is the camera position in mesh-local space
+	MeshletCullStats Cull(
+		const MeshletData& data,
+		const DirectX::XMFLOAT4X4& worldViewProjection,
+		const DirectX::XMFLOAT3& localEye,
+		std::vector<unsigned int>& outIndices);
+}
@@ -0,0 +1,35 @@
+#include "NullRenderContext.h"
+
+NullRenderContext::NullRenderContext() :
+	stateCalls(0),
+	draws(0),
+	uploadedBytes(0)
+{
+}
+
+NullRenderContext::~NullRenderContext()
+{
+}
+
+void NullRenderContext::ResetCounts()
+{
+	stateCalls = 0;
+	draws = 0;
+	uploadedBytes = 0;
+}
+
+// Only what's counted is named - the rest goes nowhere
+void NullRenderContext::SetInputLayout(ID3D11InputLayout*) { stateCalls++; }
+void NullRenderContext::SetVertexShader(ID3D11VertexShader*) { stateCalls++; }
+void NullRenderContext::SetPixelShader(ID3D11PixelShader*) { stateCalls++; }
+void NullRenderContext::SetVertexBuffer(unsigned int, ID3D11Buffer*, unsigned int, unsigned int) { stateCalls++; }
+void NullRenderContext::SetIndexBuffer(ID3D11Buffer*) { stateCalls++; }
+void NullRenderContext::SetVSConstantBuffer(unsigned int, ID3D11Buffer*) { stateCalls++; }
+void NullRenderContext::SetVSConstantBufferRange(unsigned int, ID3D11Buffer*, unsigned int, unsigned int) { stateCalls++; }
+void NullRenderContext::UploadBuffer(ID3D11Buffer*, const void*, unsigned int size) { uploadedBytes += size; }
+void NullRenderContext::DrawIndexed(unsigned int, unsigned int, int) { draws++; }
+void NullRenderContext::DrawIndexedInstanced(unsigned int, unsigned int, unsigned int, int, unsigned int) { draws++; }
+
+unsigned int NullRenderContext::GetStateCallCount() { return stateCalls; }
+unsigned int NullRenderContext::GetDrawCount() { return draws; }
+unsigned int NullRenderContext::GetUploadedBytes() { return uploadedBytes; }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "RenderContext.h"
+
+// --------------------------------------------------------
+// A RenderContext that throws every call away, only counting
+// them
+//
+// For timing whatever feeds it (recording, sorting, replaying
+// a CommandList) without a GPU, and without the allocations
+// a RecordingRenderContext makes for every call.
+// --------------------------------------------------------
+class NullRenderContext : public RenderContext
+{
+public:
+	// Basic OOP Setup
+	NullRenderContext();
+	~NullRenderContext();
+	NullRenderContext(const NullRenderContext&) = delete;
+	NullRenderContext& operator=(const NullRenderContext&) = delete;
+
+	void ResetCounts();
+
+	// RenderContext
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset) override;
+	void SetIndexBuffer(ID3D11Buffer* buffer) override;
+	void SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) override;
+	void SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount) override;
+	void UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size) override;
+	void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) override;
+	void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance) override;
+
+	// Getters
+	unsigned int GetStateCallCount();
+	unsigned int GetDrawCount();
+	unsigned int GetUploadedBytes();
+
+private:
+	unsigned int stateCalls;
+	unsigned int draws;
+	unsigned int uploadedBytes;
+};
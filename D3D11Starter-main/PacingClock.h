@@ -0,0 +1,19 @@
+#pragma once
+
+// --------------------------------------------------------
+// The time and the ability to wait, behind an interface so
+// a FramePacer can run on the real clock (SteadyPacingClock)
+// or on a simulated one in a test
+// --------------------------------------------------------
+class PacingClock
+{
+public:
+	virtual ~PacingClock() {}
+
+	// Seconds since some fixed point
+	virtual double Now() = 0;
+
+	// Gives up the thread for about this long - may run over,
+	// as operating system sleeps do, but never short
+	virtual void Sleep(double seconds) = 0;
+};
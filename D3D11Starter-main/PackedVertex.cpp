@@ -0,0 +1,247 @@
+#include "PackedVertex.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Smallest extent we allow, so a flat mesh doesn't divide by zero
+	const float minExtent = 1e-6f;
+
+	uint16_t ToUnorm16(float value)
+	{
+		value = std::clamp(value, 0.0f, 1.0f);
+		return (uint16_t)std::lround(value * 65535.0f);
+	}
+
+	int16_t ToSnorm16(float value)
+	{
+		value = std::clamp(value, -1.0f, 1.0f);
+		return (int16_t)std::lround(value * 32767.0f);
+	}
+
+	uint8_t ToUnorm8(float value)
+	{
+		value = std::clamp(value, 0.0f, 1.0f);
+		return (uint8_t)std::lround(value * 255.0f);
+	}
+
+	float SignNotZero(float value)
+	{
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+
+	// Shared min/max reduction over any vertex type with a Position
+	template <typename T>
+	QuantizationBounds BoundsOf(const T* vertices, int count)
+	{
+		QuantizationBounds bounds = {};
+		if (count <= 0)
+		{
+			bounds.Extent = XMFLOAT3(1.0f, 1.0f, 1.0f);
+			return bounds;
+		}
+
+		XMVECTOR vMin = XMLoadFloat3(&vertices[0].Position);
+		XMVECTOR vMax = vMin;
+		for (int i = 1; i < count; i++)
+		{
+			XMVECTOR p = XMLoadFloat3(&vertices[i].Position);
+			vMin = XMVectorMin(vMin, p);
+			vMax = XMVectorMax(vMax, p);
+		}
+
+		XMStoreFloat3(&bounds.Min, vMin);
+		XMStoreFloat3(&bounds.Extent, XMVectorMax(XMVectorSubtract(vMax, vMin), XMVectorReplicate(minExtent)));
+		return bounds;
+	}
+}
+
+QuantizationBounds VertexPacking::ComputeBounds(const Vertex* vertices, int count)
+{
+	return BoundsOf(vertices, count);
+}
+
+QuantizationBounds VertexPacking::ComputeBounds(const LitVertex* vertices, int count)
+{
+	return BoundsOf(vertices, count);
+}
+
+// --------------------------------------------------------
+// Matrix that takes a [0, 1] quantized position back to
+// local space. Multiply it in front of the world matrix.
+// --------------------------------------------------------
+XMFLOAT4X4 VertexPacking::DequantizationMatrix(const QuantizationBounds& bounds)
+{
+	XMMATRIX scale = XMMatrixScaling(bounds.Extent.x, bounds.Extent.y, bounds.Extent.z);
+	XMMATRIX translate = XMMatrixTranslation(bounds.Min.x, bounds.Min.y, bounds.Min.z);
+
+	XMFLOAT4X4 result;
+	XMStoreFloat4x4(&result, XMMatrixMultiply(scale, translate));
+	return result;
+}
+
+// --------------------------------------------------------
+// Largest per-axis error a round trip through 16 bits can
+// introduce (half of one quantization step)
+// --------------------------------------------------------
+XMFLOAT3 VertexPacking::MaxPositionError(const QuantizationBounds& bounds)
+{
+	const float halfStep = 0.5f / 65535.0f;
+	return XMFLOAT3(
+		bounds.Extent.x * halfStep,
+		bounds.Extent.y * halfStep,
+		bounds.Extent.z * halfStep);
+}
+
+void VertexPacking::QuantizePosition(const XMFLOAT3& position, const QuantizationBounds& bounds, uint16_t out[4])
+{
+	out[0] = ToUnorm16((position.x - bounds.Min.x) / bounds.Extent.x);
+	out[1] = ToUnorm16((position.y - bounds.Min.y) / bounds.Extent.y);
+	out[2] = ToUnorm16((position.z - bounds.Min.z) / bounds.Extent.z);
+	out[3] = 0;
+}
+
+XMFLOAT3 VertexPacking::DequantizePosition(const uint16_t in[4], const QuantizationBounds& bounds)
+{
+	return XMFLOAT3(
+		bounds.Min.x + (in[0] / 65535.0f) * bounds.Extent.x,
+		bounds.Min.y + (in[1] / 65535.0f) * bounds.Extent.y,
+		bounds.Min.z + (in[2] / 65535.0f) * bounds.Extent.z);
+}
+
+// --------------------------------------------------------
+// Packs a color as DXGI_FORMAT_R8G8B8A8_UNORM expects it
+// --------------------------------------------------------
+uint32_t VertexPacking::PackColor(const XMFLOAT4& color)
+{
+	return
+		(uint32_t)ToUnorm8(color.x) |
+		((uint32_t)ToUnorm8(color.y) << 8) |
+		((uint32_t)ToUnorm8(color.z) << 16) |
+		((uint32_t)ToUnorm8(color.w) << 24);
+}
+
+XMFLOAT4 VertexPacking::UnpackColor(uint32_t color)
+{
+	return XMFLOAT4(
+		(color & 0xFF) / 255.0f,
+		((color >> 8) & 0xFF) / 255.0f,
+		((color >> 16) & 0xFF) / 255.0f,
+		((color >> 24) & 0xFF) / 255.0f);
+}
+
+// --------------------------------------------------------
+// Octahedral normal encoding
+//
+// - Project the unit vector onto the octahedron |x|+|y|+|z| = 1
+// - Fold the lower hemisphere over the diagonals so the
+//   whole sphere maps to the [-1, 1] square
+// --------------------------------------------------------
+void VertexPacking::EncodeOctahedral(const XMFLOAT3& normal, int16_t out[2])
+{
+	float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (sum <= 0.0f)
+	{
+		out[0] = 0;
+		out[1] = 0;
+		return;
+	}
+
+	float x = normal.x / sum;
+	float y = normal.y / sum;
+	if (normal.z < 0.0f)
+	{
+		float foldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+		float foldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	out[0] = ToSnorm16(x);
+	out[1] = ToSnorm16(y);
+}
+
+XMFLOAT3 VertexPacking::DecodeOctahedral(const int16_t in[2])
+{
+	float x = std::max(in[0] / 32767.0f, -1.0f);
+	float y = std::max(in[1] / 32767.0f, -1.0f);
+	float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+	// Unfold the lower hemisphere
+	if (z < 0.0f)
+	{
+		float unfoldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+		float unfoldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+		x = unfoldedX;
+		y = unfoldedY;
+	}
+
+	XMFLOAT3 result;
+	XMStoreFloat3(&result, XMVector3Normalize(XMVectorSet(x, y, z, 0.0f)));
+	return result;
+}
+
+PackedVertex VertexPacking::Pack(const Vertex& vertex, const QuantizationBounds& bounds)
+{
+	PackedVertex packed = {};
+	QuantizePosition(vertex.Position, bounds, packed.Position);
+	packed.Color = PackColor(vertex.Color);
+	return packed;
+}
+
+Vertex VertexPacking::Unpack(const PackedVertex& vertex, const QuantizationBounds& bounds)
+{
+	Vertex unpacked = {};
+	unpacked.Position = DequantizePosition(vertex.Position, bounds);
+	unpacked.Color = UnpackColor(vertex.Color);
+	return unpacked;
+}
+
+PackedLitVertex VertexPacking::Pack(const LitVertex& vertex, const QuantizationBounds& bounds)
+{
+	PackedLitVertex packed = {};
+	QuantizePosition(vertex.Position, bounds, packed.Position);
+	packed.Color = PackColor(vertex.Color);
+	EncodeOctahedral(vertex.Normal, packed.Normal);
+	EncodeOctahedral(XMFLOAT3(vertex.Tangent.x, vertex.Tangent.y, vertex.Tangent.z), packed.Tangent);
+	packed.Position[3] = vertex.Tangent.w < 0.0f ? 0 : 65535;
+	packed.UV[0] = XMConvertFloatToHalf(vertex.UV.x);
+	packed.UV[1] = XMConvertFloatToHalf(vertex.UV.y);
+	return packed;
+}
+
+LitVertex VertexPacking::Unpack(const PackedLitVertex& vertex, const QuantizationBounds& bounds)
+{
+	LitVertex unpacked = {};
+	unpacked.Position = DequantizePosition(vertex.Position, bounds);
+	unpacked.Color = UnpackColor(vertex.Color);
+	unpacked.Normal = DecodeOctahedral(vertex.Normal);
+	XMFLOAT3 tangent = DecodeOctahedral(vertex.Tangent);
+	unpacked.Tangent = XMFLOAT4(tangent.x, tangent.y, tangent.z, vertex.Position[3] >= 32768 ? 1.0f : -1.0f);
+	unpacked.UV = XMFLOAT2(
+		XMConvertHalfToFloat(vertex.UV[0]),
+		XMConvertHalfToFloat(vertex.UV[1]));
+	return unpacked;
+}
+
+QuantizationBounds VertexPacking::PackVertices(const Vertex* vertices, int count, PackedVertex* out)
+{
+	QuantizationBounds bounds = ComputeBounds(vertices, count);
+	for (int i = 0; i < count; i++)
+		out[i] = Pack(vertices[i], bounds);
+	return bounds;
+}
+
+QuantizationBounds VertexPacking::PackVertices(const LitVertex* vertices, int count, PackedLitVertex* out)
+{
+	QuantizationBounds bounds = ComputeBounds(vertices, count);
+	for (int i = 0; i < count; i++)
+		out[i] = Pack(vertices[i], bounds);
+	return bounds;
+}
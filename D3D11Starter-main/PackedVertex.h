@@ -0,0 +1,78 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <cstdint>
+
+#include "Vertex.h"
+
+// --------------------------------------------------------
+// Compressed vertex formats for memory-bound meshes
+//
+// Positions are stored as 16-bit UNORM values relative to
+// the mesh's bounding box. The vertex shader sees them in
+// the [0, 1] range, so the dequantization matrix (scale by
+// the box extent, then translate to the box minimum) must
+// be folded into the world matrix:
+//
+//   world' = DequantizationMatrix(bounds) * world
+//
+// Colors are RGBA8 UNORM, normals and tangents are
+// octahedral-encoded into two SNORM16 values each and UVs
+// are half floats. The tangent's bitangent sign rides in
+// the position's otherwise unused w.
+// --------------------------------------------------------
+
+// Box that quantized positions are relative to
+struct QuantizationBounds
+{
+	DirectX::XMFLOAT3 Min;		// Smallest corner of the box
+	DirectX::XMFLOAT3 Extent;	// Size of the box on each axis (never zero)
+};
+
+// Packed equivalent of Vertex: 12 bytes instead of 28
+struct PackedVertex
+{
+	uint16_t Position[4];	// UNORM16 xyz relative to the bounds, w is padding
+	uint32_t Color;			// RGBA8 UNORM, red in the lowest byte
+};
+
+// Packed equivalent of LitVertex: 24 bytes instead of 64
+struct PackedLitVertex
+{
+	uint16_t Position[4];							// UNORM16 xyz relative to the bounds, w is the bitangent sign (0 = -1, 65535 = +1)
+	uint32_t Color;									// RGBA8 UNORM, red in the lowest byte
+	int16_t Normal[2];								// Octahedral-encoded unit normal, SNORM16
+	int16_t Tangent[2];								// Octahedral-encoded unit tangent, SNORM16
+	DirectX::PackedVector::HALF UV[2];				// Half-float texture coordinate
+};
+
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must match its input layout");
+static_assert(sizeof(PackedLitVertex) == 24, "PackedLitVertex must match its input layout");
+
+namespace VertexPacking
+{
+	// Bounds
+	QuantizationBounds ComputeBounds(const Vertex* vertices, int count);
+	QuantizationBounds ComputeBounds(const LitVertex* vertices, int count);
+	DirectX::XMFLOAT4X4 DequantizationMatrix(const QuantizationBounds& bounds);
+	DirectX::XMFLOAT3 MaxPositionError(const QuantizationBounds& bounds);
+
+	// Individual attributes
+	void QuantizePosition(const DirectX::XMFLOAT3& position, const QuantizationBounds& bounds, uint16_t out[4]);
+	DirectX::XMFLOAT3 DequantizePosition(const uint16_t in[4], const QuantizationBounds& bounds);
+	uint32_t PackColor(const DirectX::XMFLOAT4& color);
+	DirectX::XMFLOAT4 UnpackColor(uint32_t color);
+	void EncodeOctahedral(const DirectX::XMFLOAT3& normal, int16_t out[2]);
+	DirectX::XMFLOAT3 DecodeOctahedral(const int16_t in[2]);
+
+	// Whole vertices
+	PackedVertex Pack(const Vertex& vertex, const QuantizationBounds& bounds);
+	Vertex Unpack(const PackedVertex& vertex, const QuantizationBounds& bounds);
+	PackedLitVertex Pack(const LitVertex& vertex, const QuantizationBounds& bounds);
+	LitVertex Unpack(const PackedLitVertex& vertex, const QuantizationBounds& bounds);
+
+	// Whole arrays - returns the bounds used
+	QuantizationBounds PackVertices(const Vertex* vertices, int count, PackedVertex* out);
+	QuantizationBounds PackVertices(const LitVertex* vertices, int count, PackedLitVertex* out);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <d3d11.h>
+
+#include "PackedVertex.h"
+
+// --------------------------------------------------------
+// Input layouts matching the packed vertex formats
+//
+// The UNORM/SNORM/FLOAT formats are expanded to floats by
+// the input assembler, so the vertex shader inputs stay
+// the same as for the full-precision formats:
+//  - POSITION arrives in [0, 1] (see DequantizationMatrix)
+//  - NORMAL and TANGENT arrive still octahedral-encoded in
+//    [-1, 1], and POSITION.w is the bitangent sign in [0, 1]
+//    - VertexShaderPackedLit decodes all three
+// --------------------------------------------------------
+namespace VertexPacking
+{
+	inline const D3D11_INPUT_ELEMENT_DESC PackedVertexLayout[] =
+	{
+		{ "POSITION",	0, DXGI_FORMAT_R16G16B16A16_UNORM,	0, 0,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR",		0, DXGI_FORMAT_R8G8B8A8_UNORM,		0, 8,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	};
+
+	inline const D3D11_INPUT_ELEMENT_DESC PackedLitVertexLayout[] =
+	{
+		{ "POSITION",	0, DXGI_FORMAT_R16G16B16A16_UNORM,	0, 0,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR",		0, DXGI_FORMAT_R8G8B8A8_UNORM,		0, 8,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL",		0, DXGI_FORMAT_R16G16_SNORM,		0, 12,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TANGENT",	0, DXGI_FORMAT_R16G16_SNORM,		0, 16,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD",	0, DXGI_FORMAT_R16G16_FLOAT,		0, 20,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	};
+}
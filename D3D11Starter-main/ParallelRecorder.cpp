@@ -0,0 +1,79 @@
+#include "ParallelRecorder.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	float MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+ParallelRecorder::ParallelRecorder(WorkerPool* pool) :
+	pool(pool),
+	sliceCount(0),
+	recordMilliseconds(0),
+	executeMilliseconds(0)
+{
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+}
+
+void ParallelRecorder::Record(unsigned int drawCount, const RecordSliceBody& body)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	// As many slices as there are threads, as long as each gets enough draws
+	unsigned int maxSlices = pool ? pool->GetThreadCount() : 1;
+	sliceCount = std::clamp((drawCount + MinDrawsPerSlice - 1) / MinDrawsPerSlice, 1u, maxSlices);
+
+	while (slices.size() < sliceCount)
+		slices.push_back(std::make_unique<CommandList>());
+	for (unsigned int i = 0; i < sliceCount; i++)
+		slices[i]->Reset();
+
+	if (sliceCount == 1 || !pool)
+	{
+		body(*slices[0], 0, drawCount);
+	}
+	else
+	{
+		pool->ParallelFor(drawCount, sliceCount,
+			[&](unsigned int chunk, unsigned int begin, unsigned int end)
+			{
+				body(*slices[chunk], begin, end);
+			});
+	}
+
+	recordMilliseconds = MillisecondsSince(start);
+}
+
+void ParallelRecorder::Execute(RenderContext& target)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0; i < sliceCount; i++)
+		slices[i]->Execute(target);
+
+	executeMilliseconds = MillisecondsSince(start);
+}
+
+unsigned int ParallelRecorder::GetSliceCount() { return sliceCount; }
+CommandList& ParallelRecorder::GetSlice(unsigned int index) { return *slices[index]; }
+float ParallelRecorder::GetRecordMilliseconds() { return recordMilliseconds; }
+float ParallelRecorder::GetExecuteMilliseconds() { return executeMilliseconds; }
+
+unsigned int ParallelRecorder::GetCommandCount()
+{
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < sliceCount; i++)
+		count += slices[i]->GetCommandCount();
+	return count;
+}
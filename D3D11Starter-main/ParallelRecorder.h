@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "CommandList.h"
+
+class WorkerPool;
+
+// Records draws [begin, end) of the frame into list
+using RecordSliceBody = std::function<void(CommandList& list, unsigned int begin, unsigned int end)>;
+
+// --------------------------------------------------------
+// Records a frame's draws on several threads at once
+//
+// The draws are split into contiguous slices, one per
+// thread, and each slice is recorded into its own
+// CommandList, so no thread touches another's memory.
+// Execute() then replays the slices in slice order - the
+// same calls, in the same order, as recording every draw
+// into one list on one thread.
+//
+// Slices start with no state of their own, so a slice's
+// first draw must bind everything it uses. Put a StateCache
+// in front of the target and the binds that turn out to be
+// redundant across slice boundaries are dropped there.
+// --------------------------------------------------------
+class ParallelRecorder
+{
+public:
+	// Below this many draws per slice, another thread isn't worth it
+	static const unsigned int MinDrawsPerSlice = 64;
+
+	// Basic OOP Setup
+	explicit ParallelRecorder(WorkerPool* pool);	// Null records everything on the calling thread
+	~ParallelRecorder();
+	ParallelRecorder(const ParallelRecorder&) = delete;
+	ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+	// Resets the slices and records [0, drawCount) into them
+	void Record(unsigned int drawCount, const RecordSliceBody& body);
+
+	// Replays every slice, in order
+	void Execute(RenderContext& target);
+
+	// Getters
+	unsigned int GetSliceCount();
+	CommandList& GetSlice(unsigned int index);
+	unsigned int GetCommandCount();
+	float GetRecordMilliseconds();		// Wall time of the last Record()
+	float GetExecuteMilliseconds();		// Wall time of the last Execute()
+
+private:
+	WorkerPool* pool;
+
+	// Lists are kept (and reused) even when fewer slices are needed
+	std::vector<std::unique_ptr<CommandList>> slices;
+	unsigned int sliceCount;
+
+	float recordMilliseconds;
+	float executeMilliseconds;
+};
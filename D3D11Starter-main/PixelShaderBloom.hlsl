@@ -0,0 +1,40 @@
+
+// Struct representing the data we expect to receive from earlier pipeline stages
+// - Should match the output of VertexShaderFullscreen
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;
+	float2 uv				: TEXCOORD;
+};
+
+// Constant Buffer External Shader data
+// - Should match BloomConstants in D3D11Bloom.cpp
+cbuffer ExternalData : register(b0)
+{
+	float2 texelStep;	// Between blur taps, in UV - zero for a single sample
+	float threshold;	// Taken off every channel first
+	float intensity;	// Then what's left is scaled by this
+};
+
+Texture2D source : register(t0);
+SamplerState linearClamp : register(s0);
+
+// --------------------------------------------------------
+// The entry point (main method) for our bloom pixel shader
+// - One shader for every bloom pass: the bright pass and
+//   composite take a single (filtered) sample, the blurs
+//   are a 5 tap Gaussian along texelStep
+// --------------------------------------------------------
+float4 main(VertexToPixel input) : SV_TARGET
+{
+	const float weights[3] = { 0.4026f, 0.2442f, 0.0545f };
+
+	float3 color = source.Sample(linearClamp, input.uv).rgb * weights[0];
+	for (int i = 1; i < 3; i++)
+	{
+		color += source.Sample(linearClamp, input.uv + texelStep * i).rgb * weights[i];
+		color += source.Sample(linearClamp, input.uv - texelStep * i).rgb * weights[i];
+	}
+
+	return float4(max(color - threshold, 0.0f) * intensity, 1.0f);
+}
@@ -0,0 +1,21 @@
+
+// Struct representing the data we expect to receive from earlier pipeline stages
+// - Should match the output of VertexShaderUi
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;
+	float2 uv				: TEXCOORD;
+	float4 color			: COLOR;
+};
+
+Texture2D uiTexture : register(t0);
+SamplerState linearSampler : register(s0);
+
+// --------------------------------------------------------
+// The entry point (main method) for our UI pixel shader
+// - The vertex color tinted by the command's texture
+// --------------------------------------------------------
+float4 main(VertexToPixel input) : SV_TARGET
+{
+	return input.color * uiTexture.Sample(linearSampler, input.uv);
+}
@@ -0,0 +1,439 @@
+#include "PrimitiveGenerators.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	const PrimitiveSize noPrimitive = { 0, 0 };
+
+	// --------------------------------------------------------
+	// Writes one vertex - positions, normals and tangents stay
+	// in registers until this single store
+	// --------------------------------------------------------
+	void Store(LitVertex& out, FXMVECTOR position, FXMVECTOR normal, FXMVECTOR tangent, float u, float v)
+	{
+		XMStoreFloat3(&out.Position, position);
+		XMStoreFloat3(&out.Normal, normal);
+		XMStoreFloat4(&out.Tangent, tangent);
+		out.UV = XMFLOAT2(u, v);
+		out.Color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	}
+
+	void Store(Vertex& out, FXMVECTOR position, FXMVECTOR normal, FXMVECTOR, float, float)
+	{
+		XMStoreFloat3(&out.Position, position);
+		XMStoreFloat4(&out.Color, XMVectorSetW(XMVectorMultiplyAdd(normal, XMVectorReplicate(0.5f), XMVectorReplicate(0.5f)), 1.0f));
+	}
+
+	template <typename T>
+	bool Fits(std::span<T> vertices, std::span<unsigned int> indices, PrimitiveSize size)
+	{
+		return size.VertexCount > 0 && vertices.size() >= size.VertexCount && indices.size() >= size.IndexCount;
+	}
+
+	// Tangent with the bitangent handedness in w, given the direction v increases in
+	XMVECTOR TangentFrame(FXMVECTOR normal, FXMVECTOR tangent, FXMVECTOR vDirection)
+	{
+		float handedness = XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), vDirection)) < 0.0f ? -1.0f : 1.0f;
+		return XMVectorSetW(tangent, handedness);
+	}
+
+	// --------------------------------------------------------
+	// Two clockwise triangles per cell of a grid whose vertices
+	// are row-major with (columns + 1) per row, where
+	// cross(column direction, row direction) faces the front
+	// --------------------------------------------------------
+	unsigned int* WriteGridIndices(unsigned int* out, unsigned int baseVertex, unsigned int columns, unsigned int rows)
+	{
+		for (unsigned int j = 0; j < rows; j++)
+		{
+			for (unsigned int i = 0; i < columns; i++)
+			{
+				unsigned int a = baseVertex + j * (columns + 1) + i;
+				unsigned int b = a + 1;
+				unsigned int c = a + columns + 1;
+				unsigned int d = c + 1;
+
+				*out++ = a; *out++ = b; *out++ = c;
+				*out++ = b; *out++ = d; *out++ = c;
+			}
+		}
+		return out;
+	}
+
+	// --------------------------------------------------------
+	// A flat, subdivided rectangle: origin + uAxis * s + vAxis * t
+	// - The front face is cross(uAxis, vAxis)
+	// --------------------------------------------------------
+	template <typename T>
+	T* WriteGridFace(T* out, FXMVECTOR origin, FXMVECTOR uAxis, FXMVECTOR vAxis, unsigned int columns, unsigned int rows)
+	{
+		XMVECTOR normal = XMVector3Normalize(XMVector3Cross(uAxis, vAxis));
+		XMVECTOR tangent = TangentFrame(normal, XMVector3Normalize(uAxis), vAxis);
+		XMVECTOR uStep = XMVectorScale(uAxis, 1.0f / columns);
+		XMVECTOR vStep = XMVectorScale(vAxis, 1.0f / rows);
+
+		for (unsigned int j = 0; j <= rows; j++)
+		{
+			float v = (float)j / rows;
+			XMVECTOR rowStart = XMVectorMultiplyAdd(vStep, XMVectorReplicate((float)j), origin);
+			for (unsigned int i = 0; i <= columns; i++)
+			{
+				XMVECTOR position = XMVectorMultiplyAdd(uStep, XMVectorReplicate((float)i), rowStart);
+				Store(*out++, position, normal, tangent, (float)i / columns, v);
+			}
+		}
+		return out;
+	}
+
+	template <typename T>
+	PrimitiveSize GenerateSphere(std::span<T> vertices, std::span<unsigned int> indices, float radius, unsigned int segments, unsigned int rings)
+	{
+		PrimitiveSize size = PrimitiveGenerators::SphereSize(segments, rings);
+		if (!Fits(vertices, indices, size))
+			return noPrimitive;
+
+		// Rings run from the north pole (v = 0) to the south pole (v = 1)
+		// - The seam column and the poles are duplicated so every
+		//   vertex gets its own UV
+		T* out = vertices.data();
+		XMVECTOR scale = XMVectorReplicate(radius);
+		for (unsigned int j = 0; j <= rings; j++)
+		{
+			float sinPhi, cosPhi;
+			XMScalarSinCos(&sinPhi, &cosPhi, XM_PI * j / rings);
+
+			for (unsigned int i = 0; i <= segments; i++)
+			{
+				float sinTheta, cosTheta;
+				XMScalarSinCos(&sinTheta, &cosTheta, XM_2PI * i / segments);
+
+				XMVECTOR normal = XMVectorSet(sinPhi * cosTheta, cosPhi, sinPhi * sinTheta, 0.0f);
+				XMVECTOR tangent = XMVectorSet(-sinTheta, 0.0f, cosTheta, 1.0f);
+				Store(*out++, XMVectorMultiply(normal, scale), normal, tangent, (float)i / segments, (float)j / rings);
+			}
+		}
+
+		// Skip the zero-area half of each quad that touches a pole
+		unsigned int* index = indices.data();
+		for (unsigned int j = 0; j < rings; j++)
+		{
+			for (unsigned int i = 0; i < segments; i++)
+			{
+				unsigned int a = j * (segments + 1) + i;
+				unsigned int b = a + 1;
+				unsigned int c = a + segments + 1;
+				unsigned int d = c + 1;
+
+				if (j != 0) { *index++ = a; *index++ = b; *index++ = c; }
+				if (j != rings - 1) { *index++ = b; *index++ = d; *index++ = c; }
+			}
+		}
+
+		return size;
+	}
+
+	template <typename T>
+	PrimitiveSize GenerateCube(std::span<T> vertices, std::span<unsigned int> indices, float size, unsigned int subdivisions)
+	{
+		PrimitiveSize result = PrimitiveGenerators::CubeSize(subdivisions);
+		if (!Fits(vertices, indices, result))
+			return noPrimitive;
+
+		// Outward normal and the "up" of the texture on each face
+		const XMFLOAT3 faces[6][2] =
+		{
+			{ XMFLOAT3(+1, 0, 0), XMFLOAT3(0, 1, 0) },
+			{ XMFLOAT3(-1, 0, 0), XMFLOAT3(0, 1, 0) },
+			{ XMFLOAT3(0, +1, 0), XMFLOAT3(0, 0, 1) },
+			{ XMFLOAT3(0, -1, 0), XMFLOAT3(0, 0, -1) },
+			{ XMFLOAT3(0, 0, +1), XMFLOAT3(0, 1, 0) },
+			{ XMFLOAT3(0, 0, -1), XMFLOAT3(0, 1, 0) },
+		};
+
+		// Looking at a face (along -normal), right = cross(up, -normal) in a
+		// left-handed space, and cross(right, down) is the outward normal
+		float half = size * 0.5f;
+		unsigned int faceVertices = (subdivisions + 1) * (subdivisions + 1);
+		T* out = vertices.data();
+		unsigned int* index = indices.data();
+		for (unsigned int f = 0; f < 6; f++)
+		{
+			XMVECTOR normal = XMLoadFloat3(&faces[f][0]);
+			XMVECTOR up = XMLoadFloat3(&faces[f][1]);
+			XMVECTOR right = XMVector3Cross(up, XMVectorNegate(normal));
+
+			XMVECTOR origin = XMVectorScale(XMVectorAdd(XMVectorSubtract(normal, right), up), half);
+			out = WriteGridFace(out, origin, XMVectorScale(right, size), XMVectorScale(up, -size), subdivisions, subdivisions);
+			index = WriteGridIndices(index, f * faceVertices, subdivisions, subdivisions);
+		}
+
+		return result;
+	}
+
+	template <typename T>
+	PrimitiveSize GenerateCylinder(std::span<T> vertices, std::span<unsigned int> indices, float radius, float height, unsigned int segments, unsigned int heightSegments, bool caps)
+	{
+		PrimitiveSize size = PrimitiveGenerators::CylinderSize(segments, heightSegments, caps);
+		if (!Fits(vertices, indices, size))
+			return noPrimitive;
+
+		// Side - the same parameterization as the sphere's equator,
+		// running from the top (v = 0) down
+		T* out = vertices.data();
+		float top = height * 0.5f;
+		for (unsigned int j = 0; j <= heightSegments; j++)
+		{
+			float y = top - height * j / heightSegments;
+			for (unsigned int i = 0; i <= segments; i++)
+			{
+				float sinTheta, cosTheta;
+				XMScalarSinCos(&sinTheta, &cosTheta, XM_2PI * i / segments);
+
+				XMVECTOR normal = XMVectorSet(cosTheta, 0.0f, sinTheta, 0.0f);
+				XMVECTOR tangent = XMVectorSet(-sinTheta, 0.0f, cosTheta, 1.0f);
+				XMVECTOR position = XMVectorSet(radius * cosTheta, y, radius * sinTheta, 0.0f);
+				Store(*out++, position, normal, tangent, (float)i / segments, (float)j / heightSegments);
+			}
+		}
+
+		unsigned int* index = WriteGridIndices(indices.data(), 0, segments, heightSegments);
+		if (!caps)
+			return size;
+
+		// Caps - a center vertex and a fan, with planar UVs
+		// (+Z is "up" in the top cap's texture, -Z in the bottom's)
+		for (int cap = 0; cap < 2; cap++)
+		{
+			float sign = cap == 0 ? 1.0f : -1.0f;
+			XMVECTOR normal = XMVectorSet(0.0f, sign, 0.0f, 0.0f);
+			XMVECTOR tangent = XMVectorSet(1.0f, 0.0f, 0.0f, 1.0f);
+
+			unsigned int center = (unsigned int)(out - vertices.data());
+			Store(*out++, XMVectorSet(0.0f, sign * top, 0.0f, 0.0f), normal, tangent, 0.5f, 0.5f);
+
+			for (unsigned int i = 0; i < segments; i++)
+			{
+				float sinTheta, cosTheta;
+				XMScalarSinCos(&sinTheta, &cosTheta, XM_2PI * i / segments);
+
+				XMVECTOR position = XMVectorSet(radius * cosTheta, sign * top, radius * sinTheta, 0.0f);
+				Store(*out++, position, normal, tangent, 0.5f + 0.5f * cosTheta, 0.5f - 0.5f * sign * sinTheta);
+
+				// Angle increases counter-clockwise seen from above, so the
+				// top cap walks the ring backwards to stay clockwise
+				unsigned int current = center + 1 + i;
+				unsigned int next = center + 1 + (i + 1) % segments;
+				*index++ = center;
+				*index++ = cap == 0 ? next : current;
+				*index++ = cap == 0 ? current : next;
+			}
+		}
+
+		return size;
+	}
+
+	template <typename T>
+	PrimitiveSize GenerateTorus(std::span<T> vertices, std::span<unsigned int> indices, float majorRadius, float minorRadius, unsigned int majorSegments, unsigned int minorSegments)
+	{
+		PrimitiveSize size = PrimitiveGenerators::TorusSize(majorSegments, minorSegments);
+		if (!Fits(vertices, indices, size))
+			return noPrimitive;
+
+		// u goes around the ring, v around the tube (starting at the
+		// outer equator and heading down, so the grid faces outwards)
+		T* out = vertices.data();
+		for (unsigned int j = 0; j <= minorSegments; j++)
+		{
+			float sinPhi, cosPhi;
+			XMScalarSinCos(&sinPhi, &cosPhi, -XM_2PI * j / minorSegments);
+
+			for (unsigned int i = 0; i <= majorSegments; i++)
+			{
+				float sinTheta, cosTheta;
+				XMScalarSinCos(&sinTheta, &cosTheta, XM_2PI * i / majorSegments);
+
+				XMVECTOR ringCenter = XMVectorSet(majorRadius * cosTheta, 0.0f, majorRadius * sinTheta, 0.0f);
+				XMVECTOR normal = XMVectorSet(cosPhi * cosTheta, sinPhi, cosPhi * sinTheta, 0.0f);
+				XMVECTOR tangent = XMVectorSet(-sinTheta, 0.0f, cosTheta, 1.0f);
+				XMVECTOR position = XMVectorMultiplyAdd(normal, XMVectorReplicate(minorRadius), ringCenter);
+				Store(*out++, position, normal, tangent, (float)i / majorSegments, (float)j / minorSegments);
+			}
+		}
+
+		WriteGridIndices(indices.data(), 0, majorSegments, minorSegments);
+		return size;
+	}
+
+	template <typename T>
+	PrimitiveSize GeneratePlane(std::span<T> vertices, std::span<unsigned int> indices, float width, float depth, unsigned int xSegments, unsigned int zSegments)
+	{
+		PrimitiveSize size = PrimitiveGenerators::PlaneSize(xSegments, zSegments);
+		if (!Fits(vertices, indices, size))
+			return noPrimitive;
+
+		// Starts at the far left corner (v = 0 at +Z) and
+		// walks +X along each row and -Z down the rows
+		XMVECTOR origin = XMVectorSet(-width * 0.5f, 0.0f, depth * 0.5f, 0.0f);
+		XMVECTOR uAxis = XMVectorSet(width, 0.0f, 0.0f, 0.0f);
+		XMVECTOR vAxis = XMVectorSet(0.0f, 0.0f, -depth, 0.0f);
+		WriteGridFace(vertices.data(), origin, uAxis, vAxis, xSegments, zSegments);
+		WriteGridIndices(indices.data(), 0, xSegments, zSegments);
+		return size;
+	}
+
+	template <typename T>
+	PrimitiveSize GenerateHeightfield(std::span<T> vertices, std::span<unsigned int> indices, std::span<const float> heights, unsigned int columns, unsigned int rows, float cellSize, float heightScale)
+	{
+		PrimitiveSize size = PrimitiveGenerators::HeightfieldSize(columns, rows);
+		if (!Fits(vertices, indices, size) || heights.size() < (size_t)columns * rows)
+			return noPrimitive;
+
+		// Laid out like Plane(): row 0 at +Z, rows step towards -Z
+		float left = -cellSize * (columns - 1) * 0.5f;
+		float front = cellSize * (rows - 1) * 0.5f;
+		auto height = [&](unsigned int i, unsigned int j) { return heights[(size_t)j * columns + i] * heightScale; };
+
+		T* out = vertices.data();
+		for (unsigned int j = 0; j < rows; j++)
+		{
+			unsigned int up = j > 0 ? j - 1 : j;
+			unsigned int down = std::min(j + 1, rows - 1);
+
+			for (unsigned int i = 0; i < columns; i++)
+			{
+				// Central differences (one-sided on the edges)
+				unsigned int west = i > 0 ? i - 1 : i;
+				unsigned int east = std::min(i + 1, columns - 1);
+				float dx = (height(east, j) - height(west, j)) / (cellSize * std::max(east - west, 1u));
+				float dz = (height(i, up) - height(i, down)) / (cellSize * std::max(down - up, 1u));
+
+				XMVECTOR normal = XMVector3Normalize(XMVectorSet(-dx, 1.0f, -dz, 0.0f));
+
+				// Tangent along +X, made perpendicular to the normal
+				XMVECTOR tangent = XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+				tangent = XMVector3Normalize(XMVectorSubtract(tangent, XMVectorMultiply(normal, XMVector3Dot(normal, tangent))));
+				tangent = XMVectorSetW(tangent, 1.0f);
+
+				XMVECTOR position = XMVectorSet(left + i * cellSize, height(i, j), front - j * cellSize, 0.0f);
+				Store(*out++, position, normal, tangent, (float)i / (columns - 1), (float)j / (rows - 1));
+			}
+		}
+
+		WriteGridIndices(indices.data(), 0, columns - 1, rows - 1);
+		return size;
+	}
+}
+
+PrimitiveSize PrimitiveGenerators::SphereSize(unsigned int segments, unsigned int rings)
+{
+	if (segments < 3 || rings < 2)
+		return noPrimitive;
+	return { (segments + 1) * (rings + 1), segments * (rings - 1) * 6 };
+}
+
+PrimitiveSize PrimitiveGenerators::CubeSize(unsigned int subdivisions)
+{
+	if (subdivisions < 1)
+		return noPrimitive;
+	return { 6 * (subdivisions + 1) * (subdivisions + 1), 6 * subdivisions * subdivisions * 6 };
+}
+
+PrimitiveSize PrimitiveGenerators::CylinderSize(unsigned int segments, unsigned int heightSegments, bool caps)
+{
+	if (segments < 3 || heightSegments < 1)
+		return noPrimitive;
+
+	PrimitiveSize size = { (segments + 1) * (heightSegments + 1), segments * heightSegments * 6 };
+	if (caps)
+	{
+		size.VertexCount += 2 * (segments + 1);
+		size.IndexCount += 2 * segments * 3;
+	}
+	return size;
+}
+
+PrimitiveSize PrimitiveGenerators::TorusSize(unsigned int majorSegments, unsigned int minorSegments)
+{
+	if (majorSegments < 3 || minorSegments < 3)
+		return noPrimitive;
+	return { (majorSegments + 1) * (minorSegments + 1), majorSegments * minorSegments * 6 };
+}
+
+PrimitiveSize PrimitiveGenerators::PlaneSize(unsigned int xSegments, unsigned int zSegments)
+{
+	if (xSegments < 1 || zSegments < 1)
+		return noPrimitive;
+	return { (xSegments + 1) * (zSegments + 1), xSegments * zSegments * 6 };
+}
+
+PrimitiveSize PrimitiveGenerators::HeightfieldSize(unsigned int columns, unsigned int rows)
+{
+	if (columns < 2 || rows < 2)
+		return noPrimitive;
+	return { columns * rows, (columns - 1) * (rows - 1) * 6 };
+}
+
+PrimitiveSize PrimitiveGenerators::Sphere(std::span<LitVertex> vertices, std::span<unsigned int> indices, float radius, unsigned int segments, unsigned int rings)
+{
+	return GenerateSphere(vertices, indices, radius, segments, rings);
+}
+
+PrimitiveSize PrimitiveGenerators::Sphere(std::span<Vertex> vertices, std::span<unsigned int> indices, float radius, unsigned int segments, unsigned int rings)
+{
+	return GenerateSphere(vertices, indices, radius, segments, rings);
+}
+
+PrimitiveSize PrimitiveGenerators::Cube(std::span<LitVertex> vertices, std::span<unsigned int> indices, float size, unsigned int subdivisions)
+{
+	return GenerateCube(vertices, indices, size, subdivisions);
+}
+
+PrimitiveSize PrimitiveGenerators::Cube(std::span<Vertex> vertices, std::span<unsigned int> indices, float size, unsigned int subdivisions)
+{
+	return GenerateCube(vertices, indices, size, subdivisions);
+}
+
+PrimitiveSize PrimitiveGenerators::Cylinder(std::span<LitVertex> vertices, std::span<unsigned int> indices, float radius, float height, unsigned int segments, unsigned int heightSegments, bool caps)
+{
+	return GenerateCylinder(vertices, indices, radius, height, segments, heightSegments, caps);
+}
+
+PrimitiveSize PrimitiveGenerators::Cylinder(std::span<Vertex> vertices, std::span<unsigned int> indices, float radius, float height, unsigned int segments, unsigned int heightSegments, bool caps)
+{
+	return GenerateCylinder(vertices, indices, radius, height, segments, heightSegments, caps);
+}
+
+PrimitiveSize PrimitiveGenerators::Torus(std::span<LitVertex> vertices, std::span<unsigned int> indices, float majorRadius, float minorRadius, unsigned int majorSegments, unsigned int minorSegments)
+{
+	return GenerateTorus(vertices, indices, majorRadius, minorRadius, majorSegments, minorSegments);
+}
+
+PrimitiveSize PrimitiveGenerators::Torus(std::span<Vertex> vertices, std::span<unsigned int> indices, float majorRadius, float minorRadius, unsigned int majorSegments, unsigned int minorSegments)
+{
+	return GenerateTorus(vertices, indices, majorRadius, minorRadius, majorSegments, minorSegments);
+}
+
+PrimitiveSize PrimitiveGenerators::Plane(std::span<LitVertex> vertices, std::span<unsigned int> indices, float width, float depth, unsigned int xSegments, unsigned int zSegments)
+{
+	return GeneratePlane(vertices, indices, width, depth, xSegments, zSegments);
+}
+
+PrimitiveSize PrimitiveGenerators::Plane(std::span<Vertex> vertices, std::span<unsigned int> indices, float width, float depth, unsigned int xSegments, unsigned int zSegments)
+{
+	return GeneratePlane(vertices, indices, width, depth, xSegments, zSegments);
+}
+
+PrimitiveSize PrimitiveGenerators::Heightfield(std::span<LitVertex> vertices, std::span<unsigned int> indices, std::span<const float> heights, unsigned int columns, unsigned int rows, float cellSize, float heightScale)
+{
+	return GenerateHeightfield(vertices, indices, heights, columns, rows, cellSize, heightScale);
+}
+
+PrimitiveSize PrimitiveGenerators::Heightfield(std::span<Vertex> vertices, std::span<unsigned int> indices, std::span<const float> heights, unsigned int columns, unsigned int rows, float cellSize, float heightScale)
+{
+	return GenerateHeightfield(vertices, indices, heights, columns, rows, cellSize, heightScale);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <span>
+
+#include "Vertex.h"
+
+// --------------------------------------------------------
+// How much room a primitive needs
+// --------------------------------------------------------
+struct PrimitiveSize
+{
+	unsigned int VertexCount;
+	unsigned int IndexCount;
+};
+
+// --------------------------------------------------------
+// Procedural mesh generators
+//
+// Call the matching ...Size() function first, allocate (or
+// reuse) arrays of at least that size, then generate into
+// them. Generators never allocate, always produce the same
+// output for the same parameters, and return the size they
+// wrote - or all zeros if the spans are too small or the
+// tessellation is invalid.
+//
+// - Triangles are clockwise when seen from the front
+// - UVs have v = 0 at the "top" (D3D convention)
+// - Indices are relative to the start of the vertex span
+// - LitVertex outputs get normals, tangents (w = bitangent
+//   handedness) and UVs; Vertex outputs only have a position,
+//   so they store the normal as a color (n * 0.5 + 0.5)
+//   which is handy for checking the shape with no lighting
+// --------------------------------------------------------
+namespace PrimitiveGenerators
+{
+	// UV sphere around the origin - segments around Y, rings from top to bottom
+	PrimitiveSize SphereSize(unsigned int segments, unsigned int rings);
+	PrimitiveSize Sphere(std::span<LitVertex> vertices, std::span<unsigned int> indices, float radius, unsigned int segments, unsigned int rings);
+	PrimitiveSize Sphere(std::span<Vertex> vertices, std::span<unsigned int> indices, float radius, unsigned int segments, unsigned int rings);
+
+	// Axis-aligned cube around the origin - each face is a subdivisions x subdivisions grid
+	PrimitiveSize CubeSize(unsigned int subdivisions);
+	PrimitiveSize Cube(std::span<LitVertex> vertices, std::span<unsigned int> indices, float size, unsigned int subdivisions);
+	PrimitiveSize Cube(std::span<Vertex> vertices, std::span<unsigned int> indices, float size, unsigned int subdivisions);
+
+	// Cylinder along Y, centered on the origin, with optional end caps
+	PrimitiveSize CylinderSize(unsigned int segments, unsigned int heightSegments, bool caps);
+	PrimitiveSize Cylinder(std::span<LitVertex> vertices, std::span<unsigned int> indices, float radius, float height, unsigned int segments, unsigned int heightSegments, bool caps);
+	PrimitiveSize Cylinder(std::span<Vertex> vertices, std::span<unsigned int> indices, float radius, float height, unsigned int segments, unsigned int heightSegments, bool caps);
+
+	// Torus lying in the XZ plane
+	PrimitiveSize TorusSize(unsigned int majorSegments, unsigned int minorSegments);
+	PrimitiveSize Torus(std::span<LitVertex> vertices, std::span<unsigned int> indices, float majorRadius, float minorRadius, unsigned int majorSegments, unsigned int minorSegments);
+	PrimitiveSize Torus(std::span<Vertex> vertices, std::span<unsigned int> indices, float majorRadius, float minorRadius, unsigned int majorSegments, unsigned int minorSegments);
+
+	// Flat grid in the XZ plane facing +Y
+	PrimitiveSize PlaneSize(unsigned int xSegments, unsigned int zSegments);
+	PrimitiveSize Plane(std::span<LitVertex> vertices, std::span<unsigned int> indices, float width, float depth, unsigned int xSegments, unsigned int zSegments);
+	PrimitiveSize Plane(std::span<Vertex> vertices, std::span<unsigned int> indices, float width, float depth, unsigned int xSegments, unsigned int zSegments);
+
+	// Grid of height samples (row-major, row 0 at +Z) facing +Y,
+	// with normals from central differences
+	PrimitiveSize HeightfieldSize(unsigned int columns, unsigned int rows);
+	PrimitiveSize Heightfield(std::span<LitVertex> vertices, std::span<unsigned int> indices, std::span<const float> heights, unsigned int columns, unsigned int rows, float cellSize, float heightScale);
+	PrimitiveSize Heightfield(std::span<Vertex> vertices, std::span<unsigned int> indices, std::span<const float> heights, unsigned int columns, unsigned int rows, float cellSize, float heightScale);
+}
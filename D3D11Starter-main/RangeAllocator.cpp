@@ -0,0 +1,124 @@
+#include "RangeAllocator.h"
+
+RangeAllocator::RangeAllocator(unsigned int capacity) :
+	capacity(capacity),
+	usedSpace(0),
+	allocationCount(0)
+{
+	Reset();
+}
+
+RangeAllocator::~RangeAllocator()
+{
+}
+
+// --------------------------------------------------------
+// Best fit - the smallest free block that can hold `size`,
+// with the leftover tail going back on the free list
+// --------------------------------------------------------
+unsigned int RangeAllocator::Allocate(unsigned int size)
+{
+	if (size == 0)
+		return InvalidOffset;
+
+	auto bySizeIt = freeBySize.lower_bound(size);
+	if (bySizeIt == freeBySize.end())
+		return InvalidOffset;
+
+	unsigned int blockSize = bySizeIt->first;
+	unsigned int offset = bySizeIt->second;
+	RemoveFreeBlock(freeByOffset.find(offset));
+
+	if (blockSize > size)
+		AddFreeBlock(offset + size, blockSize - size);
+
+	usedSpace += size;
+	allocationCount++;
+	return offset;
+}
+
+// --------------------------------------------------------
+// Returns a range and merges it with any free neighbours
+// --------------------------------------------------------
+void RangeAllocator::Free(unsigned int offset, unsigned int size)
+{
+	if (offset == InvalidOffset || size == 0)
+		return;
+
+	usedSpace -= size;
+	allocationCount--;
+
+	// Merge with the block after?
+	auto next = freeByOffset.find(offset + size);
+	if (next != freeByOffset.end())
+	{
+		size += next->second;
+		RemoveFreeBlock(next);
+	}
+
+	// Merge with the block before?
+	auto prev = freeByOffset.lower_bound(offset);
+	if (prev != freeByOffset.begin())
+	{
+		--prev;
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			RemoveFreeBlock(prev);
+		}
+	}
+
+	AddFreeBlock(offset, size);
+}
+
+void RangeAllocator::Reset()
+{
+	freeByOffset.clear();
+	freeBySize.clear();
+	usedSpace = 0;
+	allocationCount = 0;
+
+	if (capacity > 0)
+		AddFreeBlock(0, capacity);
+}
+
+unsigned int RangeAllocator::GetCapacity() { return capacity; }
+unsigned int RangeAllocator::GetUsedSpace() { return usedSpace; }
+unsigned int RangeAllocator::GetFreeSpace() { return capacity - usedSpace; }
+unsigned int RangeAllocator::GetFreeBlockCount() { return (unsigned int)freeByOffset.size(); }
+unsigned int RangeAllocator::GetAllocationCount() { return allocationCount; }
+
+unsigned int RangeAllocator::GetLargestFreeBlock()
+{
+	return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+}
+
+float RangeAllocator::GetFragmentation()
+{
+	unsigned int freeSpace = GetFreeSpace();
+	if (freeSpace == 0)
+		return 0.0f;
+	return 1.0f - (float)GetLargestFreeBlock() / freeSpace;
+}
+
+void RangeAllocator::AddFreeBlock(unsigned int offset, unsigned int size)
+{
+	freeByOffset[offset] = size;
+	freeBySize.insert({ size, offset });
+}
+
+void RangeAllocator::RemoveFreeBlock(std::map<unsigned int, unsigned int>::iterator byOffsetIt)
+{
+	// Find the matching entry among blocks of the same size
+	auto range = freeBySize.equal_range(byOffsetIt->second);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == byOffsetIt->first)
+		{
+			freeBySize.erase(it);
+			break;
+		}
+	}
+	freeByOffset.erase(byOffsetIt);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+
+// --------------------------------------------------------
+// Free-list allocator for ranges of a fixed-size pool
+//
+// Knows nothing about what the pool holds - offsets and
+// sizes are in whatever units the owner picks (vertices,
+// indices, bytes...). Free blocks are kept twice: by offset
+// so neighbours can be merged on free, and by size so
+// allocation is a best-fit lookup. Both are O(log n).
+// --------------------------------------------------------
+class RangeAllocator
+{
+public:
+	static const unsigned int InvalidOffset = 0xFFFFFFFF;
+
+	// Basic OOP Setup
+	RangeAllocator(unsigned int capacity);
+	~RangeAllocator();
+
+	// Allocation - returns InvalidOffset when no block is big enough
+	unsigned int Allocate(unsigned int size);
+	void Free(unsigned int offset, unsigned int size);
+	void Reset();
+
+	// Getters
+	unsigned int GetCapacity();
+	unsigned int GetUsedSpace();
+	unsigned int GetFreeSpace();
+	unsigned int GetLargestFreeBlock();
+	unsigned int GetFreeBlockCount();
+	unsigned int GetAllocationCount();
+	float GetFragmentation(); // 0 = one free block, approaching 1 = badly split up
+
+private:
+	void AddFreeBlock(unsigned int offset, unsigned int size);
+	void RemoveFreeBlock(std::map<unsigned int, unsigned int>::iterator byOffsetIt);
+
+	unsigned int capacity;
+	unsigned int usedSpace;
+	unsigned int allocationCount;
+
+	// Free blocks: offset -> size, and size -> offset
+	std::map<unsigned int, unsigned int> freeByOffset;
+	std::multimap<unsigned int, unsigned int> freeBySize;
+};
@@ -0,0 +1,100 @@
+#include "RecordingRenderContext.h"
+
+RecordingRenderContext::RecordingRenderContext()
+{
+}
+
+RecordingRenderContext::~RecordingRenderContext()
+{
+}
+
+void RecordingRenderContext::Clear()
+{
+	calls.clear();
+}
+
+unsigned int RecordingRenderContext::CountOf(RenderCallType type)
+{
+	unsigned int count = 0;
+	for (const RenderCall& call : calls)
+	{
+		if (call.Type == type)
+			count++;
+	}
+	return count;
+}
+
+void RecordingRenderContext::SetInputLayout(ID3D11InputLayout* layout)
+{
+	Record(RenderCallType::SetInputLayout, layout);
+}
+
+void RecordingRenderContext::SetVertexShader(ID3D11VertexShader* shader)
+{
+	Record(RenderCallType::SetVertexShader, shader);
+}
+
+void RecordingRenderContext::SetPixelShader(ID3D11PixelShader* shader)
+{
+	Record(RenderCallType::SetPixelShader, shader);
+}
+
+void RecordingRenderContext::SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset)
+{
+	RenderCall& call = Record(RenderCallType::SetVertexBuffer, buffer);
+	call.Slot = slot;
+	call.Stride = stride;
+	call.Offset = offset;
+}
+
+void RecordingRenderContext::SetIndexBuffer(ID3D11Buffer* buffer)
+{
+	Record(RenderCallType::SetIndexBuffer, buffer);
+}
+
+void RecordingRenderContext::SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer)
+{
+	Record(RenderCallType::SetVSConstantBuffer, buffer).Slot = slot;
+}
+
+void RecordingRenderContext::SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	RenderCall& call = Record(RenderCallType::SetVSConstantBufferRange, buffer);
+	call.Slot = slot;
+	call.FirstConstant = firstConstant;
+	call.ConstantCount = constantCount;
+}
+
+void RecordingRenderContext::UploadBuffer(ID3D11Buffer* buffer, const void* /*data*/, unsigned int size)
+{
+	Record(RenderCallType::UploadBuffer, buffer).DataSize = size;
+}
+
+void RecordingRenderContext::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	RenderCall& call = Record(RenderCallType::DrawIndexed, nullptr);
+	call.IndexCount = indexCount;
+	call.StartIndex = startIndex;
+	call.BaseVertex = baseVertex;
+}
+
+void RecordingRenderContext::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	RenderCall& call = Record(RenderCallType::DrawIndexedInstanced, nullptr);
+	call.IndexCount = indexCount;
+	call.InstanceCount = instanceCount;
+	call.StartIndex = startIndex;
+	call.BaseVertex = baseVertex;
+	call.StartInstance = startInstance;
+}
+
+const std::vector<RenderCall>& RecordingRenderContext::GetCalls() { return calls; }
+
+RenderCall& RecordingRenderContext::Record(RenderCallType type, const void* object)
+{
+	RenderCall call = {};
+	call.Type = type;
+	call.Object = object;
+	calls.push_back(call);
+	return calls.back();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+
+#include "RenderContext.h"
+
+enum class RenderCallType
+{
+	SetInputLayout,
+	SetVertexShader,
+	SetPixelShader,
+	SetVertexBuffer,
+	SetIndexBuffer,
+	SetVSConstantBuffer,
+	SetVSConstantBufferRange,
+	UploadBuffer,
+	DrawIndexed,
+	DrawIndexedInstanced
+};
+
+// One call made on a RecordingRenderContext
+// - Only the fields that call takes are filled in, the rest are zero
+struct RenderCall
+{
+	RenderCallType Type;
+	const void* Object;		// Layout, shader or buffer
+	unsigned int DataSize;	// Bytes uploaded - the data itself isn't kept
+	unsigned int Slot;
+	unsigned int Stride;
+	unsigned int Offset;
+	unsigned int IndexCount;
+	unsigned int InstanceCount;
+	unsigned int StartIndex;
+	int BaseVertex;
+	unsigned int StartInstance;
+	unsigned int FirstConstant;
+	unsigned int ConstantCount;
+};
+
+// --------------------------------------------------------
+// A RenderContext that doesn't draw anything, it just keeps
+// a list of the calls made on it
+//
+// Needs no GPU (or d3d11.h), so whatever sits in front of a
+// RenderContext - a StateCache, a draw loop - can be run and
+// checked anywhere. The pointers it's handed are never
+// dereferenced, so any distinct addresses will do as stand-in
+// shaders and buffers.
+// --------------------------------------------------------
+class RecordingRenderContext : public RenderContext
+{
+public:
+	// Basic OOP Setup
+	RecordingRenderContext();
+	~RecordingRenderContext();
+	RecordingRenderContext(const RecordingRenderContext&) = delete;
+	RecordingRenderContext& operator=(const RecordingRenderContext&) = delete;
+
+	void Clear();
+	unsigned int CountOf(RenderCallType type);
+
+	// RenderContext
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset) override;
+	void SetIndexBuffer(ID3D11Buffer* buffer) override;
+	void SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) override;
+	void SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount) override;
+	void UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size) override;
+	void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) override;
+	void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance) override;
+
+	// Getters
+	const std::vector<RenderCall>& GetCalls();
+
+private:
+	RenderCall& Record(RenderCallType type, const void* object);
+
+	std::vector<RenderCall> calls;
+};
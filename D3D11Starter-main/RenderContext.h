@@ -0,0 +1,43 @@
+#pragma once
+
+// Only pointers to these are needed here, so the interface
+// (and anything built purely on it) compiles without d3d11.h
+struct ID3D11InputLayout;
+struct ID3D11VertexShader;
+struct ID3D11PixelShader;
+struct ID3D11Buffer;
+
+// --------------------------------------------------------
+// The pipeline state calls the renderer makes, behind an
+// interface so they can be filtered (StateCache), sent to
+// the GPU (D3D11RenderContext) or just written down
+// (RecordingRenderContext)
+//
+// Index buffers are always 32-bit, since every mesh in the
+// project uses DXGI_FORMAT_R32_UINT.
+// --------------------------------------------------------
+class RenderContext
+{
+public:
+	virtual ~RenderContext() {}
+
+	// State
+	virtual void SetInputLayout(ID3D11InputLayout* layout) = 0;
+	virtual void SetVertexShader(ID3D11VertexShader* shader) = 0;
+	virtual void SetPixelShader(ID3D11PixelShader* shader) = 0;
+	virtual void SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset) = 0;
+	virtual void SetIndexBuffer(ID3D11Buffer* buffer) = 0;
+	virtual void SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) = 0;
+
+	// Binds part of a larger buffer, in 16-byte constants
+	// - Both must be multiples of 16 (256 bytes), as in VSSetConstantBuffers1
+	virtual void SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount) = 0;
+
+	// Uploads
+	// - Replaces the contents of a dynamic buffer, discarding what was there
+	virtual void UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size) = 0;
+
+	// Draws
+	virtual void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) = 0;
+	virtual void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance) = 0;
+};
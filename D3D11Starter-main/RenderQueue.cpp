@@ -0,0 +1,162 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	uint64_t Field(unsigned int value, unsigned int bits)
+	{
+		return (uint64_t)value & ((1ull << bits) - 1);
+	}
+
+	const unsigned int passShift = 64 - RenderKey::PassBits;
+	const uint32_t maxDepth = (1u << RenderKey::DepthBits) - 1;
+}
+
+uint64_t RenderKey::Opaque(unsigned int pass, unsigned int shader, unsigned int material, unsigned int mesh, uint32_t depth)
+{
+	return
+		(Field(pass, PassBits) << passShift) |
+		(Field(shader, ShaderBits) << (MaterialBits + MeshBits + DepthBits)) |
+		(Field(material, MaterialBits) << (MeshBits + DepthBits)) |
+		(Field(mesh, MeshBits) << DepthBits) |
+		Field(depth, DepthBits);
+}
+
+uint64_t RenderKey::Transparent(unsigned int pass, unsigned int shader, unsigned int material, unsigned int mesh, uint32_t depth)
+{
+	// Inverting the depth makes the far draws sort first
+	return
+		(Field(pass, PassBits) << passShift) |
+		(Field(maxDepth - Field(depth, DepthBits), DepthBits) << (ShaderBits + MaterialBits + MeshBits)) |
+		(Field(shader, ShaderBits) << (MaterialBits + MeshBits)) |
+		(Field(material, MaterialBits) << MeshBits) |
+		Field(mesh, MeshBits);
+}
+
+uint32_t RenderKey::QuantizeDepth(float viewDepth, float nearZ, float farZ)
+{
+	float t = (viewDepth - nearZ) / (farZ - nearZ);
+	t = std::clamp(t, 0.0f, 1.0f);
+	return (uint32_t)(t * maxDepth);
+}
+
+unsigned int RenderKey::GetPass(uint64_t key)
+{
+	return (unsigned int)(key >> passShift);
+}
+
+unsigned int RenderKey::GetOpaqueShader(uint64_t key)
+{
+	return (unsigned int)Field((unsigned int)(key >> (MaterialBits + MeshBits + DepthBits)), ShaderBits);
+}
+
+RenderQueue::RenderQueue() :
+	lastSortPasses(0)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::Clear()
+{
+	entries.clear();
+}
+
+void RenderQueue::Reserve(size_t count)
+{
+	entries.reserve(count);
+	scratch.reserve(count);
+}
+
+void RenderQueue::Add(uint64_t key, uint32_t payload)
+{
+	entries.push_back({ key, payload });
+}
+
+// --------------------------------------------------------
+// LSD radix sort over just the bits that vary between keys
+//
+// Every key is XORed with the first one, so the span from
+// the lowest to the highest differing bit is all that can
+// change the order. That span is cut into the fewest
+// digits of at most 10 bits, as equal as possible - 64
+// varying bits take 7 passes rather than 8 bytes' worth, a
+// frame's typical keys 5-6. Wider digits mean fewer passes
+// but more buckets to scatter into at once, and past 10
+// bits the scatter's cache misses cost more than the saved
+// pass (measured with Tests/Benchmarks).
+// --------------------------------------------------------
+void RenderQueue::Sort()
+{
+	lastSortPasses = 0;
+	size_t count = entries.size();
+	if (count < 2)
+		return;
+
+	uint64_t first = entries[0].Key;
+	uint64_t varying = 0;
+	for (const RenderQueueEntry& entry : entries)
+		varying |= entry.Key ^ first;
+	if (varying == 0)
+		return;
+
+	const unsigned int maxDigitBits = 10;
+	unsigned int lowBit = (unsigned int)std::countr_zero(varying);
+	unsigned int span = 64 - (unsigned int)std::countl_zero(varying) - lowBit;
+	unsigned int passes = (span + maxDigitBits - 1) / maxDigitBits;
+	unsigned int digitBits = (span + passes - 1) / passes;
+	unsigned int buckets = 1u << digitBits;
+	uint64_t digitMask = buckets - 1;
+
+	// Every digit's histogram in a single read of the keys
+	histograms.assign((size_t)passes * buckets, 0);
+	for (const RenderQueueEntry& entry : entries)
+	{
+		uint64_t key = entry.Key >> lowBit;
+		for (unsigned int p = 0; p < passes; p++)
+			histograms[(size_t)p * buckets + ((key >> (p * digitBits)) & digitMask)]++;
+	}
+
+	scratch.resize(count);
+	RenderQueueEntry* source = entries.data();
+	RenderQueueEntry* destination = scratch.data();
+
+	for (unsigned int p = 0; p < passes; p++)
+	{
+		uint32_t* histogram = &histograms[(size_t)p * buckets];
+
+		// Bucket counts to starting offsets
+		uint32_t offset = 0;
+		for (unsigned int i = 0; i < buckets; i++)
+		{
+			uint32_t bucket = histogram[i];
+			histogram[i] = offset;
+			offset += bucket;
+		}
+
+		unsigned int shift = lowBit + p * digitBits;
+		for (size_t i = 0; i < count; i++)
+		{
+			const RenderQueueEntry& entry = source[i];
+			destination[histogram[(entry.Key >> shift) & digitMask]++] = entry;
+		}
+
+		std::swap(source, destination);
+		lastSortPasses++;
+	}
+
+	// An odd number of passes leaves the result in scratch
+	if (source != entries.data())
+		entries.swap(scratch);
+}
+
+const std::vector<RenderQueueEntry>& RenderQueue::GetEntries() { return entries; }
+size_t RenderQueue::GetCount() { return entries.size(); }
+unsigned int RenderQueue::GetLastSortPasses() { return lastSortPasses; }
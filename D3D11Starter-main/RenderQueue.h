@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --------------------------------------------------------
+// 64-bit draw sort keys
+//
+// The pass always sits in the top bits, so passes draw in
+// ascending order. Below that:
+//
+//  Opaque:       [pass:4][shader:8][material:12][mesh:16][depth:24]
+//   - Grouped by state first, so state changes are rare,
+//     then front-to-back within a mesh for early-z
+//
+//  Transparent:  [pass:4][~depth:24][shader:8][material:12][mesh:16]
+//   - Back-to-front first (blending needs it), state only
+//     breaks ties between draws at the same depth
+//
+// Fields wider than their bit count are masked.
+// --------------------------------------------------------
+namespace RenderKey
+{
+	const unsigned int PassBits = 4;
+	const unsigned int ShaderBits = 8;
+	const unsigned int MaterialBits = 12;
+	const unsigned int MeshBits = 16;
+	const unsigned int DepthBits = 24;
+
+	uint64_t Opaque(unsigned int pass, unsigned int shader, unsigned int material, unsigned int mesh, uint32_t depth);
+	uint64_t Transparent(unsigned int pass, unsigned int shader, unsigned int material, unsigned int mesh, uint32_t depth);
+
+	// View-space depth to a DepthBits-wide integer, linear between the planes
+	uint32_t QuantizeDepth(float viewDepth, float nearZ, float farZ);
+
+	unsigned int GetPass(uint64_t key);
+	unsigned int GetOpaqueShader(uint64_t key);	// Only for Opaque() keys
+}
+
+// One queued draw - the payload is whatever index the caller
+// needs to find the draw's data again (e.g. into a draw list)
+struct RenderQueueEntry
+{
+	uint64_t Key;
+	uint32_t Payload;
+};
+
+// --------------------------------------------------------
+// Collects a frame's draws and sorts them by key
+//
+// The sort is an LSD radix sort over only the bits that
+// differ between keys (unused passes, a single shader, ...
+// cost nothing), in digits of up to 10 bits. All of the
+// histograms are built in one pass up front. It's stable,
+// so draws with equal keys stay in submission order.
+// --------------------------------------------------------
+class RenderQueue
+{
+public:
+	// Basic OOP Setup
+	RenderQueue();
+	~RenderQueue();
+	RenderQueue(const RenderQueue&) = delete;
+	RenderQueue& operator=(const RenderQueue&) = delete;
+
+	void Clear();
+	void Reserve(size_t count);
+	void Add(uint64_t key, uint32_t payload);
+	void Sort();
+
+	// Getters
+	const std::vector<RenderQueueEntry>& GetEntries();
+	size_t GetCount();
+	unsigned int GetLastSortPasses();	// Digits the last sort scattered on
+
+private:
+	std::vector<RenderQueueEntry> entries;
+	std::vector<RenderQueueEntry> scratch;
+	std::vector<uint32_t> histograms;
+	unsigned int lastSortPasses;
+};
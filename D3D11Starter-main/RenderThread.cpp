@@ -0,0 +1,152 @@
+#include "RenderThread.h"
+
+#include <chrono>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	float MillisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	}
+}
+
+RenderThread::RenderThread(FramePacketConsumer consumer, bool useThread) :
+	consumer(consumer),
+	writeIndex(0),
+	building(false),
+	inUse{},
+	readIndex(0),
+	queuedCount(0),
+	stopping(false),
+	stats{}
+{
+	if (useThread)
+		thread = std::thread(&RenderThread::RenderLoop, this);
+}
+
+RenderThread::~RenderThread()
+{
+	if (!thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	submitted.notify_all();
+	thread.join();
+}
+
+// --------------------------------------------------------
+// Hands back the next packet to fill, once the render
+// thread has finished drawing what was in it
+// --------------------------------------------------------
+FramePacket& RenderThread::BeginPacket(uint64_t frameNumber, float deltaTime, float totalTime)
+{
+	Clock::time_point start = Clock::now();
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		rendered.wait(lock, [&]() { return !inUse[writeIndex]; });
+		stats.GameWaitMilliseconds = MillisecondsSince(start);
+	}
+
+	building = true;
+	packets[writeIndex].Reset(frameNumber, deltaTime, totalTime);
+	return packets[writeIndex];
+}
+
+void RenderThread::SubmitPacket()
+{
+	if (!building)
+		return;
+
+	unsigned int index = writeIndex;
+	packets[index].Finish();
+	building = false;
+	writeIndex = (writeIndex + 1) % PacketCount;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		inUse[index] = true;
+		queuedCount++;
+		stats.PacketsSubmitted++;
+	}
+
+	if (thread.joinable())
+	{
+		submitted.notify_one();
+	}
+	else
+	{
+		readIndex = writeIndex;
+		queuedCount--;
+		Render(index);
+	}
+}
+
+void RenderThread::WaitForIdle()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	rendered.wait(lock, [&]()
+		{
+			for (bool used : inUse)
+			{
+				if (used)
+					return false;
+			}
+			return true;
+		});
+}
+
+// --------------------------------------------------------
+// Draws packets in the order they were submitted until
+// stopped - anything already submitted is still drawn
+// --------------------------------------------------------
+void RenderThread::RenderLoop()
+{
+	while (true)
+	{
+		Clock::time_point start = Clock::now();
+		unsigned int index = 0;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			submitted.wait(lock, [&]() { return stopping || queuedCount > 0; });
+			if (queuedCount == 0)
+				return;
+
+			index = readIndex;
+			readIndex = (readIndex + 1) % PacketCount;
+			queuedCount--;
+			stats.RenderWaitMilliseconds = MillisecondsSince(start);
+		}
+
+		Render(index);
+	}
+}
+
+void RenderThread::Render(unsigned int index)
+{
+	Clock::time_point start = Clock::now();
+	consumer(packets[index]);
+	float elapsed = MillisecondsSince(start);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		inUse[index] = false;
+		stats.PacketsRendered++;
+		stats.RenderMilliseconds = elapsed;
+	}
+	rendered.notify_all();
+}
+
+bool RenderThread::IsThreaded() { return thread.joinable(); }
+
+RenderThreadStats RenderThread::GetStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "FramePacket.h"
+
+// Draws one packet, on the render thread
+using FramePacketConsumer = std::function<void(const FramePacket& packet)>;
+
+// How the two threads are keeping up with each other
+struct RenderThreadStats
+{
+	uint64_t PacketsSubmitted;
+	uint64_t PacketsRendered;
+	float GameWaitMilliseconds;		// Last BeginPacket(), waiting for the render thread to free a packet
+	float RenderWaitMilliseconds;	// Render thread idle before its last packet
+	float RenderMilliseconds;		// Render thread drawing its last packet
+};
+
+// --------------------------------------------------------
+// Runs the drawing on its own thread, one frame behind the
+// game thread, with two FramePackets between them
+//
+// Each frame the game thread fills one packet
+// (BeginPacket(), then SubmitPacket()) while the render
+// thread draws the other, so simulation and submission
+// overlap instead of taking turns. BeginPacket() only waits
+// when the render thread still has the packet it's about to
+// reuse - i.e. when the game thread is a whole frame ahead.
+//
+// Packets are drawn in the order they're submitted, and
+// each is only touched by one thread at a time, so packets
+// themselves need no locking.
+//
+// Pure CPU: whatever draws the packets is handed in, so the
+// handoff can be run without a device. Without a thread,
+// packets are drawn inside SubmitPacket() instead.
+// --------------------------------------------------------
+class RenderThread
+{
+public:
+	static const unsigned int PacketCount = 2;
+
+	// Basic OOP Setup
+	explicit RenderThread(FramePacketConsumer consumer, bool useThread = true);
+	~RenderThread();	// Draws whatever was submitted, then stops the thread
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	// Game thread
+	FramePacket& BeginPacket(uint64_t frameNumber, float deltaTime, float totalTime);	// Reset and ready to fill
+	void SubmitPacket();	// Finishes the packet from BeginPacket() and hands it over
+	void WaitForIdle();		// Until every submitted packet is drawn (before resizing, say)
+
+	// Getters
+	bool IsThreaded();
+	RenderThreadStats GetStats();
+
+private:
+	void RenderLoop();
+	void Render(unsigned int packet);
+
+	FramePacketConsumer consumer;
+	FramePacket packets[PacketCount];
+	unsigned int writeIndex;	// The game thread's packet
+	bool building;
+
+	// Shared with the render thread
+	std::mutex mutex;
+	std::condition_variable submitted;
+	std::condition_variable rendered;
+	bool inUse[PacketCount];	// Submitted and not drawn yet
+	unsigned int readIndex;		// The next packet to draw
+	unsigned int queuedCount;
+	bool stopping;
+	RenderThreadStats stats;
+
+	std::thread thread;
+};
@@ -0,0 +1,327 @@
+#include "RibbonSystem.h"
+#include "PackedVertex.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Below this many trails, waking the pool costs more than it saves
+	const unsigned int minTrailsPerChunk = 256;
+
+	// Squared segment lengths below this count as no segment at all
+	const float minSegmentLengthSq = 1e-12f;
+
+	static_assert((RibbonSystem::PointsPerTrail & (RibbonSystem::PointsPerTrail - 1)) == 0, "Ring indexing relies on a power of two");
+
+	// Each ring holds every point twice, one ring's length apart,
+	// between guards that four-wide loads can overrun into
+	const size_t RingGuard = 4;
+	const size_t RingStride = RibbonSystem::PointsPerTrail * 2 + RingGuard * 2;
+
+	// --------------------------------------------------------
+	// Unit length copies of the four vectors held in x, y and z,
+	// with any that are too short to normalize set to zero
+	// --------------------------------------------------------
+	void Normalize(XMVECTOR& x, XMVECTOR& y, XMVECTOR& z, XMVECTOR lengthSq)
+	{
+		XMVECTOR valid = XMVectorGreater(lengthSq, XMVectorReplicate(minSegmentLengthSq));
+		XMVECTOR scale = XMVectorSelect(XMVectorZero(), XMVectorReciprocalSqrtEst(lengthSq), valid);
+		x = XMVectorMultiply(x, scale);
+		y = XMVectorMultiply(y, scale);
+		z = XMVectorMultiply(z, scale);
+	}
+
+	XMVECTOR LengthSq(XMVECTOR x, XMVECTOR y, XMVECTOR z)
+	{
+		return XMVectorMultiplyAdd(x, x, XMVectorMultiplyAdd(y, y, XMVectorMultiply(z, z)));
+	}
+}
+
+RibbonSystem::RibbonSystem(WorkerPool* pool) :
+	pool(pool),
+	liveTrails(0),
+	vertexCount(0),
+	indexCount(0),
+	expandMilliseconds(0)
+{
+}
+
+RibbonSystem::~RibbonSystem()
+{
+}
+
+unsigned int RibbonSystem::CreateTrail(const RibbonStyle& style)
+{
+	unsigned int trail;
+	if (!freeTrails.empty())
+	{
+		trail = freeTrails.back();
+		freeTrails.pop_back();
+	}
+	else
+	{
+		trail = (unsigned int)trails.size();
+		trails.push_back({});
+
+		size_t slots = trails.size() * RingStride;
+		pointX.resize(slots);
+		pointY.resize(slots);
+		pointZ.resize(slots);
+		pointTime.resize(slots);
+	}
+
+	trails[trail] = { style, 0, 0, true };
+	liveTrails++;
+	return trail;
+}
+
+void RibbonSystem::DestroyTrail(unsigned int trail)
+{
+	if (trail >= trails.size() || !trails[trail].Alive)
+		return;
+
+	trails[trail].Alive = false;
+	trails[trail].Count = 0;
+	freeTrails.push_back(trail);
+	liveTrails--;
+}
+
+void RibbonSystem::ClearTrail(unsigned int trail)
+{
+	trails[trail].Count = 0;
+}
+
+void RibbonSystem::SetStyle(unsigned int trail, const RibbonStyle& style)
+{
+	trails[trail].Style = style;
+}
+
+void RibbonSystem::AddPoint(unsigned int trail, const XMFLOAT3& position, float time)
+{
+	Trail& t = trails[trail];
+	size_t slot = (size_t)trail * RingStride + RingGuard + t.Head;
+	for (size_t copy : { slot, slot + PointsPerTrail })
+	{
+		pointX[copy] = position.x;
+		pointY[copy] = position.y;
+		pointZ[copy] = position.z;
+		pointTime[copy] = time;
+	}
+
+	t.Head = (t.Head + 1) & (PointsPerTrail - 1);
+	t.Count = std::min(t.Count + 1, PointsPerTrail);
+}
+
+void RibbonSystem::Expand(const XMFLOAT3& eyePosition, float time)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	// Age out old points and lay the trails out in the stream
+	// - Points are in time order, so the expired ones are the oldest
+	unsigned int trailCount = (unsigned int)trails.size();
+	firstVertex.resize(trailCount);
+	firstIndex.resize(trailCount);
+	indexedRanges.resize(trailCount, { InvalidTrail, InvalidTrail, 0 });
+	vertexCount = 0;
+	indexCount = 0;
+	for (unsigned int i = 0; i < trailCount; i++)
+	{
+		Trail& t = trails[i];
+		const float* times = &pointTime[(size_t)i * RingStride + RingGuard];
+		float oldest = time - t.Style.Lifetime;
+		while (t.Count > 0 && times[(t.Head - t.Count) & (PointsPerTrail - 1)] < oldest)
+			t.Count--;
+
+		if (t.Count < 2)
+		{
+			firstVertex[i] = InvalidTrail;
+			continue;
+		}
+
+		firstVertex[i] = vertexCount;
+		firstIndex[i] = indexCount;
+		vertexCount += t.Count * 2;
+		indexCount += (t.Count - 1) * 6;
+	}
+
+	// Every entry is overwritten or still current, so there's no need to clear anything
+	if (vertices.size() < vertexCount)
+		vertices.resize(vertexCount);
+	if (indices.size() < indexCount)
+		indices.resize(indexCount);
+
+	unsigned int chunkCount = 1;
+	if (pool)
+		chunkCount = std::clamp(trailCount / minTrailsPerChunk, 1u, pool->GetThreadCount());
+
+	if (chunkCount == 1)
+	{
+		for (unsigned int i = 0; i < trailCount; i++)
+			ExpandTrail(i, eyePosition, time);
+	}
+	else
+	{
+		pool->ParallelFor(trailCount, chunkCount,
+			[&](unsigned int, unsigned int begin, unsigned int end)
+			{
+				for (unsigned int i = begin; i < end; i++)
+					ExpandTrail(i, eyePosition, time);
+			});
+	}
+
+	expandMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --------------------------------------------------------
+// Writes one trail's strip to its place in the stream
+// --------------------------------------------------------
+void RibbonSystem::ExpandTrail(unsigned int trail, const XMFLOAT3& eyePosition, float time)
+{
+	if (firstVertex[trail] == InvalidTrail)
+		return;
+
+	const Trail& t = trails[trail];
+	unsigned int count = t.Count;
+
+	// Thanks to the mirror, the points from oldest to newest are
+	// always contiguous, starting at the oldest one's first copy
+	size_t oldest = (size_t)trail * RingStride + RingGuard + ((t.Head - count) & (PointsPerTrail - 1));
+	const float* x = &pointX[oldest];
+	const float* y = &pointY[oldest];
+	const float* z = &pointZ[oldest];
+	const float* times = &pointTime[oldest];
+
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR one = XMVectorReplicate(1.0f);
+	const XMVECTOR eyeX = XMVectorReplicate(eyePosition.x);
+	const XMVECTOR eyeY = XMVectorReplicate(eyePosition.y);
+	const XMVECTOR eyeZ = XMVectorReplicate(eyePosition.z);
+	const XMVECTOR minMiterDot = XMVectorReplicate(1.0f / MaxMiterScale);
+	const XMVECTOR halfWidth = XMVectorReplicate(t.Style.Width * 0.5f);
+	const XMVECTOR now = XMVectorReplicate(time);
+	const XMVECTOR invLifetime = XMVectorReplicate(t.Style.Lifetime > 0 ? 1.0f / t.Style.Lifetime : 0.0f);
+	const XMVECTOR alpha = XMVectorReplicate(std::clamp(t.Style.Color.w, 0.0f, 1.0f) * 255.0f);
+	const XMVECTOR lastSegment = XMVectorReplicate((float)(count - 1));
+	const XMVECTOR laneOffsets = XMVectorSet(0, 1, 2, 3);
+
+	// Alpha is swapped in per vertex
+	const XMVECTOR rgb = XMVectorReplicateInt(VertexPacking::PackColor(t.Style.Color) & 0x00FFFFFF);
+
+	// The first point has no incoming segment
+	XMVECTOR previousOutX = zero, previousOutY = zero, previousOutZ = zero;
+
+	RibbonVertex* out = &vertices[firstVertex[trail]];
+	for (unsigned int i = 0; i < count; i += 4)
+	{
+		// Loads may run a point either side of the trail into the
+		// guards (or past the newest point), which the masks below
+		// and the lane count at the end keep out of the results
+		auto load = [](const float* values, ptrdiff_t at) { return XMLoadFloat4((const XMFLOAT4*)&values[at]); };
+		XMVECTOR px = load(x, i), py = load(y, i), pz = load(z, i);
+
+		// Directions of the segments either side of each point
+		// - The ends have only one segment, so the other is zeroed
+		//   and they simply follow the one they have
+		// - A point's incoming segment is the previous point's
+		//   outgoing one, so each is only worked out once: shifted
+		//   along a lane, with the last lane of the step before
+		XMVECTOR point = XMVectorAdd(XMVectorReplicate((float)i), laneOffsets);
+		XMVECTOR hasOut = XMVectorLess(point, lastSegment);
+		XMVECTOR outX = XMVectorAndInt(XMVectorSubtract(load(x, i + 1), px), hasOut);
+		XMVECTOR outY = XMVectorAndInt(XMVectorSubtract(load(y, i + 1), py), hasOut);
+		XMVECTOR outZ = XMVectorAndInt(XMVectorSubtract(load(z, i + 1), pz), hasOut);
+		XMVECTOR outLengthSq = LengthSq(outX, outY, outZ);
+		Normalize(outX, outY, outZ, outLengthSq);
+		XMVECTOR inX = XMVectorShiftLeft(previousOutX, outX, 3);
+		XMVECTOR inY = XMVectorShiftLeft(previousOutY, outY, 3);
+		XMVECTOR inZ = XMVectorShiftLeft(previousOutZ, outZ, 3);
+		previousOutX = outX;
+		previousOutY = outY;
+		previousOutZ = outZ;
+
+		XMVECTOR toEyeX = XMVectorSubtract(eyeX, px);
+		XMVECTOR toEyeY = XMVectorSubtract(eyeY, py);
+		XMVECTOR toEyeZ = XMVectorSubtract(eyeZ, pz);
+
+		// Across the strip: perpendicular to both the averaged direction
+		// (the miter) and the eye, so the strip faces the eye
+		XMVECTOR tangentX = XMVectorAdd(inX, outX);
+		XMVECTOR tangentY = XMVectorAdd(inY, outY);
+		XMVECTOR tangentZ = XMVectorAdd(inZ, outZ);
+		XMVECTOR sideX = XMVectorNegativeMultiplySubtract(tangentZ, toEyeY, XMVectorMultiply(tangentY, toEyeZ));
+		XMVECTOR sideY = XMVectorNegativeMultiplySubtract(tangentX, toEyeZ, XMVectorMultiply(tangentZ, toEyeX));
+		XMVECTOR sideZ = XMVectorNegativeMultiplySubtract(tangentY, toEyeX, XMVectorMultiply(tangentX, toEyeY));
+		Normalize(sideX, sideY, sideZ, LengthSq(sideX, sideY, sideZ));
+
+		// The miter is longer than the width by 1 / cos(half the turn),
+		// which is its dot product with either segment's own side
+		XMVECTOR segmentX = XMVectorSelect(inX, outX, XMVectorGreater(outLengthSq, XMVectorReplicate(minSegmentLengthSq)));
+		XMVECTOR segmentY = XMVectorSelect(inY, outY, XMVectorGreater(outLengthSq, XMVectorReplicate(minSegmentLengthSq)));
+		XMVECTOR segmentZ = XMVectorSelect(inZ, outZ, XMVectorGreater(outLengthSq, XMVectorReplicate(minSegmentLengthSq)));
+		XMVECTOR segmentSideX = XMVectorNegativeMultiplySubtract(segmentZ, toEyeY, XMVectorMultiply(segmentY, toEyeZ));
+		XMVECTOR segmentSideY = XMVectorNegativeMultiplySubtract(segmentX, toEyeZ, XMVectorMultiply(segmentZ, toEyeX));
+		XMVECTOR segmentSideZ = XMVectorNegativeMultiplySubtract(segmentY, toEyeX, XMVectorMultiply(segmentX, toEyeY));
+		Normalize(segmentSideX, segmentSideY, segmentSideZ, LengthSq(segmentSideX, segmentSideY, segmentSideZ));
+
+		XMVECTOR miterDot = XMVectorMultiplyAdd(sideX, segmentSideX, XMVectorMultiplyAdd(sideY, segmentSideY, XMVectorMultiply(sideZ, segmentSideZ)));
+		XMVECTOR offset = XMVectorMultiply(halfWidth, XMVectorReciprocalEst(XMVectorMax(miterDot, minMiterDot)));
+		sideX = XMVectorMultiply(sideX, offset);
+		sideY = XMVectorMultiply(sideY, offset);
+		sideZ = XMVectorMultiply(sideZ, offset);
+
+		// Age across the lifetime, which fades alpha out
+		XMVECTOR age = XMVectorSaturate(XMVectorMultiply(XMVectorSubtract(now, load(times, i)), invLifetime));
+		XMVECTOR fade = XMVectorTruncate(XMVectorMultiplyAdd(XMVectorNegativeMultiplySubtract(age, one, one), alpha, XMVectorReplicate(0.5f)));
+		XMVECTOR color = XMVectorOrInt(XMConvertVectorFloatToUInt(fade, 24), rgb);
+
+		// Each point's pair of vertices is 12 floats - left position and u,
+		// then v, color, right x and y, then right z, u, v and color - so
+		// transposing three sets of four vectors gives a point's pair per row
+		XMMATRIX first = XMMatrixTranspose(XMMATRIX(XMVectorAdd(px, sideX), XMVectorAdd(py, sideY), XMVectorAdd(pz, sideZ), age));
+		XMMATRIX second = XMMatrixTranspose(XMMATRIX(zero, color, XMVectorSubtract(px, sideX), XMVectorSubtract(py, sideY)));
+		XMMATRIX third = XMMatrixTranspose(XMMATRIX(XMVectorSubtract(pz, sideZ), age, one, color));
+
+		// The last few points of a trail mustn't spill into the next trail
+		unsigned int lanes = std::min(4u, count - i);
+		for (unsigned int lane = 0; lane < lanes; lane++)
+		{
+			XMFLOAT4* pair = (XMFLOAT4*)&out[(i + lane) * 2];
+			XMStoreFloat4(&pair[0], first.r[lane]);
+			XMStoreFloat4(&pair[1], second.r[lane]);
+			XMStoreFloat4(&pair[2], third.r[lane]);
+		}
+	}
+
+	// Two triangles per segment, clockwise as seen from the eye
+	unsigned int base = firstVertex[trail];
+	IndexedRange& indexed = indexedRanges[trail];
+	if (indexed.FirstVertex == base && indexed.FirstIndex == firstIndex[trail] && indexed.Count == count)
+		return;
+	indexed = { base, firstIndex[trail], count };
+
+	unsigned int* index = &indices[firstIndex[trail]];
+	for (unsigned int segment = 0; segment + 1 < count; segment++)
+	{
+		unsigned int v = base + segment * 2;
+		index[0] = v;
+		index[1] = v + 2;
+		index[2] = v + 1;
+		index[3] = v + 2;
+		index[4] = v + 3;
+		index[5] = v + 1;
+		index += 6;
+	}
+}
+
+std::span<const RibbonVertex> RibbonSystem::GetVertices() { return std::span<const RibbonVertex>(vertices.data(), vertexCount); }
+std::span<const unsigned int> RibbonSystem::GetIndices() { return std::span<const unsigned int>(indices.data(), indexCount); }
+unsigned int RibbonSystem::GetTrailCount() { return liveTrails; }
+unsigned int RibbonSystem::GetPointCount(unsigned int trail) { return trails[trail].Count; }
+float RibbonSystem::GetExpandMilliseconds() { return expandMilliseconds; }
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class WorkerPool;
+
+// --------------------------------------------------------
+// One corner of an expanded ribbon
+// - Must match RibbonVertexLayout and VertexShaderRibbon.hlsl
+// --------------------------------------------------------
+struct RibbonVertex
+{
+	DirectX::XMFLOAT3 Position;	// World space
+	DirectX::XMFLOAT2 UV;		// u = age across the trail's lifetime, v = 0 on one edge and 1 on the other
+	uint32_t Color;				// RGBA8 UNORM, red in the lowest byte, alpha faded by age
+};
+
+static_assert(sizeof(RibbonVertex) == 24, "RibbonVertex must match its input layout");
+
+// --------------------------------------------------------
+// How one trail looks
+// --------------------------------------------------------
+struct RibbonStyle
+{
+	float Width;				// World units from edge to edge
+	float Lifetime;				// Seconds a point lasts before it's dropped
+	DirectX::XMFLOAT4 Color;	// Alpha falls to zero over the lifetime
+};
+
+// --------------------------------------------------------
+// Trails, swipes and streaks behind moving things, all
+// expanded into one vertex and index stream per frame
+//
+// Each trail keeps its last PointsPerTrail positions in a
+// ring, with the components of every trail's ring stored in
+// separate arrays (x, y, z and time), and every point written
+// twice so the ring reads in order without unrolling it.
+// Expand() drops points that have outlived the trail, then
+// turns every trail into a strip facing the eye - two vertices per point, pushed
+// out along the miter between neighboring segments so the
+// strip keeps its width around corners - and lays the
+// strips end to end in one triangle list.
+//
+// The points of a trail are expanded four at a time with
+// DirectXMath, and trails are shared out across the pool,
+// each writing to its own range of the stream. A trail's
+// indices only depend on where it sits in the stream and how
+// many points it has, so they're only rewritten when those
+// change.
+//
+// Pure CPU: the stream is uploaded and drawn by the caller.
+// --------------------------------------------------------
+class RibbonSystem
+{
+public:
+	static const unsigned int PointsPerTrail = 32;
+	static const unsigned int InvalidTrail = 0xFFFFFFFF;
+
+	// Miters at sharper turns than this (2 = 120 degrees) are
+	// capped, so the join gets thinner instead of spiking out
+	static constexpr float MaxMiterScale = 2.0f;
+
+	// Basic OOP Setup
+	explicit RibbonSystem(WorkerPool* pool = nullptr);	// Null expands everything on the calling thread
+	~RibbonSystem();
+	RibbonSystem(const RibbonSystem&) = delete;
+	RibbonSystem& operator=(const RibbonSystem&) = delete;
+
+	// Trails
+	unsigned int CreateTrail(const RibbonStyle& style);
+	void DestroyTrail(unsigned int trail);
+	void ClearTrail(unsigned int trail);
+	void SetStyle(unsigned int trail, const RibbonStyle& style);
+
+	// Adds the newest point - the oldest goes once the ring is full
+	void AddPoint(unsigned int trail, const DirectX::XMFLOAT3& position, float time);
+
+	// Rebuilds the stream from every trail as seen from eyePosition at time
+	void Expand(const DirectX::XMFLOAT3& eyePosition, float time);
+
+	// Getters
+	std::span<const RibbonVertex> GetVertices();	// Valid until the next Expand()
+	std::span<const unsigned int> GetIndices();		// Triangle list into GetVertices()
+	unsigned int GetTrailCount();					// Live trails
+	unsigned int GetPointCount(unsigned int trail);
+	float GetExpandMilliseconds();					// Wall time of the last Expand()
+
+private:
+	struct Trail
+	{
+		RibbonStyle Style;
+		unsigned int Head;		// Ring slot the next point goes in
+		unsigned int Count;		// Points in the ring, newest just before Head
+		bool Alive;
+	};
+
+	void ExpandTrail(unsigned int trail, const DirectX::XMFLOAT3& eyePosition, float time);
+
+	WorkerPool* pool;
+
+	// Point rings - each point is stored at its slot and again
+	// PointsPerTrail later, so a trail's points always sit in
+	// order in one run, however the ring has wrapped
+	std::vector<float> pointX;
+	std::vector<float> pointY;
+	std::vector<float> pointZ;
+	std::vector<float> pointTime;
+
+	std::vector<Trail> trails;
+	std::vector<unsigned int> freeTrails;
+	unsigned int liveTrails;
+
+	// This frame's stream - grown, never shrunk, so only the
+	// first vertexCount/indexCount entries are current
+	std::vector<unsigned int> firstVertex;	// Per trail, or InvalidTrail when it's too short to draw
+	std::vector<unsigned int> firstIndex;
+
+	// Where each trail's indices were last written - a trail
+	// whose place and length haven't changed (most of them,
+	// most frames) has the same indices, so they're kept
+	struct IndexedRange
+	{
+		unsigned int FirstVertex;
+		unsigned int FirstIndex;
+		unsigned int Count;
+	};
+	std::vector<IndexedRange> indexedRanges;
+
+	std::vector<RibbonVertex> vertices;
+	std::vector<unsigned int> indices;
+	unsigned int vertexCount;
+	unsigned int indexCount;
+
+	float expandMilliseconds;
+};
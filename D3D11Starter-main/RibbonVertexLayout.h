@@ -0,0 +1,17 @@
+#pragma once
+
+#include <d3d11.h>
+
+#include "RibbonSystem.h"
+
+// --------------------------------------------------------
+// Input layout matching RibbonVertex
+// - COLOR is packed RGBA8, expanded to a float4 by the
+//   input assembler like the packed mesh formats
+// --------------------------------------------------------
+inline const D3D11_INPUT_ELEMENT_DESC RibbonVertexLayout[] =
+{
+	{ "POSITION",	0, DXGI_FORMAT_R32G32B32_FLOAT,	0, 0,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD",	0, DXGI_FORMAT_R32G32_FLOAT,	0, 12,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "COLOR",		0, DXGI_FORMAT_R8G8B8A8_UNORM,	0, 20,	D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
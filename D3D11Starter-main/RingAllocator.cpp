@@ -0,0 +1,80 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(unsigned int capacity, unsigned int alignment) :
+	capacity(capacity & ~(alignment - 1)),
+	alignment(alignment),
+	head(0),
+	tail(0),
+	frameStart(0),
+	frame(0)
+{
+}
+
+RingAllocator::~RingAllocator()
+{
+}
+
+// --------------------------------------------------------
+// Takes the next `size` bytes (rounded up to the alignment)
+// after the last allocation, wrapping to the start of the
+// pool if they'd run past the end
+// --------------------------------------------------------
+unsigned int RingAllocator::Allocate(unsigned int size)
+{
+	if (size == 0)
+		return InvalidOffset;
+
+	uint64_t alignedSize = ((uint64_t)size + alignment - 1) & ~(uint64_t)(alignment - 1);
+	if (alignedSize > capacity)
+		return InvalidOffset;
+
+	// Head is always aligned, so only the end of the pool can get in the way
+	uint64_t start = head;
+	uint64_t offset = start % capacity;
+	if (offset + alignedSize > capacity)
+	{
+		start += capacity - offset;
+		offset = 0;
+	}
+
+	// Would run into space a frame in flight is still using
+	if (start + alignedSize - tail > capacity)
+		return InvalidOffset;
+
+	head = start + alignedSize;
+	return (unsigned int)offset;
+}
+
+uint64_t RingAllocator::EndFrame()
+{
+	frames.push_back({ frame, head });
+	frameStart = head;
+	return frame++;
+}
+
+// --------------------------------------------------------
+// Frames finish in order, so everything up to the end of
+// the last released frame is free again
+// --------------------------------------------------------
+void RingAllocator::Release(uint64_t frame)
+{
+	while (!frames.empty() && frames.front().Frame <= frame)
+	{
+		tail = frames.front().Position;
+		frames.pop_front();
+	}
+}
+
+void RingAllocator::Reset()
+{
+	head = 0;
+	tail = 0;
+	frameStart = 0;
+	frames.clear();
+}
+
+unsigned int RingAllocator::GetCapacity() { return capacity; }
+unsigned int RingAllocator::GetAlignment() { return alignment; }
+unsigned int RingAllocator::GetUsedSpace() { return (unsigned int)(head - tail); }
+unsigned int RingAllocator::GetFrameSpace() { return (unsigned int)(head - frameStart); }
+unsigned int RingAllocator::GetFramesInFlight() { return (unsigned int)frames.size(); }
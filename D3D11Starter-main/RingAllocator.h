@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// --------------------------------------------------------
+// Linear allocator over a circular pool, for data that only
+// lives for a frame or two (per-draw constants, ...)
+//
+// Allocations are handed out back to back and never freed
+// one at a time. Instead, EndFrame() closes off everything
+// allocated since the last call and returns that frame's
+// number, and the owner calls Release() with it once the GPU
+// is done with the frame (a fence or event query passed).
+// Until then, the frame's space can't be handed out again.
+//
+// Every allocation starts on an alignment boundary and its
+// size is rounded up to one, so an allocation never straddles
+// the end of the pool: if it doesn't fit before the end, the
+// rest of the pool is skipped and it starts again at zero.
+// Like RangeAllocator, it only deals in offsets, so it knows
+// nothing about the buffer behind it.
+// --------------------------------------------------------
+class RingAllocator
+{
+public:
+	static const unsigned int InvalidOffset = 0xFFFFFFFF;
+
+	// Basic OOP Setup
+	// - capacity is rounded down to a multiple of alignment (a power of two)
+	RingAllocator(unsigned int capacity, unsigned int alignment);
+	~RingAllocator();
+
+	// Allocation - returns InvalidOffset when the space is still in use
+	unsigned int Allocate(unsigned int size);
+
+	// Call once per frame, after its last allocation
+	// - Returns the frame's number, to pass to Release() later
+	uint64_t EndFrame();
+
+	// Gives back the space of every frame up to and including this one
+	void Release(uint64_t frame);
+
+	// Forgets every allocation, including ones the GPU may still be reading
+	void Reset();
+
+	// Getters
+	unsigned int GetCapacity();
+	unsigned int GetAlignment();
+	unsigned int GetUsedSpace();	// Everything not yet given back, including skipped tails
+	unsigned int GetFrameSpace();	// Allocated since the last EndFrame()
+	unsigned int GetFramesInFlight();	// Ended but not yet released
+
+private:
+	unsigned int capacity;
+	unsigned int alignment;
+
+	// Positions only ever grow - the offset into the pool is position % capacity,
+	// and head - tail is how much is in use
+	uint64_t head;
+	uint64_t tail;
+	uint64_t frameStart;
+
+	// Where each ended but unreleased frame's allocations end
+	struct FrameEnd
+	{
+		uint64_t Frame;
+		uint64_t Position;
+	};
+	std::deque<FrameEnd> frames;
+	uint64_t frame;
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------
+// A 32-bit reference to an object in a SlotRegistry
+//  - Low 20 bits: slot index
+//  - High 12 bits: generation of that slot, so an ID for a
+//    destroyed object never finds whatever reuses its slot
+//
+// Zero is never handed out, so a zeroed ID is invalid.
+// --------------------------------------------------------
+struct SlotID
+{
+	static const unsigned int IndexBits = 20;
+	static const unsigned int GenerationBits = 12;
+	static const uint32_t IndexMask = (1u << IndexBits) - 1;
+	static const uint32_t GenerationMask = (1u << GenerationBits) - 1;
+
+	uint32_t Value;
+
+	unsigned int Index() const { return Value & IndexMask; }
+	unsigned int Generation() const { return Value >> IndexBits; }
+	bool IsValid() const { return Value != 0; }
+
+	bool operator==(const SlotID& other) const { return Value == other.Value; }
+	bool operator!=(const SlotID& other) const { return Value != other.Value; }
+};
+
+// --------------------------------------------------------
+// Owns objects and hands out SlotIDs for them
+//
+// Objects are built in place in stable storage, and lookups
+// only touch a dense array of slot generations, so draw
+// lists can hold plain 32-bit IDs instead of shared_ptrs.
+//
+// Destroy() invalidates the ID straight away, but the object
+// lives on until framesInFlight more calls to AdvanceFrame(),
+// so frames that still refer to it can finish with it.
+//
+// Pure CPU - see MeshRegistry for the GPU meshes this holds
+// in the game. A template only so it can be tested with
+// something other than a Mesh.
+// --------------------------------------------------------
+template <typename T>
+class SlotRegistry
+{
+public:
+	// Basic OOP Setup
+	explicit SlotRegistry(unsigned int framesInFlight = 2) :
+		frame(0),
+		framesInFlight(framesInFlight),
+		liveCount(0)
+	{
+	}
+
+	~SlotRegistry()
+	{
+		Clear();
+	}
+
+	SlotRegistry(const SlotRegistry&) = delete;
+	SlotRegistry& operator=(const SlotRegistry&) = delete;
+
+	// Builds a T in place from any of its constructors' arguments
+	// - Returns an invalid ID if every slot is taken
+	template <typename... Args>
+	SlotID Create(Args&&... args)
+	{
+		unsigned int index = AcquireSlot();
+		if (index > SlotID::IndexMask)
+			return SlotID{ 0 };
+
+		objects[index].emplace(std::forward<Args>(args)...);
+		liveCount++;
+		return SlotID{ (uint32_t)index | ((uint32_t)generations[index] << SlotID::IndexBits) };
+	}
+
+	// Null if the ID is invalid or its object was destroyed
+	T* Get(SlotID id)
+	{
+		unsigned int index = id.Index();
+		if (index >= generations.size() || generations[index] != id.Generation())
+			return nullptr;
+		return &*objects[index];
+	}
+
+	bool IsAlive(SlotID id)
+	{
+		return Get(id) != nullptr;
+	}
+
+	// --------------------------------------------------------
+	// Invalidates the ID now, and queues the object itself to
+	// be released once nothing can still be using it
+	// --------------------------------------------------------
+	void Destroy(SlotID id)
+	{
+		if (!Get(id))
+			return;
+
+		unsigned int index = id.Index();
+		NextGeneration(index);
+		retired.push_back({ index, frame });
+		liveCount--;
+	}
+
+	// --------------------------------------------------------
+	// Call once per frame - releases objects destroyed at least
+	// framesInFlight frames ago (retired is in frame order, so
+	// only the front matters)
+	// --------------------------------------------------------
+	void AdvanceFrame()
+	{
+		frame++;
+		while (!retired.empty() && retired.front().Frame + framesInFlight <= frame)
+		{
+			ReleaseSlot(retired.front().Index);
+			retired.pop_front();
+		}
+	}
+
+	// Releases everything immediately - only when nothing can be
+	// using any of it (shutdown)
+	void Clear()
+	{
+		for (unsigned int i = 0; i < generations.size(); i++)
+		{
+			if (objects[i].has_value())
+			{
+				// Live IDs must stop working too
+				NextGeneration(i);
+				ReleaseSlot(i);
+			}
+		}
+
+		retired.clear();
+		liveCount = 0;
+	}
+
+	// Getters
+	unsigned int GetLiveCount() { return liveCount; }
+	unsigned int GetRetiredCount() { return (unsigned int)retired.size(); }
+
+private:
+	// New generation - never zero, so a zeroed ID stays invalid
+	void NextGeneration(unsigned int index)
+	{
+		uint16_t generation = (generations[index] + 1) & SlotID::GenerationMask;
+		generations[index] = generation == 0 ? 1 : generation;
+	}
+
+	// --------------------------------------------------------
+	// Reuses a released slot if there is one, otherwise grows
+	// - Returns an index past IndexMask when full
+	// --------------------------------------------------------
+	unsigned int AcquireSlot()
+	{
+		if (!freeSlots.empty())
+		{
+			unsigned int index = freeSlots.back();
+			freeSlots.pop_back();
+			return index;
+		}
+
+		unsigned int index = (unsigned int)generations.size();
+		if (index > SlotID::IndexMask)
+			return index;
+
+		objects.emplace_back();
+		generations.push_back(1);
+		return index;
+	}
+
+	void ReleaseSlot(unsigned int index)
+	{
+		objects[index].reset();
+		freeSlots.push_back(index);
+	}
+
+	// Object storage - a deque never moves its elements, so T
+	// needn't be movable and pointers from Get() stay put
+	std::deque<std::optional<T>> objects;
+
+	// Current generation of every slot (what a live ID must match)
+	std::vector<uint16_t> generations;
+	std::vector<unsigned int> freeSlots;
+
+	// Destroyed objects waiting to be released
+	struct Retired
+	{
+		unsigned int Index;
+		uint64_t Frame;
+	};
+	std::deque<Retired> retired;
+
+	uint64_t frame;
+	unsigned int framesInFlight;
+	unsigned int liveCount;
+};
@@ -0,0 +1,716 @@
+#include "SoftwareRasterizer.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Below this many vertices or triangles, waking the pool costs more than it saves
+	const unsigned int minItemsPerThread = 1024;
+
+	float MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// --------------------------------------------------------
+	// Runs body(begin, end) over [0, count), spread across the
+	// pool if there is one and enough work to share
+	// --------------------------------------------------------
+	template <typename Body>
+	void ForRange(WorkerPool* pool, unsigned int count, Body body)
+	{
+		unsigned int chunkCount = 1;
+		if (pool)
+			chunkCount = std::clamp(count / minItemsPerThread, 1u, pool->GetThreadCount());
+
+		if (chunkCount == 1)
+		{
+			body(0u, count);
+			return;
+		}
+
+		pool->ParallelFor(count, chunkCount,
+			[&](unsigned int, unsigned int begin, unsigned int end) { body(begin, end); });
+	}
+
+	// Linear blend of two vertex shader outputs, for clipping
+	SoftwareVertexOutput Lerp(const SoftwareVertexOutput& a, const SoftwareVertexOutput& b, float t)
+	{
+		SoftwareVertexOutput result;
+		XMStoreFloat4(&result.ScreenPosition, XMVectorLerp(XMLoadFloat4(&a.ScreenPosition), XMLoadFloat4(&b.ScreenPosition), t));
+		XMStoreFloat4(&result.Color, XMVectorLerp(XMLoadFloat4(&a.Color), XMLoadFloat4(&b.Color), t));
+		return result;
+	}
+
+	typedef XMFLOAT4(*PixelShaderFunction)(const SoftwareVertexOutput& input);
+
+	// Is this the stock pixel shader, which only returns its input color?
+	bool IsPassThrough(const SoftwarePixelShader& shader)
+	{
+		const PixelShaderFunction* function = shader.target<PixelShaderFunction>();
+		return function && *function == SoftwareShaders::PixelShader;
+	}
+
+	// RGBA8, red in the low byte, as a DXGI_FORMAT_R8G8B8A8_UNORM target stores it
+	uint32_t PackColor(const XMFLOAT4& color)
+	{
+		XMFLOAT4 scaled;
+		XMStoreFloat4(&scaled, XMVectorMultiplyAdd(XMVectorSaturate(XMLoadFloat4(&color)), XMVectorReplicate(255.0f), XMVectorReplicate(0.5f)));
+		return
+			(uint32_t)scaled.x |
+			((uint32_t)scaled.y << 8) |
+			((uint32_t)scaled.z << 16) |
+			((uint32_t)scaled.w << 24);
+	}
+
+	// PackColor() for four pixels at once, one channel per vector -
+	// the same rounding, with the bytes shifted into place by scaling
+	// (red, green and blue sum exactly in a float's 24 bits, alpha
+	// needs an unsigned conversion of its own)
+	XMVECTOR PackColors(const XMVECTOR channels[4])
+	{
+		const XMVECTOR scale = XMVectorReplicate(255.0f);
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+
+		XMVECTOR bytes[4];
+		for (int c = 0; c < 4; c++)
+			bytes[c] = XMVectorTruncate(XMVectorMultiplyAdd(XMVectorSaturate(channels[c]), scale, half));
+
+		XMVECTOR rgb = XMVectorMultiplyAdd(bytes[2], XMVectorReplicate(65536.0f),
+			XMVectorMultiplyAdd(bytes[1], XMVectorReplicate(256.0f), bytes[0]));
+		XMVECTOR alpha = XMVectorScale(bytes[3], 16777216.0f);
+		return XMVectorOrInt(XMConvertVectorFloatToInt(rgb, 0), XMConvertVectorFloatToUInt(alpha, 0));
+	}
+
+	// --------------------------------------------------------
+	// CRC-32 as PNG chunks use it (the zlib/ISO-HDLC one),
+	// continuing from a previous crc so a chunk can be summed
+	// a piece at a time - start from 0
+	// --------------------------------------------------------
+	uint32_t Crc32(uint32_t crc, const unsigned char* data, size_t size)
+	{
+		static const std::array<uint32_t, 256> table = []()
+			{
+				std::array<uint32_t, 256> entries = {};
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					uint32_t value = i;
+					for (int bit = 0; bit < 8; bit++)
+						value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+					entries[i] = value;
+				}
+				return entries;
+			}();
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	void AppendBigEndian(std::vector<unsigned char>& out, uint32_t value)
+	{
+		out.push_back((unsigned char)(value >> 24));
+		out.push_back((unsigned char)(value >> 16));
+		out.push_back((unsigned char)(value >> 8));
+		out.push_back((unsigned char)value);
+	}
+
+	// Length, type, data and the CRC of the type and data
+	void WriteChunk(std::ofstream& file, const char type[4], const std::vector<unsigned char>& data)
+	{
+		std::vector<unsigned char> header;
+		AppendBigEndian(header, (uint32_t)data.size());
+		header.insert(header.end(), type, type + 4);
+
+		std::vector<unsigned char> crc;
+		AppendBigEndian(crc, Crc32(Crc32(0, header.data() + 4, 4), data.data(), data.size()));
+
+		file.write((const char*)header.data(), header.size());
+		file.write((const char*)data.data(), data.size());
+		file.write((const char*)crc.data(), crc.size());
+	}
+}
+
+// --------------------------------------------------------
+// VertexShader.hlsl: transform by world * view * projection
+// and tint the vertex color
+//
+// The HLSL's mul(matrix, vector) with column-major packing is
+// vector * matrix on the CPU, hence the reversed order here.
+// --------------------------------------------------------
+SoftwareVertexOutput SoftwareShaders::VertexShader(const Vertex& input, const SoftwareDrawConstants& constants)
+{
+	SoftwareVertexOutput output;
+
+	XMMATRIX wvp = XMLoadFloat4x4(&constants.WorldViewProjection);
+	XMVECTOR position = XMVectorSet(input.Position.x, input.Position.y, input.Position.z, 1.0f);
+	XMStoreFloat4(&output.ScreenPosition, XMVector4Transform(position, wvp));
+
+	XMStoreFloat4(&output.Color, XMVectorMultiply(XMLoadFloat4(&input.Color), XMLoadFloat4(&constants.Object.colorTint)));
+	return output;
+}
+
+// --------------------------------------------------------
+// PixelShader.hlsl: just return the interpolated color
+// --------------------------------------------------------
+XMFLOAT4 SoftwareShaders::PixelShader(const SoftwareVertexOutput& input)
+{
+	return input.Color;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned int width, unsigned int height, WorkerPool* pool) :
+	pool(pool),
+	width(width),
+	height(height),
+	tilesX((width + TileSize - 1) / TileSize),
+	tilesY((height + TileSize - 1) / TileSize),
+	stride(tilesX * TileSize),
+	vertexShader(SoftwareShaders::VertexShader),
+	pixelShader(SoftwareShaders::PixelShader),
+	trianglesDrawn(0),
+	trianglesRasterized(0),
+	drawMilliseconds(0),
+	finishMilliseconds(0)
+{
+	XMStoreFloat4x4(&view, XMMatrixIdentity());
+	XMStoreFloat4x4(&projection, XMMatrixIdentity());
+
+	// Padded to whole tiles, so four-pixel steps never run off a row
+	colorBuffer.resize((size_t)stride * tilesY * TileSize);
+	depthBuffer.resize((size_t)stride * tilesY * TileSize);
+	tileBins.resize(tilesX * tilesY);
+
+	Clear(XMFLOAT4(0, 0, 0, 0));
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+}
+
+void SoftwareRasterizer::SetShaders(SoftwareVertexShader vertexShader, SoftwarePixelShader pixelShader)
+{
+	this->vertexShader = vertexShader;
+	this->pixelShader = pixelShader;
+}
+
+void SoftwareRasterizer::SetCamera(const XMFLOAT4X4& view, const XMFLOAT4X4& projection)
+{
+	this->view = view;
+	this->projection = projection;
+}
+
+void SoftwareRasterizer::Clear(const XMFLOAT4& color, float depth)
+{
+	std::fill(colorBuffer.begin(), colorBuffer.end(), PackColor(color));
+	std::fill(depthBuffer.begin(), depthBuffer.end(), depth);
+
+	triangles.clear();
+	pixelShaders.clear();
+	passThroughShaders.clear();
+	for (std::vector<unsigned int>& bin : tileBins)
+		bin.clear();
+
+	trianglesDrawn = 0;
+	trianglesRasterized = 0;
+	drawMilliseconds = 0;
+}
+
+void SoftwareRasterizer::Draw(
+	const Vertex* vertices, int vertexCount,
+	const unsigned int* indices, int indexCount,
+	const BufferStruct& constants)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	SoftwareDrawConstants drawConstants;
+	drawConstants.Object = constants;
+	drawConstants.View = view;
+	drawConstants.Projection = projection;
+	XMStoreFloat4x4(&drawConstants.WorldViewProjection,
+		XMLoadFloat4x4(&constants.world) * XMLoadFloat4x4(&view) * XMLoadFloat4x4(&projection));
+
+	// Vertex shading
+	shadedVertices.resize(vertexCount);
+	ForRange(pool, vertexCount,
+		[&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+				shadedVertices[i] = vertexShader(vertices[i], drawConstants);
+		});
+
+	// Triangle setup - near clipping can split one triangle into two
+	unsigned int triangleCount = indexCount / 3;
+	unsigned int shader = (unsigned int)pixelShaders.size();
+	pixelShaders.push_back(pixelShader);
+	passThroughShaders.push_back(IsPassThrough(pixelShader));
+
+	setupTriangles.resize(triangleCount * 2);
+	setupCounts.resize(triangleCount);
+	ForRange(pool, triangleCount,
+		[&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int t = begin; t < end; t++)
+			{
+				SoftwareVertexOutput corners[3] = {
+					shadedVertices[indices[t * 3 + 0]],
+					shadedVertices[indices[t * 3 + 1]],
+					shadedVertices[indices[t * 3 + 2]] };
+				SetupTriangle(corners, shader, &setupTriangles[t * 2], setupCounts[t]);
+			}
+		});
+
+	// Binning, on this thread so every bin stays in submission order
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		for (unsigned int i = 0; i < setupCounts[t]; i++)
+		{
+			const Triangle& triangle = setupTriangles[t * 2 + i];
+			unsigned int index = (unsigned int)triangles.size();
+			triangles.push_back(triangle);
+
+			for (int ty = triangle.MinY / (int)TileSize; ty <= triangle.MaxY / (int)TileSize; ty++)
+			{
+				for (int tx = triangle.MinX / (int)TileSize; tx <= triangle.MaxX / (int)TileSize; tx++)
+				{
+					// Skip tiles entirely outside any one edge - big, thin triangles touch
+					// far fewer tiles than their bounds cover
+					float tileMinX = tx * (float)TileSize + 0.5f;
+					float tileMinY = ty * (float)TileSize + 0.5f;
+					float tileMaxX = tileMinX + TileSize - 1;
+					float tileMaxY = tileMinY + TileSize - 1;
+
+					bool outside = false;
+					for (int e = 0; e < 3 && !outside; e++)
+					{
+						float x = triangle.EdgeA[e] >= 0 ? tileMaxX : tileMinX;
+						float y = triangle.EdgeB[e] >= 0 ? tileMaxY : tileMinY;
+						outside = triangle.EdgeA[e] * x + triangle.EdgeB[e] * y + triangle.EdgeC[e] < 0;
+					}
+
+					if (!outside)
+						tileBins[ty * tilesX + tx].push_back(index);
+				}
+			}
+		}
+	}
+
+	trianglesDrawn += triangleCount;
+	trianglesRasterized = (unsigned int)triangles.size();
+	drawMilliseconds += MillisecondsSince(start);
+}
+
+void SoftwareRasterizer::Finish()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	unsigned int tileCount = tilesX * tilesY;
+	if (pool)
+		pool->ParallelFor(tileCount, tileCount, [&](unsigned int chunk, unsigned int, unsigned int) { RasterizeTile(chunk); });
+	else
+		for (unsigned int i = 0; i < tileCount; i++)
+			RasterizeTile(i);
+
+	triangles.clear();
+	pixelShaders.clear();
+	passThroughShaders.clear();
+	for (std::vector<unsigned int>& bin : tileBins)
+		bin.clear();
+
+	finishMilliseconds = MillisecondsSince(start);
+}
+
+bool SoftwareRasterizer::WritePPM(const std::wstring& path)
+{
+	std::ofstream file{ std::filesystem::path(path), std::ios::binary };
+	if (!file)
+		return false;
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	std::vector<unsigned char> row(width * 3);
+	for (unsigned int y = 0; y < height; y++)
+	{
+		for (unsigned int x = 0; x < width; x++)
+		{
+			uint32_t pixel = colorBuffer[(size_t)y * stride + x];
+			row[x * 3 + 0] = (unsigned char)(pixel);
+			row[x * 3 + 1] = (unsigned char)(pixel >> 8);
+			row[x * 3 + 2] = (unsigned char)(pixel >> 16);
+		}
+		file.write((const char*)row.data(), row.size());
+	}
+
+	return file.good();
+}
+
+// --------------------------------------------------------
+// A PNG needs its image zlib-compressed, but deflate allows
+// "stored" blocks of raw bytes - so this writes a valid file
+// with no encoder at all, just bigger than it could be. Every
+// row gets filter type 0 (none), then the rows are split into
+// stored blocks of up to 65535 bytes, framed by a zlib header
+// and the Adler-32 of the raw data.
+// --------------------------------------------------------
+bool SoftwareRasterizer::WritePNG(const std::wstring& path)
+{
+	std::ofstream file{ std::filesystem::path(path), std::ios::binary };
+	if (!file)
+		return false;
+
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write((const char*)signature, sizeof(signature));
+
+	// 8 bits per channel, RGB, no interlacing
+	std::vector<unsigned char> header;
+	AppendBigEndian(header, width);
+	AppendBigEndian(header, height);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });
+	WriteChunk(file, "IHDR", header);
+
+	// The raw scanlines, each led by its filter byte
+	size_t rowBytes = 1 + (size_t)width * 3;
+	std::vector<unsigned char> raw(rowBytes * height);
+	for (unsigned int y = 0; y < height; y++)
+	{
+		unsigned char* row = &raw[y * rowBytes];
+		row[0] = 0;
+		for (unsigned int x = 0; x < width; x++)
+		{
+			uint32_t pixel = colorBuffer[(size_t)y * stride + x];
+			row[1 + x * 3 + 0] = (unsigned char)(pixel);
+			row[1 + x * 3 + 1] = (unsigned char)(pixel >> 8);
+			row[1 + x * 3 + 2] = (unsigned char)(pixel >> 16);
+		}
+	}
+
+	// zlib: deflate with a 32K window, no dictionary, then stored blocks
+	const size_t maxBlock = 65535;
+	std::vector<unsigned char> compressed = { 0x78, 0x01 };
+	compressed.reserve(raw.size() + (raw.size() / maxBlock + 1) * 5 + 6);
+	size_t position = 0;
+	do
+	{
+		size_t blockSize = std::min(maxBlock, raw.size() - position);
+		bool last = position + blockSize == raw.size();
+		compressed.push_back(last ? 1 : 0);
+		compressed.push_back((unsigned char)blockSize);
+		compressed.push_back((unsigned char)(blockSize >> 8));
+		compressed.push_back((unsigned char)~blockSize);
+		compressed.push_back((unsigned char)(~blockSize >> 8));
+		compressed.insert(compressed.end(), raw.begin() + position, raw.begin() + position + blockSize);
+		position += blockSize;
+	} while (position < raw.size());
+
+	// Adler-32, with the sums reduced often enough not to overflow
+	uint32_t a = 1, b = 0;
+	for (size_t start = 0; start < raw.size(); start += 5552)
+	{
+		size_t end = std::min(raw.size(), start + 5552);
+		for (size_t i = start; i < end; i++)
+		{
+			a += raw[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	AppendBigEndian(compressed, (b << 16) | a);
+
+	WriteChunk(file, "IDAT", compressed);
+	WriteChunk(file, "IEND", {});
+	return file.good();
+}
+
+// --------------------------------------------------------
+// Clips one triangle of vertex shader output to the near
+// plane and turns what's left into zero, one or two screen
+// space triangles, dropping back faces
+// --------------------------------------------------------
+void SoftwareRasterizer::SetupTriangle(const SoftwareVertexOutput* corners, unsigned int shader, Triangle* out, unsigned int& outCount)
+{
+	outCount = 0;
+
+	// Sutherland-Hodgman against z >= 0, the only plane that can put
+	// a vertex behind the camera - one plane adds at most one vertex
+	SoftwareVertexOutput polygon[4];
+	int polygonCount = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const SoftwareVertexOutput& a = corners[i];
+		const SoftwareVertexOutput& b = corners[(i + 1) % 3];
+		float za = a.ScreenPosition.z;
+		float zb = b.ScreenPosition.z;
+
+		if (za >= 0)
+			polygon[polygonCount++] = a;
+		if ((za >= 0) != (zb >= 0))
+			polygon[polygonCount++] = Lerp(a, b, za / (za - zb));
+	}
+	if (polygonCount < 3)
+		return;
+
+	// Perspective divide and viewport transform
+	float x[4], y[4], z[4], invW[4];
+	for (int i = 0; i < polygonCount; i++)
+	{
+		const XMFLOAT4& position = polygon[i].ScreenPosition;
+		if (position.w <= 0)
+			return;
+
+		invW[i] = 1.0f / position.w;
+		x[i] = (position.x * invW[i] * 0.5f + 0.5f) * width;
+		y[i] = (0.5f - position.y * invW[i] * 0.5f) * height;
+		z[i] = position.z * invW[i];
+	}
+
+	// Fan out the clipped polygon
+	for (int fan = 1; fan + 1 < polygonCount; fan++)
+	{
+		int v[3] = { 0, fan, fan + 1 };
+
+		// Clockwise on screen (y down) is positive, and front facing
+		float area =
+			(x[v[1]] - x[v[0]]) * (y[v[2]] - y[v[0]]) -
+			(y[v[1]] - y[v[0]]) * (x[v[2]] - x[v[0]]);
+		if (!(area > 0))
+			continue;
+
+		Triangle& triangle = out[outCount];
+		triangle.Shader = shader;
+
+		// Pixels whose centers can be inside, clamped to the screen
+		// (in float first, as the unclipped sides can be enormous) -
+		// most small triangles in a dense mesh cover none at all
+		float minX = std::min({ x[v[0]], x[v[1]], x[v[2]] });
+		float minY = std::min({ y[v[0]], y[v[1]], y[v[2]] });
+		float maxX = std::max({ x[v[0]], x[v[1]], x[v[2]] });
+		float maxY = std::max({ y[v[0]], y[v[1]], y[v[2]] });
+		triangle.MinX = (int)std::ceil(std::clamp(minX - 0.5f, 0.0f, (float)width));
+		triangle.MinY = (int)std::ceil(std::clamp(minY - 0.5f, 0.0f, (float)height));
+		triangle.MaxX = (int)std::floor(std::clamp(maxX - 0.5f, -1.0f, width - 1.0f));
+		triangle.MaxY = (int)std::floor(std::clamp(maxY - 0.5f, -1.0f, height - 1.0f));
+
+		if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+			continue;
+
+		// Edge e runs between the two corners other than e, so it's
+		// the barycentric weight of corner e once divided by area
+		for (int e = 0; e < 3; e++)
+		{
+			int a = v[(e + 1) % 3];
+			int b = v[(e + 2) % 3];
+			float dx = x[b] - x[a];
+			float dy = y[b] - y[a];
+
+			triangle.EdgeA[e] = -dy;
+			triangle.EdgeB[e] = dx;
+
+			// Anchored on the same end of a shared edge from either side, so the
+			// neighbor's edge is the exact negation of this one and no pixel
+			// along it is drawn twice or missed
+			int anchor = (x[a] < x[b] || (x[a] == x[b] && y[a] < y[b])) ? a : b;
+			triangle.EdgeC[e] = -(triangle.EdgeA[e] * x[anchor] + triangle.EdgeB[e] * y[anchor]);
+
+			// Top edges run right along the top (y down), left edges run up
+			bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+			triangle.EdgeInclusive[e] = topLeft ? 0xFFFFFFFF : 0;
+		}
+
+		// Interpolated values as planes over the screen, from their
+		// gradients across the triangle
+		float invArea = 1.0f / area;
+		float dx1 = x[v[1]] - x[v[0]], dy1 = y[v[1]] - y[v[0]];
+		float dx2 = x[v[2]] - x[v[0]], dy2 = y[v[2]] - y[v[0]];
+		triangle.OriginX = x[v[0]];
+		triangle.OriginY = y[v[0]];
+		auto plane = [&](const float* values, float& a, float& b, float& c)
+			{
+				float d1 = values[v[1]] - values[v[0]];
+				float d2 = values[v[2]] - values[v[0]];
+				a = (d1 * dy2 - d2 * dy1) * invArea;
+				b = (d2 * dx1 - d1 * dx2) * invArea;
+				c = values[v[0]];
+			};
+
+		plane(z, triangle.DepthA, triangle.DepthB, triangle.DepthC);
+		plane(invW, triangle.InvWA, triangle.InvWB, triangle.InvWC);
+		for (int channel = 0; channel < 4; channel++)
+		{
+			float colorOverW[4];
+			for (int i = 0; i < polygonCount; i++)
+				colorOverW[i] = (&polygon[i].Color.x)[channel] * invW[i];
+			plane(colorOverW, triangle.ColorA[channel], triangle.ColorB[channel], triangle.ColorC[channel]);
+		}
+
+		outCount++;
+	}
+}
+
+// --------------------------------------------------------
+// Draws every triangle binned to one tile, in order, four
+// pixels at a time
+// --------------------------------------------------------
+void SoftwareRasterizer::RasterizeTile(unsigned int tile)
+{
+	const std::vector<unsigned int>& bin = tileBins[tile];
+	if (bin.empty())
+		return;
+
+	int tileX = (int)(tile % tilesX) * TileSize;
+	int tileY = (int)(tile / tilesX) * TileSize;
+
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR one = XMVectorReplicate(1.0f);
+	const XMVECTOR four = XMVectorReplicate(4.0f);
+	const XMVECTOR laneCenters = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for (unsigned int index : bin)
+	{
+		const Triangle& triangle = triangles[index];
+		const SoftwarePixelShader& shader = pixelShaders[triangle.Shader];
+		bool passThrough = passThroughShaders[triangle.Shader];
+
+		// Tiles are a multiple of four wide, so aligning down stays in the tile
+		int startX = std::max(triangle.MinX, tileX) & ~3;
+		int endX = std::min(triangle.MaxX, tileX + (int)TileSize - 1);
+		int startY = std::max(triangle.MinY, tileY);
+		int endY = std::min(triangle.MaxY, tileY + (int)TileSize - 1);
+
+		XMVECTOR originX = XMVectorReplicate(triangle.OriginX);
+		XMVECTOR edgeA[3], inclusive[3];
+		for (int e = 0; e < 3; e++)
+		{
+			edgeA[e] = XMVectorReplicate(triangle.EdgeA[e]);
+			inclusive[e] = XMVectorReplicateInt(triangle.EdgeInclusive[e]);
+		}
+		XMVECTOR depthA = XMVectorReplicate(triangle.DepthA);
+		XMVECTOR invWA = XMVectorReplicate(triangle.InvWA);
+		XMVECTOR colorA[4];
+		for (int c = 0; c < 4; c++)
+			colorA[c] = XMVectorReplicate(triangle.ColorA[c]);
+
+		for (int y = startY; y <= endY; y++)
+		{
+			float pixelY = y + 0.5f;
+			float planeY = pixelY - triangle.OriginY;
+
+			// The y part of every plane is the same across the row
+			XMVECTOR edgeRow[3];
+			for (int e = 0; e < 3; e++)
+				edgeRow[e] = XMVectorReplicate(triangle.EdgeB[e] * pixelY + triangle.EdgeC[e]);
+			XMVECTOR depthRow = XMVectorReplicate(triangle.DepthB * planeY + triangle.DepthC);
+			XMVECTOR invWRow = XMVectorReplicate(triangle.InvWB * planeY + triangle.InvWC);
+			XMVECTOR colorRows[4];
+			for (int c = 0; c < 4; c++)
+				colorRows[c] = XMVectorReplicate(triangle.ColorB[c] * planeY + triangle.ColorC[c]);
+
+			// Narrow the row to where each edge crosses it, a pixel wider
+			// either side for rounding - the coverage test still decides,
+			// this only skips the steps (half, in a small triangle's bounds)
+			// that can't be inside
+			float rowStart = (float)startX;
+			float rowEnd = (float)endX;
+			for (int e = 0; e < 3; e++)
+			{
+				float edgeA = triangle.EdgeA[e];
+				if (edgeA == 0)
+					continue;
+
+				float crossing = -(triangle.EdgeB[e] * pixelY + triangle.EdgeC[e]) / edgeA - 0.5f;
+				if (edgeA > 0)
+					rowStart = std::max(rowStart, std::floor(crossing) - 1.0f);
+				else
+					rowEnd = std::min(rowEnd, std::ceil(crossing) + 1.0f);
+			}
+			if (rowStart > rowEnd)
+				continue;
+
+			int rowStartX = (int)rowStart & ~3;
+			int rowEndX = (int)rowEnd;
+
+			XMVECTOR pixelX = XMVectorAdd(XMVectorReplicate((float)rowStartX), laneCenters);
+			for (int x = rowStartX; x <= rowEndX; x += 4, pixelX = XMVectorAdd(pixelX, four))
+			{
+				// Coverage - inside every edge, or exactly on a top/left one
+				XMVECTOR mask = XMVectorTrueInt();
+				for (int e = 0; e < 3; e++)
+				{
+					XMVECTOR edge = XMVectorMultiplyAdd(edgeA[e], pixelX, edgeRow[e]);
+					XMVECTOR inside = XMVectorSelect(XMVectorGreater(edge, zero), XMVectorGreaterOrEqual(edge, zero), inclusive[e]);
+					mask = XMVectorAndInt(mask, inside);
+				}
+				if (XMVector4EqualInt(mask, zero))
+					continue;
+
+				// Depth - LESS against the buffer, and clipped at the far plane
+				size_t offset = (size_t)y * stride + x;
+				XMVECTOR planeX = XMVectorSubtract(pixelX, originX);
+				XMVECTOR depth = XMVectorMultiplyAdd(depthA, planeX, depthRow);
+				XMVECTOR stored = XMLoadFloat4((const XMFLOAT4*)&depthBuffer[offset]);
+				mask = XMVectorAndInt(mask, XMVectorAndInt(XMVectorLess(depth, stored), XMVectorLessOrEqual(depth, one)));
+				if (XMVector4EqualInt(mask, zero))
+					continue;
+
+				// Perspective correct color
+				XMVECTOR invW = XMVectorMultiplyAdd(invWA, planeX, invWRow);
+				XMVECTOR w = XMVectorReciprocal(invW);
+				XMVECTOR channels[4];
+				for (int c = 0; c < 4; c++)
+					channels[c] = XMVectorMultiply(XMVectorMultiplyAdd(colorA[c], planeX, colorRows[c]), w);
+
+				// The color is the output - write all four lanes, keeping
+				// what was there wherever the mask is off
+				if (passThrough)
+				{
+					XMVECTOR storedColor = XMLoadInt4(&colorBuffer[offset]);
+					XMStoreInt4(&colorBuffer[offset], XMVectorSelect(storedColor, PackColors(channels), mask));
+					XMStoreFloat4((XMFLOAT4*)&depthBuffer[offset], XMVectorSelect(stored, depth, mask));
+					continue;
+				}
+
+				XMFLOAT4 color[4];
+				for (int c = 0; c < 4; c++)
+					XMStoreFloat4(&color[c], channels[c]);
+
+				uint32_t lanes[4];
+				XMFLOAT4 laneDepth, laneInvW;
+				XMStoreInt4(lanes, mask);
+				XMStoreFloat4(&laneDepth, depth);
+				XMStoreFloat4(&laneInvW, invW);
+
+				for (int lane = 0; lane < 4; lane++)
+				{
+					if (!lanes[lane])
+						continue;
+
+					SoftwareVertexOutput input;
+					input.ScreenPosition = XMFLOAT4(x + lane + 0.5f, pixelY, (&laneDepth.x)[lane], (&laneInvW.x)[lane]);
+					input.Color = XMFLOAT4((&color[0].x)[lane], (&color[1].x)[lane], (&color[2].x)[lane], (&color[3].x)[lane]);
+
+					colorBuffer[offset + lane] = PackColor(shader(input));
+					depthBuffer[offset + lane] = input.ScreenPosition.z;
+				}
+			}
+		}
+	}
+}
+
+unsigned int SoftwareRasterizer::GetWidth() { return width; }
+unsigned int SoftwareRasterizer::GetHeight() { return height; }
+uint32_t SoftwareRasterizer::GetPixel(unsigned int x, unsigned int y) { return colorBuffer[(size_t)y * stride + x]; }
+float SoftwareRasterizer::GetDepth(unsigned int x, unsigned int y) { return depthBuffer[(size_t)y * stride + x]; }
+unsigned int SoftwareRasterizer::GetTrianglesDrawn() { return trianglesDrawn; }
+unsigned int SoftwareRasterizer::GetTrianglesRasterized() { return trianglesRasterized; }
+float SoftwareRasterizer::GetDrawMilliseconds() { return drawMilliseconds; }
+float SoftwareRasterizer::GetFinishMilliseconds() { return finishMilliseconds; }
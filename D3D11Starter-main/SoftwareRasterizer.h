@@ -0,0 +1,166 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "BufferStruct.h"
+#include "Vertex.h"
+
+class WorkerPool;
+
+// --------------------------------------------------------
+// What the software vertex shader hands to the rasterizer
+// - matches VertexToPixel in the HLSL
+// --------------------------------------------------------
+struct SoftwareVertexOutput
+{
+	DirectX::XMFLOAT4 ScreenPosition;	// Clip space on the way out of the VS, pixels (xy), depth (z) and 1/w (w) on the way into the PS
+	DirectX::XMFLOAT4 Color;
+};
+
+// --------------------------------------------------------
+// Everything the vertex shader can see for one draw: the
+// object's cbuffer plus the camera matrices the HLSL reads
+// (with their product worked out once, rather than per vertex)
+// --------------------------------------------------------
+struct SoftwareDrawConstants
+{
+	BufferStruct Object;
+	DirectX::XMFLOAT4X4 View;
+	DirectX::XMFLOAT4X4 Projection;
+	DirectX::XMFLOAT4X4 WorldViewProjection;
+};
+
+// C++ stand-ins for compiled vertex and pixel shaders
+using SoftwareVertexShader = std::function<SoftwareVertexOutput(const Vertex& input, const SoftwareDrawConstants& constants)>;
+using SoftwarePixelShader = std::function<DirectX::XMFLOAT4(const SoftwareVertexOutput& input)>;
+
+// --------------------------------------------------------
+// Line-for-line ports of VertexShader.hlsl and
+// PixelShader.hlsl - keep them in step with the HLSL
+// --------------------------------------------------------
+namespace SoftwareShaders
+{
+	SoftwareVertexOutput VertexShader(const Vertex& input, const SoftwareDrawConstants& constants);
+	DirectX::XMFLOAT4 PixelShader(const SoftwareVertexOutput& input);
+}
+
+// --------------------------------------------------------
+// Draws triangles on the CPU, for machines with no GPU
+//
+// Takes the same vertex/index arrays a Mesh is built from,
+// the same BufferStruct and the camera's matrices, and
+// follows D3D11's rules closely enough that images from both
+// can be compared: clockwise triangles are front facing and
+// back faces are culled, pixel centers are sampled with the
+// top-left fill rule, colors are interpolated perspective
+// correct, and depth is tested LESS against a float buffer.
+//
+// Draw() shades vertices and sets up triangles (spread
+// across the pool), then bins them into TileSize square
+// screen tiles in submission order. Finish() rasterizes all
+// the tiles at once, one tile per task, each testing four
+// pixels at a time with DirectXMath - tiles never share
+// pixels, and each walks its triangles in submission order,
+// so the image is the same whatever the thread count. The
+// default pixel shader is inlined there too, so only custom
+// shaders are called a pixel at a time.
+//
+// Triangles are only clipped against the near plane; the
+// rest are clipped per pixel by the tile and depth tests.
+// --------------------------------------------------------
+class SoftwareRasterizer
+{
+public:
+	static const unsigned int TileSize = 64;
+
+	// Basic OOP Setup
+	SoftwareRasterizer(unsigned int width, unsigned int height, WorkerPool* pool = nullptr);	// Null does everything on the calling thread
+	~SoftwareRasterizer();
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	// Defaults to the SoftwareShaders ports
+	void SetShaders(SoftwareVertexShader vertexShader, SoftwarePixelShader pixelShader);
+	void SetCamera(const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& projection);
+
+	// Drops anything drawn but not finished
+	void Clear(const DirectX::XMFLOAT4& color, float depth = 1.0f);
+
+	// Shades and bins a triangle list - nothing reaches the
+	// image until Finish(), but the arrays can go right away
+	void Draw(
+		const Vertex* vertices, int vertexCount,
+		const unsigned int* indices, int indexCount,
+		const BufferStruct& constants);
+
+	// Rasterizes everything drawn since the last Finish()
+	void Finish();
+
+	// The color buffer as 8-bit RGB, alpha dropped
+	bool WritePPM(const std::wstring& path);	// Binary PPM (P6)
+	bool WritePNG(const std::wstring& path);	// Uncompressed (stored deflate blocks), readable by anything
+
+	// Getters
+	unsigned int GetWidth();
+	unsigned int GetHeight();
+	uint32_t GetPixel(unsigned int x, unsigned int y);	// RGBA8, red in the low byte
+	float GetDepth(unsigned int x, unsigned int y);
+	unsigned int GetTrianglesDrawn();		// Since the last Clear(), before culling
+	unsigned int GetTrianglesRasterized();	// Since the last Clear(), after culling and clipping
+	float GetDrawMilliseconds();			// Wall time of every Draw() since the last Clear()
+	float GetFinishMilliseconds();			// Wall time of the last Finish()
+
+private:
+	// A screen-space triangle, ready to rasterize
+	// - edges are planes a*x + b*y + c over pixel coordinates
+	// - interpolated values are a*(x - OriginX) + b*(y - OriginY) + c,
+	//   measured from a corner to keep thin triangles precise
+	struct Triangle
+	{
+		float EdgeA[3], EdgeB[3], EdgeC[3];		// >= 0 inside, one per edge
+		uint32_t EdgeInclusive[3];				// All ones for top/left edges, which own pixels exactly on them
+		float OriginX, OriginY;
+		float DepthA, DepthB, DepthC;
+		float InvWA, InvWB, InvWC;
+		float ColorA[4], ColorB[4], ColorC[4];	// Color / w
+		int MinX, MinY, MaxX, MaxY;				// Pixel bounds, clamped to the screen
+		unsigned int Shader;					// Index into pixelShaders
+	};
+
+	void SetupTriangle(const SoftwareVertexOutput* corners, unsigned int shader, Triangle* out, unsigned int& outCount);
+	void RasterizeTile(unsigned int tile);
+
+	WorkerPool* pool;
+
+	unsigned int width;
+	unsigned int height;
+	unsigned int tilesX;
+	unsigned int tilesY;
+	unsigned int stride;	// Pixels per row, padded out to whole tiles
+
+	std::vector<uint32_t> colorBuffer;
+	std::vector<float> depthBuffer;
+
+	SoftwareVertexShader vertexShader;
+	SoftwarePixelShader pixelShader;
+	DirectX::XMFLOAT4X4 view;
+	DirectX::XMFLOAT4X4 projection;
+
+	// Waiting for Finish() - kept between frames to avoid reallocating
+	std::vector<SoftwareVertexOutput> shadedVertices;
+	std::vector<Triangle> setupTriangles;
+	std::vector<unsigned int> setupCounts;
+	std::vector<Triangle> triangles;
+	std::vector<SoftwarePixelShader> pixelShaders;
+	std::vector<bool> passThroughShaders;	// Just SoftwareShaders::PixelShader, so shaded four pixels at a time
+	std::vector<std::vector<unsigned int>> tileBins;
+
+	unsigned int trianglesDrawn;
+	unsigned int trianglesRasterized;
+	float drawMilliseconds;
+	float finishMilliseconds;
+};
@@ -0,0 +1,165 @@
+#include "StateCache.h"
+
+StateCache::StateCache(RenderContext& target) :
+	target(target),
+	stats{},
+	inputLayout(nullptr),
+	vertexShader(nullptr),
+	pixelShader(nullptr),
+	vertexBuffers{},
+	indexBuffer(nullptr),
+	constantBuffers{}
+{
+	Invalidate();
+}
+
+StateCache::~StateCache()
+{
+}
+
+void StateCache::Invalidate()
+{
+	knowsInputLayout = false;
+	knowsVertexShader = false;
+	knowsPixelShader = false;
+	knowsIndexBuffer = false;
+	for (unsigned int i = 0; i < VertexBufferSlots; i++)
+		knowsVertexBuffer[i] = false;
+	for (unsigned int i = 0; i < ConstantBufferSlots; i++)
+		knowsConstantBuffer[i] = false;
+}
+
+void StateCache::ResetStats()
+{
+	stats = {};
+}
+
+void StateCache::SetInputLayout(ID3D11InputLayout* layout)
+{
+	if (!Changes(!knowsInputLayout || inputLayout != layout))
+		return;
+
+	inputLayout = layout;
+	knowsInputLayout = true;
+	target.SetInputLayout(layout);
+}
+
+void StateCache::SetVertexShader(ID3D11VertexShader* shader)
+{
+	if (!Changes(!knowsVertexShader || vertexShader != shader))
+		return;
+
+	vertexShader = shader;
+	knowsVertexShader = true;
+	target.SetVertexShader(shader);
+}
+
+void StateCache::SetPixelShader(ID3D11PixelShader* shader)
+{
+	if (!Changes(!knowsPixelShader || pixelShader != shader))
+		return;
+
+	pixelShader = shader;
+	knowsPixelShader = true;
+	target.SetPixelShader(shader);
+}
+
+void StateCache::SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset)
+{
+	if (slot >= VertexBufferSlots)
+	{
+		Changes(true);
+		target.SetVertexBuffer(slot, buffer, stride, offset);
+		return;
+	}
+
+	VertexBufferBinding& bound = vertexBuffers[slot];
+	bool same = bound.Buffer == buffer && bound.Stride == stride && bound.Offset == offset;
+	if (!Changes(!knowsVertexBuffer[slot] || !same))
+		return;
+
+	bound = { buffer, stride, offset };
+	knowsVertexBuffer[slot] = true;
+	target.SetVertexBuffer(slot, buffer, stride, offset);
+}
+
+void StateCache::SetIndexBuffer(ID3D11Buffer* buffer)
+{
+	if (!Changes(!knowsIndexBuffer || indexBuffer != buffer))
+		return;
+
+	indexBuffer = buffer;
+	knowsIndexBuffer = true;
+	target.SetIndexBuffer(buffer);
+}
+
+void StateCache::SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer)
+{
+	if (slot >= ConstantBufferSlots)
+	{
+		Changes(true);
+		target.SetVSConstantBuffer(slot, buffer);
+		return;
+	}
+
+	if (!ChangesConstantBuffer(slot, buffer, 0, 0))
+		return;
+
+	target.SetVSConstantBuffer(slot, buffer);
+}
+
+void StateCache::SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	if (slot >= ConstantBufferSlots)
+	{
+		Changes(true);
+		target.SetVSConstantBufferRange(slot, buffer, firstConstant, constantCount);
+		return;
+	}
+
+	if (!ChangesConstantBuffer(slot, buffer, firstConstant, constantCount))
+		return;
+
+	target.SetVSConstantBufferRange(slot, buffer, firstConstant, constantCount);
+}
+
+void StateCache::UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size)
+{
+	target.UploadBuffer(buffer, data, size);
+}
+
+void StateCache::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	target.DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void StateCache::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	target.DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+StateCacheStats StateCache::GetStats() { return stats; }
+
+bool StateCache::Changes(bool changed)
+{
+	stats.Submitted++;
+	if (!changed)
+		stats.Filtered++;
+	return changed;
+}
+
+// --------------------------------------------------------
+// Counts the call and, if it changes the slot, remembers
+// the new binding
+// --------------------------------------------------------
+bool StateCache::ChangesConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	ConstantBufferBinding& bound = constantBuffers[slot];
+	bool same = bound.Buffer == buffer && bound.FirstConstant == firstConstant && bound.ConstantCount == constantCount;
+	if (!Changes(!knowsConstantBuffer[slot] || !same))
+		return false;
+
+	bound = { buffer, firstConstant, constantCount };
+	knowsConstantBuffer[slot] = true;
+	return true;
+}
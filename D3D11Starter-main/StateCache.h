@@ -0,0 +1,100 @@
+#pragma once
+
+#include "RenderContext.h"
+
+// How many state calls reached a StateCache, and how many
+// of those it dropped because they changed nothing
+struct StateCacheStats
+{
+	unsigned int Submitted;
+	unsigned int Filtered;
+};
+
+// --------------------------------------------------------
+// Sits in front of another RenderContext and only passes on
+// state calls that actually change something
+//
+// It remembers the last value of every piece of state it
+// forwarded, so binding the same shader (or buffer, or
+// layout) twice in a row costs one call instead of two.
+// Uploads and draws always go straight through.
+//
+// Anything that sets state on the device without going
+// through the cache (ImGui, for instance) must be followed
+// by Invalidate(), or the cache will wrongly skip the next
+// bind of whatever it thinks is still there.
+// --------------------------------------------------------
+class StateCache : public RenderContext
+{
+public:
+	static const unsigned int VertexBufferSlots = 2;
+	static const unsigned int ConstantBufferSlots = 4;
+
+	// Basic OOP Setup
+	explicit StateCache(RenderContext& target);
+	~StateCache();
+	StateCache(const StateCache&) = delete;
+	StateCache& operator=(const StateCache&) = delete;
+
+	// Forgets everything, so the next call to each setter goes through
+	void Invalidate();
+	void ResetStats();
+
+	// RenderContext
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int stride, unsigned int offset) override;
+	void SetIndexBuffer(ID3D11Buffer* buffer) override;
+	void SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) override;
+	void SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount) override;
+	void UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size) override;
+	void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) override;
+	void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance) override;
+
+	// Getters
+	StateCacheStats GetStats();
+
+private:
+	// Counts the call, and whether it's dropped
+	bool Changes(bool changed);
+
+	// Whether this binding would change the slot (a count of zero means the whole buffer)
+	bool ChangesConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount);
+
+	RenderContext& target;
+	StateCacheStats stats;
+
+	// What's bound, as far as the cache knows
+	// - Slots past the tracked ones are never filtered
+	struct VertexBufferBinding
+	{
+		ID3D11Buffer* Buffer;
+		unsigned int Stride;
+		unsigned int Offset;
+	};
+
+	// A count of zero means the whole buffer
+	struct ConstantBufferBinding
+	{
+		ID3D11Buffer* Buffer;
+		unsigned int FirstConstant;
+		unsigned int ConstantCount;
+	};
+
+	ID3D11InputLayout* inputLayout;
+	ID3D11VertexShader* vertexShader;
+	ID3D11PixelShader* pixelShader;
+	VertexBufferBinding vertexBuffers[VertexBufferSlots];
+	ID3D11Buffer* indexBuffer;
+	ConstantBufferBinding constantBuffers[ConstantBufferSlots];
+
+	// Whether each value above is known - false after Invalidate(),
+	// until that piece of state is next set
+	bool knowsInputLayout;
+	bool knowsVertexShader;
+	bool knowsPixelShader;
+	bool knowsVertexBuffer[VertexBufferSlots];
+	bool knowsIndexBuffer;
+	bool knowsConstantBuffer[ConstantBufferSlots];
+};
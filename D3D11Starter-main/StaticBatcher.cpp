@@ -0,0 +1,191 @@
+#include "StaticBatcher.h"
+#include "MeshBounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// What one object's world matrix does to each part of a vertex
+	struct VertexTransform
+	{
+		XMMATRIX World;
+		XMMATRIX Normal;	// Inverse transpose of the upper 3x3
+		bool Mirrors;		// Negative determinant - faces turn inside out
+	};
+
+	VertexTransform MakeTransform(const XMFLOAT4X4& world)
+	{
+		VertexTransform transform;
+		transform.World = XMLoadFloat4x4(&world);
+
+		XMMATRIX world3 = transform.World;
+		world3.r[3] = XMVectorSet(0, 0, 0, 1);
+		XMVECTOR determinant;
+		XMMATRIX inverse = XMMatrixInverse(&determinant, world3);
+		transform.Normal = XMMatrixTranspose(inverse);
+		transform.Mirrors = XMVectorGetX(determinant) < 0.0f;
+		return transform;
+	}
+
+	void TransformVertex(Vertex& vertex, const VertexTransform& transform)
+	{
+		XMStoreFloat3(&vertex.Position, XMVector3TransformCoord(XMLoadFloat3(&vertex.Position), transform.World));
+	}
+
+	void TransformVertex(LitVertex& vertex, const VertexTransform& transform)
+	{
+		XMStoreFloat3(&vertex.Position, XMVector3TransformCoord(XMLoadFloat3(&vertex.Position), transform.World));
+
+		XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&vertex.Normal), transform.Normal));
+		XMStoreFloat3(&vertex.Normal, normal);
+
+		// Tangents lie in the surface, so they follow the surface itself;
+		// re-orthogonalizing keeps them exactly perpendicular to the normal
+		XMVECTOR tangent = XMVector3TransformNormal(XMLoadFloat4(&vertex.Tangent), transform.World);
+		tangent = XMVectorSubtract(tangent, XMVectorMultiply(normal, XMVector3Dot(normal, tangent)));
+		tangent = XMVector3Normalize(tangent);
+		float handedness = transform.Mirrors ? -vertex.Tangent.w : vertex.Tangent.w;
+		XMStoreFloat4(&vertex.Tangent, XMVectorSetW(tangent, handedness));
+	}
+}
+
+template <typename T>
+StaticBatcherOf<T>::StaticBatcherOf(float cellSize, unsigned int maxVerticesPerBatch) :
+	cellSize(cellSize),
+	maxVerticesPerBatch(maxVerticesPerBatch)
+{
+}
+
+template <typename T>
+StaticBatcherOf<T>::~StaticBatcherOf()
+{
+}
+
+template <typename T>
+void StaticBatcherOf<T>::Add(
+	const T* vertices, int vertexCount,
+	const unsigned int* indices, int indexCount,
+	const XMFLOAT4X4& world,
+	unsigned int materialID)
+{
+	if (vertexCount <= 0 || indexCount <= 0)
+		return;
+
+	Source source = {};
+	source.FirstVertex = (unsigned int)sourceVertices.size();
+	source.VertexCount = vertexCount;
+	source.FirstIndex = (unsigned int)sourceIndices.size();
+	source.IndexCount = indexCount;
+	source.MaterialID = materialID;
+	source.World = world;
+
+	// Which cell does the center of the world space box land in?
+	XMMATRIX worldMatrix = XMLoadFloat4x4(&world);
+	BoundingBox localBox = MeshBounds::ComputeBox(vertices, vertexCount, sizeof(T));
+	XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&localBox.Center), worldMatrix);
+	XMVECTOR cell = XMVectorFloor(XMVectorScale(center, 1.0f / cellSize));
+	source.CellX = (int)XMVectorGetX(cell);
+	source.CellY = (int)XMVectorGetY(cell);
+	source.CellZ = (int)XMVectorGetZ(cell);
+
+	sourceVertices.insert(sourceVertices.end(), vertices, vertices + vertexCount);
+	sourceIndices.insert(sourceIndices.end(), indices, indices + indexCount);
+	sources.push_back(source);
+}
+
+// --------------------------------------------------------
+// Sorts the queued objects by (material, cell), then walks
+// them appending pre-transformed vertices and rebased
+// indices, starting a new batch when the key changes or
+// the current batch is full
+// --------------------------------------------------------
+template <typename T>
+std::vector<StaticBatchOf<T>> StaticBatcherOf<T>::Build()
+{
+	std::vector<StaticBatchOf<T>> batches;
+
+	std::vector<unsigned int> order(sources.size());
+	for (unsigned int i = 0; i < order.size(); i++)
+		order[i] = i;
+
+	auto key = [&](unsigned int i)
+		{
+			const Source& s = sources[i];
+			return std::make_tuple(s.MaterialID, s.CellX, s.CellY, s.CellZ);
+		};
+	std::stable_sort(order.begin(), order.end(),
+		[&](unsigned int a, unsigned int b) { return key(a) < key(b); });
+
+	StaticBatchOf<T>* current = nullptr;
+	for (unsigned int i : order)
+	{
+		const Source& source = sources[i];
+
+		bool sameKey = current &&
+			current->MaterialID == source.MaterialID &&
+			current->CellX == source.CellX &&
+			current->CellY == source.CellY &&
+			current->CellZ == source.CellZ;
+		bool fits = current && current->Vertices.size() + source.VertexCount <= maxVerticesPerBatch;
+
+		if (!sameKey || !fits)
+		{
+			batches.emplace_back();
+			current = &batches.back();
+			current->CellX = source.CellX;
+			current->CellY = source.CellY;
+			current->CellZ = source.CellZ;
+			current->MaterialID = source.MaterialID;
+			current->SourceCount = 0;
+		}
+
+		// Vertices go to world space, anything without a direction is copied as is
+		VertexTransform transform = MakeTransform(source.World);
+		unsigned int baseVertex = (unsigned int)current->Vertices.size();
+		for (unsigned int v = 0; v < source.VertexCount; v++)
+		{
+			T vertex = sourceVertices[source.FirstVertex + v];
+			TransformVertex(vertex, transform);
+			current->Vertices.push_back(vertex);
+		}
+
+		// Swapping two corners of each triangle undoes a mirror's flip
+		const unsigned int* indices = &sourceIndices[source.FirstIndex];
+		for (unsigned int n = 0; n + 2 < source.IndexCount; n += 3)
+		{
+			current->Indices.push_back(baseVertex + indices[n]);
+			current->Indices.push_back(baseVertex + indices[transform.Mirrors ? n + 2 : n + 1]);
+			current->Indices.push_back(baseVertex + indices[transform.Mirrors ? n + 1 : n + 2]);
+		}
+
+		current->SourceCount++;
+	}
+
+	for (StaticBatchOf<T>& batch : batches)
+		batch.Bounds = MeshBounds::ComputeBox(batch.Vertices.data(), (int)batch.Vertices.size(), sizeof(T));
+
+	return batches;
+}
+
+template <typename T>
+void StaticBatcherOf<T>::Clear()
+{
+	sources.clear();
+	sourceVertices.clear();
+	sourceIndices.clear();
+}
+
+template <typename T>
+unsigned int StaticBatcherOf<T>::GetObjectCount()
+{
+	return (unsigned int)sources.size();
+}
+
+template class StaticBatcherOf<Vertex>;
+template class StaticBatcherOf<LitVertex>;
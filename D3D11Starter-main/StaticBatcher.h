@@ -0,0 +1,88 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+#include <vector>
+
+#include "Vertex.h"
+
+// --------------------------------------------------------
+// One merged draw: every static object of one material
+// whose center falls in one grid cell, already in world space
+// --------------------------------------------------------
+template <typename T>
+struct StaticBatchOf
+{
+	int CellX, CellY, CellZ;
+	unsigned int MaterialID;
+	unsigned int SourceCount;			// How many objects were merged into this batch
+	std::vector<T> Vertices;			// World space
+	std::vector<unsigned int> Indices;
+	DirectX::BoundingBox Bounds;		// World space, for culling the whole batch
+};
+
+// --------------------------------------------------------
+// Collects static geometry and merges it into a few large
+// batches, trading per-object draws for per-cell draws
+//
+// Objects are bucketed by (cell, material) using the center
+// of their world space box, so each batch stays spatially
+// compact and can still be frustum culled as a unit.
+//
+// Positions go through the world matrix. For LitVertex,
+// normals go through its inverse transpose (so non-uniform
+// scales keep them perpendicular) and tangents through the
+// world matrix itself. A mirroring world matrix (negative
+// determinant) would turn faces inside out, so those
+// objects get their winding swapped and their bitangent
+// sign flipped.
+// --------------------------------------------------------
+template <typename T>
+class StaticBatcherOf
+{
+public:
+	// Basic OOP Setup
+	StaticBatcherOf(float cellSize, unsigned int maxVerticesPerBatch = 65536);
+	~StaticBatcherOf();
+
+	// Queues an object - the data is copied, so the arrays can go away afterwards
+	void Add(
+		const T* vertices, int vertexCount,
+		const unsigned int* indices, int indexCount,
+		const DirectX::XMFLOAT4X4& world,
+		unsigned int materialID);
+
+	// Transforms and merges everything queued so far
+	std::vector<StaticBatchOf<T>> Build();
+	void Clear();
+
+	unsigned int GetObjectCount();
+
+private:
+	// A queued object, pointing into the shared source arrays
+	struct Source
+	{
+		unsigned int FirstVertex;
+		unsigned int VertexCount;
+		unsigned int FirstIndex;
+		unsigned int IndexCount;
+		unsigned int MaterialID;
+		int CellX, CellY, CellZ;
+		DirectX::XMFLOAT4X4 World;
+	};
+
+	float cellSize;
+	unsigned int maxVerticesPerBatch;
+
+	std::vector<Source> sources;
+	std::vector<T> sourceVertices;
+	std::vector<unsigned int> sourceIndices;
+};
+
+// The formats the batcher is built for (see StaticBatcher.cpp)
+using StaticBatch = StaticBatchOf<Vertex>;
+using StaticBatcher = StaticBatcherOf<Vertex>;
+using LitStaticBatch = StaticBatchOf<LitVertex>;
+using LitStaticBatcher = StaticBatcherOf<LitVertex>;
+extern template class StaticBatcherOf<Vertex>;
+extern template class StaticBatcherOf<LitVertex>;
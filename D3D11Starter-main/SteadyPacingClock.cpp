@@ -0,0 +1,23 @@
+#include "SteadyPacingClock.h"
+
+#include <thread>
+
+SteadyPacingClock::SteadyPacingClock() :
+	start(std::chrono::steady_clock::now())
+{
+}
+
+SteadyPacingClock::~SteadyPacingClock()
+{
+}
+
+double SteadyPacingClock::Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SteadyPacingClock::Sleep(double seconds)
+{
+	if (seconds > 0)
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
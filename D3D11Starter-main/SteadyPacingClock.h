@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+
+#include "PacingClock.h"
+
+// --------------------------------------------------------
+// A PacingClock on std::chrono::steady_clock
+//
+// Sleeps are only as fine as the OS scheduler allows - on
+// Windows, raise the timer resolution (timeBeginPeriod(1))
+// or they'll run over by up to ~15ms.
+// --------------------------------------------------------
+class SteadyPacingClock : public PacingClock
+{
+public:
+	// Basic OOP Setup
+	SteadyPacingClock();
+	~SteadyPacingClock();
+	SteadyPacingClock(const SteadyPacingClock&) = delete;
+	SteadyPacingClock& operator=(const SteadyPacingClock&) = delete;
+
+	// PacingClock
+	double Now() override;
+	void Sleep(double seconds) override;
+
+private:
+	std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,188 @@
+#include "TestHarness.h"
+
+#include "AsyncMeshLoader.h"
+#include "PrimitiveGenerators.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Stands in for the GPU: accepts everything, creates nothing
+	bool NoUpload(MeshData&, std::shared_ptr<Mesh>&)
+	{
+		return true;
+	}
+
+	// A decoder for an n x n grid, (n + 1)^2 vertices
+	MeshDecoder Grid(unsigned int n)
+	{
+		return [n](MeshData& out)
+			{
+				PrimitiveSize size = PrimitiveGenerators::PlaneSize(n, n);
+				out.Vertices.resize(size.VertexCount);
+				out.Indices.resize(size.IndexCount);
+				PrimitiveGenerators::Plane(out.Vertices, out.Indices, 2.0f, 2.0f, n, n);
+				return true;
+			};
+	}
+
+	size_t GridBytes(unsigned int n)
+	{
+		PrimitiveSize size = PrimitiveGenerators::PlaneSize(n, n);
+		return size.VertexCount * sizeof(Vertex) + size.IndexCount * sizeof(unsigned int);
+	}
+}
+
+TEST_CASE("Decoded meshes wait for Update to become ready")
+{
+	AsyncMeshLoader loader(NoUpload);
+	std::vector<MeshHandle> handles;
+	for (int i = 0; i < 4; i++)
+		handles.push_back(loader.Load("grid", Grid(8)));
+
+	loader.WaitForDecodes();
+	for (MeshHandle& handle : handles)
+		CHECK(handle.IsPending());
+	CHECK(loader.GetStats().Decoded == 4);
+	CHECK(loader.GetPendingCount() == 4);
+
+	loader.Update();
+	for (MeshHandle& handle : handles)
+		CHECK(handle.IsReady());
+
+	MeshLoadStats stats = loader.GetStats();
+	CHECK(stats.Requested == 4 && stats.Uploaded == 4 && stats.Failed == 0);
+	CHECK(stats.BytesUploaded == 4 * GridBytes(8));
+	CHECK(loader.IsIdle());
+	CHECK(handles[0].GetName() == "grid");
+}
+
+TEST_CASE("Update stops at the byte budget, but always uploads one")
+{
+	// One worker, so the meshes decode (and upload) in order
+	AsyncMeshLoader loader(NoUpload, 1, GridBytes(8) * 2);
+	MeshHandle big = loader.Load("big", Grid(32));
+	MeshHandle small[3];
+	for (MeshHandle& handle : small)
+		handle = loader.Load("small", Grid(8));
+	loader.WaitForDecodes();
+
+	// The big mesh is over the whole budget on its own
+	loader.Update();
+	CHECK(big.IsReady());
+	CHECK(small[0].IsPending());
+
+	loader.Update();
+	CHECK(small[0].IsReady() && small[1].IsReady());
+	CHECK(small[2].IsPending());
+
+	loader.Update();
+	CHECK(small[2].IsReady());
+	CHECK(loader.GetStats().BytesUploaded == GridBytes(32) + 3 * GridBytes(8));
+}
+
+TEST_CASE("Decoded meshes are welded and bounded before upload")
+{
+	// Two triangles sharing an edge, with the shared corners duplicated
+	MeshDecoder decoder = [](MeshData& out)
+		{
+			XMFLOAT4 white(1, 1, 1, 1);
+			out.Vertices = {
+				{ XMFLOAT3(0, 0, 0), white }, { XMFLOAT3(0, 1, 0), white }, { XMFLOAT3(1, 1, 0), white },
+				{ XMFLOAT3(0, 0, 0), white }, { XMFLOAT3(1, 1, 0), white }, { XMFLOAT3(1, 0, 4), white } };
+			out.Indices = { 0, 1, 2, 3, 4, 5 };
+			return true;
+		};
+
+	size_t uploadedVertices = 0;
+	XMFLOAT3 extents = {};
+	AsyncMeshLoader loader([&](MeshData& data, std::shared_ptr<Mesh>&)
+		{
+			uploadedVertices = data.Vertices.size();
+			extents = data.Box.Extents;
+			return true;
+		});
+	loader.Load("quad", decoder);
+	loader.WaitForDecodes();
+	loader.Update();
+
+	CHECK(uploadedVertices == 4);
+	CHECK_NEAR(extents.x, 0.5, 1e-6);
+	CHECK_NEAR(extents.z, 2.0, 1e-6);
+}
+
+TEST_CASE("Failed decodes and uploads are counted")
+{
+	AsyncMeshLoader loader([](MeshData& data, std::shared_ptr<Mesh>&) { return data.Vertices.size() < 100; });
+	MeshHandle failsDecode = loader.Load("fails", [](MeshData&) { return false; });
+	MeshHandle empty = loader.Load("empty", [](MeshData&) { return true; });
+	MeshHandle failsUpload = loader.Load("large", Grid(16));
+	MeshHandle fine = loader.Load("fine", Grid(2));
+	loader.WaitForDecodes();
+	loader.Update();
+
+	CHECK(failsDecode.GetState() == MeshLoadState::Failed);
+	CHECK(empty.GetState() == MeshLoadState::Failed);
+	CHECK(failsUpload.GetState() == MeshLoadState::Failed);
+	CHECK(fine.IsReady());
+
+	MeshLoadStats stats = loader.GetStats();
+	CHECK(stats.Requested == 4 && stats.Decoded == 2 && stats.Uploaded == 1 && stats.Failed == 3);
+	CHECK(loader.IsIdle());
+
+	// A default handle has nothing behind it
+	CHECK(MeshHandle().GetState() == MeshLoadState::Failed);
+}
+
+TEST_CASE("Loads still queued at shutdown fail")
+{
+	std::vector<MeshHandle> handles;
+	{
+		AsyncMeshLoader loader(NoUpload, 1);
+		handles.push_back(loader.Load("decoded", Grid(4)));
+		loader.WaitForDecodes();
+
+		handles.push_back(loader.Load("slow", [](MeshData& out)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				return Grid(4)(out);
+			}));
+		for (int i = 0; i < 3; i++)
+			handles.push_back(loader.Load("queued", Grid(4)));
+	}
+
+	for (MeshHandle& handle : handles)
+		CHECK(handle.GetState() == MeshLoadState::Failed);
+}
+
+TEST_CASE("OBJ faces are fan triangulated into our handedness")
+{
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "AsyncMeshLoaderTests.obj";
+	{
+		std::ofstream file(path);
+		file << "v 0 0 0\nv 1 0 0\nv 1 1 0 1 0 0\nv 0 1 1\nvt 0 0\nf 1/1 2/1 3/1 -1/1\n";
+	}
+
+	MeshData uploaded;
+	AsyncMeshLoader loader([&](MeshData& data, std::shared_ptr<Mesh>&) { uploaded = data; return true; });
+	MeshHandle handle = loader.LoadOBJ(path.wstring());
+	loader.WaitForDecodes();
+	loader.Update();
+	std::filesystem::remove(path);
+
+	CHECK(handle.IsReady());
+	CHECK(handle.GetName() == "AsyncMeshLoaderTests.obj");
+	CHECK((uploaded.Indices == std::vector<unsigned int>{ 0, 2, 1, 0, 3, 2 }));
+	CHECK(uploaded.Vertices[3].Position.z == -1.0f);
+	CHECK(uploaded.Vertices[2].Color.x == 1.0f && uploaded.Vertices[2].Color.y == 0.0f);
+}
+
+TEST_MAIN()
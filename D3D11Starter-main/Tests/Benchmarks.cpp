@@ -0,0 +1,396 @@
+#include "TestHarness.h"
+
+#include "AsyncMeshLoader.h"
+#include "LightClusters.h"
+#include "MeshSimplifier.h"
+#include "PackedVertex.h"
+#include "PrimitiveGenerators.h"
+#include "RenderQueue.h"
+#include "RibbonSystem.h"
+#include "SoftwareRasterizer.h"
+#include "VertexWelder.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// --------------------------------------------------------
+// Timings for the CPU-side hot paths
+//
+// Not a ctest test, since timings depend on the machine -
+// run it by hand in a Release build. Each line is the best
+// of a few runs. Pass a benchmark's name (or part of it)
+// to run just those that match.
+// --------------------------------------------------------
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	const char* filter = nullptr;
+
+	bool Selected(const char* name)
+	{
+		return !filter || std::strstr(name, filter);
+	}
+
+	void Report(const char* name, double milliseconds, double items, const char* itemName)
+	{
+		std::printf("%-48s %9.3f ms  %8.2f M%s/s\n", name, milliseconds, items / (milliseconds * 1000.0), itemName);
+	}
+
+	// --------------------------------------------------------
+	// 1,000 point and spot lights scattered through a 720p
+	// view's frustum, binned into its clusters - the target
+	// is under 1 ms a frame
+	// --------------------------------------------------------
+	void ClusterLights(WorkerPool* pool, const char* name)
+	{
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<ClusterLight> lights(1000);
+		for (ClusterLight& light : lights)
+		{
+			float depth = 1.0f + unit(random) * 80.0f;
+			light = {};
+			light.Position = XMFLOAT3((unit(random) * 2 - 1) * depth, (unit(random) * 2 - 1) * depth * 0.6f, depth);
+			light.Range = 1.0f + unit(random) * 4.0f;
+			light.Color = XMFLOAT3(1, 1, 1);
+			light.Type = LightTypePoint;
+			if (unit(random) < 0.25f)
+			{
+				light.Direction = XMFLOAT3(0, -1, 0);
+				light.SpotCosAngle = 0.5f + unit(random) * 0.5f;
+				light.Type = LightTypeSpot;
+			}
+		}
+
+		XMFLOAT4X4 view, projection;
+		XMStoreFloat4x4(&view, XMMatrixIdentity());
+		XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PIDIV4, 1280.0f / 720.0f, 0.1f, 100.0f));
+
+		LightClusters clusters(pool);
+		double milliseconds = TestHarness::TimeMilliseconds(20, [&]()
+			{
+				clusters.Build(lights, view, projection, 1280, 720);
+			});
+		Report(name, milliseconds, (double)lights.size(), "lights");
+	}
+
+	// --------------------------------------------------------
+	// 256 grid meshes of 4k vertices each, decoded (generated,
+	// welded and bounded) on the loader's workers, then
+	// uploaded with a no-op uploader a frame's budget at a time
+	// --------------------------------------------------------
+	void LoadMeshes(unsigned int workerCount, const char* name)
+	{
+		const unsigned int meshCount = 256;
+		PrimitiveSize size = PrimitiveGenerators::PlaneSize(64, 64);
+		MeshDecoder grid = [size](MeshData& out)
+			{
+				out.Vertices.resize(size.VertexCount);
+				out.Indices.resize(size.IndexCount);
+				PrimitiveGenerators::Plane(out.Vertices, out.Indices, 10.0f, 10.0f, 64, 64);
+				return true;
+			};
+
+		// Decoding alone is the best of its own timings
+		MeshLoadStats stats = {};
+		unsigned int frames = 0;
+		double decodeMilliseconds = 1e30;
+		TestHarness::TimeMilliseconds(3, [&]()
+			{
+				AsyncMeshLoader loader([](MeshData&, std::shared_ptr<Mesh>&) { return true; }, workerCount);
+				decodeMilliseconds = std::min(decodeMilliseconds, TestHarness::TimeMilliseconds(1, [&]()
+					{
+						for (unsigned int i = 0; i < meshCount; i++)
+							loader.Load("grid", grid);
+						loader.WaitForDecodes();
+					}));
+
+				frames = 0;
+				while (!loader.IsIdle())
+				{
+					loader.Update();
+					frames++;
+				}
+				stats = loader.GetStats();
+			});
+		Report(name, decodeMilliseconds, meshCount * (double)size.VertexCount, "vertices");
+
+		// Update() should only cost a copy of its budget
+		// (the default 4 MB), however long the queue behind it is
+		Report("  worst Update(), 4 MB budget", stats.MaxUploadMilliseconds, (double)stats.BytesUploaded / frames, "bytes");
+	}
+
+	// --------------------------------------------------------
+	// Each generator writing about 128k lit triangles into
+	// spans that are reused between runs, as a loader would
+	// --------------------------------------------------------
+	template <typename Generate>
+	void GenerateShape(PrimitiveSize size, Generate generate, const char* name)
+	{
+		std::vector<LitVertex> vertices(size.VertexCount);
+		std::vector<unsigned int> indices(size.IndexCount);
+		double milliseconds = TestHarness::TimeMilliseconds(10, [&]()
+			{
+				generate(std::span<LitVertex>(vertices), std::span<unsigned int>(indices));
+			});
+		Report(name, milliseconds, size.IndexCount / 3.0, "triangles");
+	}
+
+	void GenerateShapes()
+	{
+		std::vector<float> heights(257 * 257);
+		for (size_t i = 0; i < heights.size(); i++)
+			heights[i] = sinf(i * 0.01f) * cosf(i * 0.003f);
+
+		GenerateShape(PrimitiveGenerators::SphereSize(256, 256),
+			[](auto v, auto i) { PrimitiveGenerators::Sphere(v, i, 1.0f, 256, 256); }, "Generate sphere, 256 x 256");
+		GenerateShape(PrimitiveGenerators::CubeSize(104),
+			[](auto v, auto i) { PrimitiveGenerators::Cube(v, i, 1.0f, 104); }, "Generate cube, 104 x 104 per face");
+		GenerateShape(PrimitiveGenerators::CylinderSize(256, 255, true),
+			[](auto v, auto i) { PrimitiveGenerators::Cylinder(v, i, 1.0f, 2.0f, 256, 255, true); }, "Generate capped cylinder, 256 x 255");
+		GenerateShape(PrimitiveGenerators::TorusSize(256, 256),
+			[](auto v, auto i) { PrimitiveGenerators::Torus(v, i, 1.0f, 0.25f, 256, 256); }, "Generate torus, 256 x 256");
+		GenerateShape(PrimitiveGenerators::PlaneSize(256, 256),
+			[](auto v, auto i) { PrimitiveGenerators::Plane(v, i, 10.0f, 10.0f, 256, 256); }, "Generate plane, 256 x 256");
+		GenerateShape(PrimitiveGenerators::HeightfieldSize(257, 257),
+			[&](auto v, auto i) { PrimitiveGenerators::Heightfield(v, i, heights, 257, 257, 0.1f, 1.0f); }, "Generate heightfield, 257 x 257 samples");
+	}
+
+	void PackVertices()
+	{
+		const int count = 1 << 20;
+		std::vector<LitVertex> vertices(count);
+		for (int i = 0; i < count; i++)
+		{
+			float angle = i * 0.001f;
+			vertices[i].Position = XMFLOAT3(cosf(angle) * i * 1e-4f, sinf(angle), (float)(i % 977));
+			vertices[i].Normal = XMFLOAT3(cosf(angle), 0.0f, sinf(angle));
+			vertices[i].Tangent = XMFLOAT4(-sinf(angle), 0.0f, cosf(angle), 1.0f);
+			vertices[i].UV = XMFLOAT2(angle, 1.0f - angle);
+			vertices[i].Color = XMFLOAT4(1, 1, 1, 1);
+		}
+
+		std::vector<PackedLitVertex> packed(count);
+		double milliseconds = TestHarness::TimeMilliseconds(5, [&]()
+			{
+				VertexPacking::PackVertices(vertices.data(), count, packed.data());
+			});
+		Report("Pack 1M lit vertices", milliseconds, count, "vertices");
+	}
+
+	// --------------------------------------------------------
+	// 10k trails with full rings, every one a different curve,
+	// expanded as a frame would: after one new point each
+	// --------------------------------------------------------
+	void ExpandRibbons(WorkerPool* pool, const char* name)
+	{
+		const unsigned int trailCount = 10000;
+		RibbonSystem ribbons(pool);
+		for (unsigned int t = 0; t < trailCount; t++)
+		{
+			unsigned int trail = ribbons.CreateTrail({ 0.1f, 10.0f, XMFLOAT4(1.0f, 0.5f, 0.25f, 0.8f) });
+			for (unsigned int i = 0; i < RibbonSystem::PointsPerTrail; i++)
+			{
+				float angle = i * 0.2f + t;
+				ribbons.AddPoint(trail, XMFLOAT3(cosf(angle) + t * 0.01f, i * 0.05f, sinf(angle)), i * 0.016f);
+			}
+		}
+
+		// Expand() alone is the best of its own timings
+		float time = RibbonSystem::PointsPerTrail * 0.016f;
+		double expandMilliseconds = 1e30;
+		double milliseconds = TestHarness::TimeMilliseconds(20, [&]()
+			{
+				for (unsigned int t = 0; t < trailCount; t++)
+					ribbons.AddPoint(t, XMFLOAT3(t * 0.01f, time, 0.0f), time);
+				ribbons.Expand(XMFLOAT3(0, 2, -10), time);
+				expandMilliseconds = std::min(expandMilliseconds, (double)ribbons.GetExpandMilliseconds());
+				time += 0.016f;
+			});
+		Report(name, expandMilliseconds, trailCount * (double)RibbonSystem::PointsPerTrail, "points");
+		Report("  with a new point on every trail", milliseconds, trailCount * (double)RibbonSystem::PointsPerTrail, "points");
+	}
+
+	void SimplifySphere()
+	{
+		PrimitiveSize size = PrimitiveGenerators::SphereSize(256, 128);
+		std::vector<Vertex> vertices(size.VertexCount);
+		std::vector<unsigned int> indices(size.IndexCount);
+		PrimitiveGenerators::Sphere(vertices, indices, 1.0f, 256, 128);
+
+		SimplifyOptions options;
+		options.TargetTriangleCount = size.IndexCount / 3 / 10;
+		double milliseconds = TestHarness::TimeMilliseconds(3, [&]()
+			{
+				MeshSimplifier::Simplify(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size(), options);
+			});
+		Report("Simplify 64k-triangle sphere to 10%", milliseconds, size.IndexCount / 3.0, "triangles");
+	}
+
+	// --------------------------------------------------------
+	// A moderate scene at 720p: a floor filling the bottom of
+	// the screen and a grid of spheres and tori over it, 64k
+	// triangles in all, timed from Clear() to Finish()
+	// --------------------------------------------------------
+	void RasterizeScene(WorkerPool* pool, const char* name)
+	{
+		PrimitiveSize sphereSize = PrimitiveGenerators::SphereSize(32, 16);
+		std::vector<Vertex> sphereVertices(sphereSize.VertexCount);
+		std::vector<unsigned int> sphereIndices(sphereSize.IndexCount);
+		PrimitiveGenerators::Sphere(sphereVertices, sphereIndices, 0.5f, 32, 16);
+
+		PrimitiveSize torusSize = PrimitiveGenerators::TorusSize(48, 16);
+		std::vector<Vertex> torusVertices(torusSize.VertexCount);
+		std::vector<unsigned int> torusIndices(torusSize.IndexCount);
+		PrimitiveGenerators::Torus(torusVertices, torusIndices, 0.45f, 0.15f, 48, 16);
+
+		PrimitiveSize floorSize = PrimitiveGenerators::PlaneSize(16, 16);
+		std::vector<Vertex> floorVertices(floorSize.VertexCount);
+		std::vector<unsigned int> floorIndices(floorSize.IndexCount);
+		PrimitiveGenerators::Plane(floorVertices, floorIndices, 40.0f, 40.0f, 16, 16);
+
+		SoftwareRasterizer rasterizer(1280, 720, pool);
+		XMFLOAT4X4 view, projection;
+		XMStoreFloat4x4(&view, XMMatrixLookToLH(XMVectorSet(0, 4, -9, 1), XMVectorSet(0, -4, 11, 0), XMVectorSet(0, 1, 0, 0)));
+		XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PIDIV4, 1280.0f / 720.0f, 0.1f, 100.0f));
+		rasterizer.SetCamera(view, projection);
+
+		unsigned int triangles = 0;
+		double milliseconds = TestHarness::TimeMilliseconds(10, [&]()
+			{
+				rasterizer.Clear(XMFLOAT4(0.4f, 0.6f, 0.75f, 1.0f));
+
+				BufferStruct constants = {};
+				constants.colorTint = XMFLOAT4(1, 1, 1, 1);
+				XMStoreFloat4x4(&constants.world, XMMatrixTranslation(0, -0.5f, 0));
+				rasterizer.Draw(floorVertices.data(), (int)floorVertices.size(), floorIndices.data(), (int)floorIndices.size(), constants);
+
+				for (int z = 0; z < 6; z++)
+				{
+					for (int x = 0; x < 8; x++)
+					{
+						XMStoreFloat4x4(&constants.world, XMMatrixTranslation(x * 1.3f - 4.55f, 0.0f, z * 1.5f));
+						if ((x + z) % 2)
+							rasterizer.Draw(sphereVertices.data(), (int)sphereVertices.size(), sphereIndices.data(), (int)sphereIndices.size(), constants);
+						else
+							rasterizer.Draw(torusVertices.data(), (int)torusVertices.size(), torusIndices.data(), (int)torusIndices.size(), constants);
+					}
+				}
+				rasterizer.Finish();
+				triangles = rasterizer.GetTrianglesDrawn();
+			});
+		Report(name, milliseconds, triangles, "triangles");
+	}
+
+	// --------------------------------------------------------
+	// Draw keys with either every bit random (the worst case,
+	// all 64 bits vary) or shaped like a frame's: one pass,
+	// a few shaders and materials, many meshes and a full
+	// range of depths. Adding the draws is timed too.
+	// --------------------------------------------------------
+	void SortKeys(int count, bool realistic, const char* name)
+	{
+		std::mt19937_64 random(11);
+		std::vector<uint64_t> keys(count);
+		for (uint64_t& key : keys)
+		{
+			key = realistic
+				? RenderKey::Opaque(0, random() % 4, random() % 64, random() % 5000, (uint32_t)random())
+				: random();
+		}
+
+		RenderQueue queue;
+		queue.Reserve(count);
+		double milliseconds = TestHarness::TimeMilliseconds(20, [&]()
+			{
+				queue.Clear();
+				for (int i = 0; i < count; i++)
+					queue.Add(keys[i], i);
+				queue.Sort();
+			});
+		Report(name, milliseconds, count, "keys");
+
+		std::vector<RenderQueueEntry> entries(count);
+		double stdMilliseconds = TestHarness::TimeMilliseconds(20, [&]()
+			{
+				for (int i = 0; i < count; i++)
+					entries[i] = { keys[i], (uint32_t)i };
+				std::sort(entries.begin(), entries.end(),
+					[](const RenderQueueEntry& a, const RenderQueueEntry& b) { return a.Key < b.Key; });
+			});
+		Report("  std::sort, same keys", stdMilliseconds, count, "keys");
+	}
+
+	void WeldSphere(float epsilon, const char* name)
+	{
+		PrimitiveSize size = PrimitiveGenerators::SphereSize(1024, 512);
+		std::vector<Vertex> source(size.VertexCount);
+		std::vector<unsigned int> sourceIndices(size.IndexCount);
+		PrimitiveGenerators::Sphere(source, sourceIndices, 1.0f, 1024, 512);
+
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+		double milliseconds = TestHarness::TimeMilliseconds(5, [&]()
+			{
+				vertices = source;
+				indices = sourceIndices;
+				VertexWelder::Weld(vertices, indices, epsilon);
+			});
+		Report(name, milliseconds, size.VertexCount, "vertices");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+		filter = argv[1];
+
+	if (Selected("Cluster"))
+	{
+		WorkerPool pool;
+		ClusterLights(nullptr, "Cluster 1k lights, one thread");
+		ClusterLights(&pool, "Cluster 1k lights, worker pool");
+	}
+	if (Selected("Decode"))
+	{
+		LoadMeshes(1, "Decode 256 4k-vertex meshes, one worker");
+		LoadMeshes(4, "Decode 256 4k-vertex meshes, four workers");
+	}
+	if (Selected("Generate"))
+		GenerateShapes();
+	if (Selected("Pack"))
+		PackVertices();
+	if (Selected("Rasterize"))
+	{
+		WorkerPool pool;
+		RasterizeScene(nullptr, "Rasterize 720p scene, one thread");
+		RasterizeScene(&pool, "Rasterize 720p scene, worker pool");
+	}
+	if (Selected("Ribbons"))
+	{
+		WorkerPool pool;
+		ExpandRibbons(nullptr, "Expand 10k 32-point ribbons, one thread");
+		ExpandRibbons(&pool, "Expand 10k 32-point ribbons, worker pool");
+	}
+	if (Selected("Simplify"))
+		SimplifySphere();
+	if (Selected("Sort"))
+	{
+		SortKeys(100000, false, "Queue and sort 100k random keys");
+		SortKeys(100000, true, "Queue and sort 100k frame-shaped keys");
+		SortKeys(10000, true, "Queue and sort 10k frame-shaped keys");
+	}
+	if (Selected("Weld"))
+	{
+		WeldSphere(0.0f, "Weld 500k-vertex sphere, exact");
+		WeldSphere(1e-4f, "Weld 500k-vertex sphere, epsilon");
+	}
+	return 0;
+}
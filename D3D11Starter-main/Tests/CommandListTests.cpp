@@ -0,0 +1,156 @@
+#include "TestHarness.h"
+
+#include "CommandList.h"
+#include "NullRenderContext.h"
+#include "RecordingRenderContext.h"
+#include "StateCache.h"
+
+#include <cstring>
+#include <vector>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Never dereferenced, so any distinct addresses will do
+	ID3D11InputLayout* const layout = (ID3D11InputLayout*)0x1000;
+	ID3D11VertexShader* const vertexShader = (ID3D11VertexShader*)0x2000;
+	ID3D11PixelShader* const pixelShader = (ID3D11PixelShader*)0x3000;
+	ID3D11Buffer* const vertexBuffer = (ID3D11Buffer*)0x4000;
+	ID3D11Buffer* const indexBuffer = (ID3D11Buffer*)0x5000;
+	ID3D11Buffer* const constantBuffer = (ID3D11Buffer*)0x6000;
+
+	bool SameCall(const RenderCall& a, const RenderCall& b)
+	{
+		return a.Type == b.Type && a.Object == b.Object && a.DataSize == b.DataSize &&
+			a.Slot == b.Slot && a.Stride == b.Stride && a.Offset == b.Offset &&
+			a.IndexCount == b.IndexCount && a.InstanceCount == b.InstanceCount &&
+			a.StartIndex == b.StartIndex && a.BaseVertex == b.BaseVertex &&
+			a.StartInstance == b.StartInstance && a.FirstConstant == b.FirstConstant &&
+			a.ConstantCount == b.ConstantCount;
+	}
+
+	// One of every call, with values that would show a mixed up field
+	void MakeEveryCall(RenderContext& context)
+	{
+		float data[5] = { 1, 2, 3, 4, 5 };
+		context.SetInputLayout(layout);
+		context.SetVertexShader(vertexShader);
+		context.SetPixelShader(pixelShader);
+		context.SetVertexBuffer(1, vertexBuffer, 24, 8);
+		context.SetIndexBuffer(indexBuffer);
+		context.SetVSConstantBuffer(2, constantBuffer);
+		context.SetVSConstantBufferRange(0, constantBuffer, 48, 16);
+		context.UploadBuffer(constantBuffer, data, sizeof(data));
+		context.DrawIndexed(36, 6, -3);
+		context.DrawIndexedInstanced(72, 9, 12, 5, 7);
+	}
+
+	// Keeps a copy of every upload, which RecordingRenderContext doesn't
+	class UploadCapture : public RecordingRenderContext
+	{
+	public:
+		void UploadBuffer(ID3D11Buffer* buffer, const void* data, unsigned int size) override
+		{
+			RecordingRenderContext::UploadBuffer(buffer, data, size);
+			const unsigned char* bytes = (const unsigned char*)data;
+			Uploads.push_back(std::vector<unsigned char>(bytes, bytes + size));
+		}
+
+		std::vector<std::vector<unsigned char>> Uploads;
+	};
+}
+
+TEST_CASE("Execute replays every call as it was made")
+{
+	RecordingRenderContext direct;
+	MakeEveryCall(direct);
+
+	CommandList list;
+	MakeEveryCall(list);
+	CHECK(list.GetCommandCount() == direct.GetCalls().size());
+	CHECK(list.GetByteSize() % 8 == 0);
+
+	RecordingRenderContext replayed;
+	list.Execute(replayed);
+	CHECK(replayed.GetCalls().size() == direct.GetCalls().size());
+	for (size_t i = 0; i < direct.GetCalls().size() && i < replayed.GetCalls().size(); i++)
+		CHECK(SameCall(replayed.GetCalls()[i], direct.GetCalls()[i]));
+}
+
+TEST_CASE("Uploads are copied, so the source can go away before Execute")
+{
+	CommandList list;
+	{
+		// Odd sizes, so the data after each command needs padding
+		std::vector<unsigned char> first = { 1, 2, 3 };
+		std::vector<unsigned char> second(37);
+		for (size_t i = 0; i < second.size(); i++)
+			second[i] = (unsigned char)(i * 7);
+		list.UploadBuffer(constantBuffer, first.data(), (unsigned int)first.size());
+		list.DrawIndexed(3, 0, 0);
+		list.UploadBuffer(vertexBuffer, second.data(), (unsigned int)second.size());
+		std::memset(first.data(), 0, first.size());
+		std::memset(second.data(), 0, second.size());
+	}
+
+	UploadCapture capture;
+	list.Execute(capture);
+	CHECK(capture.GetCalls().size() == 3);
+	CHECK(capture.Uploads.size() == 2);
+	if (capture.Uploads.size() == 2)
+	{
+		CHECK(capture.Uploads[0] == std::vector<unsigned char>({ 1, 2, 3 }));
+		CHECK(capture.Uploads[1].size() == 37);
+		for (size_t i = 0; i < capture.Uploads[1].size(); i++)
+			CHECK(capture.Uploads[1][i] == (unsigned char)(i * 7));
+	}
+}
+
+TEST_CASE("Reset empties the list and keeps its memory")
+{
+	CommandList list;
+	for (int i = 0; i < 1000; i++)
+		MakeEveryCall(list);
+	CHECK(list.GetCommandCount() == 10000);
+	size_t fullSize = list.GetByteSize();
+
+	list.Reset();
+	CHECK(list.GetCommandCount() == 0);
+	CHECK(list.GetByteSize() == 0);
+
+	RecordingRenderContext empty;
+	list.Execute(empty);
+	CHECK(empty.GetCalls().empty());
+
+	// Refilling gives the same bytes, and only the new calls replay
+	MakeEveryCall(list);
+	CHECK(list.GetByteSize() * 1000 == fullSize);
+	RecordingRenderContext replayed;
+	list.Execute(replayed);
+	CHECK(replayed.GetCalls().size() == 10);
+}
+
+TEST_CASE("A NullRenderContext counts what a replay would have done")
+{
+	CommandList list;
+	for (int i = 0; i < 100; i++)
+		MakeEveryCall(list);
+
+	NullRenderContext counter;
+	list.Execute(counter);
+	CHECK(counter.GetStateCallCount() == 700);
+	CHECK(counter.GetDrawCount() == 200);
+	CHECK(counter.GetUploadedBytes() == 100 * 5 * sizeof(float));
+
+	// Through a StateCache, only the first frame's binds get there
+	counter.ResetCounts();
+	CHECK(counter.GetStateCallCount() == 0 && counter.GetDrawCount() == 0 && counter.GetUploadedBytes() == 0);
+	StateCache cache(counter);
+	list.Execute(cache);
+	CHECK(counter.GetStateCallCount() == 7);
+	CHECK(counter.GetDrawCount() == 200);
+	CHECK(cache.GetStats().Submitted == 700 && cache.GetStats().Filtered == 693);
+}
+
+TEST_MAIN()
@@ -0,0 +1,214 @@
+#include "TestHarness.h"
+
+#include "FrameGraph.h"
+
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	const FrameGraphTextureDesc screen = { 1280, 720, 28, 4 };
+	const FrameGraphTextureDesc half = { 640, 360, 28, 4 };
+
+	// The kept passes' names, in the order they'd run
+	std::vector<std::string> Order(FrameGraph& graph)
+	{
+		std::vector<std::string> names;
+		for (unsigned int pass : graph.GetPassOrder())
+			names.push_back(graph.GetPassName(pass));
+		return names;
+	}
+
+	// Appends its name to the log when it runs
+	unsigned int AddLoggedPass(FrameGraph& graph, const std::string& name, std::vector<std::string>& log)
+	{
+		return graph.AddPass(name, [&log, name]() { log.push_back(name); });
+	}
+}
+
+TEST_CASE("A read sees the write before it, and the next write waits for it")
+{
+	FrameGraph graph;
+	std::vector<std::string> log;
+	unsigned int backBuffer = graph.ImportTexture("Back buffer", screen);
+	unsigned int scene = graph.CreateTexture("Scene", screen);
+
+	unsigned int first = AddLoggedPass(graph, "W1", log);
+	graph.Write(first, scene);
+	unsigned int reader = AddLoggedPass(graph, "R", log);
+	graph.Read(reader, scene);
+	graph.Write(reader, backBuffer);
+	unsigned int second = AddLoggedPass(graph, "W2", log);
+	graph.Write(second, scene);
+	unsigned int finalReader = AddLoggedPass(graph, "R2", log);
+	graph.Read(finalReader, scene);
+	graph.Write(finalReader, backBuffer);
+
+	CHECK(graph.Compile());
+	graph.Execute();
+	CHECK((log == std::vector<std::string>{ "W1", "R", "W2", "R2" }));
+}
+
+TEST_CASE("Overwritten versions nothing reads are culled")
+{
+	FrameGraph graph;
+	unsigned int backBuffer = graph.ImportTexture("Back buffer", screen);
+	unsigned int scene = graph.CreateTexture("Scene", screen);
+
+	// Only W2's version is ever read, so W1 has nothing to do
+	unsigned int first = graph.AddPass("W1", nullptr);
+	graph.Write(first, scene);
+	unsigned int second = graph.AddPass("W2", nullptr);
+	graph.Write(second, scene);
+	unsigned int reader = graph.AddPass("R", nullptr);
+	graph.Read(reader, scene);
+	graph.Write(reader, backBuffer);
+	unsigned int unread = graph.AddPass("Unread", nullptr);
+	graph.Write(unread, graph.CreateTexture("Unread", half));
+
+	CHECK(graph.Compile());
+	CHECK(graph.IsCulled(first));
+	CHECK(!graph.IsCulled(second));
+	CHECK(graph.IsCulled(unread));
+	CHECK((Order(graph) == std::vector<std::string>{ "W2", "R" }));
+	CHECK(graph.GetStats().CulledPassCount == 2);
+}
+
+TEST_CASE("Passes that blend into a resource keep the ones before them")
+{
+	FrameGraph graph;
+	unsigned int backBuffer = graph.ImportTexture("Back buffer", screen);
+	unsigned int depth = graph.ImportTexture("Depth buffer", screen);
+	unsigned int clear = graph.AddPass("Clear", nullptr);
+	graph.Write(clear, backBuffer);
+	graph.Write(clear, depth);
+	unsigned int opaque = graph.AddPass("Opaque", nullptr);
+	graph.Read(opaque, depth);
+	graph.Write(opaque, backBuffer);
+	graph.Write(opaque, depth);
+	unsigned int ui = graph.AddPass("UI", nullptr);
+	graph.Read(ui, backBuffer);
+	graph.Write(ui, backBuffer);
+
+	// Writes given before reads still read what came before the pass
+	unsigned int blend = graph.AddPass("Blend", nullptr);
+	graph.Write(blend, backBuffer);
+	graph.Read(blend, backBuffer);
+
+	CHECK(graph.Compile());
+	CHECK((Order(graph) == std::vector<std::string>{ "Clear", "Opaque", "UI", "Blend" }));
+}
+
+TEST_CASE("Reading a transient before anything writes it fails")
+{
+	FrameGraph graph;
+	unsigned int backBuffer = graph.ImportTexture("Back buffer", screen);
+	unsigned int scene = graph.CreateTexture("Scene", screen);
+
+	// The write comes after the read, so it's no use to it
+	unsigned int reader = graph.AddPass("R", nullptr);
+	graph.Read(reader, scene);
+	graph.Write(reader, backBuffer);
+	unsigned int writer = graph.AddPass("W", nullptr);
+	graph.Write(writer, scene);
+
+	CHECK(!graph.Compile());
+	CHECK(graph.GetError().find("\"R\" reads \"Scene\"") != std::string::npos);
+	CHECK(graph.GetPassOrder().empty());
+
+	// A pass reading its own earlier write is no better
+	graph.Reset();
+	backBuffer = graph.ImportTexture("Back buffer", screen);
+	scene = graph.CreateTexture("Scene", screen);
+	unsigned int blend = graph.AddPass("Blend", nullptr);
+	graph.Read(blend, scene);
+	graph.Write(blend, scene);
+	graph.Write(blend, backBuffer);
+	CHECK(!graph.Compile());
+}
+
+TEST_CASE("Transients that are never alive at once share a texture")
+{
+	// A downsample and blur chain: Half A is done with once the first
+	// blur has read it, so the second blur's target can take its place
+	FrameGraph graph;
+	unsigned int backBuffer = graph.ImportTexture("Back buffer", screen);
+	unsigned int scene = graph.CreateTexture("Scene", screen);
+	unsigned int halfA = graph.CreateTexture("Half A", half);
+	unsigned int halfB = graph.CreateTexture("Half B", half);
+	unsigned int halfC = graph.CreateTexture("Half C", half);
+
+	unsigned int copy = graph.AddPass("Copy", nullptr);
+	graph.Read(copy, backBuffer);
+	graph.Write(copy, scene);
+	unsigned int bright = graph.AddPass("Bright", nullptr);
+	graph.Read(bright, scene);
+	graph.Write(bright, halfA);
+	unsigned int blurX = graph.AddPass("Blur X", nullptr);
+	graph.Read(blurX, halfA);
+	graph.Write(blurX, halfB);
+	unsigned int blurY = graph.AddPass("Blur Y", nullptr);
+	graph.Read(blurY, halfB);
+	graph.Write(blurY, halfC);
+	unsigned int composite = graph.AddPass("Composite", nullptr);
+	graph.Read(composite, halfC);
+	graph.Read(composite, backBuffer);
+	graph.Write(composite, backBuffer);
+
+	CHECK(graph.Compile());
+	CHECK(graph.GetPhysicalIndex(backBuffer) == FrameGraph::Invalid);
+	CHECK(graph.GetPhysicalIndex(halfA) == graph.GetPhysicalIndex(halfC));
+	CHECK(graph.GetPhysicalIndex(halfA) != graph.GetPhysicalIndex(halfB));
+	CHECK(graph.GetPhysicalTextureCount() == 3);
+
+	FrameGraphStats stats = graph.GetStats();
+	CHECK(stats.TransientCount == 4);
+	CHECK(stats.PhysicalTextureCount == 3);
+	CHECK(stats.UnaliasedBytes == 1280 * 720 * 4 + 3 * 640 * 360 * 4);
+	CHECK(stats.PeakTransientBytes == 1280 * 720 * 4 + 2 * 640 * 360 * 4);
+}
+
+TEST_CASE("Only matching descriptions are aliased")
+{
+	// Same size and format, but a different pixel size, can't share
+	FrameGraphTextureDesc wide = half;
+	wide.BytesPerPixel = 8;
+	CHECK(!(wide == half));
+	CHECK(half == half);
+
+	FrameGraph graph;
+	unsigned int backBuffer = graph.ImportTexture("Back buffer", screen);
+	unsigned int a = graph.CreateTexture("A", half);
+	unsigned int b = graph.CreateTexture("B", wide);
+	unsigned int first = graph.AddPass("First", nullptr);
+	graph.Write(first, a);
+	unsigned int second = graph.AddPass("Second", nullptr);
+	graph.Read(second, a);
+	graph.Write(second, backBuffer);
+	unsigned int third = graph.AddPass("Third", nullptr);
+	graph.Write(third, b);
+	unsigned int fourth = graph.AddPass("Fourth", nullptr);
+	graph.Read(fourth, b);
+	graph.Write(fourth, backBuffer);
+
+	CHECK(graph.Compile());
+	CHECK(graph.GetPhysicalIndex(a) != graph.GetPhysicalIndex(b));
+	CHECK(graph.GetPhysicalTextureCount() == 2);
+}
+
+TEST_CASE("Passes kept alive run even when nothing reads them")
+{
+	FrameGraph graph;
+	std::vector<std::string> log;
+	unsigned int query = AddLoggedPass(graph, "Query", log);
+	graph.KeepAlive(query);
+	AddLoggedPass(graph, "Nothing", log);
+
+	CHECK(graph.Compile());
+	graph.Execute();
+	CHECK((log == std::vector<std::string>{ "Query" }));
+}
+
+TEST_MAIN()
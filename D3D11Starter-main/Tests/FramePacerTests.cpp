@@ -0,0 +1,196 @@
+#include "TestHarness.h"
+
+#include "FrameFence.h"
+#include "FramePacer.h"
+#include "PacingClock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// --------------------------------------------------------
+	// Time only moves when the pacer looks at it or sleeps
+	//  - Every Now() costs a microsecond, so spinning ends
+	//  - Sleeps run over by a repeating pattern of up to
+	//    overrun seconds, as operating system sleeps do
+	// --------------------------------------------------------
+	class SimulatedClock : public PacingClock
+	{
+	public:
+		explicit SimulatedClock(double overrun = 0) : time(100.0), overrun(overrun), sleeps(0) {}
+
+		double Now() override
+		{
+			time += 1e-6;
+			return time;
+		}
+
+		void Sleep(double seconds) override
+		{
+			time += seconds + overrun * ((sleeps++ * 7) % 10) / 9.0;
+		}
+
+		// The frame's own work
+		void Advance(double seconds) { time += seconds; }
+
+		double time;
+		double overrun;
+		unsigned int sleeps;
+	};
+
+	// A GPU that works through frames one after another, each
+	// taking frameSeconds from when it's signaled (or when the
+	// one before it is done, if that's later)
+	class SimulatedFence : public FrameFence
+	{
+	public:
+		SimulatedFence(SimulatedClock& clock, double frameSeconds) : clock(clock), frameSeconds(frameSeconds) {}
+
+		void Signal(uint64_t frame) override
+		{
+			double start = finishTimes.empty() ? clock.time : std::max(clock.time, finishTimes.back());
+			finishTimes.resize(frame, start);
+			finishTimes.back() = start + frameSeconds;
+		}
+
+		bool IsComplete(uint64_t frame) override
+		{
+			return frame <= finishTimes.size() && finishTimes[frame - 1] <= clock.time;
+		}
+
+		SimulatedClock& clock;
+		double frameSeconds;
+		std::vector<double> finishTimes;	// Of frame n at [n - 1]
+	};
+
+	// Runs frames with the given work each, returning when each started
+	template <typename Work>
+	std::vector<double> RunFrames(FramePacer& pacer, SimulatedClock& clock, unsigned int count, Work work)
+	{
+		std::vector<double> starts;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			pacer.WaitForNextFrame();
+			starts.push_back(clock.time);
+			clock.Advance(work(i));
+			pacer.EndFrame();
+		}
+		return starts;
+	}
+}
+
+TEST_CASE("Target FPS keeps a steady beat through sleeps that run over")
+{
+	SimulatedClock clock(0.002);
+	FramePacer pacer(clock);
+	pacer.SetMode(FramePacingMode::TargetFps);
+	pacer.SetTargetFps(60.0f);
+
+	std::vector<double> starts = RunFrames(pacer, clock, 300, [](unsigned int i) { return 0.004 + (i % 5) * 0.001; });
+
+	// The first few sleeps teach it how far to stay back, after
+	// that every start is within a few spins of its deadline
+	double beat = 1.0 / 60.0;
+	for (size_t i = 20; i < starts.size(); i++)
+		CHECK_NEAR(starts[i] - starts[i - 1], beat, 1e-4);
+
+	FramePacerStats stats = pacer.GetStats();
+	CHECK_NEAR(stats.TargetMilliseconds, 1000.0 / 60.0, 1e-3);
+	CHECK_NEAR(stats.AverageMilliseconds, 1000.0 / 60.0, 0.01);
+	CHECK(stats.JitterMilliseconds < 0.05f);
+	CHECK(stats.DeadlineErrorMilliseconds < 0.05f);
+	CHECK(stats.MissedDeadlines == 0);
+}
+
+TEST_CASE("Deadlines follow the beat, not the last start, so nothing drifts")
+{
+	SimulatedClock clock(0.001);
+	FramePacer pacer(clock);
+	pacer.SetTargetFps(100.0f);
+
+	std::vector<double> starts = RunFrames(pacer, clock, 1000, [](unsigned int i) { return 0.002 * (i % 3); });
+	CHECK_NEAR(starts.back() - starts.front(), 999 * 0.01, 1e-4);
+}
+
+TEST_CASE("A frame a whole beat late starts the beat over instead of catching up")
+{
+	SimulatedClock clock;
+	FramePacer pacer(clock);
+	pacer.SetTargetFps(50.0f);
+
+	std::vector<double> starts = RunFrames(pacer, clock, 40, [](unsigned int i) { return i == 20 ? 0.1 : 0.005; });
+	CHECK(pacer.GetStats().MissedDeadlines == 1);
+
+	// The slow frame's successor starts straight away, then the beat goes on from there
+	CHECK(starts[21] - starts[20] < 0.1 + 1e-4);
+	for (size_t i = 22; i < starts.size(); i++)
+		CHECK_NEAR(starts[i] - starts[i - 1], 0.02, 1e-4);
+}
+
+TEST_CASE("Unlimited starts every frame as soon as the last one ends")
+{
+	SimulatedClock clock;
+	FramePacer pacer(clock);
+	pacer.SetMode(FramePacingMode::Unlimited);
+
+	std::vector<double> starts = RunFrames(pacer, clock, 50, [](unsigned int) { return 0.003; });
+	for (size_t i = 1; i < starts.size(); i++)
+		CHECK_NEAR(starts[i] - starts[i - 1], 0.003, 1e-4);
+	CHECK(pacer.GetStats().TargetMilliseconds == 0.0f);
+	CHECK(pacer.GetFrameNumber() == 50);
+}
+
+TEST_CASE("Frames in flight wait for the GPU")
+{
+	// The GPU takes 20 ms a frame, the CPU 2 - without a limit the
+	// CPU would run further and further ahead of it
+	SimulatedClock clock;
+	SimulatedFence fence(clock, 0.02);
+	FramePacer pacer(clock);
+	pacer.SetMode(FramePacingMode::Unlimited);
+	pacer.SetFramesInFlight(&fence, 2);
+
+	for (unsigned int i = 0; i < 100; i++)
+	{
+		pacer.WaitForNextFrame();
+		uint64_t frame = pacer.GetFrameNumber();
+		if (frame > 2)
+			CHECK(fence.IsComplete(frame - 2));
+		clock.Advance(0.002);
+		pacer.EndFrame();
+	}
+
+	// So it settles into the GPU's pace, give or take a fence poll
+	FramePacerStats stats = pacer.GetStats();
+	CHECK_NEAR(stats.AverageMilliseconds, 20.0, 0.6);
+	CHECK(fence.finishTimes.size() == 100);
+}
+
+TEST_CASE("Adaptive slows to a beat the frames keep up with")
+{
+	SimulatedClock clock(0.001);
+	FramePacer pacer(clock);
+	pacer.SetMode(FramePacingMode::Adaptive);
+	pacer.SetTargetFps(60.0f);
+
+	// 25 ms of work can't keep a 60 FPS beat
+	RunFrames(pacer, clock, 200, [](unsigned int) { return 0.025; });
+	FramePacerStats stats = pacer.GetStats();
+	CHECK(stats.TargetMilliseconds >= 25.0f);
+	CHECK(stats.TargetMilliseconds < 26.0f);
+	CHECK_NEAR(stats.AverageMilliseconds, stats.TargetMilliseconds, 0.1);
+	CHECK(stats.JitterMilliseconds < 0.1f);
+
+	// Once the work gets cheaper it eases back down to the target
+	unsigned int missed = stats.MissedDeadlines;
+	RunFrames(pacer, clock, 400, [](unsigned int) { return 0.005; });
+	stats = pacer.GetStats();
+	CHECK_NEAR(stats.TargetMilliseconds, 1000.0 / 60.0, 0.05);
+	CHECK(stats.MissedDeadlines == missed);
+}
+
+TEST_MAIN()
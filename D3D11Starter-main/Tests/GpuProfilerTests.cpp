@@ -0,0 +1,201 @@
+#include "TestHarness.h"
+
+#include "CpuTimestampSource.h"
+#include "GpuProfiler.h"
+
+#include <cstring>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// --------------------------------------------------------
+	// A CpuTimestampSource whose clock only moves when told to,
+	// in ticks of a millisecond
+	// --------------------------------------------------------
+	struct SteppedSource
+	{
+		uint64_t Now = 0;
+		CpuTimestampSource Source;
+
+		SteppedSource(unsigned int frameCount, unsigned int timestampsPerFrame, unsigned int latencyFrames) :
+			Source(frameCount, timestampsPerFrame, latencyFrames, [this]() { return Now; }, 1000)
+		{
+		}
+	};
+
+	// A frame with one scope, "Work", lasting the given time
+	void WorkFrame(GpuProfiler& profiler, SteppedSource& source, uint64_t milliseconds)
+	{
+		profiler.BeginFrame();
+		profiler.BeginScope("Work");
+		source.Now += milliseconds;
+		profiler.EndScope();
+		profiler.EndFrame();
+	}
+
+	bool IsResult(const GpuProfileResult& result, const char* name, unsigned int depth, float milliseconds)
+	{
+		return std::strcmp(result.Name, name) == 0 && result.Depth == depth && result.Milliseconds == milliseconds;
+	}
+}
+
+TEST_CASE("Nested scopes come back with their depths and times")
+{
+	SteppedSource source(4, 64, 1);
+	GpuProfiler profiler(source.Source);
+
+	profiler.BeginFrame();
+	source.Now += 10;
+	{
+		GpuProfileScope outer(profiler, "Outer");
+		source.Now += 2;
+		{
+			GpuProfileScope inner(profiler, "Inner");
+			source.Now += 3;
+		}
+		source.Now += 5;
+	}
+	profiler.BeginScope("Sibling");
+	profiler.BeginScope("Unclosed");
+	source.Now += 4;
+	profiler.EndScope();
+	source.Now += 6;
+	profiler.EndFrame();	// Ends "Sibling" too
+
+	// Nothing's back until the source's latency has passed
+	profiler.BeginFrame();
+	profiler.EndFrame();
+	CHECK(profiler.GetResults().empty());
+	CHECK(profiler.GetStats().FramesResolved == 0);
+
+	profiler.BeginFrame();
+	const std::vector<GpuProfileResult>& results = profiler.GetResults();
+	CHECK(results.size() == 4);
+	if (results.size() == 4)
+	{
+		CHECK(IsResult(results[0], "Outer", 0, 10));
+		CHECK(IsResult(results[1], "Inner", 1, 3));
+		CHECK(IsResult(results[2], "Sibling", 0, 10));
+		CHECK(IsResult(results[3], "Unclosed", 1, 4));
+		CHECK(results[1].AverageMilliseconds == 3);
+	}
+	CHECK(profiler.GetFrameMilliseconds() == 30);
+	CHECK(profiler.GetStats().FramesResolved == 1);
+}
+
+TEST_CASE("Results are from the newest frame the source has finished")
+{
+	SteppedSource source(4, 64, 2);
+	GpuProfiler profiler(source.Source);
+	for (uint64_t milliseconds = 1; milliseconds <= 5; milliseconds++)
+		WorkFrame(profiler, source, milliseconds);
+
+	// Five frames ended, two still in flight, so the third is the newest
+	profiler.BeginFrame();
+	CHECK(profiler.GetStats().FramesResolved == 3);
+	CHECK(profiler.GetResults().size() == 1);
+	if (profiler.GetResults().size() == 1)
+	{
+		CHECK(IsResult(profiler.GetResults()[0], "Work", 0, 3));
+
+		// Each frame moves the average a tenth of the way: 1, 1.1, 1.29
+		CHECK_NEAR(profiler.GetResults()[0].AverageMilliseconds, 1.29, 1e-5);
+	}
+	CHECK(profiler.GetFrameMilliseconds() == 3);
+	CHECK_NEAR(profiler.GetAverageFrameMilliseconds(), 1.29, 1e-5);
+	CHECK(profiler.GetStats().FramesDropped == 0);
+}
+
+TEST_CASE("Frames still in flight when their slot comes round are dropped")
+{
+	// More latency than slots, so no frame is ever ready in time
+	SteppedSource slow(2, 64, 3);
+	GpuProfiler dropping(slow.Source);
+	for (int i = 0; i < 6; i++)
+		WorkFrame(dropping, slow, 1);
+	dropping.BeginFrame();
+	CHECK(dropping.GetStats().FramesDropped == 5);
+	CHECK(dropping.GetStats().FramesResolved == 0);
+	CHECK(dropping.GetResults().empty());
+
+	// Enough slots to cover the latency, and nothing is lost
+	SteppedSource fast(4, 64, 3);
+	GpuProfiler keeping(fast.Source);
+	for (int i = 0; i < 6; i++)
+		WorkFrame(keeping, fast, 1);
+	keeping.BeginFrame();
+	CHECK(keeping.GetStats().FramesDropped == 0);
+	CHECK(keeping.GetStats().FramesResolved == 3);
+}
+
+TEST_CASE("Disjoint frames are counted and their times ignored")
+{
+	SteppedSource source(4, 64, 0);
+	GpuProfiler profiler(source.Source);
+
+	WorkFrame(profiler, source, 2);
+	profiler.BeginFrame();
+	profiler.BeginScope("Work");
+	source.Now += 50;
+	profiler.EndScope();
+	source.Source.SetNextFrameDisjoint();
+	profiler.EndFrame();
+
+	// Read back, but the results are still the first frame's
+	profiler.BeginFrame();
+	CHECK(profiler.GetStats().FramesDisjoint == 1);
+	CHECK(profiler.GetStats().FramesResolved == 1);
+	CHECK(profiler.GetResults().size() == 1 && profiler.GetResults()[0].Milliseconds == 2);
+	CHECK(profiler.GetAverageFrameMilliseconds() == 2);
+
+	// Only the one frame was marked
+	profiler.BeginScope("Work");
+	source.Now += 4;
+	profiler.EndScope();
+	profiler.EndFrame();
+	profiler.BeginFrame();
+	CHECK(profiler.GetStats().FramesDisjoint == 1);
+	CHECK(profiler.GetStats().FramesResolved == 2);
+	CHECK(profiler.GetResults().size() == 1 && profiler.GetResults()[0].Milliseconds == 4);
+}
+
+TEST_CASE("Scopes beyond the frame's timestamps are dropped but keep their place")
+{
+	// The frame's own two, and room for two scopes
+	SteppedSource source(4, 6, 0);
+	GpuProfiler profiler(source.Source);
+
+	profiler.BeginFrame();
+	profiler.BeginScope("A");
+	profiler.BeginScope("B");
+	profiler.BeginScope("C");
+	source.Now += 1;
+	profiler.EndScope();
+	profiler.EndScope();
+	profiler.EndScope();
+	profiler.BeginScope("D");
+	profiler.EndScope();
+	profiler.EndFrame();
+	CHECK(profiler.GetStats().ScopesDropped == 2);
+
+	profiler.BeginFrame();
+	const std::vector<GpuProfileResult>& results = profiler.GetResults();
+	CHECK(results.size() == 4);
+	if (results.size() == 4)
+	{
+		CHECK(IsResult(results[0], "A", 0, 1));
+		CHECK(IsResult(results[1], "B", 1, 1));
+		CHECK(IsResult(results[2], "C", 2, 0));
+		CHECK(IsResult(results[3], "D", 0, 0));
+	}
+
+	// Scopes outside a frame, and unmatched ends, are ignored
+	profiler.EndFrame();
+	profiler.BeginScope("Outside");
+	profiler.EndScope();
+	profiler.EndScope();
+	CHECK(profiler.GetStats().ScopesDropped == 2);
+}
+
+TEST_MAIN()
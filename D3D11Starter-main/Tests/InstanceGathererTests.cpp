@@ -0,0 +1,116 @@
+#include "TestHarness.h"
+
+#include "InstanceGatherer.h"
+
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// An instance at (x, y, z), tinted with its tag in red so
+	// the packed order can be read back
+	InstanceData At(float x, float y, float z, float tag)
+	{
+		InstanceData instance = {};
+		XMStoreFloat4x4(&instance.World, XMMatrixTranslation(x, y, z));
+		instance.Tint = XMFLOAT4(tag, 0, 0, 1);
+		return instance;
+	}
+
+	// Looking down +z from the origin, seeing out to 100 units
+	XMFLOAT4X4 ViewProjection()
+	{
+		XMMATRIX view = XMMatrixLookToLH(XMVectorZero(), XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 1, 0, 0));
+		XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.1f, 100.0f);
+		XMFLOAT4X4 viewProjection;
+		XMStoreFloat4x4(&viewProjection, view * projection);
+		return viewProjection;
+	}
+}
+
+TEST_CASE("Instances are grouped by mesh in submission order")
+{
+	InstanceGatherer gatherer;
+	gatherer.BeginWithoutCulling();
+	gatherer.Add(7, At(0, 0, 0, 0));
+	gatherer.Add(2, At(0, 0, 0, 1));
+	gatherer.Add(7, At(0, 0, 0, 2));
+	gatherer.Add(5, At(0, 0, 0, 3));
+	gatherer.Add(2, At(0, 0, 0, 4));
+	gatherer.Add(7, At(0, 0, 0, 5));
+	gatherer.Finish();
+
+	const std::vector<InstanceGroup>& groups = gatherer.GetGroups();
+	const std::vector<InstanceData>& instances = gatherer.GetInstances();
+	CHECK(instances.size() == 6);
+	CHECK(groups.size() == 3);
+
+	// One contiguous run per mesh, each starting where the last ended
+	CHECK(groups[0].MeshID == 2 && groups[0].FirstInstance == 0 && groups[0].InstanceCount == 2);
+	CHECK(groups[1].MeshID == 5 && groups[1].FirstInstance == 2 && groups[1].InstanceCount == 1);
+	CHECK(groups[2].MeshID == 7 && groups[2].FirstInstance == 3 && groups[2].InstanceCount == 3);
+
+	// Stable within each group
+	float expected[] = { 1, 4, 3, 0, 2, 5 };
+	for (int i = 0; i < 6; i++)
+		CHECK(instances[i].Tint.x == expected[i]);
+}
+
+TEST_CASE("Culled instances are dropped and counted")
+{
+	BoundingSphere unitSphere(XMFLOAT3(0, 0, 0), 1.0f);
+
+	InstanceGatherer gatherer;
+	gatherer.Begin(ViewProjection());
+	CHECK(gatherer.Add(1, At(0, 0, 10, 0), unitSphere));
+	CHECK(!gatherer.Add(1, At(0, 0, -10, 1), unitSphere));		// Behind
+	CHECK(!gatherer.Add(2, At(0, 0, 200, 2), unitSphere));		// Past the far plane
+	CHECK(gatherer.Add(2, At(10.5f, 0, 10, 3), unitSphere));	// Straddles the right plane
+	CHECK(!gatherer.Add(3, At(50, 0, 10, 4), unitSphere));		// Off to the side
+	gatherer.Finish();
+
+	CHECK(gatherer.GetCulledCount() == 3);
+	CHECK(gatherer.GetInstances().size() == 2);
+
+	// Mesh 3 lost its only instance, so it has no group at all
+	const std::vector<InstanceGroup>& groups = gatherer.GetGroups();
+	CHECK(groups.size() == 2);
+	CHECK(groups[0].MeshID == 1 && groups[0].FirstInstance == 0 && groups[0].InstanceCount == 1);
+	CHECK(groups[1].MeshID == 2 && groups[1].FirstInstance == 1 && groups[1].InstanceCount == 1);
+	CHECK(gatherer.GetInstances()[1].Tint.x == 3);
+}
+
+TEST_CASE("Scale grows the bounds used for culling")
+{
+	BoundingSphere unitSphere(XMFLOAT3(0, 0, 0), 1.0f);
+
+	// Just behind the camera, but scaled up enough to reach in front
+	InstanceData big = At(0, 0, -2, 0);
+	XMStoreFloat4x4(&big.World, XMMatrixScaling(1, 5, 1) * XMMatrixTranslation(0, 0, -2));
+
+	InstanceGatherer gatherer;
+	gatherer.Begin(ViewProjection());
+	CHECK(!gatherer.Add(0, At(0, 0, -2, 0), unitSphere));
+	CHECK(gatherer.Add(0, big, unitSphere));
+}
+
+TEST_CASE("Begin starts a fresh frame")
+{
+	InstanceGatherer gatherer;
+	gatherer.Begin(ViewProjection());
+	gatherer.Add(0, At(0, 0, -10, 0), BoundingSphere(XMFLOAT3(0, 0, 0), 1.0f));
+	gatherer.Add(0, At(0, 0, 10, 0));
+	gatherer.Finish();
+	CHECK(gatherer.GetCulledCount() == 1);
+
+	gatherer.BeginWithoutCulling();
+	gatherer.Finish();
+	CHECK(gatherer.GetCulledCount() == 0);
+	CHECK(gatherer.GetInstances().empty());
+	CHECK(gatherer.GetGroups().empty());
+}
+
+TEST_MAIN()
@@ -0,0 +1,260 @@
+#include "TestHarness.h"
+
+#include "LightClusters.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	const unsigned int width = 1280;
+	const unsigned int height = 720;
+
+	// Looking down +z from the origin, so view space is world space
+	struct TestCamera
+	{
+		XMFLOAT4X4 View;
+		XMFLOAT4X4 Projection;
+
+		TestCamera()
+		{
+			XMStoreFloat4x4(&View, XMMatrixIdentity());
+			XMStoreFloat4x4(&Projection, XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)width / height, 0.1f, 100.0f));
+		}
+
+		// The point in the middle of a cluster, the way a pixel shader
+		// would find it (see ClusterConstants)
+		XMFLOAT3 ClusterCenter(LightClusters& clusters, unsigned int x, unsigned int y, unsigned int z)
+		{
+			ClusterConstants constants = clusters.GetConstants();
+			float depth = std::exp((z + 0.5f - constants.DepthBias) / constants.DepthScale);
+			float ndcX = -1.0f + 2.0f * (x + 0.5f) / LightClusters::ClustersX;
+			float ndcY = 1.0f - 2.0f * (y + 0.5f) / LightClusters::ClustersY;
+			return XMFLOAT3(ndcX * depth / Projection._11, ndcY * depth / Projection._22, depth);
+		}
+	};
+
+	unsigned int SliceOf(LightClusters& clusters, float depth)
+	{
+		ClusterConstants constants = clusters.GetConstants();
+		return (unsigned int)std::floor(std::log(depth) * constants.DepthScale + constants.DepthBias);
+	}
+
+	ClusterLight PointLight(XMFLOAT3 position, float range)
+	{
+		ClusterLight light = {};
+		light.Position = position;
+		light.Range = range;
+		light.Type = LightTypePoint;
+		return light;
+	}
+
+	ClusterLight SpotLight(XMFLOAT3 position, XMFLOAT3 direction, float range, float cosAngle)
+	{
+		ClusterLight light = PointLight(position, range);
+		light.Direction = direction;
+		light.SpotCosAngle = cosAngle;
+		light.Type = LightTypeSpot;
+		return light;
+	}
+
+	// Whether any cluster in a slice lists the light
+	bool SliceHasLight(LightClusters& clusters, unsigned int z, uint32_t light)
+	{
+		for (unsigned int y = 0; y < LightClusters::ClustersY; y++)
+		{
+			for (unsigned int x = 0; x < LightClusters::ClustersX; x++)
+			{
+				ClusterRange range = clusters.GetClusterRanges()[clusters.GetClusterIndex(x, y, z)];
+				for (uint32_t i = 0; i < range.LightCount; i++)
+				{
+					if (clusters.GetLightIndices()[range.FirstIndex + i] == light)
+						return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// Lights scattered through the view frustum, some of them spots
+	std::vector<ClusterLight> RandomLights(unsigned int count)
+	{
+		std::mt19937 random(5);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<ClusterLight> lights(count);
+		for (ClusterLight& light : lights)
+		{
+			float depth = 1.0f + unit(random) * 80.0f;
+			XMFLOAT3 position((unit(random) * 2 - 1) * depth, (unit(random) * 2 - 1) * depth * 0.6f, depth);
+			light = PointLight(position, 0.5f + unit(random) * 4.0f);
+			if (unit(random) < 0.25f)
+			{
+				XMFLOAT3 direction;
+				XMStoreFloat3(&direction, XMVector3Normalize(XMVectorSet(unit(random) - 0.5f, -1.0f, unit(random) - 0.5f, 0)));
+				light = SpotLight(position, direction, light.Range * 2, 0.5f + unit(random) * 0.5f);
+			}
+		}
+		return lights;
+	}
+}
+
+TEST_CASE("A small point light lands in the cluster around it")
+{
+	TestCamera camera;
+	LightClusters clusters;
+
+	// Builds once with no lights, just to get the grid's constants
+	clusters.Build({}, camera.View, camera.Projection, width, height);
+	ClusterConstants constants = clusters.GetConstants();
+	CHECK(constants.ClustersX == LightClusters::ClustersX && constants.ClustersZ == LightClusters::ClustersZ);
+	CHECK_NEAR(constants.TileScaleX * width, LightClusters::ClustersX, 1e-4);
+	CHECK(SliceOf(clusters, 0.1001f) == 0);
+	CHECK(SliceOf(clusters, 99.9f) == LightClusters::ClustersZ - 1);
+	CHECK(clusters.GetLightIndices().empty());
+
+	const unsigned int x = 3, y = 6, z = 10;
+	XMFLOAT3 center = camera.ClusterCenter(clusters, x, y, z);
+	ClusterLight lights[] = { PointLight(center, center.z * 0.001f) };
+	clusters.Build(lights, camera.View, camera.Projection, width, height);
+
+	unsigned int cluster = clusters.GetClusterIndex(x, y, z);
+	CHECK(clusters.GetClusterRanges()[cluster].LightCount == 1);
+	CHECK(clusters.GetLightIndices()[clusters.GetClusterRanges()[cluster].FirstIndex] == 0);
+	CHECK(clusters.GetMaxLightsPerCluster() == 1);
+
+	// Clusters are tested by their bounding boxes, which overlap their
+	// neighbours' - but never by more than a tile
+	for (unsigned int other = 0; other < LightClusters::ClusterCount; other++)
+	{
+		if (clusters.GetClusterRanges()[other].LightCount == 0)
+			continue;
+		unsigned int otherX = other % LightClusters::ClustersX;
+		unsigned int otherY = other / LightClusters::ClustersX % LightClusters::ClustersY;
+		unsigned int otherZ = other / (LightClusters::ClustersX * LightClusters::ClustersY);
+		CHECK(otherZ == z && otherY == y && otherX + 1 >= x && otherX <= x + 1);
+	}
+	CHECK(clusters.GetLightIndices().size() <= 3);
+}
+
+TEST_CASE("A spot light only reaches the clusters its cone can")
+{
+	TestCamera camera;
+	LightClusters clusters;
+
+	// Both at a depth of 20 with a range of 10, the spot pointing
+	// away from the camera in a 60 degree cone, so it can't light
+	// anything nearer than 20 - but its bounding sphere does
+	// reach a little nearer than that
+	ClusterLight lights[] = {
+		PointLight(XMFLOAT3(0, 0, 20), 10),
+		SpotLight(XMFLOAT3(0, 0, 20), XMFLOAT3(0, 0, 1), 10, 0.5f) };
+	clusters.Build(lights, camera.View, camera.Projection, width, height);
+
+	// Both light what's straight ahead of them
+	unsigned int ahead = clusters.GetClusterIndex(LightClusters::ClustersX / 2, LightClusters::ClustersY / 2, SliceOf(clusters, 25));
+	ClusterRange range = clusters.GetClusterRanges()[ahead];
+	CHECK(range.LightCount == 2);
+	CHECK(clusters.GetLightIndices()[range.FirstIndex] == 0);
+	CHECK(clusters.GetLightIndices()[range.FirstIndex + 1] == 1);
+
+	// Only the point light reaches back towards the camera...
+	CHECK(SliceHasLight(clusters, SliceOf(clusters, 12), 0));
+	CHECK(!SliceHasLight(clusters, SliceOf(clusters, 12), 1));
+
+	// ...or past either's range
+	CHECK(SliceHasLight(clusters, SliceOf(clusters, 29), 0));
+	CHECK(SliceHasLight(clusters, SliceOf(clusters, 33), 1));
+	CHECK(!SliceHasLight(clusters, SliceOf(clusters, 40), 0));
+	CHECK(!SliceHasLight(clusters, SliceOf(clusters, 50), 1));
+
+	// Neither reaches the screen's corners at the light's depth
+	unsigned int corner = clusters.GetClusterIndex(0, 0, SliceOf(clusters, 20));
+	CHECK(clusters.GetClusterRanges()[corner].LightCount == 0);
+}
+
+TEST_CASE("Lights outside the frustum are in no cluster")
+{
+	TestCamera camera;
+	LightClusters clusters;
+	ClusterLight lights[] = {
+		PointLight(XMFLOAT3(0, 0, -5), 2),		// Behind the camera
+		PointLight(XMFLOAT3(0, 0, 150), 20),	// Past the far plane
+		PointLight(XMFLOAT3(80, 0, 10), 5),		// Off to the side
+		SpotLight(XMFLOAT3(0, 0, -1), XMFLOAT3(0, 0, -1), 20, 0.9f) };	// Pointing away
+	clusters.Build(lights, camera.View, camera.Projection, width, height);
+	CHECK(clusters.GetLightIndices().empty());
+	CHECK(clusters.GetMaxLightsPerCluster() == 0);
+}
+
+TEST_CASE("Clusters' lists are packed end to end, lights ascending")
+{
+	TestCamera camera;
+	std::vector<ClusterLight> lights = RandomLights(1000);
+	LightClusters clusters;
+	clusters.Build(lights, camera.View, camera.Projection, width, height);
+
+	std::span<const ClusterRange> ranges = clusters.GetClusterRanges();
+	std::span<const uint32_t> indices = clusters.GetLightIndices();
+	CHECK(ranges.size() == LightClusters::ClusterCount);
+	CHECK(!indices.empty());
+
+	bool packed = true, ascending = true;
+	uint32_t next = 0, most = 0;
+	for (const ClusterRange& range : ranges)
+	{
+		packed = packed && range.FirstIndex == next;
+		for (uint32_t i = 1; i < range.LightCount; i++)
+			ascending = ascending && indices[range.FirstIndex + i - 1] < indices[range.FirstIndex + i];
+		next += range.LightCount;
+		most = std::max(most, range.LightCount);
+	}
+	CHECK(packed && ascending);
+	CHECK(next == indices.size());
+	CHECK(most == clusters.GetMaxLightsPerCluster());
+	for (uint32_t index : indices)
+		CHECK(index < lights.size());
+
+	// A smaller build afterwards leaves nothing of the bigger one
+	lights.resize(1);
+	lights[0] = PointLight(camera.ClusterCenter(clusters, 0, 0, 0), 0.0001f);
+	clusters.Build(lights, camera.View, camera.Projection, width, height);
+	CHECK(clusters.GetClusterRanges()[0].LightCount == 1);
+	CHECK(clusters.GetMaxLightsPerCluster() == 1);
+	CHECK(clusters.GetLightIndices().size() <= 4);	// The corner and its neighbours at most
+	CHECK(clusters.GetClusterRanges()[LightClusters::ClusterCount - 1].FirstIndex == clusters.GetLightIndices().size());
+}
+
+TEST_CASE("The worker pool builds the same clusters as one thread")
+{
+	TestCamera camera;
+	std::vector<ClusterLight> lights = RandomLights(1000);
+
+	// A camera somewhere else, so the view transform matters too
+	XMStoreFloat4x4(&camera.View, XMMatrixLookToLH(XMVectorSet(5, 3, -10, 1), XMVectorSet(-0.2f, -0.1f, 1, 0), XMVectorSet(0, 1, 0, 0)));
+
+	LightClusters serial;
+	serial.Build(lights, camera.View, camera.Projection, width, height);
+
+	WorkerPool pool(4);
+	LightClusters pooled(&pool);
+	pooled.Build(lights, camera.View, camera.Projection, width, height);
+
+	CHECK(pooled.GetLightIndices().size() == serial.GetLightIndices().size());
+	CHECK(std::equal(pooled.GetLightIndices().begin(), pooled.GetLightIndices().end(), serial.GetLightIndices().begin(), serial.GetLightIndices().end()));
+	bool same = true;
+	for (unsigned int i = 0; i < LightClusters::ClusterCount; i++)
+	{
+		same = same && pooled.GetClusterRanges()[i].FirstIndex == serial.GetClusterRanges()[i].FirstIndex &&
+			pooled.GetClusterRanges()[i].LightCount == serial.GetClusterRanges()[i].LightCount;
+	}
+	CHECK(same);
+}
+
+TEST_MAIN()
@@ -0,0 +1,132 @@
+#include "TestHarness.h"
+
+#include "MeshBounds.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// A lopsided cloud - dense on one side, so a plain average
+	// center would be well off
+	std::vector<Vertex> Cloud(int count, unsigned int seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::vector<Vertex> vertices(count);
+		for (int i = 0; i < count; i++)
+		{
+			float spread = (i % 5 == 0) ? 4.0f : 0.5f;
+			vertices[i].Position = XMFLOAT3(unit(random) * spread + 3.0f, unit(random) * spread, unit(random) * spread - 2.0f);
+			vertices[i].Color = XMFLOAT4(1, 1, 1, 1);
+		}
+		return vertices;
+	}
+
+	float DistanceTo(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		return XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&a), XMLoadFloat3(&b))));
+	}
+}
+
+TEST_CASE("Boxes match a brute-force min and max, for any count")
+{
+	// Counts either side of the four-wide loop's remainder
+	for (int count : { 1, 2, 3, 4, 5, 7, 8, 1001 })
+	{
+		std::vector<Vertex> vertices = Cloud(count, count);
+		XMFLOAT3 lo = vertices[0].Position, hi = vertices[0].Position;
+		for (const Vertex& v : vertices)
+		{
+			lo = XMFLOAT3(std::min(lo.x, v.Position.x), std::min(lo.y, v.Position.y), std::min(lo.z, v.Position.z));
+			hi = XMFLOAT3(std::max(hi.x, v.Position.x), std::max(hi.y, v.Position.y), std::max(hi.z, v.Position.z));
+		}
+
+		BoundingBox box = MeshBounds::ComputeBox(vertices.data(), count, sizeof(Vertex));
+		CHECK_NEAR(box.Center.x - box.Extents.x, lo.x, 1e-5);
+		CHECK_NEAR(box.Center.y - box.Extents.y, lo.y, 1e-5);
+		CHECK_NEAR(box.Center.z - box.Extents.z, lo.z, 1e-5);
+		CHECK_NEAR(box.Center.x + box.Extents.x, hi.x, 1e-5);
+		CHECK_NEAR(box.Center.y + box.Extents.y, hi.y, 1e-5);
+		CHECK_NEAR(box.Center.z + box.Extents.z, hi.z, 1e-5);
+	}
+}
+
+TEST_CASE("Spheres hold every point and stay close to the smallest")
+{
+	std::vector<Vertex> vertices = Cloud(5000, 42);
+	BoundingSphere sphere = MeshBounds::ComputeSphere(vertices.data(), (int)vertices.size(), sizeof(Vertex));
+
+	float farthest = 0.0f;
+	for (const Vertex& v : vertices)
+		farthest = std::max(farthest, DistanceTo(v.Position, sphere.Center));
+	CHECK(farthest <= sphere.Radius * 1.0001f);
+
+	// The cloud's outer cube is 8 wide, so the optimal sphere's radius is
+	// at least half its diagonal minus what random sampling left empty
+	float cubeHalfDiagonal = 4.0f * sqrtf(3.0f);
+	CHECK(sphere.Radius <= cubeHalfDiagonal * 1.05f);
+
+	// Points on a known sphere come back as (nearly) that sphere
+	std::vector<Vertex> shell(2000);
+	for (size_t i = 0; i < shell.size(); i++)
+	{
+		float z = 1.0f - 2.0f * (i + 0.5f) / shell.size();
+		float r = sqrtf(1.0f - z * z);
+		float angle = i * 2.39996323f;
+		shell[i].Position = XMFLOAT3(cosf(angle) * r * 2.0f + 1.0f, sinf(angle) * r * 2.0f, z * 2.0f - 5.0f);
+	}
+	BoundingSphere fitted = MeshBounds::ComputeSphere(shell.data(), (int)shell.size(), sizeof(Vertex));
+	CHECK(fitted.Radius >= 2.0f * 0.999f && fitted.Radius <= 2.0f * 1.03f);
+	CHECK(DistanceTo(fitted.Center, XMFLOAT3(1.0f, 0.0f, -5.0f)) <= 0.06f);
+}
+
+TEST_CASE("Positions are read through the stride")
+{
+	// The same points, packed tightly and spread through lit vertices
+	std::vector<Vertex> vertices = Cloud(37, 3);
+	std::vector<XMFLOAT3> positions;
+	std::vector<LitVertex> lit(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		positions.push_back(vertices[i].Position);
+		lit[i].Position = vertices[i].Position;
+		lit[i].Normal = XMFLOAT3(1e6f, 1e6f, 1e6f);
+	}
+
+	BoundingBox tight = MeshBounds::ComputeBox(positions.data(), (int)positions.size(), sizeof(XMFLOAT3));
+	BoundingBox strided = MeshBounds::ComputeBox(lit.data(), (int)lit.size(), sizeof(LitVertex));
+	CHECK(tight.Center.x == strided.Center.x && tight.Extents.x == strided.Extents.x);
+	CHECK(tight.Center.z == strided.Center.z && tight.Extents.z == strided.Extents.z);
+
+	BoundingSphere sphere = MeshBounds::ComputeSphere(lit.data(), (int)lit.size(), sizeof(LitVertex));
+	CHECK(sphere.Radius < 100.0f);
+}
+
+TEST_CASE("Frustum planes keep what's in view and cull what isn't")
+{
+	// Camera at the origin looking down +z, 90 degrees wide
+	XMFLOAT4X4 viewProjection;
+	XMStoreFloat4x4(&viewProjection, XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.1f, 100.0f));
+	XMFLOAT4 planes[6];
+	MeshBounds::ExtractFrustumPlanes(viewProjection, planes);
+
+	// Normalized, so distances are in world units
+	for (const XMFLOAT4& plane : planes)
+		CHECK_NEAR(sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z), 1.0, 1e-5);
+
+	CHECK(MeshBounds::SphereInFrustum(planes, XMFLOAT3(0, 0, 10), 1.0f));
+	CHECK(!MeshBounds::SphereInFrustum(planes, XMFLOAT3(0, 0, -10), 1.0f));		// Behind
+	CHECK(!MeshBounds::SphereInFrustum(planes, XMFLOAT3(0, 0, 200), 1.0f));		// Past far
+	CHECK(!MeshBounds::SphereInFrustum(planes, XMFLOAT3(20, 0, 10), 1.0f));		// Off to the right
+	CHECK(MeshBounds::SphereInFrustum(planes, XMFLOAT3(10.5f, 0, 10), 1.0f));	// Straddling the edge
+	CHECK(!MeshBounds::SphereInFrustum(planes, XMFLOAT3(0, -12, 10), 1.0f));	// Below
+}
+
+TEST_MAIN()
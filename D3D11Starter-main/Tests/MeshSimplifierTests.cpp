@@ -0,0 +1,262 @@
+#include "TestHarness.h"
+
+#include "MeshSimplifier.h"
+#include "PrimitiveGenerators.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	struct TestMesh
+	{
+		std::vector<Vertex> Vertices;
+		std::vector<unsigned int> Indices;
+	};
+
+	// --------------------------------------------------------
+	// The generators duplicate seam and pole vertices (they
+	// differ in UV), so merge them and drop the triangles that
+	// leaves degenerate, for a closed mesh
+	// --------------------------------------------------------
+	TestMesh Closed(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+	{
+		TestMesh mesh;
+		std::map<std::tuple<long, long, long>, unsigned int> merged;
+		std::vector<unsigned int> remap(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const XMFLOAT3& p = vertices[i].Position;
+			std::tuple<long, long, long> key(lroundf(p.x * 1e5f), lroundf(p.y * 1e5f), lroundf(p.z * 1e5f));
+			auto found = merged.find(key);
+			if (found == merged.end())
+			{
+				found = merged.emplace(key, (unsigned int)mesh.Vertices.size()).first;
+				mesh.Vertices.push_back(vertices[i]);
+			}
+			remap[i] = found->second;
+		}
+
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			unsigned int a = remap[indices[t]], b = remap[indices[t + 1]], c = remap[indices[t + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			mesh.Indices.insert(mesh.Indices.end(), { a, b, c });
+		}
+		return mesh;
+	}
+
+	TestMesh ClosedSphere(float radius, unsigned int segments, unsigned int rings)
+	{
+		PrimitiveSize size = PrimitiveGenerators::SphereSize(segments, rings);
+		std::vector<Vertex> vertices(size.VertexCount);
+		std::vector<unsigned int> indices(size.IndexCount);
+		PrimitiveGenerators::Sphere(vertices, indices, radius, segments, rings);
+		return Closed(vertices, indices);
+	}
+
+	TestMesh ClosedTorus(float majorRadius, float minorRadius, unsigned int majorSegments, unsigned int minorSegments)
+	{
+		PrimitiveSize size = PrimitiveGenerators::TorusSize(majorSegments, minorSegments);
+		std::vector<Vertex> vertices(size.VertexCount);
+		std::vector<unsigned int> indices(size.IndexCount);
+		PrimitiveGenerators::Torus(vertices, indices, majorRadius, minorRadius, majorSegments, minorSegments);
+		return Closed(vertices, indices);
+	}
+
+	// Every edge of a closed, consistently wound manifold is
+	// used once in each direction
+	bool IsClosedManifold(const std::vector<unsigned int>& indices)
+	{
+		std::map<std::pair<unsigned int, unsigned int>, int> directedEdges;
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int a = indices[t + k];
+				unsigned int b = indices[t + (k + 1) % 3];
+				if (a == b || ++directedEdges[{ a, b }] > 1)
+					return false;
+			}
+		}
+
+		for (const auto& edge : directedEdges)
+		{
+			if (directedEdges.find({ edge.first.second, edge.first.first }) == directedEdges.end())
+				return false;
+		}
+		return true;
+	}
+
+	XMVECTOR FaceNormal(const std::vector<Vertex>& vertices, const unsigned int* tri)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&vertices[tri[0]].Position);
+		XMVECTOR p1 = XMLoadFloat3(&vertices[tri[1]].Position);
+		XMVECTOR p2 = XMLoadFloat3(&vertices[tri[2]].Position);
+		return XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+	}
+
+	// Distance from p to triangle abc
+	float PointTriangleDistance(XMVECTOR p, XMVECTOR a, XMVECTOR b, XMVECTOR c)
+	{
+		XMVECTOR n = XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+		float nLengthSq = XMVectorGetX(XMVector3LengthSq(n));
+
+		// Inside the prism over the triangle? Then it's the plane distance
+		if (nLengthSq > 0.0f)
+		{
+			bool inside = true;
+			XMVECTOR corners[3] = { a, b, c };
+			for (int k = 0; k < 3; k++)
+			{
+				XMVECTOR edge = XMVectorSubtract(corners[(k + 1) % 3], corners[k]);
+				XMVECTOR toPoint = XMVectorSubtract(p, corners[k]);
+				if (XMVectorGetX(XMVector3Dot(XMVector3Cross(edge, toPoint), n)) < 0.0f)
+					inside = false;
+			}
+			if (inside)
+				return fabsf(XMVectorGetX(XMVector3Dot(XMVectorSubtract(p, a), n))) / sqrtf(nLengthSq);
+		}
+
+		// Otherwise the closest edge
+		float best = 1e30f;
+		XMVECTOR corners[3] = { a, b, c };
+		for (int k = 0; k < 3; k++)
+		{
+			XMVECTOR start = corners[k];
+			XMVECTOR edge = XMVectorSubtract(corners[(k + 1) % 3], start);
+			float edgeLengthSq = XMVectorGetX(XMVector3LengthSq(edge));
+			float t = edgeLengthSq > 0.0f ? XMVectorGetX(XMVector3Dot(XMVectorSubtract(p, start), edge)) / edgeLengthSq : 0.0f;
+			t = std::clamp(t, 0.0f, 1.0f);
+			XMVECTOR closest = XMVectorAdd(start, XMVectorScale(edge, t));
+			best = std::min(best, XMVectorGetX(XMVector3Length(XMVectorSubtract(p, closest))));
+		}
+		return best;
+	}
+
+	// Largest distance from an original vertex to the simplified surface
+	float MeasuredDeviation(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& simplified)
+	{
+		float worst = 0.0f;
+		for (const Vertex& v : vertices)
+		{
+			XMVECTOR p = XMLoadFloat3(&v.Position);
+			float nearest = 1e30f;
+			for (size_t t = 0; t + 2 < simplified.size(); t += 3)
+			{
+				nearest = std::min(nearest, PointTriangleDistance(p,
+					XMLoadFloat3(&vertices[simplified[t]].Position),
+					XMLoadFloat3(&vertices[simplified[t + 1]].Position),
+					XMLoadFloat3(&vertices[simplified[t + 2]].Position)));
+			}
+			worst = std::max(worst, nearest);
+		}
+		return worst;
+	}
+}
+
+TEST_CASE("Colors change the order of collapses but never the error")
+{
+	// A flat grid with a different color at every vertex
+	PrimitiveSize size = PrimitiveGenerators::PlaneSize(16, 16);
+	std::vector<Vertex> vertices(size.VertexCount);
+	std::vector<unsigned int> indices(size.IndexCount);
+	PrimitiveGenerators::Plane(vertices, indices, 2.0f, 2.0f, 16, 16);
+	for (size_t i = 0; i < vertices.size(); i++)
+		vertices[i].Color = XMFLOAT4((i * 37 % 101) / 100.0f, (i * 53 % 89) / 88.0f, (i % 7) / 6.0f, 1.0f);
+
+	SimplifyOptions options;
+	options.TargetTriangleCount = (unsigned int)indices.size() / 3 / 4;
+	options.AttributeWeight = 100.0f;
+	MeshLOD lod = MeshSimplifier::Simplify(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size(), options);
+
+	CHECK(lod.Indices.size() / 3 <= options.TargetTriangleCount);
+	CHECK(lod.Error < 1e-5f);
+}
+
+TEST_CASE("Simplified closed meshes stay closed and manifold")
+{
+	// The torus's hole is what an unchecked collapse pinches shut
+	TestMesh meshes[] = { ClosedSphere(1.0f, 48, 24), ClosedTorus(1.0f, 0.3f, 24, 8), ClosedTorus(1.0f, 0.6f, 6, 4) };
+	for (const TestMesh& mesh : meshes)
+	{
+		CHECK(IsClosedManifold(mesh.Indices));
+		for (unsigned int target : { 400u, 100u, 30u, 8u, 0u })
+		{
+			SimplifyOptions options;
+			options.TargetTriangleCount = target;
+			MeshLOD lod = MeshSimplifier::Simplify(mesh.Vertices.data(), (int)mesh.Vertices.size(), mesh.Indices.data(), (int)mesh.Indices.size(), options);
+			CHECK(!lod.Indices.empty());
+			CHECK(IsClosedManifold(lod.Indices));
+		}
+	}
+}
+
+TEST_CASE("No face is turned over")
+{
+	// Every face of a convex mesh around the origin faces away from it
+	TestMesh sphere = ClosedSphere(1.0f, 48, 24);
+	SimplifyOptions options;
+	options.TargetTriangleCount = 60;
+	MeshLOD lod = MeshSimplifier::Simplify(sphere.Vertices.data(), (int)sphere.Vertices.size(), sphere.Indices.data(), (int)sphere.Indices.size(), options);
+
+	for (size_t t = 0; t + 2 < lod.Indices.size(); t += 3)
+	{
+		XMVECTOR normal = FaceNormal(sphere.Vertices, &lod.Indices[t]);
+		XMVECTOR center = XMLoadFloat3(&sphere.Vertices[lod.Indices[t]].Position);
+		CHECK(XMVectorGetX(XMVector3Dot(normal, center)) > 0.0f);
+	}
+}
+
+TEST_CASE("Reported error is a distance, and keeps to TargetError")
+{
+	TestMesh sphere = ClosedSphere(2.0f, 64, 32);
+
+	for (float targetError : { 0.002f, 0.01f, 0.05f })
+	{
+		SimplifyOptions options;
+		options.TargetError = targetError;
+		MeshLOD lod = MeshSimplifier::Simplify(sphere.Vertices.data(), (int)sphere.Vertices.size(), sphere.Indices.data(), (int)sphere.Indices.size(), options);
+		float measured = MeasuredDeviation(sphere.Vertices, lod.Indices);
+		std::printf("  target %.3f: %u triangles, error %.4f, measured %.4f\n",
+			targetError, (unsigned int)lod.Indices.size() / 3, lod.Error, measured);
+
+		CHECK(lod.Error <= targetError);
+		CHECK(lod.Indices.size() < sphere.Indices.size());
+
+		// The error is an average over the surface each collapse replaced,
+		// so the worst vertex can sit a little further out - but the same scale
+		CHECK(measured <= targetError * 4.0f);
+	}
+}
+
+TEST_CASE("LOD chains shrink and their errors only grow")
+{
+	TestMesh sphere = ClosedSphere(1.0f, 64, 32);
+	std::vector<MeshLOD> lods = MeshSimplifier::BuildLODChain(sphere.Vertices.data(), (int)sphere.Vertices.size(), sphere.Indices.data(), (int)sphere.Indices.size(), 5, 0.5f);
+
+	CHECK(lods.size() == 5);
+	CHECK(lods[0].Indices == sphere.Indices);
+	CHECK(lods[0].Error == 0.0f);
+	for (size_t i = 1; i < lods.size(); i++)
+	{
+		CHECK(lods[i].Indices.size() < lods[i - 1].Indices.size());
+		CHECK(lods[i].Error >= lods[i - 1].Error);
+		CHECK(IsClosedManifold(lods[i].Indices));
+	}
+
+	// Far away, the coarsest level is good enough; up close, only the original
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PIDIV4, 1.0f, 0.1f, 100.0f));
+	CHECK(MeshSimplifier::SelectLOD(lods, 1000.0f, projection, 1080.0f) == (int)lods.size() - 1);
+	CHECK(MeshSimplifier::SelectLOD(lods, 0.5f, projection, 1080.0f) == 0);
+}
+
+TEST_MAIN()
@@ -0,0 +1,170 @@
+#include "TestHarness.h"
+
+#include "MeshTangents.h"
+#include "PrimitiveGenerators.h"
+#include "WorkerPool.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	LitVertex At(float x, float y, float z, float u, float v)
+	{
+		LitVertex vertex = {};
+		vertex.Position = XMFLOAT3(x, y, z);
+		vertex.UV = XMFLOAT2(u, v);
+		return vertex;
+	}
+
+	void Generate(std::vector<LitVertex>& vertices, const std::vector<unsigned int>& indices, WorkerPool* pool = nullptr)
+	{
+		MeshTangents::GenerateNormals(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size(), pool);
+		MeshTangents::GenerateTangents(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size(), pool);
+	}
+
+	bool Near(const XMFLOAT3& a, const XMFLOAT3& b, float epsilon = 1e-5f)
+	{
+		return std::abs(a.x - b.x) < epsilon && std::abs(a.y - b.y) < epsilon && std::abs(a.z - b.z) < epsilon;
+	}
+
+	bool Near(const XMFLOAT4& a, const XMFLOAT4& b, float epsilon = 1e-5f)
+	{
+		return Near(XMFLOAT3(a.x, a.y, a.z), XMFLOAT3(b.x, b.y, b.z), epsilon) && a.w == b.w;
+	}
+
+	// A quad in the xy plane facing -z (clockwise from the front),
+	// with u to the right and v down, at x = left
+	void AppendQuad(std::vector<LitVertex>& vertices, std::vector<unsigned int>& indices, float left, float uLeft, float uRight)
+	{
+		unsigned int base = (unsigned int)vertices.size();
+		vertices.push_back(At(left, 0, 0, uLeft, 1));
+		vertices.push_back(At(left, 1, 0, uLeft, 0));
+		vertices.push_back(At(left + 1, 1, 0, uRight, 0));
+		vertices.push_back(At(left + 1, 0, 0, uRight, 1));
+		for (unsigned int i : { 0, 1, 2, 0, 2, 3 })
+			indices.push_back(base + i);
+	}
+}
+
+TEST_CASE("A quad gets the face's normal and UV-aligned tangent")
+{
+	std::vector<LitVertex> vertices;
+	std::vector<unsigned int> indices;
+	AppendQuad(vertices, indices, 0, 0, 1);
+	Generate(vertices, indices);
+
+	// Tangent along +u; bitangent = cross(N, T) * w = -y, which is +v
+	for (const LitVertex& v : vertices)
+	{
+		CHECK(Near(v.Normal, XMFLOAT3(0, 0, -1)));
+		CHECK(Near(v.Tangent, XMFLOAT4(1, 0, 0, 1)));
+	}
+}
+
+TEST_CASE("Mirrored UVs across a split seam flip the tangent and its sign")
+{
+	// The right quad's u runs back towards the seam, as on a model
+	// whose two halves share one side of a texture
+	std::vector<LitVertex> vertices;
+	std::vector<unsigned int> indices;
+	AppendQuad(vertices, indices, -1, 0, 1);
+	AppendQuad(vertices, indices, 0, 1, 0);
+	Generate(vertices, indices);
+
+	for (int i = 0; i < 4; i++)
+		CHECK(Near(vertices[i].Tangent, XMFLOAT4(1, 0, 0, 1)));
+	for (int i = 4; i < 8; i++)
+		CHECK(Near(vertices[i].Tangent, XMFLOAT4(-1, 0, 0, -1)));
+
+	// Both halves still agree on the bitangent
+	for (const LitVertex& v : vertices)
+	{
+		XMVECTOR bitangent = XMVectorScale(XMVector3Cross(XMLoadFloat3(&v.Normal), XMLoadFloat4(&v.Tangent)), v.Tangent.w);
+		CHECK_NEAR(XMVectorGetY(bitangent), -1.0, 1e-5);
+	}
+}
+
+TEST_CASE("A cube's generated frames match its faces")
+{
+	PrimitiveSize size = PrimitiveGenerators::CubeSize(2);
+	std::vector<LitVertex> expected(size.VertexCount);
+	std::vector<unsigned int> indices(size.IndexCount);
+	PrimitiveGenerators::Cube(expected, indices, 2.0f, 2);
+
+	// Faces don't share vertices, so each face is flat
+	std::vector<LitVertex> vertices = expected;
+	for (LitVertex& v : vertices)
+	{
+		v.Normal = XMFLOAT3(0, 0, 0);
+		v.Tangent = XMFLOAT4(0, 0, 0, 0);
+	}
+	Generate(vertices, indices);
+
+	bool matches = true;
+	for (unsigned int i = 0; i < size.VertexCount; i++)
+		matches = matches && Near(vertices[i].Normal, expected[i].Normal) && Near(vertices[i].Tangent, expected[i].Tangent);
+	CHECK(matches);
+}
+
+TEST_CASE("Normals are weighted by corner angle, not triangle count")
+{
+	// The corner of a cube at the origin, seen from outside: the z = 0
+	// face is split through the corner, the other two are not, so the
+	// corner has two triangles from one face and one from each other
+	enum { O, X, Y, Z, XY, YZ, XZ };
+	std::vector<LitVertex> vertices = {
+		At(0, 0, 0, 0, 0), At(1, 0, 0, 0, 0), At(0, 1, 0, 0, 0), At(0, 0, 1, 0, 0),
+		At(1, 1, 0, 0, 0), At(0, 1, 1, 0, 0), At(1, 0, 1, 0, 0) };
+	std::vector<unsigned int> indices = {
+		O, Y, XY,	O, XY, X,	// z = 0
+		O, Z, Y,	Z, YZ, Y,	// x = 0
+		O, X, Z,	X, XZ, Z,	// y = 0
+	};
+	MeshTangents::GenerateNormals(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size());
+
+	// 90 degrees of each face meets at the corner, and at X
+	float third = 1.0f / std::sqrt(3.0f);
+	float half = 1.0f / std::sqrt(2.0f);
+	CHECK(Near(vertices[O].Normal, XMFLOAT3(-third, -third, -third)));
+	CHECK(Near(vertices[X].Normal, XMFLOAT3(0, -half, -half)));
+	CHECK(Near(vertices[XY].Normal, XMFLOAT3(0, 0, -1)));
+}
+
+TEST_CASE("Worker pool results match one thread exactly")
+{
+	// Big enough to be split into several chunks
+	PrimitiveSize size = PrimitiveGenerators::SphereSize(256, 192);
+	std::vector<LitVertex> serial(size.VertexCount);
+	std::vector<unsigned int> indices(size.IndexCount);
+	PrimitiveGenerators::Sphere(serial, indices, 1.0f, 256, 192);
+	std::vector<LitVertex> pooled = serial;
+
+	Generate(serial, indices);
+	for (unsigned int threads : { 2u, 3u, 4u })
+	{
+		WorkerPool pool(threads);
+		std::vector<LitVertex> result = pooled;
+		Generate(result, indices, &pool);
+		CHECK(std::memcmp(result.data(), serial.data(), serial.size() * sizeof(LitVertex)) == 0);
+	}
+}
+
+TEST_CASE("Expand copies positions and colors only")
+{
+	Vertex source[] = { { XMFLOAT3(1, 2, 3), XMFLOAT4(0.5f, 0.25f, 1, 1) } };
+	LitVertex expanded;
+	std::memset(&expanded, 0x7f, sizeof(expanded));
+	MeshTangents::Expand(source, 1, &expanded);
+
+	CHECK(Near(expanded.Position, source[0].Position));
+	CHECK(expanded.Color.x == 0.5f && expanded.Color.y == 0.25f);
+	CHECK(expanded.Normal.x == 0 && expanded.Tangent.w == 0 && expanded.UV.y == 0);
+}
+
+TEST_MAIN()
@@ -0,0 +1,188 @@
+#include "TestHarness.h"
+
+#include "Meshlet.h"
+#include "PrimitiveGenerators.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	struct TestMesh
+	{
+		std::vector<Vertex> Vertices;
+		std::vector<unsigned int> Indices;
+	};
+
+	TestMesh Sphere(unsigned int segments, unsigned int rings)
+	{
+		PrimitiveSize size = PrimitiveGenerators::SphereSize(segments, rings);
+		TestMesh mesh;
+		mesh.Vertices.resize(size.VertexCount);
+		mesh.Indices.resize(size.IndexCount);
+		PrimitiveGenerators::Sphere(mesh.Vertices, mesh.Indices, 1.0f, segments, rings);
+		return mesh;
+	}
+
+	// The same sphere seen from the inside: every triangle wound the other way
+	TestMesh InsideOut(TestMesh mesh)
+	{
+		for (size_t t = 0; t + 2 < mesh.Indices.size(); t += 3)
+			std::swap(mesh.Indices[t + 1], mesh.Indices[t + 2]);
+		return mesh;
+	}
+
+	XMFLOAT4X4 ViewProjection(XMFLOAT3 eye, XMFLOAT3 direction)
+	{
+		XMMATRIX view = XMMatrixLookToLH(XMLoadFloat3(&eye), XMLoadFloat3(&direction), XMVectorSet(0, 1, 0, 0));
+		XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.01f, 100.0f);
+		XMFLOAT4X4 viewProjection;
+		XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, projection));
+		return viewProjection;
+	}
+
+	// A meshlet's triangles as indices into the mesh's vertices
+	void AppendTriangles(const MeshletData& data, const Meshlet& meshlet, std::vector<unsigned int>& indices)
+	{
+		for (unsigned int i = 0; i < meshlet.TriangleCount * 3; i++)
+			indices.push_back(data.Vertices[meshlet.VertexOffset + data.Triangles[meshlet.TriangleOffset + i]]);
+	}
+
+	// Is the triangle at indices[t] front facing from the eye?
+	bool FacesEye(const TestMesh& mesh, const unsigned int* triangle, XMFLOAT3 eye)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&mesh.Vertices[triangle[0]].Position);
+		XMVECTOR p1 = XMLoadFloat3(&mesh.Vertices[triangle[1]].Position);
+		XMVECTOR p2 = XMLoadFloat3(&mesh.Vertices[triangle[2]].Position);
+		XMVECTOR normal = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+		return XMVectorGetX(XMVector3Dot(normal, XMVectorSubtract(XMLoadFloat3(&eye), p0))) > 0.0f;
+	}
+}
+
+TEST_CASE("Meshlets keep to the size limits and cover every triangle once")
+{
+	TestMesh sphere = Sphere(64, 32);
+	MeshletData data = Meshlets::Build(sphere.Vertices.data(), (int)sphere.Vertices.size(), sphere.Indices.data(), (int)sphere.Indices.size());
+
+	CHECK(data.Meshlets.size() >= sphere.Indices.size() / 3 / Meshlets::MaxTriangles);
+	unsigned int triangles = 0;
+	std::vector<unsigned int> rebuilt;
+	for (const Meshlet& meshlet : data.Meshlets)
+	{
+		CHECK(meshlet.VertexCount > 0 && meshlet.VertexCount <= Meshlets::MaxVertices);
+		CHECK(meshlet.TriangleCount > 0 && meshlet.TriangleCount <= Meshlets::MaxTriangles);
+		triangles += meshlet.TriangleCount;
+		AppendTriangles(data, meshlet, rebuilt);
+
+		// Local indices stay within the meshlet's own vertices, and its sphere holds them all
+		for (unsigned int i = 0; i < meshlet.TriangleCount * 3; i++)
+			CHECK(data.Triangles[meshlet.TriangleOffset + i] < meshlet.VertexCount);
+		for (unsigned int i = 0; i < meshlet.VertexCount; i++)
+		{
+			XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&sphere.Vertices[data.Vertices[meshlet.VertexOffset + i]].Position), XMLoadFloat3(&meshlet.Center));
+			CHECK(XMVectorGetX(XMVector3Length(offset)) <= meshlet.Radius * 1.0001f);
+		}
+	}
+
+	// Triangles go in whole and in order, so expanding them again gives back the index buffer
+	CHECK(triangles == sphere.Indices.size() / 3);
+	CHECK(rebuilt == sphere.Indices);
+}
+
+TEST_CASE("Culled index buffers hold exactly the surviving meshlets")
+{
+	TestMesh sphere = Sphere(64, 32);
+	MeshletData data = Meshlets::Build(sphere.Vertices.data(), (int)sphere.Vertices.size(), sphere.Indices.data(), (int)sphere.Indices.size());
+
+	// From outside, looking a little to one side so some of it is off screen
+	XMFLOAT3 eye(0.0f, 0.0f, -2.5f);
+	XMFLOAT4X4 viewProjection = ViewProjection(eye, XMFLOAT3(1.5f, 0.0f, 1.0f));
+	std::vector<unsigned int> culled;
+	MeshletCullStats stats = Meshlets::Cull(data, viewProjection, eye, culled);
+
+	CHECK(stats.Visible > 0);
+	CHECK(stats.FrustumCulled > 0);
+	CHECK(stats.BackfaceCulled > 0);
+	CHECK(stats.Visible + stats.FrustumCulled + stats.BackfaceCulled == data.Meshlets.size());
+
+	// Cull the meshlets one at a time to see which survive, in order
+	std::vector<unsigned int> expected;
+	MeshletData single = data;
+	for (const Meshlet& meshlet : data.Meshlets)
+	{
+		single.Meshlets = { meshlet };
+		std::vector<unsigned int> ignored;
+		if (Meshlets::Cull(single, viewProjection, eye, ignored).Visible == 1)
+			AppendTriangles(data, meshlet, expected);
+	}
+	CHECK(culled == expected);
+
+	// Cone culling is conservative: no triangle facing the eye went with a culled meshlet
+	std::vector<unsigned int> backfaceCulled;
+	for (const Meshlet& meshlet : data.Meshlets)
+	{
+		single.Meshlets = { meshlet };
+		std::vector<unsigned int> ignored;
+		if (Meshlets::Cull(single, viewProjection, eye, ignored).BackfaceCulled == 1)
+			AppendTriangles(data, meshlet, backfaceCulled);
+	}
+	CHECK(!backfaceCulled.empty());
+	for (size_t t = 0; t + 2 < backfaceCulled.size(); t += 3)
+		CHECK(!FacesEye(sphere, &backfaceCulled[t], eye));
+}
+
+TEST_CASE("From inside a cube every cluster faces away, until it's turned inside out")
+{
+	// 7 x 7 quads a face: exactly MaxVertices each, so every face is one
+	// meshlet - flat, with the tightest cone there is
+	PrimitiveSize size = PrimitiveGenerators::CubeSize(7);
+	TestMesh cube;
+	cube.Vertices.resize(size.VertexCount);
+	cube.Indices.resize(size.IndexCount);
+	PrimitiveGenerators::Cube(cube.Vertices, cube.Indices, 2.0f, 7);
+
+	// Looking out from the middle, every face is a back face
+	XMFLOAT3 eye(0.0f, 0.0f, 0.0f);
+	XMFLOAT4X4 viewProjection = ViewProjection(eye, XMFLOAT3(0.0f, 0.0f, 1.0f));
+	MeshletData data = Meshlets::Build(cube.Vertices.data(), (int)cube.Vertices.size(), cube.Indices.data(), (int)cube.Indices.size());
+	CHECK(data.Meshlets.size() == 6);
+
+	std::vector<unsigned int> culled;
+	MeshletCullStats stats = Meshlets::Cull(data, viewProjection, eye, culled);
+	CHECK(stats.Visible == 0);
+	CHECK(stats.BackfaceCulled >= 5);
+	CHECK(stats.FrustumCulled + stats.BackfaceCulled == 6);
+	CHECK(culled.empty());
+
+	// Inside out, the same clusters all face the eye - only the frustum culls any
+	TestMesh insideOut = InsideOut(cube);
+	MeshletData insideOutData = Meshlets::Build(insideOut.Vertices.data(), (int)insideOut.Vertices.size(), insideOut.Indices.data(), (int)insideOut.Indices.size());
+	MeshletCullStats insideOutStats = Meshlets::Cull(insideOutData, viewProjection, eye, culled);
+	CHECK(insideOutStats.BackfaceCulled == 0);
+	CHECK(insideOutStats.FrustumCulled == stats.FrustumCulled);
+	CHECK(insideOutStats.Visible == stats.BackfaceCulled);
+	CHECK(culled.size() == insideOutStats.Visible * 98 * 3);
+	for (size_t t = 0; t + 2 < culled.size(); t += 3)
+		CHECK(FacesEye(insideOut, &culled[t], eye));
+}
+
+TEST_CASE("Tiny and empty inputs")
+{
+	std::vector<Vertex> vertices(3);
+	vertices[1].Position = XMFLOAT3(1, 0, 0);
+	vertices[2].Position = XMFLOAT3(0, 1, 0);
+	unsigned int indices[] = { 0, 1, 2 };
+
+	MeshletData data = Meshlets::Build(vertices.data(), 3, indices, 3);
+	CHECK(data.Meshlets.size() == 1);
+	CHECK(data.Meshlets[0].VertexCount == 3);
+	CHECK(data.Meshlets[0].TriangleCount == 1);
+
+	CHECK(Meshlets::Build(vertices.data(), 3, indices, 0).Meshlets.empty());
+}
+
+TEST_MAIN()
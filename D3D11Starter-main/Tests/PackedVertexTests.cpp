@@ -0,0 +1,174 @@
+#include "TestHarness.h"
+
+#include "PackedVertex.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Unit vectors spread evenly over the whole sphere
+	std::vector<XMFLOAT3> SphereDirections(int count)
+	{
+		std::vector<XMFLOAT3> directions(count);
+		for (int i = 0; i < count; i++)
+		{
+			float z = 1.0f - 2.0f * (i + 0.5f) / count;
+			float r = sqrtf(std::max(0.0f, 1.0f - z * z));
+			float angle = i * 2.39996323f;
+			directions[i] = XMFLOAT3(cosf(angle) * r, sinf(angle) * r, z);
+		}
+
+		// And the axes, where the octahedron folds
+		directions.push_back(XMFLOAT3(1, 0, 0));
+		directions.push_back(XMFLOAT3(-1, 0, 0));
+		directions.push_back(XMFLOAT3(0, 1, 0));
+		directions.push_back(XMFLOAT3(0, -1, 0));
+		directions.push_back(XMFLOAT3(0, 0, 1));
+		directions.push_back(XMFLOAT3(0, 0, -1));
+		return directions;
+	}
+
+	float AngleBetween(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		float cosine = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&a), XMLoadFloat3(&b)));
+		return acosf(std::clamp(cosine, -1.0f, 1.0f));
+	}
+
+	std::vector<LitVertex> LitVertices(int count)
+	{
+		std::vector<XMFLOAT3> directions = SphereDirections(count);
+		std::vector<LitVertex> vertices(directions.size());
+		for (size_t i = 0; i < directions.size(); i++)
+		{
+			const XMFLOAT3& n = directions[i];
+			vertices[i].Position = XMFLOAT3(n.x * 3.0f - 1.0f, n.y * 0.5f + 2.0f, n.z * 7.0f);
+			vertices[i].Normal = n;
+
+			// Any direction perpendicular to the normal will do
+			XMVECTOR axis = fabsf(n.y) < 0.9f ? XMVectorSet(0, 1, 0, 0) : XMVectorSet(1, 0, 0, 0);
+			XMVECTOR tangent = XMVector3Normalize(XMVector3Cross(axis, XMLoadFloat3(&n)));
+			XMStoreFloat4(&vertices[i].Tangent, XMVectorSetW(tangent, (i % 2) ? 1.0f : -1.0f));
+			vertices[i].UV = XMFLOAT2((float)i / directions.size(), 1.0f - (float)i / directions.size());
+			vertices[i].Color = XMFLOAT4(n.x * 0.5f + 0.5f, n.y * 0.5f + 0.5f, n.z * 0.5f + 0.5f, 1.0f);
+		}
+		return vertices;
+	}
+}
+
+TEST_CASE("Positions round trip within half a quantization step")
+{
+	std::vector<LitVertex> vertices = LitVertices(2000);
+	std::vector<PackedLitVertex> packed(vertices.size());
+	QuantizationBounds bounds = VertexPacking::PackVertices(vertices.data(), (int)vertices.size(), packed.data());
+	XMFLOAT3 maxError = VertexPacking::MaxPositionError(bounds);
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		XMFLOAT3 p = VertexPacking::DequantizePosition(packed[i].Position, bounds);
+		CHECK(fabsf(p.x - vertices[i].Position.x) <= maxError.x * 1.01f);
+		CHECK(fabsf(p.y - vertices[i].Position.y) <= maxError.y * 1.01f);
+		CHECK(fabsf(p.z - vertices[i].Position.z) <= maxError.z * 1.01f);
+	}
+}
+
+TEST_CASE("The dequantization matrix matches DequantizePosition")
+{
+	std::vector<LitVertex> vertices = LitVertices(100);
+	std::vector<PackedLitVertex> packed(vertices.size());
+	QuantizationBounds bounds = VertexPacking::PackVertices(vertices.data(), (int)vertices.size(), packed.data());
+	XMFLOAT4X4 dequantize = VertexPacking::DequantizationMatrix(bounds);
+
+	for (size_t i = 0; i < packed.size(); i++)
+	{
+		// As the input assembler would expand UNORM16
+		XMVECTOR unorm = XMVectorSet(
+			packed[i].Position[0] / 65535.0f,
+			packed[i].Position[1] / 65535.0f,
+			packed[i].Position[2] / 65535.0f, 1.0f);
+		XMFLOAT3 fromMatrix;
+		XMStoreFloat3(&fromMatrix, XMVector3TransformCoord(unorm, XMLoadFloat4x4(&dequantize)));
+		XMFLOAT3 expected = VertexPacking::DequantizePosition(packed[i].Position, bounds);
+
+		CHECK_NEAR(fromMatrix.x, expected.x, 1e-5);
+		CHECK_NEAR(fromMatrix.y, expected.y, 1e-5);
+		CHECK_NEAR(fromMatrix.z, expected.z, 1e-5);
+	}
+}
+
+TEST_CASE("Flat meshes still get a usable extent")
+{
+	Vertex flat[3] = {
+		{ XMFLOAT3(0, 1, 0), XMFLOAT4(1, 1, 1, 1) },
+		{ XMFLOAT3(1, 1, 0), XMFLOAT4(1, 1, 1, 1) },
+		{ XMFLOAT3(0, 1, 1), XMFLOAT4(1, 1, 1, 1) },
+	};
+	PackedVertex packed[3];
+	QuantizationBounds bounds = VertexPacking::PackVertices(flat, 3, packed);
+
+	CHECK(bounds.Extent.y > 0.0f);
+	for (int i = 0; i < 3; i++)
+		CHECK_NEAR(VertexPacking::Unpack(packed[i], bounds).Position.y, 1.0f, 1e-5);
+}
+
+TEST_CASE("Colors round trip within half an 8-bit step")
+{
+	for (int i = 0; i <= 255; i++)
+	{
+		float value = i / 255.0f + 0.3f / 255.0f;
+		XMFLOAT4 color(value, 1.0f - value, value * 0.5f, 1.0f);
+		XMFLOAT4 unpacked = VertexPacking::UnpackColor(VertexPacking::PackColor(color));
+		CHECK_NEAR(unpacked.x, std::min(color.x, 1.0f), 0.5 / 255.0 + 1e-6);
+		CHECK_NEAR(unpacked.y, std::max(color.y, 0.0f), 0.5 / 255.0 + 1e-6);
+		CHECK_NEAR(unpacked.z, color.z, 0.5 / 255.0 + 1e-6);
+		CHECK_NEAR(unpacked.w, 1.0f, 1e-6);
+	}
+
+	// Red in the lowest byte, as R8G8B8A8_UNORM reads it
+	CHECK(VertexPacking::PackColor(XMFLOAT4(1, 0, 0, 0)) == 0x000000FFu);
+}
+
+TEST_CASE("Octahedral normals round trip to within 0.05 degrees")
+{
+	const float maxAngle = XMConvertToRadians(0.05f);
+	float worst = 0.0f;
+	for (const XMFLOAT3& direction : SphereDirections(20000))
+	{
+		int16_t encoded[2];
+		VertexPacking::EncodeOctahedral(direction, encoded);
+		worst = std::max(worst, AngleBetween(direction, VertexPacking::DecodeOctahedral(encoded)));
+	}
+
+	std::printf("  worst normal error: %.5f degrees\n", XMConvertToDegrees(worst));
+	CHECK(worst <= maxAngle);
+}
+
+TEST_CASE("Lit vertices round trip every attribute")
+{
+	std::vector<LitVertex> vertices = LitVertices(500);
+	std::vector<PackedLitVertex> packed(vertices.size());
+	QuantizationBounds bounds = VertexPacking::PackVertices(vertices.data(), (int)vertices.size(), packed.data());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		LitVertex unpacked = VertexPacking::Unpack(packed[i], bounds);
+		CHECK(AngleBetween(unpacked.Normal, vertices[i].Normal) <= XMConvertToRadians(0.05f));
+
+		// The tangent's handedness rides in the position's w
+		XMFLOAT3 tangent(vertices[i].Tangent.x, vertices[i].Tangent.y, vertices[i].Tangent.z);
+		XMFLOAT3 unpackedTangent(unpacked.Tangent.x, unpacked.Tangent.y, unpacked.Tangent.z);
+		CHECK(AngleBetween(unpackedTangent, tangent) <= XMConvertToRadians(0.05f));
+		CHECK(unpacked.Tangent.w == vertices[i].Tangent.w);
+
+		// Half floats keep 11 significant bits
+		CHECK_NEAR(unpacked.UV.x, vertices[i].UV.x, 1.0 / 2048.0);
+		CHECK_NEAR(unpacked.UV.y, vertices[i].UV.y, 1.0 / 2048.0);
+		CHECK_NEAR(unpacked.Color.x, vertices[i].Color.x, 0.5 / 255.0 + 1e-6);
+	}
+}
+
+TEST_MAIN()
@@ -0,0 +1,132 @@
+#include "TestHarness.h"
+
+#include "ParallelRecorder.h"
+#include "RecordingRenderContext.h"
+#include "WorkerPool.h"
+
+#include <vector>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	bool SameCall(const RenderCall& a, const RenderCall& b)
+	{
+		return a.Type == b.Type && a.Object == b.Object && a.DataSize == b.DataSize &&
+			a.Slot == b.Slot && a.Stride == b.Stride && a.Offset == b.Offset &&
+			a.IndexCount == b.IndexCount && a.InstanceCount == b.InstanceCount &&
+			a.StartIndex == b.StartIndex && a.BaseVertex == b.BaseVertex &&
+			a.StartInstance == b.StartInstance && a.FirstConstant == b.FirstConstant &&
+			a.ConstantCount == b.ConstantCount;
+	}
+
+	bool SameCalls(const std::vector<RenderCall>& a, const std::vector<RenderCall>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (!SameCall(a[i], b[i]))
+				return false;
+		}
+		return true;
+	}
+
+	// --------------------------------------------------------
+	// Draw i of a made up frame - what it binds and uploads
+	// depends only on i, as a real draw's would depend only on
+	// its own object, so every slice records it the same way
+	// --------------------------------------------------------
+	void RecordDraw(RenderContext& context, unsigned int i)
+	{
+		// Stand-in objects, never dereferenced
+		ID3D11Buffer* vertexBuffer = (ID3D11Buffer*)(uintptr_t)(0x10000 + (i / 7) * 0x100);
+		ID3D11Buffer* indexBuffer = (ID3D11Buffer*)(uintptr_t)(0x90000 + (i / 7) * 0x100);
+		ID3D11Buffer* constantBuffer = (ID3D11Buffer*)(uintptr_t)0xC0000;
+
+		context.SetVertexShader((ID3D11VertexShader*)(uintptr_t)(0x1000 + (i % 3) * 0x10));
+		context.SetVertexBuffer(0, vertexBuffer, 28, 0);
+		context.SetIndexBuffer(indexBuffer);
+
+		float constants[20] = { (float)i };
+		context.UploadBuffer(constantBuffer, constants, sizeof(constants));
+		context.SetVSConstantBufferRange(0, constantBuffer, i * 16, 16);
+		if (i % 5 == 0)
+			context.DrawIndexedInstanced(36, i % 11 + 1, i, (int)i % 4, i * 2);
+		else
+			context.DrawIndexed(36 + i % 9, i * 3, -(int)(i % 4));
+	}
+
+	const RecordSliceBody recordSlice = [](CommandList& list, unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+				RecordDraw(list, i);
+		};
+
+	// Every draw straight into one context, on this thread
+	std::vector<RenderCall> RecordSerially(unsigned int drawCount)
+	{
+		RecordingRenderContext context;
+		for (unsigned int i = 0; i < drawCount; i++)
+			RecordDraw(context, i);
+		return context.GetCalls();
+	}
+}
+
+TEST_CASE("Parallel recording replays exactly as a single-threaded one")
+{
+	WorkerPool pool(4);
+	ParallelRecorder recorder(&pool);
+
+	// Below, at and well over a slice's worth, and not a multiple of the thread count
+	for (unsigned int drawCount : { 0u, 1u, 63u, 64u, 65u, 300u, 5003u })
+	{
+		recorder.Record(drawCount, recordSlice);
+		RecordingRenderContext merged;
+		recorder.Execute(merged);
+
+		std::vector<RenderCall> serial = RecordSerially(drawCount);
+		CHECK(SameCalls(merged.GetCalls(), serial));
+		CHECK(recorder.GetCommandCount() == serial.size());
+	}
+}
+
+TEST_CASE("Slices are split across the pool only when each gets enough draws")
+{
+	WorkerPool pool(4);
+	ParallelRecorder recorder(&pool);
+
+	recorder.Record(ParallelRecorder::MinDrawsPerSlice, recordSlice);
+	CHECK(recorder.GetSliceCount() == 1);
+	recorder.Record(ParallelRecorder::MinDrawsPerSlice * 2 + 1, recordSlice);
+	CHECK(recorder.GetSliceCount() == 3);
+	recorder.Record(100000, recordSlice);
+	CHECK(recorder.GetSliceCount() == pool.GetThreadCount());
+
+	// Slices are recorded in draw order, so their sizes add up
+	unsigned int sliceCommands = 0;
+	for (unsigned int i = 0; i < recorder.GetSliceCount(); i++)
+		sliceCommands += recorder.GetSlice(i).GetCommandCount();
+	CHECK(sliceCommands == recorder.GetCommandCount());
+}
+
+TEST_CASE("Recording again replaces the last frame, with or without a pool")
+{
+	WorkerPool pool(3);
+	ParallelRecorder threaded(&pool);
+	ParallelRecorder serial(nullptr);
+
+	threaded.Record(5000, recordSlice);
+	threaded.Record(200, recordSlice);
+	serial.Record(200, recordSlice);
+	CHECK(serial.GetSliceCount() == 1);
+
+	RecordingRenderContext fromThreaded;
+	RecordingRenderContext fromSerial;
+	threaded.Execute(fromThreaded);
+	serial.Execute(fromSerial);
+	CHECK(SameCalls(fromThreaded.GetCalls(), RecordSerially(200)));
+	CHECK(SameCalls(fromSerial.GetCalls(), RecordSerially(200)));
+}
+
+TEST_MAIN()
@@ -0,0 +1,274 @@
+#include "TestHarness.h"
+
+#include "PrimitiveGenerators.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	typedef std::function<PrimitiveSize(std::span<LitVertex>, std::span<unsigned int>)> Generator;
+
+	struct Shape
+	{
+		const char* Name;
+		PrimitiveSize Size;
+		Generator Generate;
+		bool Closed;
+		double Volume;	// Of the ideal shape, or 0 if not closed
+	};
+
+	// Every generator, tessellated finely enough that the volume is close
+	std::vector<Shape> Shapes()
+	{
+		std::vector<float> heights(9 * 7);
+		for (size_t i = 0; i < heights.size(); i++)
+			heights[i] = std::sin(i * 0.7f);
+
+		return {
+			{ "sphere", PrimitiveGenerators::SphereSize(64, 32),
+				[](auto v, auto i) { return PrimitiveGenerators::Sphere(v, i, 2.0f, 64, 32); }, true, 4.0 / 3.0 * XM_PI * 8.0 },
+			{ "cube", PrimitiveGenerators::CubeSize(3),
+				[](auto v, auto i) { return PrimitiveGenerators::Cube(v, i, 2.0f, 3); }, true, 8.0 },
+			{ "cylinder", PrimitiveGenerators::CylinderSize(64, 3, true),
+				[](auto v, auto i) { return PrimitiveGenerators::Cylinder(v, i, 1.0f, 3.0f, 64, 3, true); }, true, XM_PI * 3.0 },
+			{ "open cylinder", PrimitiveGenerators::CylinderSize(16, 2, false),
+				[](auto v, auto i) { return PrimitiveGenerators::Cylinder(v, i, 1.0f, 3.0f, 16, 2, false); }, false, 0.0 },
+			{ "torus", PrimitiveGenerators::TorusSize(64, 32),
+				[](auto v, auto i) { return PrimitiveGenerators::Torus(v, i, 2.0f, 0.5f, 64, 32); }, true, 2.0 * XM_PI * XM_PI * 2.0 * 0.25 },
+			{ "plane", PrimitiveGenerators::PlaneSize(4, 3),
+				[](auto v, auto i) { return PrimitiveGenerators::Plane(v, i, 4.0f, 3.0f, 4, 3); }, false, 0.0 },
+			{ "heightfield", PrimitiveGenerators::HeightfieldSize(9, 7),
+				[heights](auto v, auto i) { return PrimitiveGenerators::Heightfield(v, i, heights, 9, 7, 0.5f, 0.25f); }, false, 0.0 },
+		};
+	}
+
+	struct Generated
+	{
+		PrimitiveSize Size;
+		std::vector<LitVertex> Vertices;
+		std::vector<unsigned int> Indices;
+	};
+
+	Generated Generate(const Shape& shape)
+	{
+		Generated result;
+		result.Vertices.resize(shape.Size.VertexCount);
+		result.Indices.resize(shape.Size.IndexCount);
+		result.Size = shape.Generate(result.Vertices, result.Indices);
+		return result;
+	}
+
+	XMVECTOR Load(const XMFLOAT3& v) { return XMLoadFloat3(&v); }
+	float Length(FXMVECTOR v) { return XMVectorGetX(XMVector3Length(v)); }
+	float Dot(FXMVECTOR a, FXMVECTOR b) { return XMVectorGetX(XMVector3Dot(a, b)); }
+
+	// Positions that differ only by rounding (seams, poles, shared
+	// cube edges) collapse to the same id
+	std::vector<unsigned int> WeldedIDs(const std::vector<LitVertex>& vertices)
+	{
+		std::map<std::tuple<long, long, long>, unsigned int> ids;
+		std::vector<unsigned int> result;
+		for (const LitVertex& v : vertices)
+		{
+			auto key = std::make_tuple(std::lround(v.Position.x * 1e4), std::lround(v.Position.y * 1e4), std::lround(v.Position.z * 1e4));
+			result.push_back(ids.emplace(key, (unsigned int)ids.size()).first->second);
+		}
+		return result;
+	}
+
+	// Left-handed, clockwise front faces: the face normal is (b - a) x (c - a)
+	XMVECTOR FaceCross(const std::vector<LitVertex>& vertices, const unsigned int* tri)
+	{
+		XMVECTOR a = Load(vertices[tri[0]].Position);
+		return XMVector3Cross(XMVectorSubtract(Load(vertices[tri[1]].Position), a), XMVectorSubtract(Load(vertices[tri[2]].Position), a));
+	}
+}
+
+TEST_CASE("Generators fill exactly the size they report")
+{
+	for (const Shape& shape : Shapes())
+	{
+		Generated mesh = Generate(shape);
+		CHECK(mesh.Size.VertexCount == shape.Size.VertexCount && mesh.Size.IndexCount == shape.Size.IndexCount);
+		CHECK(mesh.Size.IndexCount % 3 == 0);
+
+		bool inRange = true;
+		for (unsigned int index : mesh.Indices)
+			inRange = inRange && index < mesh.Size.VertexCount;
+		CHECK(inRange);
+
+		// One short in either span, and nothing is written
+		std::vector<LitVertex> vertices(shape.Size.VertexCount - 1);
+		std::vector<unsigned int> indices(shape.Size.IndexCount);
+		PrimitiveSize tooSmall = shape.Generate(vertices, indices);
+		CHECK(tooSmall.VertexCount == 0 && tooSmall.IndexCount == 0);
+
+		vertices.resize(shape.Size.VertexCount);
+		indices.resize(shape.Size.IndexCount - 1);
+		tooSmall = shape.Generate(vertices, indices);
+		CHECK(tooSmall.VertexCount == 0 && tooSmall.IndexCount == 0);
+	}
+
+	// Known sizes, and tessellations too coarse to make a shape
+	CHECK(PrimitiveGenerators::SphereSize(4, 3).VertexCount == 20 && PrimitiveGenerators::SphereSize(4, 3).IndexCount == 48);
+	CHECK(PrimitiveGenerators::CubeSize(1).VertexCount == 24 && PrimitiveGenerators::CubeSize(1).IndexCount == 36);
+	CHECK(PrimitiveGenerators::CylinderSize(3, 1, true).VertexCount == 16 && PrimitiveGenerators::CylinderSize(3, 1, true).IndexCount == 36);
+	CHECK(PrimitiveGenerators::SphereSize(2, 8).VertexCount == 0);
+	CHECK(PrimitiveGenerators::CubeSize(0).VertexCount == 0);
+	CHECK(PrimitiveGenerators::TorusSize(8, 2).VertexCount == 0);
+	CHECK(PrimitiveGenerators::HeightfieldSize(1, 5).VertexCount == 0);
+}
+
+TEST_CASE("Solids are closed, consistently wound and face outwards")
+{
+	for (const Shape& shape : Shapes())
+	{
+		if (!shape.Closed)
+			continue;
+
+		Generated mesh = Generate(shape);
+		std::vector<unsigned int> ids = WeldedIDs(mesh.Vertices);
+
+		// Every directed edge once, and its reverse exactly once
+		std::map<std::pair<unsigned int, unsigned int>, int> edges;
+		double volume = 0.0;
+		for (size_t t = 0; t < mesh.Indices.size(); t += 3)
+		{
+			const unsigned int* tri = &mesh.Indices[t];
+			for (int e = 0; e < 3; e++)
+				edges[{ ids[tri[e]], ids[tri[(e + 1) % 3]] }]++;
+
+			// Signed volume of the tetrahedron to the origin
+			volume += Dot(Load(mesh.Vertices[tri[0]].Position),
+				XMVector3Cross(Load(mesh.Vertices[tri[1]].Position), Load(mesh.Vertices[tri[2]].Position))) / 6.0;
+		}
+
+		bool manifold = true;
+		for (const auto& [edge, count] : edges)
+		{
+			auto reverse = edges.find({ edge.second, edge.first });
+			manifold = manifold && count == 1 && reverse != edges.end() && reverse->second == 1;
+		}
+		CHECK(manifold);
+
+		// Positive means outward, and close to the ideal shape's
+		CHECK(volume > 0.0);
+		CHECK_NEAR(volume / shape.Volume, 1.0, 0.02);
+	}
+}
+
+TEST_CASE("Normals are unit length and agree with the winding")
+{
+	for (const Shape& shape : Shapes())
+	{
+		Generated mesh = Generate(shape);
+
+		bool unit = true;
+		for (const LitVertex& v : mesh.Vertices)
+			unit = unit && std::abs(Length(Load(v.Normal)) - 1.0f) < 1e-5f;
+		CHECK(unit);
+
+		// Zero-area triangles (there are none) would have no say
+		bool agrees = true;
+		for (size_t t = 0; t < mesh.Indices.size(); t += 3)
+		{
+			XMVECTOR face = FaceCross(mesh.Vertices, &mesh.Indices[t]);
+			for (int c = 0; c < 3; c++)
+				agrees = agrees && Dot(face, Load(mesh.Vertices[mesh.Indices[t + c]].Normal)) > 0.0f;
+		}
+		CHECK(agrees);
+	}
+}
+
+TEST_CASE("Tangents follow u, and w makes the bitangent follow v")
+{
+	for (const Shape& shape : Shapes())
+	{
+		Generated mesh = Generate(shape);
+
+		bool frame = true;
+		for (const LitVertex& v : mesh.Vertices)
+		{
+			XMVECTOR tangent = XMLoadFloat4(&v.Tangent);
+			frame = frame && std::abs(Length(tangent) - 1.0f) < 1e-5f;
+			frame = frame && std::abs(Dot(tangent, Load(v.Normal))) < 1e-5f;
+			frame = frame && std::abs(v.Tangent.w) == 1.0f;
+		}
+		CHECK(frame);
+
+		// Per triangle, the directions u and v increase in (from its UV
+		// gradients) against each corner's tangent frame
+		bool handed = true;
+		for (size_t t = 0; t < mesh.Indices.size(); t += 3)
+		{
+			const LitVertex& a = mesh.Vertices[mesh.Indices[t]];
+			const LitVertex& b = mesh.Vertices[mesh.Indices[t + 1]];
+			const LitVertex& c = mesh.Vertices[mesh.Indices[t + 2]];
+
+			XMVECTOR e1 = XMVectorSubtract(Load(b.Position), Load(a.Position));
+			XMVECTOR e2 = XMVectorSubtract(Load(c.Position), Load(a.Position));
+			float du1 = b.UV.x - a.UV.x, dv1 = b.UV.y - a.UV.y;
+			float du2 = c.UV.x - a.UV.x, dv2 = c.UV.y - a.UV.y;
+			float determinant = du1 * dv2 - du2 * dv1;
+			if (std::abs(determinant) < 1e-12f)
+				continue;
+
+			XMVECTOR dPdu = XMVectorScale(XMVectorSubtract(XMVectorScale(e1, dv2), XMVectorScale(e2, dv1)), 1.0f / determinant);
+			XMVECTOR dPdv = XMVectorScale(XMVectorSubtract(XMVectorScale(e2, du1), XMVectorScale(e1, du2)), 1.0f / determinant);
+
+			for (const LitVertex* corner : { &a, &b, &c })
+			{
+				XMVECTOR tangent = XMLoadFloat4(&corner->Tangent);
+				XMVECTOR bitangent = XMVectorScale(XMVector3Cross(Load(corner->Normal), tangent), corner->Tangent.w);
+				handed = handed && Dot(tangent, dPdu) > 0.0f && Dot(bitangent, dPdv) > 0.0f;
+			}
+		}
+		CHECK(handed);
+	}
+}
+
+TEST_CASE("Output depends only on the parameters")
+{
+	for (const Shape& shape : Shapes())
+	{
+		// Different garbage in each set of spans beforehand
+		std::vector<LitVertex> first(shape.Size.VertexCount), second(shape.Size.VertexCount);
+		std::vector<unsigned int> firstIndices(shape.Size.IndexCount), secondIndices(shape.Size.IndexCount);
+		std::memset(first.data(), 0x11, first.size() * sizeof(LitVertex));
+		std::memset(second.data(), 0x7f, second.size() * sizeof(LitVertex));
+		std::memset(firstIndices.data(), 0x11, firstIndices.size() * sizeof(unsigned int));
+		std::memset(secondIndices.data(), 0x7f, secondIndices.size() * sizeof(unsigned int));
+
+		shape.Generate(first, firstIndices);
+		shape.Generate(second, secondIndices);
+		CHECK(std::memcmp(first.data(), second.data(), first.size() * sizeof(LitVertex)) == 0);
+		CHECK(firstIndices == secondIndices);
+	}
+
+	// The position-only overloads write the same shape
+	PrimitiveSize size = PrimitiveGenerators::TorusSize(12, 8);
+	std::vector<LitVertex> lit(size.VertexCount);
+	std::vector<Vertex> plain(size.VertexCount);
+	std::vector<unsigned int> litIndices(size.IndexCount), plainIndices(size.IndexCount);
+	PrimitiveGenerators::Torus(lit, litIndices, 1.0f, 0.25f, 12, 8);
+	PrimitiveGenerators::Torus(plain, plainIndices, 1.0f, 0.25f, 12, 8);
+
+	bool same = litIndices == plainIndices;
+	for (unsigned int i = 0; i < size.VertexCount; i++)
+	{
+		same = same && std::memcmp(&lit[i].Position, &plain[i].Position, sizeof(XMFLOAT3)) == 0;
+		same = same && std::abs(plain[i].Color.x - (lit[i].Normal.x * 0.5f + 0.5f)) < 1e-6f;
+	}
+	CHECK(same);
+}
+
+TEST_MAIN()
@@ -0,0 +1,101 @@
+#include "TestHarness.h"
+
+#include "RangeAllocator.h"
+
+#include <random>
+#include <vector>
+
+TEST_CASE("Allocations are best fit and fail cleanly when full")
+{
+	RangeAllocator allocator(100);
+	unsigned int a = allocator.Allocate(30);
+	unsigned int b = allocator.Allocate(10);
+	unsigned int c = allocator.Allocate(40);
+	CHECK(a == 0 && b == 30 && c == 40);
+	CHECK(allocator.GetUsedSpace() == 80);
+
+	// Free holes of 30 and 20 (the tail) - a 15 goes in the smaller one
+	allocator.Free(a, 30);
+	CHECK(allocator.Allocate(15) == 80);
+	CHECK(allocator.Allocate(31) == RangeAllocator::InvalidOffset);
+	CHECK(allocator.Allocate(0) == RangeAllocator::InvalidOffset);
+	CHECK(allocator.GetAllocationCount() == 3);
+}
+
+TEST_CASE("Freed neighbours merge back into one block")
+{
+	RangeAllocator allocator(64);
+	unsigned int offsets[4];
+	for (unsigned int& offset : offsets)
+		offset = allocator.Allocate(16);
+	CHECK(allocator.GetFreeSpace() == 0);
+
+	// Free out of order, so merges happen on both sides
+	allocator.Free(offsets[1], 16);
+	allocator.Free(offsets[3], 16);
+	CHECK(allocator.GetFreeBlockCount() == 2);
+	CHECK(allocator.GetFragmentation() == 0.5f);
+	allocator.Free(offsets[2], 16);
+	CHECK(allocator.GetFreeBlockCount() == 1);
+	CHECK(allocator.GetLargestFreeBlock() == 48);
+	allocator.Free(offsets[0], 16);
+	CHECK(allocator.GetFreeBlockCount() == 1);
+	CHECK(allocator.GetLargestFreeBlock() == 64);
+	CHECK(allocator.GetFragmentation() == 0.0f);
+	CHECK(allocator.GetAllocationCount() == 0);
+}
+
+TEST_CASE("Random allocations never overlap and the books balance")
+{
+	const unsigned int capacity = 4096;
+	RangeAllocator allocator(capacity);
+	std::vector<int> owner(capacity, -1);
+	struct Live { unsigned int Offset, Size; };
+	std::vector<Live> live;
+	std::mt19937 random(7);
+
+	for (int step = 0; step < 20000; step++)
+	{
+		if (live.empty() || random() % 3 != 0)
+		{
+			unsigned int size = 1 + random() % 64;
+			unsigned int offset = allocator.Allocate(size);
+			if (offset == RangeAllocator::InvalidOffset)
+			{
+				CHECK(allocator.GetLargestFreeBlock() < size);
+				continue;
+			}
+
+			CHECK(offset + size <= capacity);
+			for (unsigned int i = offset; i < offset + size; i++)
+			{
+				CHECK(owner[i] == -1);
+				owner[i] = step;
+			}
+			live.push_back({ offset, size });
+		}
+		else
+		{
+			size_t pick = random() % live.size();
+			for (unsigned int i = live[pick].Offset; i < live[pick].Offset + live[pick].Size; i++)
+				owner[i] = -1;
+			allocator.Free(live[pick].Offset, live[pick].Size);
+			live[pick] = live.back();
+			live.pop_back();
+		}
+	}
+
+	unsigned int used = 0;
+	for (const Live& range : live)
+		used += range.Size;
+	CHECK(allocator.GetUsedSpace() == used);
+	CHECK(allocator.GetAllocationCount() == live.size());
+
+	// Everything back, and it's one block again
+	for (const Live& range : live)
+		allocator.Free(range.Offset, range.Size);
+	CHECK(allocator.GetFreeBlockCount() == 1);
+	CHECK(allocator.GetLargestFreeBlock() == capacity);
+}
+
+TEST_MAIN()
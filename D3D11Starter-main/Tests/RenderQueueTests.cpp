@@ -0,0 +1,138 @@
+#include "TestHarness.h"
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// The reference: a stable sort on the key alone
+	std::vector<RenderQueueEntry> Reference(const std::vector<uint64_t>& keys)
+	{
+		std::vector<RenderQueueEntry> entries;
+		for (size_t i = 0; i < keys.size(); i++)
+			entries.push_back({ keys[i], (uint32_t)i });
+		std::stable_sort(entries.begin(), entries.end(),
+			[](const RenderQueueEntry& a, const RenderQueueEntry& b) { return a.Key < b.Key; });
+		return entries;
+	}
+
+	bool SortsLikeReference(const std::vector<uint64_t>& keys)
+	{
+		RenderQueue queue;
+		for (size_t i = 0; i < keys.size(); i++)
+			queue.Add(keys[i], (uint32_t)i);
+		queue.Sort();
+
+		std::vector<RenderQueueEntry> expected = Reference(keys);
+		const std::vector<RenderQueueEntry>& sorted = queue.GetEntries();
+		if (sorted.size() != expected.size())
+			return false;
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			if (sorted[i].Key != expected[i].Key || sorted[i].Payload != expected[i].Payload)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE("Keys pack their fields where the getters look")
+{
+	uint64_t key = RenderKey::Opaque(3, 7, 100, 2000, 12345);
+	CHECK(RenderKey::GetPass(key) == 3);
+	CHECK(RenderKey::GetOpaqueShader(key) == 7);
+	CHECK((key & ((1ull << RenderKey::DepthBits) - 1)) == 12345);
+
+	// Over-wide fields are masked rather than spilling into their neighbours
+	uint64_t masked = RenderKey::Opaque(1, 0x1FF, 0, 0, 0);
+	CHECK(RenderKey::GetPass(masked) == 1);
+	CHECK(RenderKey::GetOpaqueShader(masked) == 0xFF);
+}
+
+TEST_CASE("Depths quantize linearly and clamp to the planes")
+{
+	const uint32_t maxDepth = (1u << RenderKey::DepthBits) - 1;
+	CHECK(RenderKey::QuantizeDepth(0.1f, 0.1f, 100.0f) == 0);
+	CHECK(RenderKey::QuantizeDepth(100.0f, 0.1f, 100.0f) == maxDepth);
+	CHECK(RenderKey::QuantizeDepth(-5.0f, 0.1f, 100.0f) == 0);
+	CHECK(RenderKey::QuantizeDepth(500.0f, 0.1f, 100.0f) == maxDepth);
+	CHECK_NEAR(RenderKey::QuantizeDepth(50.05f, 0.1f, 100.0f), maxDepth / 2.0, 2.0);
+
+	uint32_t previous = 0;
+	for (float z = 0.1f; z < 100.0f; z += 0.37f)
+	{
+		uint32_t depth = RenderKey::QuantizeDepth(z, 0.1f, 100.0f);
+		CHECK(depth >= previous);
+		previous = depth;
+	}
+}
+
+TEST_CASE("Opaque draws group by state then go front to back, transparent back to front")
+{
+	RenderQueue queue;
+	queue.Add(RenderKey::Opaque(0, 1, 0, 5, 900), 0);
+	queue.Add(RenderKey::Opaque(0, 0, 0, 5, 900), 1);
+	queue.Add(RenderKey::Opaque(0, 0, 0, 5, 100), 2);
+	queue.Add(RenderKey::Transparent(1, 0, 0, 5, 100), 3);
+	queue.Add(RenderKey::Transparent(1, 3, 2, 1, 900), 4);
+	queue.Sort();
+
+	std::vector<uint32_t> order;
+	for (const RenderQueueEntry& entry : queue.GetEntries())
+		order.push_back(entry.Payload);
+	CHECK((order == std::vector<uint32_t>{ 2, 1, 0, 4, 3 }));
+}
+
+TEST_CASE("The radix sort matches a stable sort")
+{
+	std::mt19937_64 random(5);
+	for (size_t count : { 0, 1, 2, 3, 17, 1000, 50000 })
+	{
+		std::vector<uint64_t> randomKeys(count), frameKeys(count), fewKeys(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			randomKeys[i] = random();
+			frameKeys[i] = RenderKey::Opaque(0, random() % 3, random() % 40, random() % 3000, (uint32_t)random());
+			fewKeys[i] = RenderKey::Opaque(2, 1, 4, random() % 4, 0);
+		}
+		CHECK(SortsLikeReference(randomKeys));
+		CHECK(SortsLikeReference(frameKeys));
+		CHECK(SortsLikeReference(fewKeys));
+	}
+
+	// A single varying bit, at either end of the key
+	CHECK(SortsLikeReference({ 1ull << 63, 0, 1ull << 63, 0 }));
+	CHECK(SortsLikeReference({ 1, 0, 1, 0, 1 }));
+}
+
+TEST_CASE("Only the varying bits cost passes")
+{
+	RenderQueue queue;
+	for (uint32_t i = 0; i < 100; i++)
+		queue.Add(RenderKey::Opaque(0, 0, 0, 0, 7), i);
+	queue.Sort();
+	CHECK(queue.GetLastSortPasses() == 0);
+	CHECK(queue.GetEntries()[42].Payload == 42);
+
+	// 3 meshes' worth of bits - one short pass
+	queue.Clear();
+	for (uint32_t i = 0; i < 100; i++)
+		queue.Add(RenderKey::Opaque(0, 0, 0, (i * 7) % 3, 0), i);
+	queue.Sort();
+	CHECK(queue.GetLastSortPasses() == 1);
+
+	// Every bit - 64 bits in 10-bit digits
+	queue.Clear();
+	queue.Add(~0ull, 0);
+	queue.Add(0, 1);
+	queue.Sort();
+	CHECK(queue.GetLastSortPasses() == 7);
+	CHECK(queue.GetEntries()[0].Payload == 1);
+}
+
+TEST_MAIN()
@@ -0,0 +1,264 @@
+#include "TestHarness.h"
+
+#include "RenderThread.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Never dereferenced, so any distinct addresses will do
+	Mesh* FakeMesh(uintptr_t id)
+	{
+		return (Mesh*)(0x1000 + id * 0x100);
+	}
+
+	// --------------------------------------------------------
+	// A consumer that notes each packet's frame number, and
+	// can be told to hold on to a packet until let go
+	// --------------------------------------------------------
+	struct PacketLog
+	{
+		std::mutex Mutex;
+		std::vector<uint64_t> Frames;
+		std::atomic<bool> Blocked = false;
+		std::atomic<unsigned int> Drawing = 0;
+
+		FramePacketConsumer Consumer()
+		{
+			return [this](const FramePacket& packet)
+				{
+					Drawing++;
+					while (Blocked)
+						std::this_thread::yield();
+					std::lock_guard<std::mutex> lock(Mutex);
+					Frames.push_back(packet.GetFrameNumber());
+				};
+		}
+
+		std::vector<uint64_t> Drawn()
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			return Frames;
+		}
+	};
+
+	void Submit(RenderThread& renderThread, uint64_t frameNumber)
+	{
+		renderThread.BeginPacket(frameNumber, 0.016f, frameNumber * 0.016f);
+		renderThread.SubmitPacket();
+	}
+
+	void WaitUntil(const std::atomic<unsigned int>& value, unsigned int expected)
+	{
+		while (value < expected)
+			std::this_thread::yield();
+	}
+}
+
+TEST_CASE("Finish sorts draws by key, equal keys in the order added")
+{
+	FramePacket packet;
+	packet.Reset(7, 0.5f, 3.0f);
+	BufferStruct constants = {};
+	const uint64_t keys[] = { 30, 10, 20, 10, 0xFFFFFFFFFFFFFFFF, 0 };
+	for (uintptr_t i = 0; i < 6; i++)
+		packet.AddDraw(keys[i], FakeMesh(i), constants);
+	CHECK(!packet.IsFinished());
+	CHECK(packet.GetDraws().empty());
+
+	packet.Finish();
+	CHECK(packet.IsFinished());
+	std::span<const PacketDraw> draws = packet.GetDraws();
+	CHECK(draws.size() == 6);
+	if (draws.size() == 6)
+	{
+		const uintptr_t order[] = { 5, 1, 3, 2, 0, 4 };
+		for (int i = 0; i < 6; i++)
+			CHECK(draws[i].Geometry == FakeMesh(order[i]) && draws[i].SortKey == keys[order[i]]);
+	}
+
+	// Reset starts the next frame from nothing
+	packet.Reset(8, 0.25f, 3.25f);
+	CHECK(!packet.IsFinished() && packet.GetDraws().empty());
+	CHECK(packet.GetFrameNumber() == 8 && packet.GetTotalTime() == 3.25f);
+}
+
+TEST_CASE("Instances and UI are copied in")
+{
+	FramePacket packet;
+	packet.Reset(1, 0, 0);
+
+	std::vector<InstanceData> instances(3);
+	instances[2].Tint = XMFLOAT4(1, 2, 3, 4);
+	packet.AddInstances(FakeMesh(0), instances);
+	packet.AddInstances(FakeMesh(1), std::span<const InstanceData>());
+	packet.AddInstances(FakeMesh(2), std::span<const InstanceData>(instances.data(), 2));
+	instances[2].Tint.x = 0;
+
+	PacketUiVertex uiVertices[4] = {};
+	uint16_t uiIndices[6] = { 0, 1, 2, 0, 2, 3 };
+	PacketUiCommand uiCommand = {};
+	uiCommand.ElementCount = 6;
+	packet.AddUiList(uiVertices, uiIndices, std::span<const PacketUiCommand>(&uiCommand, 1));
+	packet.AddUiList(uiVertices, uiIndices, std::span<const PacketUiCommand>(&uiCommand, 1));
+	packet.Finish();
+
+	// Empty groups are skipped
+	CHECK(packet.GetInstanceGroups().size() == 2);
+	CHECK(packet.GetInstances().size() == 5);
+	CHECK(packet.GetInstances()[2].Tint.x == 1);
+	if (packet.GetInstanceGroups().size() == 2)
+	{
+		CHECK(packet.GetInstanceGroups()[1].Geometry == FakeMesh(2));
+		CHECK(packet.GetInstanceGroups()[1].FirstInstance == 3 && packet.GetInstanceGroups()[1].InstanceCount == 2);
+	}
+
+	CHECK(packet.GetUiLists().size() == 2 && packet.GetUiIndices().size() == 12);
+	if (packet.GetUiLists().size() == 2)
+	{
+		const PacketUiList& second = packet.GetUiLists()[1];
+		CHECK(second.FirstCommand == 1 && second.FirstVertex == 4 && second.FirstIndex == 6);
+	}
+}
+
+TEST_CASE("KeepAlive holds a mesh until its packet is drawn and reused")
+{
+	bool released = false;
+	std::shared_ptr<Mesh> mesh(FakeMesh(0), [&](Mesh*) { released = true; });
+
+	bool releasedWhileDrawing = false;
+	RenderThread renderThread([&](const FramePacket& packet)
+		{
+			if (packet.GetFrameNumber() == 1)
+				releasedWhileDrawing = released;
+		}, false);
+	CHECK(!renderThread.IsThreaded());
+
+	FramePacket& packet = renderThread.BeginPacket(1, 0, 0);
+	packet.AddDraw(0, mesh.get(), BufferStruct{});
+	packet.KeepAlive(mesh);
+	mesh.reset();
+	renderThread.SubmitPacket();
+	CHECK(!releasedWhileDrawing);
+	CHECK(!released);
+
+	// The other packet doesn't touch it, reusing its own does
+	Submit(renderThread, 2);
+	CHECK(!released);
+	renderThread.BeginPacket(3, 0, 0);
+	CHECK(released);
+	renderThread.SubmitPacket();
+}
+
+TEST_CASE("Without a thread, packets are drawn inside SubmitPacket")
+{
+	PacketLog log;
+	RenderThread renderThread(log.Consumer(), false);
+	for (uint64_t frame = 1; frame <= 5; frame++)
+	{
+		Submit(renderThread, frame);
+		CHECK(log.Drawn().size() == frame && log.Drawn().back() == frame);
+	}
+
+	// A submit with nothing begun does nothing
+	renderThread.SubmitPacket();
+	CHECK(renderThread.GetStats().PacketsSubmitted == 5);
+	CHECK(renderThread.GetStats().PacketsRendered == 5);
+}
+
+TEST_CASE("Packets are drawn in order, and the game thread waits a frame ahead")
+{
+	PacketLog log;
+	RenderThread renderThread(log.Consumer());
+	CHECK(renderThread.IsThreaded());
+
+	// Hold the render thread on the first packet, with the second queued
+	log.Blocked = true;
+	Submit(renderThread, 1);
+	WaitUntil(log.Drawing, 1);
+	Submit(renderThread, 2);
+
+	// Both packets are in use, so the next BeginPacket() has to wait
+	std::atomic<bool> begun = false;
+	std::thread gameThread([&]()
+		{
+			renderThread.BeginPacket(3, 0, 0);
+			begun = true;
+			renderThread.SubmitPacket();
+		});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	CHECK(!begun);
+
+	log.Blocked = false;
+	gameThread.join();
+	CHECK(begun);
+
+	for (uint64_t frame = 4; frame <= 20; frame++)
+		Submit(renderThread, frame);
+	renderThread.WaitForIdle();
+
+	std::vector<uint64_t> drawn = log.Drawn();
+	CHECK(drawn.size() == 20);
+	bool inOrder = true;
+	for (size_t i = 0; i < drawn.size(); i++)
+		inOrder = inOrder && drawn[i] == i + 1;
+	CHECK(inOrder);
+	CHECK(renderThread.GetStats().PacketsSubmitted == 20);
+	CHECK(renderThread.GetStats().PacketsRendered == 20);
+}
+
+TEST_CASE("WaitForIdle returns once everything submitted is drawn")
+{
+	PacketLog log;
+	RenderThread renderThread(log.Consumer());
+
+	// Nothing submitted yet
+	renderThread.WaitForIdle();
+
+	log.Blocked = true;
+	Submit(renderThread, 1);
+	Submit(renderThread, 2);
+	std::thread release([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			log.Blocked = false;
+		});
+	renderThread.WaitForIdle();
+	CHECK(log.Drawn().size() == 2);
+	CHECK(renderThread.GetStats().PacketsRendered == 2);
+	release.join();
+}
+
+TEST_CASE("The destructor draws whatever was submitted")
+{
+	PacketLog log;
+	std::thread release;
+	{
+		RenderThread renderThread(log.Consumer());
+		log.Blocked = true;
+		Submit(renderThread, 1);
+		WaitUntil(log.Drawing, 1);
+		Submit(renderThread, 2);
+
+		// Let go only once the destructor is under way
+		release = std::thread([&]()
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				log.Blocked = false;
+			});
+	}
+	release.join();
+
+	std::vector<uint64_t> drawn = log.Drawn();
+	CHECK(drawn.size() == 2 && drawn[0] == 1 && drawn[1] == 2);
+}
+
+TEST_MAIN()
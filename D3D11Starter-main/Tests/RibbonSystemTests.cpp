@@ -0,0 +1,199 @@
+#include "TestHarness.h"
+
+#include "RibbonSystem.h"
+#include "WorkerPool.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	const RibbonStyle style = { 0.5f, 2.0f, XMFLOAT4(1.0f, 0.5f, 0.25f, 1.0f) };
+	const XMFLOAT3 eye(0.0f, 0.0f, -10.0f);
+
+	float Distance(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		return XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&a), XMLoadFloat3(&b))));
+	}
+
+	// Every trail gets a different curve, and some wrap their ring
+	// - Circles roughly facing the eye: a strip along a path heading
+	//   straight at the eye twists, as any camera facing strip does
+	void AddCurve(RibbonSystem& ribbons, unsigned int trail, unsigned int points, float startTime)
+	{
+		for (unsigned int i = 0; i < points; i++)
+		{
+			float angle = i * 0.3f + trail;
+			XMFLOAT3 position(cosf(angle) + trail * 0.1f, sinf(angle), 0.2f * sinf(angle * 0.5f));
+			ribbons.AddPoint(trail, position, startTime + i * 0.01f);
+		}
+	}
+
+	bool SameStream(RibbonSystem& a, RibbonSystem& b)
+	{
+		std::span<const RibbonVertex> aVertices = a.GetVertices(), bVertices = b.GetVertices();
+		std::span<const unsigned int> aIndices = a.GetIndices(), bIndices = b.GetIndices();
+		return aVertices.size() == bVertices.size() && aIndices.size() == bIndices.size() &&
+			std::memcmp(aVertices.data(), bVertices.data(), aVertices.size_bytes()) == 0 &&
+			std::memcmp(aIndices.data(), bIndices.data(), aIndices.size_bytes()) == 0;
+	}
+}
+
+TEST_CASE("Straight trails come out exactly Width wide")
+{
+	RibbonSystem ribbons;
+	unsigned int trail = ribbons.CreateTrail(style);
+	for (int i = 0; i < 6; i++)
+		ribbons.AddPoint(trail, XMFLOAT3(i * 1.0f, 0.0f, 0.0f), i * 0.1f);
+	ribbons.Expand(eye, 0.5f);
+
+	std::span<const RibbonVertex> vertices = ribbons.GetVertices();
+	CHECK(vertices.size() == 12);
+	CHECK(ribbons.GetIndices().size() == 5 * 6);
+	for (size_t i = 0; i + 1 < vertices.size(); i += 2)
+	{
+		CHECK_NEAR(Distance(vertices[i].Position, vertices[i + 1].Position), style.Width, 2e-3);
+
+		// Across the strip is straight up, as the trail runs along x facing the eye
+		CHECK_NEAR(vertices[i].Position.x, vertices[i + 1].Position.x, 1e-5);
+		CHECK(vertices[i].UV.y == 0.0f && vertices[i + 1].UV.y == 1.0f);
+	}
+
+	// Age across the lifetime: the newest point is u = 0 and fully opaque
+	CHECK_NEAR(vertices[10].UV.x, 0.0f, 1e-6);
+	CHECK_NEAR(vertices[0].UV.x, 0.5f / style.Lifetime, 1e-5);
+	CHECK((vertices[10].Color >> 24) == 255);
+	CHECK((vertices[0].Color >> 24) < 255);
+	CHECK((vertices[0].Color & 0x00FFFFFF) == 0x4080FFu);
+}
+
+TEST_CASE("Right angle turns get a square root of two miter")
+{
+	RibbonSystem ribbons;
+	unsigned int trail = ribbons.CreateTrail(style);
+	ribbons.AddPoint(trail, XMFLOAT3(-2.0f, 0.0f, 0.0f), 0.0f);
+	ribbons.AddPoint(trail, XMFLOAT3(0.0f, 0.0f, 0.0f), 0.1f);
+	ribbons.AddPoint(trail, XMFLOAT3(0.0f, 2.0f, 0.0f), 0.2f);
+	ribbons.Expand(eye, 0.2f);
+
+	std::span<const RibbonVertex> vertices = ribbons.GetVertices();
+	CHECK(vertices.size() == 6);
+	CHECK_NEAR(Distance(vertices[2].Position, vertices[3].Position), style.Width * sqrtf(2.0f), 2e-3);
+}
+
+TEST_CASE("Every triangle faces the eye")
+{
+	RibbonSystem ribbons;
+	for (unsigned int t = 0; t < 8; t++)
+		AddCurve(ribbons, ribbons.CreateTrail(style), 20, 0.0f);
+	ribbons.Expand(eye, 0.2f);
+
+	std::span<const RibbonVertex> vertices = ribbons.GetVertices();
+	std::span<const unsigned int> indices = ribbons.GetIndices();
+	int backFacing = 0;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		XMVECTOR a = XMLoadFloat3(&vertices[indices[i]].Position);
+		XMVECTOR b = XMLoadFloat3(&vertices[indices[i + 1]].Position);
+		XMVECTOR c = XMLoadFloat3(&vertices[indices[i + 2]].Position);
+
+		// Clockwise from the eye is front facing, in a left-handed world
+		XMVECTOR normal = XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+		XMVECTOR toEye = XMVectorSubtract(XMLoadFloat3(&eye), a);
+		backFacing += XMVectorGetX(XMVector3Dot(normal, toEye)) <= 0.0f;
+	}
+	CHECK(backFacing == 0);
+}
+
+TEST_CASE("Old points are dropped, and trails too short to draw are skipped")
+{
+	RibbonSystem ribbons;
+	unsigned int trail = ribbons.CreateTrail(style);
+	for (int i = 0; i < 10; i++)
+		ribbons.AddPoint(trail, XMFLOAT3(i * 1.0f, 0.0f, 0.0f), i * 0.5f);
+
+	// Lifetime 2: at 4.5, only the points from 2.5 on are left
+	ribbons.Expand(eye, 4.5f);
+	CHECK(ribbons.GetPointCount(trail) == 5);
+	CHECK(ribbons.GetVertices().size() == 10);
+
+	ribbons.Expand(eye, 6.2f);
+	CHECK(ribbons.GetPointCount(trail) == 1);
+	CHECK(ribbons.GetVertices().empty());
+	CHECK(ribbons.GetIndices().empty());
+}
+
+TEST_CASE("Kept indices match a stream built from scratch")
+{
+	// One system is expanded every frame while its trails grow, wrap,
+	// clear and go away, so it keeps and moves indices between frames;
+	// the other only ever expands the final state once
+	RibbonSystem reused;
+	std::vector<unsigned int> trails;
+	for (unsigned int t = 0; t < 40; t++)
+		trails.push_back(reused.CreateTrail(style));
+
+	for (int frame = 0; frame < 12; frame++)
+	{
+		float time = frame * 0.1f;
+		for (unsigned int t = 0; t < trails.size(); t++)
+		{
+			if (frame > 6 && (t == 3 || t == 17))
+				continue;
+			if ((t + frame) % 5 == 0)
+				reused.ClearTrail(trails[t]);
+			AddCurve(reused, trails[t], (t + frame) % 9, time);
+		}
+		if (frame == 6)
+		{
+			reused.DestroyTrail(trails[3]);
+			reused.DestroyTrail(trails[17]);
+		}
+		reused.Expand(eye, time + 0.05f);
+	}
+
+	// Rebuild the same points in a fresh system, destroying the same
+	// trails, so every live trail keeps its number
+	RibbonSystem fresh;
+	for (unsigned int t = 0; t < trails.size(); t++)
+	{
+		unsigned int trail = fresh.CreateTrail(style);
+		CHECK(trail == t);
+		for (int frame = 0; frame < 12; frame++)
+		{
+			if (frame > 6 && (t == 3 || t == 17))
+				continue;
+			if ((t + frame) % 5 == 0)
+				fresh.ClearTrail(trail);
+			AddCurve(fresh, trail, (t + frame) % 9, frame * 0.1f);
+		}
+	}
+	fresh.DestroyTrail(3);
+	fresh.DestroyTrail(17);
+	fresh.Expand(eye, 11 * 0.1f + 0.05f);
+
+	CHECK(!reused.GetIndices().empty());
+	CHECK(SameStream(reused, fresh));
+}
+
+TEST_CASE("Streams don't depend on the thread count")
+{
+	WorkerPool pool(4);
+	RibbonSystem threaded(&pool);
+	RibbonSystem serial;
+	for (unsigned int t = 0; t < 2000; t++)
+	{
+		AddCurve(threaded, threaded.CreateTrail(style), 5 + t % 40, 0.0f);
+		AddCurve(serial, serial.CreateTrail(style), 5 + t % 40, 0.0f);
+	}
+
+	threaded.Expand(eye, 0.3f);
+	serial.Expand(eye, 0.3f);
+	CHECK(SameStream(threaded, serial));
+}
+
+TEST_MAIN()
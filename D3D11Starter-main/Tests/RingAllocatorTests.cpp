@@ -0,0 +1,70 @@
+#include "TestHarness.h"
+
+#include "RingAllocator.h"
+
+TEST_CASE("Allocations are aligned and back to back")
+{
+	RingAllocator ring(1000, 256);
+	CHECK(ring.GetCapacity() == 768);
+	CHECK(ring.Allocate(1) == 0);
+	CHECK(ring.Allocate(256) == 256);
+	CHECK(ring.GetFrameSpace() == 512);
+	CHECK(ring.Allocate(0) == RingAllocator::InvalidOffset);
+	CHECK(ring.Allocate(769) == RingAllocator::InvalidOffset);
+}
+
+TEST_CASE("Space in flight is never handed out again until released")
+{
+	RingAllocator ring(1024, 256);
+	ring.Allocate(256);
+	ring.Allocate(256);
+	uint64_t first = ring.EndFrame();
+	ring.Allocate(256);
+	uint64_t second = ring.EndFrame();
+	CHECK(ring.GetFramesInFlight() == 2);
+
+	// One block left before it would run into the first frame
+	CHECK(ring.Allocate(256) == 768);
+	CHECK(ring.Allocate(256) == RingAllocator::InvalidOffset);
+	CHECK(ring.GetFrameSpace() == 256);
+
+	ring.Release(first);
+	CHECK(ring.Allocate(256) == 0);
+	CHECK(ring.Allocate(256) == 256);
+	CHECK(ring.Allocate(256) == RingAllocator::InvalidOffset);
+
+	ring.Release(second);
+	CHECK(ring.GetFramesInFlight() == 0);
+	CHECK(ring.Allocate(256) == 512);
+}
+
+TEST_CASE("A block that won't fit before the end wraps to the start")
+{
+	RingAllocator ring(1024, 256);
+	ring.Allocate(768);
+	ring.Release(ring.EndFrame());
+
+	// 512 bytes don't fit in the last 256, so that tail is skipped
+	CHECK(ring.Allocate(512) == 0);
+	CHECK(ring.GetUsedSpace() == 768);
+	CHECK(ring.Allocate(512) == RingAllocator::InvalidOffset);
+}
+
+TEST_CASE("Reset forgets everything, frame numbers keep counting")
+{
+	RingAllocator ring(1024, 256);
+	ring.Allocate(1024);
+	uint64_t before = ring.EndFrame();
+	ring.Reset();
+	CHECK(ring.GetUsedSpace() == 0);
+	CHECK(ring.GetFramesInFlight() == 0);
+	CHECK(ring.Allocate(1024) == 0);
+
+	// So a fence from before the reset can't release a frame from after it
+	uint64_t after = ring.EndFrame();
+	CHECK(after > before);
+	ring.Release(before);
+	CHECK(ring.GetUsedSpace() == 1024);
+}
+
+TEST_MAIN()
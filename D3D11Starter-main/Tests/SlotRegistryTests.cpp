@@ -0,0 +1,121 @@
+#include "TestHarness.h"
+
+#include "SlotRegistry.h"
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Stands in for a Mesh - counts how many are alive, and can't be
+	// copied or moved, just like one
+	struct Tracked
+	{
+		static inline int alive = 0;
+		int Value;
+
+		explicit Tracked(int value) : Value(value) { alive++; }
+		~Tracked() { alive--; }
+		Tracked(const Tracked&) = delete;
+		Tracked& operator=(const Tracked&) = delete;
+	};
+}
+
+TEST_CASE("IDs find their object until it's destroyed")
+{
+	SlotRegistry<Tracked> registry;
+	SlotID a = registry.Create(1);
+	SlotID b = registry.Create(2);
+	CHECK(a.IsValid() && b.IsValid() && a != b);
+	CHECK(registry.Get(a)->Value == 1 && registry.Get(b)->Value == 2);
+	CHECK(registry.GetLiveCount() == 2);
+
+	registry.Destroy(a);
+	CHECK(registry.Get(a) == nullptr);
+	CHECK(!registry.IsAlive(a));
+	CHECK(registry.Get(b)->Value == 2);
+	CHECK(registry.GetLiveCount() == 1);
+	CHECK(registry.GetRetiredCount() == 1);
+
+	// Destroying twice, or an ID that was never handed out, is harmless
+	registry.Destroy(a);
+	registry.Destroy(SlotID{ 0 });
+	CHECK(registry.GetRetiredCount() == 1);
+	CHECK(registry.Get(SlotID{ 0 }) == nullptr);
+	CHECK(registry.Get(SlotID{ b.Value + 1 }) == nullptr);
+}
+
+TEST_CASE("Destroyed objects survive exactly framesInFlight frames")
+{
+	Tracked::alive = 0;
+	for (unsigned int framesInFlight : { 1u, 2u, 3u })
+	{
+		SlotRegistry<Tracked> registry(framesInFlight);
+		SlotID id = registry.Create(7);
+		Tracked* object = registry.Get(id);
+		registry.Destroy(id);
+
+		// Still there for anything that took the pointer before Destroy
+		for (unsigned int i = 1; i < framesInFlight; i++)
+		{
+			registry.AdvanceFrame();
+			CHECK(Tracked::alive == 1);
+			CHECK(object->Value == 7);
+		}
+
+		registry.AdvanceFrame();
+		CHECK(Tracked::alive == 0);
+		CHECK(registry.GetRetiredCount() == 0);
+	}
+}
+
+TEST_CASE("Reused slots get a new generation")
+{
+	SlotRegistry<Tracked> registry(1);
+	SlotID first = registry.Create(1);
+	registry.Destroy(first);
+
+	// Not reused until it's been released
+	SlotID second = registry.Create(2);
+	CHECK(second.Index() != first.Index());
+
+	registry.AdvanceFrame();
+	SlotID third = registry.Create(3);
+	CHECK(third.Index() == first.Index());
+	CHECK(third.Generation() != first.Generation());
+	CHECK(registry.Get(first) == nullptr);
+	CHECK(registry.Get(third)->Value == 3);
+
+	// Generations wrap without ever producing zero
+	for (int i = 0; i < (int)SlotID::GenerationMask + 2; i++)
+	{
+		registry.Destroy(third);
+		registry.AdvanceFrame();
+		third = registry.Create(3);
+		CHECK(third.Index() == first.Index() && third.Generation() != 0);
+	}
+}
+
+TEST_CASE("Clear releases everything and stale IDs stay stale")
+{
+	Tracked::alive = 0;
+	{
+		SlotRegistry<Tracked> registry(3);
+		SlotID live = registry.Create(1);
+		SlotID retired = registry.Create(2);
+		registry.Destroy(retired);
+		CHECK(Tracked::alive == 2);
+
+		registry.Clear();
+		CHECK(Tracked::alive == 0);
+		CHECK(registry.Get(live) == nullptr && registry.Get(retired) == nullptr);
+		CHECK(registry.GetLiveCount() == 0 && registry.GetRetiredCount() == 0);
+
+		registry.Create(3);
+		CHECK(Tracked::alive == 1);
+	}
+
+	// The destructor clears too
+	CHECK(Tracked::alive == 0);
+}
+
+TEST_MAIN()
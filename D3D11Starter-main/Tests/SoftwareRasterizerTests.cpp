@@ -0,0 +1,286 @@
+#include "TestHarness.h"
+
+#include "PrimitiveGenerators.h"
+#include "SoftwareRasterizer.h"
+#include "WorkerPool.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	const XMFLOAT4 background(0.0f, 0.0f, 0.0f, 1.0f);
+
+	BufferStruct Constants(const XMMATRIX& world)
+	{
+		BufferStruct constants = {};
+		constants.colorTint = XMFLOAT4(1, 1, 1, 1);
+		XMStoreFloat4x4(&constants.world, world);
+		return constants;
+	}
+
+	// Vertices straight in clip space - the camera is left at identity
+	Vertex ClipVertex(float x, float y, float z, const XMFLOAT4& color)
+	{
+		return { XMFLOAT3(x, y, z), color };
+	}
+
+	// A sphere and a torus through a perspective camera, with
+	// colors that vary across every triangle
+	void DrawScene(SoftwareRasterizer& rasterizer)
+	{
+		PrimitiveSize sphereSize = PrimitiveGenerators::SphereSize(64, 32);
+		std::vector<Vertex> sphereVertices(sphereSize.VertexCount);
+		std::vector<unsigned int> sphereIndices(sphereSize.IndexCount);
+		PrimitiveGenerators::Sphere(sphereVertices, sphereIndices, 1.0f, 64, 32);
+
+		PrimitiveSize torusSize = PrimitiveGenerators::TorusSize(32, 12);
+		std::vector<Vertex> torusVertices(torusSize.VertexCount);
+		std::vector<unsigned int> torusIndices(torusSize.IndexCount);
+		PrimitiveGenerators::Torus(torusVertices, torusIndices, 1.2f, 0.3f, 32, 12);
+
+		for (size_t i = 0; i < sphereVertices.size(); i++)
+			sphereVertices[i].Color = XMFLOAT4((i % 7) / 6.0f, (i % 5) / 4.0f, (i % 3) / 2.0f, 1.0f);
+		for (size_t i = 0; i < torusVertices.size(); i++)
+			torusVertices[i].Color = XMFLOAT4(1.0f, (i % 11) / 10.0f, 0.25f, (i % 2) ? 1.0f : 0.5f);
+
+		XMFLOAT4X4 view, projection;
+		XMStoreFloat4x4(&view, XMMatrixLookToLH(XMVectorSet(0.3f, 1.0f, -4.0f, 1), XMVectorSet(-0.05f, -0.25f, 1, 0), XMVectorSet(0, 1, 0, 0)));
+		XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)rasterizer.GetWidth() / rasterizer.GetHeight(), 0.1f, 100.0f));
+		rasterizer.SetCamera(view, projection);
+
+		rasterizer.Clear(background);
+		rasterizer.Draw(sphereVertices.data(), (int)sphereVertices.size(), sphereIndices.data(), (int)sphereIndices.size(), Constants(XMMatrixIdentity()));
+		rasterizer.Draw(torusVertices.data(), (int)torusVertices.size(), torusIndices.data(), (int)torusIndices.size(), Constants(XMMatrixRotationY(0.4f)));
+		rasterizer.Finish();
+	}
+
+	bool SameImage(SoftwareRasterizer& a, SoftwareRasterizer& b)
+	{
+		for (unsigned int y = 0; y < a.GetHeight(); y++)
+		{
+			for (unsigned int x = 0; x < a.GetWidth(); x++)
+			{
+				if (a.GetPixel(x, y) != b.GetPixel(x, y) || a.GetDepth(x, y) != b.GetDepth(x, y))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Bit at a time, so it shares nothing with the table-driven one
+	uint32_t ReferenceCrc32(const unsigned char* data, size_t size)
+	{
+		uint32_t crc = 0xFFFFFFFF;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320u : 0);
+		}
+		return ~crc;
+	}
+
+	uint32_t ReadBigEndian(const unsigned char* at)
+	{
+		return ((uint32_t)at[0] << 24) | ((uint32_t)at[1] << 16) | ((uint32_t)at[2] << 8) | at[3];
+	}
+}
+
+TEST_CASE("Triangles sharing edges cover every pixel exactly once")
+{
+	// A fan around an off-center point, out to the screen's edges -
+	// some edges pass exactly through pixel centers, so the fill rule decides
+	const unsigned int width = 96, height = 64;
+	const XMFLOAT2 rim[] = {
+		{ -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 }, { 1, 1.0f / 3.0f }, { 1, -1 }, { 0.5f, -1 } };
+	const int rimCount = (int)std::size(rim);
+	const XMFLOAT4 white(1, 1, 1, 1);
+
+	SoftwareRasterizer rasterizer(width, height);
+	std::vector<int> coverage(width * height, 0);
+	for (int i = 0; i < rimCount; i++)
+	{
+		const XMFLOAT2& a = rim[i];
+		const XMFLOAT2& b = rim[(i + 1) % rimCount];
+		Vertex vertices[3] = {
+			ClipVertex(0.125f, -0.0625f, 0.5f, white),
+			ClipVertex(a.x, a.y, 0.5f, white),
+			ClipVertex(b.x, b.y, 0.5f, white) };
+
+		// Both windings - whichever is back facing is culled
+		unsigned int indices[6] = { 0, 1, 2, 0, 2, 1 };
+		rasterizer.Clear(background);
+		rasterizer.Draw(vertices, 3, indices, 6, Constants(XMMatrixIdentity()));
+		rasterizer.Finish();
+		CHECK(rasterizer.GetTrianglesRasterized() == 1);
+
+		for (unsigned int y = 0; y < height; y++)
+			for (unsigned int x = 0; x < width; x++)
+				coverage[y * width + x] += rasterizer.GetPixel(x, y) != 0xFF000000u;
+	}
+
+	int wrong = 0;
+	for (int count : coverage)
+		wrong += count != 1;
+	CHECK(wrong == 0);
+}
+
+TEST_CASE("The nearer surface wins, whatever the draw order")
+{
+	const XMFLOAT4 red(1, 0, 0, 1), green(0, 1, 0, 1);
+	Vertex nearQuad[4] = {
+		ClipVertex(-1, -1, 0.25f, green), ClipVertex(-1, 1, 0.25f, green),
+		ClipVertex(1, 1, 0.25f, green), ClipVertex(1, -1, 0.25f, green) };
+	Vertex farQuad[4] = {
+		ClipVertex(-1, -1, 0.75f, red), ClipVertex(-1, 1, 0.75f, red),
+		ClipVertex(1, 1, 0.75f, red), ClipVertex(1, -1, 0.75f, red) };
+	unsigned int indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+	for (bool nearFirst : { true, false })
+	{
+		SoftwareRasterizer rasterizer(70, 40);
+		rasterizer.Clear(background);
+		rasterizer.Draw(nearFirst ? nearQuad : farQuad, 4, indices, 6, Constants(XMMatrixIdentity()));
+		rasterizer.Draw(nearFirst ? farQuad : nearQuad, 4, indices, 6, Constants(XMMatrixIdentity()));
+		rasterizer.Finish();
+
+		for (unsigned int y = 0; y < 40; y++)
+		{
+			for (unsigned int x = 0; x < 70; x++)
+			{
+				CHECK(rasterizer.GetPixel(x, y) == 0xFF00FF00u);
+				CHECK_NEAR(rasterizer.GetDepth(x, y), 0.25, 1e-6);
+			}
+		}
+	}
+}
+
+TEST_CASE("The built-in pixel shader matches the same shader called per pixel")
+{
+	// The stock shader is packed four pixels at a time - a lambda
+	// doing the same goes down the general, one pixel at a time path
+	SoftwareRasterizer inlined(320, 200);
+	SoftwareRasterizer called(320, 200);
+	called.SetShaders(SoftwareShaders::VertexShader, [](const SoftwareVertexOutput& input) { return input.Color; });
+
+	DrawScene(inlined);
+	DrawScene(called);
+	CHECK(inlined.GetTrianglesRasterized() > 1000);
+	CHECK(SameImage(inlined, called));
+}
+
+TEST_CASE("Images don't depend on the thread count")
+{
+	WorkerPool pool(4);
+	SoftwareRasterizer threaded(333, 211, &pool);
+	SoftwareRasterizer serial(333, 211);
+
+	DrawScene(threaded);
+	DrawScene(serial);
+	CHECK(SameImage(threaded, serial));
+}
+
+TEST_CASE("PNG files hold the color buffer")
+{
+	// Big enough to need more than one stored deflate block
+	SoftwareRasterizer rasterizer(200, 120);
+	DrawScene(rasterizer);
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "SoftwareRasterizerTests.png";
+	CHECK(rasterizer.WritePNG(path.wstring()));
+
+	std::ifstream file(path, std::ios::binary);
+	std::vector<unsigned char> png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+	std::filesystem::remove(path);
+
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	CHECK(png.size() > 8 && std::equal(signature, signature + 8, png.begin()));
+
+	// Walk the chunks, checking each CRC and gathering the image data
+	std::vector<unsigned char> imageData;
+	std::vector<std::string> chunkTypes;
+	size_t at = 8;
+	while (at + 12 <= png.size())
+	{
+		uint32_t length = ReadBigEndian(&png[at]);
+		if (at + 12 + length > png.size())
+			break;
+
+		std::string type(png.begin() + at + 4, png.begin() + at + 8);
+		const unsigned char* data = &png[at + 8];
+		chunkTypes.push_back(type);
+		CHECK(ReadBigEndian(data + length) == ReferenceCrc32(&png[at + 4], length + 4));
+
+		if (type == "IHDR")
+		{
+			CHECK(length == 13);
+			CHECK(ReadBigEndian(data) == 200);
+			CHECK(ReadBigEndian(data + 4) == 120);
+			CHECK(data[8] == 8 && data[9] == 2);
+		}
+		else if (type == "IDAT")
+			imageData.insert(imageData.end(), data, data + length);
+		at += 12 + length;
+	}
+	CHECK(at == png.size());
+	CHECK(chunkTypes == std::vector<std::string>({ "IHDR", "IDAT", "IEND" }));
+
+	// zlib header, then stored blocks until the last one
+	CHECK(imageData.size() > 6);
+	CHECK(((imageData[0] << 8) | imageData[1]) % 31 == 0);
+	std::vector<unsigned char> raw;
+	size_t position = 2;
+	int blocks = 0;
+	bool last = false;
+	while (!last && position + 5 <= imageData.size())
+	{
+		last = imageData[position] & 1;
+		CHECK((imageData[position] >> 1) == 0);
+		unsigned int blockSize = imageData[position + 1] | (imageData[position + 2] << 8);
+		unsigned int inverse = imageData[position + 3] | (imageData[position + 4] << 8);
+		CHECK((blockSize ^ inverse) == 0xFFFF);
+		position += 5;
+		raw.insert(raw.end(), imageData.begin() + position, imageData.begin() + position + blockSize);
+		position += blockSize;
+		blocks++;
+	}
+	CHECK(last);
+	CHECK(blocks > 1);
+
+	uint32_t a = 1, b = 0;
+	for (unsigned char byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	CHECK(position + 4 == imageData.size());
+	CHECK(ReadBigEndian(&imageData[position]) == ((b << 16) | a));
+
+	// Unfiltered RGB rows, matching the color buffer
+	CHECK(raw.size() == 120 * (1 + 200 * 3));
+	int wrong = 0;
+	for (unsigned int y = 0; y < 120 && raw.size() == 120 * (1 + 200 * 3); y++)
+	{
+		const unsigned char* row = &raw[y * (1 + 200 * 3)];
+		wrong += row[0] != 0;
+		for (unsigned int x = 0; x < 200; x++)
+		{
+			uint32_t pixel = rasterizer.GetPixel(x, y);
+			wrong += row[1 + x * 3] != (pixel & 0xFF);
+			wrong += row[2 + x * 3] != ((pixel >> 8) & 0xFF);
+			wrong += row[3 + x * 3] != ((pixel >> 16) & 0xFF);
+		}
+	}
+	CHECK(wrong == 0);
+}
+
+TEST_MAIN()
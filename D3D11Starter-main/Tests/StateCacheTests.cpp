@@ -0,0 +1,131 @@
+#include "TestHarness.h"
+
+#include "RecordingRenderContext.h"
+#include "StateCache.h"
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Never dereferenced, so any distinct addresses will do
+	ID3D11InputLayout* const layout = (ID3D11InputLayout*)0x1000;
+	ID3D11InputLayout* const otherLayout = (ID3D11InputLayout*)0x1100;
+	ID3D11VertexShader* const vertexShader = (ID3D11VertexShader*)0x2000;
+	ID3D11VertexShader* const otherVertexShader = (ID3D11VertexShader*)0x2100;
+	ID3D11PixelShader* const pixelShader = (ID3D11PixelShader*)0x3000;
+	ID3D11Buffer* const vertexBuffer = (ID3D11Buffer*)0x4000;
+	ID3D11Buffer* const otherVertexBuffer = (ID3D11Buffer*)0x4100;
+	ID3D11Buffer* const indexBuffer = (ID3D11Buffer*)0x5000;
+	ID3D11Buffer* const constantBuffer = (ID3D11Buffer*)0x6000;
+
+	// Every state setter once
+	void BindEverything(RenderContext& context)
+	{
+		context.SetInputLayout(layout);
+		context.SetVertexShader(vertexShader);
+		context.SetPixelShader(pixelShader);
+		context.SetVertexBuffer(0, vertexBuffer, 28, 0);
+		context.SetIndexBuffer(indexBuffer);
+		context.SetVSConstantBufferRange(0, constantBuffer, 0, 16);
+	}
+}
+
+TEST_CASE("Repeated binds are filtered, changed ones forwarded")
+{
+	RecordingRenderContext device;
+	StateCache cache(device);
+
+	// Nothing is known yet, so all of it goes through
+	BindEverything(cache);
+	CHECK(device.GetCalls().size() == 6);
+
+	// The same again is dropped entirely
+	BindEverything(cache);
+	CHECK(device.GetCalls().size() == 6);
+	CHECK(cache.GetStats().Submitted == 12);
+	CHECK(cache.GetStats().Filtered == 6);
+
+	// Only what differs reaches the device
+	device.Clear();
+	cache.SetInputLayout(otherLayout);
+	cache.SetVertexShader(vertexShader);
+	cache.SetVertexShader(otherVertexShader);
+	cache.SetVertexBuffer(0, vertexBuffer, 28, 64);		// New offset
+	cache.SetVertexBuffer(1, vertexBuffer, 28, 64);		// Another slot
+	cache.SetVSConstantBufferRange(0, constantBuffer, 16, 16);
+	cache.SetVSConstantBufferRange(0, constantBuffer, 16, 16);
+	CHECK(device.GetCalls().size() == 5);
+	CHECK(device.CountOf(RenderCallType::SetVertexShader) == 1);
+	CHECK(device.GetCalls()[1].Object == otherVertexShader);
+	CHECK(device.CountOf(RenderCallType::SetVertexBuffer) == 2);
+	CHECK(device.GetCalls()[2].Offset == 64);
+	CHECK(cache.GetStats().Submitted == 19 && cache.GetStats().Filtered == 8);
+}
+
+TEST_CASE("Whole and ranged constant buffer binds are told apart")
+{
+	RecordingRenderContext device;
+	StateCache cache(device);
+
+	cache.SetVSConstantBuffer(0, constantBuffer);
+	cache.SetVSConstantBufferRange(0, constantBuffer, 0, 16);
+	cache.SetVSConstantBuffer(0, constantBuffer);
+	cache.SetVSConstantBuffer(0, constantBuffer);
+	CHECK(device.CountOf(RenderCallType::SetVSConstantBuffer) == 2);
+	CHECK(device.CountOf(RenderCallType::SetVSConstantBufferRange) == 1);
+	CHECK(cache.GetStats().Filtered == 1);
+}
+
+TEST_CASE("Untracked slots, uploads and draws always go through")
+{
+	RecordingRenderContext device;
+	StateCache cache(device);
+
+	float data[4] = {};
+	for (int i = 0; i < 2; i++)
+	{
+		cache.SetVertexBuffer(StateCache::VertexBufferSlots, vertexBuffer, 16, 0);
+		cache.SetVSConstantBuffer(StateCache::ConstantBufferSlots, constantBuffer);
+		cache.UploadBuffer(constantBuffer, data, sizeof(data));
+		cache.DrawIndexed(36, 0, 0);
+		cache.DrawIndexedInstanced(36, 4, 0, 0, 0);
+	}
+	CHECK(device.GetCalls().size() == 10);
+
+	// Uploads and draws aren't state, so they aren't counted
+	CHECK(cache.GetStats().Submitted == 4 && cache.GetStats().Filtered == 0);
+}
+
+TEST_CASE("Invalidate forces the next bind of everything through")
+{
+	RecordingRenderContext device;
+	StateCache cache(device);
+	BindEverything(cache);
+
+	// Something behind the cache's back changed the device
+	device.Clear();
+	cache.Invalidate();
+	BindEverything(cache);
+	CHECK(device.GetCalls().size() == 6);
+
+	// Then it's known again
+	BindEverything(cache);
+	CHECK(device.GetCalls().size() == 6);
+
+	// Even unbinding (null) goes through once nothing's known
+	device.Clear();
+	cache.Invalidate();
+	cache.SetPixelShader(nullptr);
+	cache.SetPixelShader(nullptr);
+	cache.SetVertexBuffer(1, otherVertexBuffer, 0, 0);
+	CHECK(device.CountOf(RenderCallType::SetPixelShader) == 1);
+	CHECK(device.GetCalls()[0].Object == nullptr);
+
+	// ResetStats only clears the counts
+	cache.ResetStats();
+	cache.SetPixelShader(nullptr);
+	CHECK(cache.GetStats().Submitted == 1 && cache.GetStats().Filtered == 1);
+	CHECK(device.CountOf(RenderCallType::SetPixelShader) == 1);
+}
+
+TEST_MAIN()
@@ -0,0 +1,135 @@
+#include "TestHarness.h"
+
+#include "StaticBatcher.h"
+
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// A unit quad in the xy plane facing -z (clockwise from the front,
+	// as D3D culls), with normals and tangents to match
+	const unsigned int quadIndices[] = { 0, 1, 2, 0, 2, 3 };
+
+	std::vector<LitVertex> LitQuad()
+	{
+		XMFLOAT3 corners[] = { { 0, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 } };
+		std::vector<LitVertex> vertices(4);
+		for (int i = 0; i < 4; i++)
+		{
+			vertices[i].Position = corners[i];
+			vertices[i].Normal = XMFLOAT3(0, 0, -1);
+			vertices[i].Tangent = XMFLOAT4(1, 0, 0, 1);
+			vertices[i].UV = XMFLOAT2(corners[i].x, 1.0f - corners[i].y);
+			vertices[i].Color = XMFLOAT4(1, 1, 1, 1);
+		}
+		return vertices;
+	}
+
+	XMFLOAT4X4 Store(XMMATRIX matrix)
+	{
+		XMFLOAT4X4 stored;
+		XMStoreFloat4x4(&stored, matrix);
+		return stored;
+	}
+
+	// Left-handed, clockwise front faces: the face normal is (b - a) x (c - a)
+	XMVECTOR FaceNormal(const std::vector<LitVertex>& vertices, const unsigned int* tri)
+	{
+		XMVECTOR a = XMLoadFloat3(&vertices[tri[0]].Position);
+		XMVECTOR b = XMLoadFloat3(&vertices[tri[1]].Position);
+		XMVECTOR c = XMLoadFloat3(&vertices[tri[2]].Position);
+		return XMVector3Normalize(XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a)));
+	}
+
+	float Dot(XMVECTOR a, const XMFLOAT3& b)
+	{
+		return XMVectorGetX(XMVector3Dot(a, XMLoadFloat3(&b)));
+	}
+}
+
+TEST_CASE("Objects batch by material and cell, and split when full")
+{
+	Vertex triangle[] = { { XMFLOAT3(0, 0, 0), XMFLOAT4(1, 1, 1, 1) }, { XMFLOAT3(0, 1, 0), XMFLOAT4(1, 1, 1, 1) }, { XMFLOAT3(1, 0, 0), XMFLOAT4(1, 1, 1, 1) } };
+	unsigned int indices[] = { 0, 1, 2 };
+
+	StaticBatcher batcher(10.0f, 9);
+	for (int i = 0; i < 4; i++)
+		batcher.Add(triangle, 3, indices, 3, Store(XMMatrixTranslation(i * 1.0f, 0, 0)), 0);
+	batcher.Add(triangle, 3, indices, 3, Store(XMMatrixTranslation(25.0f, 0, 0)), 0);
+	batcher.Add(triangle, 3, indices, 3, Store(XMMatrixIdentity()), 1);
+	CHECK(batcher.GetObjectCount() == 6);
+
+	// Material 0, cell 0 holds four triangles but only three fit
+	std::vector<StaticBatch> batches = batcher.Build();
+	CHECK(batches.size() == 4);
+	CHECK(batches[0].MaterialID == 0 && batches[0].CellX == 0 && batches[0].SourceCount == 3);
+	CHECK(batches[1].MaterialID == 0 && batches[1].CellX == 0 && batches[1].SourceCount == 1);
+	CHECK(batches[2].MaterialID == 0 && batches[2].CellX == 2);
+	CHECK(batches[3].MaterialID == 1);
+
+	// Indices are rebased onto each batch's vertices
+	CHECK((batches[0].Indices == std::vector<unsigned int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8 }));
+	CHECK_NEAR(batches[0].Vertices[8].Position.x, 3.0, 1e-6);
+	CHECK_NEAR(batches[2].Bounds.Center.x, 25.5, 1e-5);
+}
+
+TEST_CASE("Mirrored objects keep their winding and handedness")
+{
+	std::vector<LitVertex> quad = LitQuad();
+	LitStaticBatcher batcher(100.0f);
+	batcher.Add(quad.data(), 4, quadIndices, 6, Store(XMMatrixIdentity()), 0);
+	batcher.Add(quad.data(), 4, quadIndices, 6, Store(XMMatrixScaling(-1, 1, 1)), 1);
+	std::vector<LitStaticBatch> batches = batcher.Build();
+	CHECK(batches.size() == 2);
+
+	for (const LitStaticBatch& batch : batches)
+	{
+		// Vertex normals agree with the winding, so nothing gets culled inside out
+		for (size_t t = 0; t < batch.Indices.size(); t += 3)
+		{
+			XMVECTOR face = FaceNormal(batch.Vertices, &batch.Indices[t]);
+			for (int k = 0; k < 3; k++)
+				CHECK(Dot(face, batch.Vertices[batch.Indices[t + k]].Normal) > 0.99f);
+		}
+	}
+
+	// Mirroring turns the tangent around and flips the bitangent sign
+	const LitVertex& mirrored = batches[1].Vertices[0];
+	CHECK_NEAR(mirrored.Normal.z, -1.0, 1e-6);
+	CHECK_NEAR(mirrored.Tangent.x, -1.0, 1e-6);
+	CHECK(mirrored.Tangent.w == -1.0f);
+	CHECK(batches[0].Vertices[0].Tangent.w == 1.0f);
+}
+
+TEST_CASE("Normals stay perpendicular under non-uniform scale")
+{
+	// A slanted quad, then squashed - transforming the normal by the
+	// world matrix itself would leave it leaning off the surface
+	std::vector<LitVertex> quad = LitQuad();
+	XMMATRIX world = XMMatrixMultiply(XMMatrixRotationY(0.7f), XMMatrixScaling(4.0f, 1.0f, 0.25f));
+	world = XMMatrixMultiply(world, XMMatrixTranslation(3, 2, 1));
+
+	LitStaticBatcher batcher(100.0f);
+	batcher.Add(quad.data(), 4, quadIndices, 6, Store(world), 0);
+	std::vector<LitStaticBatch> batches = batcher.Build();
+	const std::vector<LitVertex>& vertices = batches[0].Vertices;
+
+	XMVECTOR face = FaceNormal(vertices, &batches[0].Indices[0]);
+	XMVECTOR edge = XMVector3Normalize(XMVectorSubtract(XMLoadFloat3(&vertices[3].Position), XMLoadFloat3(&vertices[0].Position)));
+	for (const LitVertex& v : vertices)
+	{
+		CHECK(Dot(face, v.Normal) > 0.9999f);
+		CHECK_NEAR(XMVectorGetX(XMVector3Length(XMLoadFloat3(&v.Normal))), 1.0, 1e-5);
+
+		// The tangent still runs along the quad's u edge, in the surface
+		XMFLOAT3 tangent(v.Tangent.x, v.Tangent.y, v.Tangent.z);
+		CHECK(Dot(edge, tangent) > 0.9999f);
+		CHECK_NEAR(Dot(face, tangent), 0.0, 1e-5);
+	}
+}
+
+TEST_MAIN()
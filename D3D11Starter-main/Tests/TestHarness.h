@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+// --------------------------------------------------------
+// Just enough of a test framework for the CPU-only tests
+//
+// Each test file is its own executable: TEST_CASE()s run in
+// the order they're written, CHECK()s print failures and
+// keep going, and TEST_MAIN()'s main() fails if any did -
+// which is all ctest looks at.
+// --------------------------------------------------------
+namespace TestHarness
+{
+	typedef void (*TestFunction)();
+
+	struct TestCase
+	{
+		const char* Name;
+		TestFunction Function;
+	};
+
+	inline TestCase testCases[256];
+	inline int testCaseCount = 0;
+	inline int failureCount = 0;
+
+	struct Registrar
+	{
+		Registrar(const char* name, TestFunction function)
+		{
+			testCases[testCaseCount++] = { name, function };
+		}
+	};
+
+	inline void Fail(const char* file, int line, const char* expression)
+	{
+		std::printf("  FAILED %s(%d): %s\n", file, line, expression);
+		failureCount++;
+	}
+
+	// Runs every test case, returning the number of failed checks
+	inline int RunAll()
+	{
+		for (int i = 0; i < testCaseCount; i++)
+		{
+			int failuresBefore = failureCount;
+			std::printf("%s\n", testCases[i].Name);
+			testCases[i].Function();
+			if (failureCount != failuresBefore)
+				std::printf("  %d check(s) failed\n", failureCount - failuresBefore);
+		}
+
+		std::printf("%d test case(s), %d failed check(s)\n", testCaseCount, failureCount);
+		return failureCount;
+	}
+
+	// Milliseconds per run of body, the best of a few repeats
+	// so one unlucky context switch doesn't decide it
+	template <typename Body>
+	double TimeMilliseconds(int repeats, Body body)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		double best = 1e30;
+		for (int i = 0; i < repeats; i++)
+		{
+			Clock::time_point start = Clock::now();
+			body();
+			double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			if (elapsed < best)
+				best = elapsed;
+		}
+		return best;
+	}
+}
+
+#define TEST_HARNESS_JOIN2(a, b) a##b
+#define TEST_HARNESS_JOIN(a, b) TEST_HARNESS_JOIN2(a, b)
+
+#define TEST_CASE(name) \
+	static void TEST_HARNESS_JOIN(TestCase_, __LINE__)(); \
+	static TestHarness::Registrar TEST_HARNESS_JOIN(TestRegistrar_, __LINE__)(name, &TEST_HARNESS_JOIN(TestCase_, __LINE__)); \
+	static void TEST_HARNESS_JOIN(TestCase_, __LINE__)()
+
+#define CHECK(expression) \
+	do { if (!(expression)) TestHarness::Fail(__FILE__, __LINE__, #expression); } while (false)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+	do { if (!(std::fabs((double)(actual) - (double)(expected)) <= (double)(tolerance))) TestHarness::Fail(__FILE__, __LINE__, #actual " ~= " #expected); } while (false)
+
+#define TEST_MAIN() \
+	int main() { return TestHarness::RunAll() == 0 ? 0 : 1; }
@@ -0,0 +1,107 @@
+#include "TestHarness.h"
+
+#include "PrimitiveGenerators.h"
+#include "VertexWelder.h"
+
+#include <vector>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	Vertex At(float x, float y, float z)
+	{
+		return { XMFLOAT3(x, y, z), XMFLOAT4(1, 1, 1, 1) };
+	}
+}
+
+TEST_CASE("Exact duplicates weld and -0 matches +0")
+{
+	std::vector<Vertex> vertices = { At(0, 0, 0), At(1, 0, 0), At(-0.0f, 0, 0), At(1, 0, 0), At(0, 1, 0) };
+	std::vector<unsigned int> indices = { 0, 1, 4, 2, 4, 3 };
+	WeldResult result = VertexWelder::Weld(vertices, indices);
+
+	CHECK(result.OriginalVertexCount == 5);
+	CHECK(result.WeldedVertexCount == 3);
+	CHECK(result.Removed() == 2);
+	CHECK(result.DegenerateTriangles == 0);
+	CHECK((indices == std::vector<unsigned int>{ 0, 1, 2, 0, 2, 1 }));
+}
+
+TEST_CASE("Vertices either side of a cell border still weld")
+{
+	// Grid cells are twice epsilon wide, so 0.1999 and 0.2001 land
+	// in different cells although they're well within epsilon - on
+	// every axis at once for the last one
+	const float epsilon = 0.1f;
+	Vertex vertices[] = { At(0.1999f, 5, 5), At(0.2001f, 5, 5), At(0.2001f, 4.9999f, 0.4001f), At(0.1999f, 4.95f, 0.3999f) };
+	unsigned int remap[4];
+	CHECK(VertexWelder::BuildRemap(vertices, 4, epsilon, remap) == 2);
+	CHECK(remap[0] == 0 && remap[1] == 0 && remap[2] == 1 && remap[3] == 1);
+}
+
+TEST_CASE("Every attribute is held to epsilon, not just the cell")
+{
+	const float epsilon = 0.01f;
+	Vertex vertices[] = { At(1, 1, 1), At(1.005f, 1, 1), At(1, 1, 1), At(1.02f, 1, 1) };
+	vertices[2].Color = XMFLOAT4(1, 0.5f, 1, 1);
+	unsigned int remap[4];
+	CHECK(VertexWelder::BuildRemap(vertices, 4, epsilon, remap) == 3);
+	CHECK(remap[1] == remap[0]);
+	CHECK(remap[2] != remap[0]);
+	CHECK(remap[3] != remap[0]);
+
+	// Lit vertices carry more than color - a sharp edge's normals stay apart
+	LitVertex lit[2] = {};
+	lit[0].Normal = XMFLOAT3(0, 1, 0);
+	lit[1].Normal = XMFLOAT3(1, 0, 0);
+	unsigned int litRemap[2];
+	CHECK(VertexWelder::BuildRemap(lit, 2, epsilon, litRemap) == 2);
+}
+
+TEST_CASE("Huge coordinates and tiny epsilons don't overflow the grid")
+{
+	// Old int32 cells turned 1e6 / 1e-6 into garbage, so these two - a long
+	// way apart - could share a cell; the near pair must still weld
+	const float epsilon = 1e-6f;
+	Vertex vertices[] = { At(1e6f, 0, 0), At(-1e6f, 0, 0), At(3e9f, 0, 0), At(3e9f, 0, 0), At(-3e38f, 0, 0) };
+	unsigned int remap[5];
+	CHECK(VertexWelder::BuildRemap(vertices, 5, epsilon, remap) == 4);
+	CHECK(remap[0] != remap[1]);
+	CHECK(remap[2] == remap[3]);
+	CHECK(remap[4] != remap[0]);
+}
+
+TEST_CASE("Triangles collapsed by the weld are removed")
+{
+	// A sliver whose two close corners merge, next to a normal triangle
+	std::vector<Vertex> vertices = { At(0, 0, 0), At(1, 0, 0), At(1.0001f, 0, 0), At(0, 1, 0) };
+	std::vector<unsigned int> indices = { 0, 1, 3, 1, 2, 3 };
+	WeldResult result = VertexWelder::Weld(vertices, indices, 0.001f);
+
+	CHECK(result.WeldedVertexCount == 3);
+	CHECK(result.DegenerateTriangles == 1);
+	CHECK((indices == std::vector<unsigned int>{ 0, 1, 2 }));
+}
+
+TEST_CASE("Welding a generated sphere leaves one vertex per point")
+{
+	// The generator repeats the seam column and the poles for their UVs,
+	// which plain vertices don't have - so every repeat welds away
+	const unsigned int segments = 32, rings = 16;
+	PrimitiveSize size = PrimitiveGenerators::SphereSize(segments, rings);
+	std::vector<Vertex> vertices(size.VertexCount);
+	std::vector<unsigned int> indices(size.IndexCount);
+	PrimitiveGenerators::Sphere(vertices, indices, 1.0f, segments, rings);
+
+	WeldResult result = VertexWelder::Weld(vertices, indices, 1e-5f);
+	CHECK(result.WeldedVertexCount == (int)(segments * (rings - 1) + 2));
+	CHECK(result.DegenerateTriangles == 0);
+	CHECK(indices.size() == size.IndexCount);
+	for (unsigned int index : indices)
+		CHECK(index < vertices.size());
+}
+
+TEST_MAIN()
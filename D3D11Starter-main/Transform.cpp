@@ -11,3 +11,40 @@ Transform::Transform() : position(0, 0, 0), rotation(0, 0, 0), scale(1, 1, 1)
 Transform::~Transform()
 {
 }
+
+void Transform::SetPosition(float x, float y, float z) { position = XMFLOAT3(x, y, z); }
+void Transform::SetPosition(DirectX::XMFLOAT3 position) { this->position = position; }
+void Transform::SetRotation(float pitch, float yaw, float roll) { rotation = XMFLOAT3(pitch, yaw, roll); }
+void Transform::SetRotation(DirectX::XMFLOAT3 rotation) { this->rotation = rotation; }
+void Transform::SetScale(float x, float y, float z) { scale = XMFLOAT3(x, y, z); }
+void Transform::SetScale(DirectX::XMFLOAT3 scale) { this->scale = scale; }
+
+// --------------------------------------------------------
+// Moves along the object's own axes (so forward is
+// wherever it's currently facing)
+// --------------------------------------------------------
+void Transform::MoveRelative(float x, float y, float z)
+{
+	XMVECTOR orientation = XMQuaternionRotationRollPitchYaw(rotation.x, rotation.y, rotation.z);
+	XMVECTOR offset = XMVector3Rotate(XMVectorSet(x, y, z, 0.0f), orientation);
+	XMStoreFloat3(&position, XMVectorAdd(XMLoadFloat3(&position), offset));
+}
+
+void Transform::Rotate(float pitch, float yaw, float roll)
+{
+	rotation.x += pitch;
+	rotation.y += yaw;
+	rotation.z += roll;
+}
+
+DirectX::XMFLOAT3 Transform::GetPosition() { return position; }
+DirectX::XMFLOAT3 Transform::GetPitchYawRoll() { return rotation; }
+
+// Local +Z, rotated to face wherever the object does
+DirectX::XMFLOAT3 Transform::GetForward()
+{
+	XMFLOAT3 forward;
+	XMVECTOR orientation = XMQuaternionRotationRollPitchYaw(rotation.x, rotation.y, rotation.z);
+	XMStoreFloat3(&forward, XMVector3Rotate(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), orientation));
+	return forward;
+}
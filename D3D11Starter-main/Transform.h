@@ -17,9 +17,14 @@ public:
 	void SetScale(float x, float y, float z);
 	void SetScale(DirectX::XMFLOAT3 scale);
 
+	// Transformers
+	void MoveRelative(float x, float y, float z);
+	void Rotate(float pitch, float yaw, float roll);
+
 	// Getters
 	DirectX::XMFLOAT3 GetPosition();
 	DirectX::XMFLOAT3 GetPitchYawRoll(); // XMFLOAT4 GetRotation() for quaternion
+	DirectX::XMFLOAT3 GetForward();
 
 private:
 	// Raw Transformational Data
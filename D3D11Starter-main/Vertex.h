@@ -11,4 +11,20 @@ struct Vertex
 {
 	DirectX::XMFLOAT3 Position;	    // The local position of the vertex
 	DirectX::XMFLOAT4 Color;        // The color of the vertex
-};
\ No newline at end of file
+};
+
+// --------------------------------------------------------
+// A full-precision vertex with the attributes needed for
+// lighting and texturing
+//
+// This is the "source" format that the packed vertex
+// encoders (see PackedVertex.h) read from
+// --------------------------------------------------------
+struct LitVertex
+{
+	DirectX::XMFLOAT3 Position;	    // The local position of the vertex
+	DirectX::XMFLOAT3 Normal;       // Unit length surface normal
+	DirectX::XMFLOAT4 Tangent;      // Tangent (xyz) and bitangent handedness (w)
+	DirectX::XMFLOAT2 UV;           // Texture coordinate
+	DirectX::XMFLOAT4 Color;        // The color of the vertex
+};
@@ -0,0 +1,37 @@
+// Struct representing a single vertex worth of data for
+// position-only passes (depth, shadows, occlusion)
+// - Should match a mesh's position stream: one float3 per vertex
+struct VertexShaderInput
+{ 
+	// Data type
+	//  |
+	//  |   Name          Semantic
+	//  |    |                |
+	//  v    v                v
+	float3 localPosition	: POSITION;     // XYZ position
+};
+
+// Only the position goes down the pipeline - these passes
+// usually run with no pixel shader at all
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;	// XYZW position (System Value Position)
+};
+
+// Constant Buffer External Shader data
+// - Same layout as VertexShader.hlsl, so the same buffer works for both
+cbuffer ExternalData : register(b0)
+{
+	float4 colorTint;
+	matrix world;
+};
+
+// --------------------------------------------------------
+// The entry point (main method) for our position-only vertex shader
+// --------------------------------------------------------
+VertexToPixel main( VertexShaderInput input )
+{
+	VertexToPixel output;
+	output.screenPosition = mul(world, float4(input.localPosition, 1.0f));
+	return output;
+}
@@ -0,0 +1,21 @@
+
+// Struct representing the data we're sending down the pipeline
+// - Should match the full screen pixel shaders' input
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;	// XYZW position (System Value Position)
+	float2 uv				: TEXCOORD;     // [0, 1] across the target, v down
+};
+
+// --------------------------------------------------------
+// The entry point (main method) for our full screen vertex shader
+// - No vertex buffer: three vertices make one triangle that
+//   covers the whole target, worked out from the vertex id
+// --------------------------------------------------------
+VertexToPixel main( uint id : SV_VertexID )
+{
+	VertexToPixel output;
+	output.uv = float2((id << 1) & 2, id & 2);
+	output.screenPosition = float4(output.uv * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+	return output;
+}
@@ -0,0 +1,58 @@
+// Struct representing a single vertex worth of data, plus
+// the data of the instance it's being drawn for
+// - Slot 0 (per vertex) should match our Vertex struct
+// - Slot 1 (per instance) should match our InstanceData struct
+struct VertexShaderInput
+{ 
+	// Data type
+	//  |
+	//  |   Name          Semantic
+	//  |    |                |
+	//  v    v                v
+	float3 localPosition	: POSITION;     // XYZ position
+	float4 color			: COLOR;        // RGBA color
+
+	// Per-instance data
+	float4 world0			: WORLD0;       // World matrix, one row at a time
+	float4 world1			: WORLD1;
+	float4 world2			: WORLD2;
+	float4 world3			: WORLD3;
+	float4 tint				: TINT;         // Per-instance color tint
+};
+
+// Struct representing the data we're sending down the pipeline
+// - Should match our pixel shader's input (hence the name: Vertex to Pixel)
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;	// XYZW position (System Value Position)
+	float4 color			: COLOR;        // RGBA color
+};
+
+// Constant Buffer External Shader data
+// - Same layout as VertexShader.hlsl, so the same buffer works for both
+// - world is applied on top of each instance's own world matrix
+cbuffer ExternalData : register(b0)
+{
+	float4 colorTint;
+	matrix world;
+};
+
+// --------------------------------------------------------
+// The entry point (main method) for our instanced vertex shader
+// --------------------------------------------------------
+VertexToPixel main( VertexShaderInput input )
+{
+	// Set up output struct
+	VertexToPixel output;
+
+	// The instance matrix arrives as four rows straight from the
+	// C++ struct, so it's used with a row vector on the left
+	matrix instanceWorld = matrix(input.world0, input.world1, input.world2, input.world3);
+	float4 worldPosition = mul(float4(input.localPosition, 1.0f), instanceWorld);
+	output.screenPosition = mul(world, worldPosition);
+
+	// Both tints apply to the interpolated vertex color
+	output.color = input.color * input.tint * colorTint;
+
+	return output;
+}
@@ -0,0 +1,82 @@
+// Struct representing a single packed lit vertex
+// - Should match PackedLitVertex and PackedLitVertexLayout in our C++ code
+// - The input assembler has already expanded UNORM/SNORM/half to floats
+struct VertexShaderInput
+{
+	// Data type
+	//  |
+	//  |   Name          Semantic
+	//  |    |                |
+	//  v    v                v
+	float4 packedPosition	: POSITION;     // XYZ in [0, 1] of the mesh's bounds, W = bitangent sign in [0, 1]
+	float4 color			: COLOR;        // RGBA color
+	float2 packedNormal		: NORMAL;       // Octahedral-encoded, in [-1, 1]
+	float2 packedTangent	: TANGENT;      // Octahedral-encoded, in [-1, 1]
+	float2 uv				: TEXCOORD;     // Texture coordinate
+};
+
+// Struct representing the data we're sending down the pipeline
+// - Starts like our pixel shader's input, which only reads the color;
+//   the rest is there for pixel shaders that light per pixel
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;	// XYZW position (System Value Position)
+	float4 color			: COLOR;        // RGBA color, lit per vertex
+	float3 normal			: NORMAL;       // World space, unit length
+	float4 tangent			: TANGENT;      // World space, w = bitangent sign
+	float2 uv				: TEXCOORD;
+};
+
+// Constant Buffer External Shader data
+// - Same layout as VertexShader.hlsl, so the same buffer works for both
+// - world has the dequantization matrix folded in (see DequantizationMatrix)
+cbuffer ExternalData : register(b0)
+{
+	float4 colorTint;
+	matrix world;
+};
+
+// --------------------------------------------------------
+// Undoes VertexPacking::EncodeOctahedral() - unfolds the
+// lower hemisphere back out of the corners of the square
+// --------------------------------------------------------
+float3 DecodeOctahedral(float2 encoded)
+{
+	float3 direction = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	if (direction.z < 0.0f)
+		direction.xy = (1.0f - abs(direction.yx)) * (direction.xy >= 0.0f ? 1.0f : -1.0f);
+	return normalize(direction);
+}
+
+// --------------------------------------------------------
+// The entry point (main method) for our packed lit vertex shader
+// - Decodes the normal and tangent, then lights the vertex
+//   with a single fixed light
+// --------------------------------------------------------
+VertexToPixel main( VertexShaderInput input )
+{
+	VertexToPixel output;
+	output.screenPosition = mul(world, float4(input.packedPosition.xyz, 1.0f));
+
+	// world stretches [0, 1] out to the bounds, a different amount per
+	// axis, which directions mustn't pick up:
+	//  - Tangents were never stretched, so divide the stretch back out
+	//  - Normals need the inverse transpose, which divides by it once more
+	// The rest of world is assumed to be a rotation and a uniform scale
+	float3x3 world3 = (float3x3)world;
+	float3 stretchSq = float3(
+		dot(world3._11_21_31, world3._11_21_31),
+		dot(world3._12_22_32, world3._12_22_32),
+		dot(world3._13_23_33, world3._13_23_33));
+	float3 normal = DecodeOctahedral(input.packedNormal);
+	float3 tangent = DecodeOctahedral(input.packedTangent);
+	output.normal = normalize(mul(world3, normal / stretchSq));
+	output.tangent = float4(normalize(mul(world3, tangent * rsqrt(stretchSq))), input.packedPosition.w * 2.0f - 1.0f);
+	output.uv = input.uv;
+
+	// Half-Lambert from a light up and to the left, so the unlit side isn't flat black
+	float3 toLight = normalize(float3(-0.4f, 0.8f, -0.45f));
+	float diffuse = dot(output.normal, toLight) * 0.5f + 0.5f;
+	output.color = float4(input.color.rgb * diffuse * diffuse, input.color.a) * colorTint;
+	return output;
+}
@@ -0,0 +1,43 @@
+
+// Struct representing a single ribbon vertex
+// - Should match RibbonVertex and RibbonVertexLayout in our C++ code
+struct VertexShaderInput
+{ 
+	// Data type
+	//  |
+	//  |   Name          Semantic
+	//  |    |                |
+	//  v    v                v
+	float3 worldPosition	: POSITION;     // XYZ position, already expanded on the CPU
+	float2 uv				: TEXCOORD;     // u = age, v = across the strip
+	float4 color			: COLOR;        // RGBA color, alpha faded by age
+};
+
+// Struct representing the data we're sending down the pipeline
+// - Should match our pixel shader's input (hence the name: Vertex to Pixel)
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;	// XYZW position (System Value Position)
+	float4 color			: COLOR;        // RGBA color
+};
+
+// Constant Buffer External Shader data
+// - Same layout as VertexShader.hlsl, so the same buffer works for both
+cbuffer ExternalData : register(b0)
+{
+	float4 colorTint;
+	matrix world;
+};
+
+// --------------------------------------------------------
+// The entry point (main method) for our ribbon vertex shader
+// - The strips are built facing the eye on the CPU, so all
+//   that's left is the transform and the tint
+// --------------------------------------------------------
+VertexToPixel main( VertexShaderInput input )
+{
+	VertexToPixel output;
+	output.screenPosition = mul(world, float4(input.worldPosition, 1.0f));
+	output.color = input.color * colorTint;
+	return output;
+}
@@ -0,0 +1,42 @@
+
+// Struct representing a single UI vertex
+// - Should match PacketUiVertex and the layout in D3D11UiRenderer
+struct VertexShaderInput
+{ 
+	// Data type
+	//  |
+	//  |   Name          Semantic
+	//  |    |                |
+	//  v    v                v
+	float2 position			: POSITION;     // XY position, in UI pixels
+	float2 uv				: TEXCOORD;     // Into the UI's texture (its font atlas, usually)
+	float4 color			: COLOR;        // RGBA color, unpacked from RGBA8
+};
+
+// Struct representing the data we're sending down the pipeline
+// - Should match PixelShaderUi's input
+struct VertexToPixel
+{
+	float4 screenPosition	: SV_POSITION;	// XYZW position (System Value Position)
+	float2 uv				: TEXCOORD;
+	float4 color			: COLOR;
+};
+
+// Constant Buffer External Shader data
+// - Should match UiConstants in D3D11UiRenderer.cpp
+cbuffer ExternalData : register(b0)
+{
+	matrix projection;	// Orthographic, UI pixels to the screen
+};
+
+// --------------------------------------------------------
+// The entry point (main method) for our UI vertex shader
+// --------------------------------------------------------
+VertexToPixel main( VertexShaderInput input )
+{
+	VertexToPixel output;
+	output.screenPosition = mul(projection, float4(input.position, 0.0f, 1.0f));
+	output.uv = input.uv;
+	output.color = input.color;
+	return output;
+}
@@ -0,0 +1,236 @@
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	const unsigned int emptySlot = 0xFFFFFFFF;
+
+	// Every vertex format here is made purely of floats,
+	// and every one starts with its position
+	template <typename T>
+	constexpr int componentCount = sizeof(T) / sizeof(float);
+
+	// A grid cell, one coordinate per position axis
+	struct Cell
+	{
+		int64_t Coords[3];
+		int8_t Nearer[3];	// Which neighbor is nearer: -1 or +1, 0 when exact
+
+		bool operator==(const Cell& other) const
+		{
+			return Coords[0] == other.Coords[0] && Coords[1] == other.Coords[1] && Coords[2] == other.Coords[2];
+		}
+	};
+
+	// --------------------------------------------------------
+	// The cell a position falls in
+	//  - epsilon == 0: the raw bits (with -0 folded into +0),
+	//    so only exact matches share a cell
+	//  - epsilon > 0:  the grid cell, 2 * epsilon wide, worked
+	//    out in doubles and clamped so huge coordinates or a
+	//    tiny epsilon can't overflow the integer
+	// --------------------------------------------------------
+	Cell CellOf(const float position[3], double invCellSize)
+	{
+		const double limit = 4611686018427387904.0; // 2^62
+		Cell cell = {};
+		for (int i = 0; i < 3; i++)
+		{
+			if (invCellSize > 0.0)
+			{
+				double scaled = position[i] * invCellSize;
+				double coord = std::floor(scaled);
+				cell.Coords[i] = coord == coord ? (int64_t)std::clamp(coord, -limit, limit) : 0;
+				cell.Nearer[i] = scaled - coord < 0.5 ? -1 : 1;
+			}
+			else
+			{
+				float value = position[i] == 0.0f ? 0.0f : position[i];
+				uint32_t bits;
+				memcpy(&bits, &value, sizeof(float));
+				cell.Coords[i] = bits;
+			}
+		}
+		return cell;
+	}
+
+	uint32_t HashCell(const Cell& cell)
+	{
+		// FNV-1a over the coordinates, then a final avalanche so
+		// linear probing sees well-spread low bits
+		uint64_t hash = 14695981039346656037ull;
+		for (int i = 0; i < 3; i++)
+		{
+			hash ^= (uint64_t)cell.Coords[i];
+			hash *= 1099511628211ull;
+		}
+		hash ^= hash >> 32;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+		return (uint32_t)hash;
+	}
+
+	// Is every component of a within epsilon of b's?
+	template <typename T>
+	bool WithinEpsilon(const float* a, const float* b, float epsilon)
+	{
+		for (int i = 0; i < componentCount<T>; i++)
+		{
+			if (!(std::fabs(a[i] - b[i]) <= epsilon))
+				return false;
+		}
+		return true;
+	}
+
+	// --------------------------------------------------------
+	// Welding looks up the position's cell in a hash table,
+	// where each cell holds a chain of the representatives
+	// that fell in it. With epsilon > 0 a vertex right across
+	// a cell border can still be within epsilon, so neighbors
+	// are searched too - cells are twice epsilon wide, so on
+	// each axis only the neighbor on the nearer side can hold
+	// a match, 8 cells in all rather than 27. Every component
+	// is then compared against epsilon before merging, not
+	// just the position the cell came from.
+	// --------------------------------------------------------
+	template <typename T>
+	int BuildRemapImpl(const T* vertices, int count, float epsilon, unsigned int* remap)
+	{
+		if (count <= 0)
+			return 0;
+
+		double invCellSize = epsilon > 0.0f ? 0.5 / epsilon : 0.0;
+
+		// Components are copied out once so comparisons are flat loops
+		std::vector<float> components((size_t)count * componentCount<T>);
+		memcpy(components.data(), vertices, sizeof(T) * count);
+		std::vector<Cell> cells(count);
+		for (int i = 0; i < count; i++)
+			cells[i] = CellOf(&components[(size_t)i * componentCount<T>], invCellSize);
+
+		// Power of two table at most half full (there are never
+		// more occupied cells than vertices)
+		size_t tableSize = 1;
+		while (tableSize < (size_t)count * 2)
+			tableSize <<= 1;
+		std::vector<unsigned int> table(tableSize, emptySlot);
+		std::vector<unsigned int> nextInCell(count, emptySlot);
+		size_t mask = tableSize - 1;
+
+		// The slot holding a cell's chain, or the empty slot it would go in
+		auto findSlot = [&](const Cell& cell)
+			{
+				size_t slot = HashCell(cell) & mask;
+				while (table[slot] != emptySlot && !(cells[table[slot]] == cell))
+					slot = (slot + 1) & mask;
+				return slot;
+			};
+
+		int unique = 0;
+		for (int i = 0; i < count; i++)
+		{
+			const float* vertex = &components[(size_t)i * componentCount<T>];
+			unsigned int match = emptySlot;
+
+			// Bit k of the corner picks the nearer neighbor on axis k
+			const Cell& home = cells[i];
+			int corners = epsilon > 0.0f ? 8 : 1;
+			for (int corner = 0; corner < corners && match == emptySlot; corner++)
+			{
+				Cell neighbor = home;
+				for (int k = 0; k < 3; k++)
+					neighbor.Coords[k] += (corner >> k & 1) ? home.Nearer[k] : 0;
+				for (unsigned int rep = table[findSlot(neighbor)]; rep != emptySlot; rep = nextInCell[rep])
+				{
+					if (WithinEpsilon<T>(vertex, &components[(size_t)rep * componentCount<T>], epsilon))
+					{
+						match = rep;
+						break;
+					}
+				}
+			}
+
+			if (match != emptySlot)
+			{
+				remap[i] = remap[match];
+				continue;
+			}
+
+			// New vertex - it keeps its place in the output, and
+			// joins the front of its cell's chain
+			size_t slot = findSlot(cells[i]);
+			nextInCell[i] = table[slot];
+			table[slot] = (unsigned int)i;
+			remap[i] = (unsigned int)unique++;
+		}
+
+		return unique;
+	}
+
+	template <typename T>
+	WeldResult WeldImpl(std::vector<T>& vertices, std::vector<unsigned int>& indices, float epsilon)
+	{
+		WeldResult result = {};
+		result.OriginalVertexCount = (int)vertices.size();
+
+		std::vector<unsigned int> remap(vertices.size());
+		int unique = BuildRemapImpl(vertices.data(), (int)vertices.size(), epsilon, remap.data());
+
+		// Representatives always come before their duplicates and get
+		// increasing new indices, so the compaction can happen in place
+		unsigned int next = 0;
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			if (remap[i] == next)
+				vertices[next++] = vertices[i];
+		}
+		vertices.resize(unique);
+
+		// Remap, dropping any triangle that now uses a vertex twice
+		size_t kept = 0;
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			unsigned int a = remap[indices[t]];
+			unsigned int b = remap[indices[t + 1]];
+			unsigned int c = remap[indices[t + 2]];
+			if (a == b || b == c || c == a)
+			{
+				result.DegenerateTriangles++;
+				continue;
+			}
+			indices[kept++] = a;
+			indices[kept++] = b;
+			indices[kept++] = c;
+		}
+		indices.resize(kept);
+
+		result.WeldedVertexCount = unique;
+		return result;
+	}
+}
+
+int VertexWelder::BuildRemap(const Vertex* vertices, int count, float epsilon, unsigned int* remap)
+{
+	return BuildRemapImpl(vertices, count, epsilon, remap);
+}
+
+int VertexWelder::BuildRemap(const LitVertex* vertices, int count, float epsilon, unsigned int* remap)
+{
+	return BuildRemapImpl(vertices, count, epsilon, remap);
+}
+
+WeldResult VertexWelder::Weld(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float epsilon)
+{
+	return WeldImpl(vertices, indices, epsilon);
+}
+
+WeldResult VertexWelder::Weld(std::vector<LitVertex>& vertices, std::vector<unsigned int>& indices, float epsilon)
+{
+	return WeldImpl(vertices, indices, epsilon);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "Vertex.h"
+
+// --------------------------------------------------------
+// Vertex welding - merges duplicate vertices and remaps
+// the index buffer to match
+//
+// Positions are hashed into a grid of epsilon-sized cells
+// (or by their exact bits when epsilon is zero) through an
+// open-addressing table, so the whole pass stays linear in
+// the vertex count. A vertex merges into the first earlier
+// representative - searched in its own cell and the ones
+// around it - whose every attribute is within epsilon, so
+// each merged vertex is within epsilon of the one kept.
+// Triangles the merge leaves degenerate are removed.
+// --------------------------------------------------------
+
+// Reports how much a weld removed
+struct WeldResult
+{
+	int OriginalVertexCount;
+	int WeldedVertexCount;
+	int DegenerateTriangles;	// Dropped from the index buffer
+
+	int Removed() const { return OriginalVertexCount - WeldedVertexCount; }
+};
+
+namespace VertexWelder
+{
+	// Low level - fills remap[i] with the new index of vertex i and
+	// returns the number of unique vertices. Doesn't move anything.
+	int BuildRemap(const Vertex* vertices, int count, float epsilon, unsigned int* remap);
+	int BuildRemap(const LitVertex* vertices, int count, float epsilon, unsigned int* remap);
+
+	// Convenience for loaders - welds and compacts the arrays in place,
+	// leaving out triangles that no longer have three distinct corners
+	WeldResult Weld(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float epsilon = 0.0f);
+	WeldResult Weld(std::vector<LitVertex>& vertices, std::vector<unsigned int>& indices, float epsilon = 0.0f);
+}
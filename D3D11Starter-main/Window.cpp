@@ -42,6 +42,7 @@ namespace Window
 		// Function pointer to call
 		// when the window resizes
 		void (*onResize)() = 0;
+		void (*onBeforeResize)() = 0;
 
 		// Basic FPS tracking
 		float fpsTimeElapsed = 0.0f;
@@ -68,6 +69,8 @@ bool Window::IsMinimized() { return isMinimized; }
 // titleBarText    - Window's title bar text
 // statsInTitleBar - Want debug stats (like FPS) in title bar?
 // resizeCallback  - The function to call when the window resizes
+// beforeResizeCallback - The function to call just before the
+//                   buffers are resized (optional)
 // --------------------------------------------------------
 HRESULT Window::Create(
 	HINSTANCE appInstance,
@@ -75,7 +78,8 @@ HRESULT Window::Create(
 	unsigned int height, 
 	std::wstring titleBarText,
 	bool statsInTitleBar,
-	void (*resizeCallback)())
+	void (*resizeCallback)(),
+	void (*beforeResizeCallback)())
 {
 	// Verify
 	if (windowCreated)
@@ -87,6 +91,7 @@ HRESULT Window::Create(
 	windowTitle = titleBarText;
 	windowStats = statsInTitleBar;
 	onResize = resizeCallback;
+	onBeforeResize = beforeResizeCallback;
 
 	// Start window creation by filling out the
 	// appropriate window class struct
@@ -304,6 +309,8 @@ LRESULT Window::ProcessMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPara
 		windowHeight = HIWORD(lParam);
 
 		// Let other systems know
+		if (onBeforeResize)
+			onBeforeResize();
 		Graphics::ResizeBuffers(windowWidth, windowHeight);
 		if(onResize)
 			onResize();
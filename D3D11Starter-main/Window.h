@@ -20,7 +20,8 @@ namespace Window
 		unsigned int height,
 		std::wstring titleBarText,
 		bool statsInTitleBar,
-		void (*resizeCallback)());
+		void (*resizeCallback)(),
+		void (*beforeResizeCallback)() = 0);
 	void UpdateStats(float totalTime);
 	void Quit();
 
@@ -0,0 +1,135 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+// Annonymous namespace to hold variables
+// only accessible in this file
+namespace
+{
+	// Set on pool threads (and on a caller while it helps out),
+	// so nested loops know to run serially
+	thread_local bool insideParallelFor = false;
+}
+
+WorkerPool::WorkerPool(unsigned int threadCount) :
+	body(nullptr),
+	count(0),
+	chunkCount(0),
+	generation(0),
+	workersFinished(0),
+	stopping(false),
+	nextChunk(0)
+{
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	// The calling thread is one of the threads
+	for (unsigned int i = 1; i < threadCount; i++)
+		workers.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+unsigned int WorkerPool::GetThreadCount()
+{
+	return (unsigned int)workers.size() + 1;
+}
+
+// --------------------------------------------------------
+// Hands the loop to the workers, helps out, then waits
+// until every worker has let go of it
+//  - Every worker checks in once per loop, even if the
+//    chunks ran out before it woke, so none can still be
+//    holding this loop when the next one starts
+// --------------------------------------------------------
+void WorkerPool::ParallelFor(unsigned int count, unsigned int chunkCount, const ParallelForBody& body)
+{
+	chunkCount = std::min(std::max(chunkCount, 1u), std::max(count, 1u));
+	if (count == 0)
+		return;
+
+	// Nested or single chunk - no point waking anyone
+	if (insideParallelFor || chunkCount == 1 || workers.empty())
+	{
+		for (unsigned int c = 0; c < chunkCount; c++)
+		{
+			unsigned int begin = (unsigned int)((uint64_t)count * c / chunkCount);
+			unsigned int end = (unsigned int)((uint64_t)count * (c + 1) / chunkCount);
+			body(c, begin, end);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> submitLock(submitMutex);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->body = &body;
+		this->count = count;
+		this->chunkCount = chunkCount;
+		nextChunk = 0;
+		workersFinished = 0;
+		generation++;
+	}
+	wake.notify_all();
+
+	insideParallelFor = true;
+	RunChunks();
+	insideParallelFor = false;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [&]() { return workersFinished == workers.size(); });
+	this->body = nullptr;
+}
+
+void WorkerPool::WorkerLoop()
+{
+	insideParallelFor = true;
+	uint64_t seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+			if (stopping)
+				return;
+
+			seenGeneration = generation;
+		}
+
+		RunChunks();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			workersFinished++;
+		}
+		finished.notify_all();
+	}
+}
+
+// --------------------------------------------------------
+// Grabs chunks until there are none left
+// --------------------------------------------------------
+void WorkerPool::RunChunks()
+{
+	while (true)
+	{
+		unsigned int c = nextChunk.fetch_add(1);
+		if (c >= chunkCount)
+			return;
+
+		unsigned int begin = (unsigned int)((uint64_t)count * c / chunkCount);
+		unsigned int end = (unsigned int)((uint64_t)count * (c + 1) / chunkCount);
+		(*body)(c, begin, end);
+	}
+}
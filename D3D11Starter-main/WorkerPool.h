@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The work for one chunk of a ParallelFor - [begin, end) out of the full range
+using ParallelForBody = std::function<void(unsigned int chunk, unsigned int begin, unsigned int end)>;
+
+// --------------------------------------------------------
+// A fixed set of threads for data-parallel loops
+//
+// ParallelFor() splits [0, count) into chunkCount equal,
+// contiguous chunks and runs them on the workers and the
+// calling thread, returning once every chunk is done.
+//
+// Chunk boundaries only depend on count and chunkCount -
+// never on timing - so per-chunk partial results can be
+// merged in chunk order for deterministic output.
+//
+// A ParallelFor started from inside a body runs serially
+// on that thread instead of deadlocking.
+// --------------------------------------------------------
+class WorkerPool
+{
+public:
+	// Basic OOP Setup
+	explicit WorkerPool(unsigned int threadCount = 0);	// 0 = one per hardware thread
+	~WorkerPool();
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	void ParallelFor(unsigned int count, unsigned int chunkCount, const ParallelForBody& body);
+
+	// Threads that take part in a ParallelFor, including the caller
+	unsigned int GetThreadCount();
+
+private:
+	void WorkerLoop();
+	void RunChunks();
+
+	std::vector<std::thread> workers;
+
+	// Only one loop at a time
+	std::mutex submitMutex;
+
+	// Current loop - written under mutex, read by workers after waking
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	const ParallelForBody* body;
+	unsigned int count;
+	unsigned int chunkCount;
+	uint64_t generation;
+	unsigned int workersFinished;
+	bool stopping;
+
+	std::atomic<unsigned int> nextChunk;
+};